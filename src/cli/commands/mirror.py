@@ -16,11 +16,22 @@ class SppMirror(object):
     MIRROR_CMDS = {
             'status': None,
             'exit': None,
-            'component': ['start', 'stop'],
-            'port': ['add', 'del']}
+            'component': ['start', 'stop', 'move', 'weight', 'sample',
+                          'sample_rate', 'snaplen', 'copy'],
+            'port': ['add', 'del'],
+            'latency_stats': ['on', 'off'],
+            'latency': None,
+            'filter': None}
 
     WORKER_TYPES = ['mirror']
 
+    FILTER_FIELDS = ['vlan', 'proto', 'src', 'dst', 'sport', 'dport']
+
+    # Options of mirror set with `component` command.
+    MIRROR_OPTS = ['sample', 'sample_rate', 'snaplen', 'copy']
+
+    COPY_MODES = ['shallow', 'deep', 'hybrid']
+
     def __init__(self, spp_ctl_cli, sec_id, use_cache=False):
         self.spp_ctl_cli = spp_ctl_cli
         self.sec_id = sec_id
@@ -70,6 +81,15 @@ class SppMirror(object):
         elif cmd == 'port':
             self._run_port(params)
 
+        elif cmd == 'latency_stats':
+            self._run_latency_stats(params)
+
+        elif cmd == 'latency':
+            self._run_latency()
+
+        elif cmd == 'filter':
+            self._run_filter(params)
+
         elif cmd == 'exit':
             self._run_exit()
 
@@ -96,6 +116,10 @@ class SppMirror(object):
               - rx:
               - tx:
             ...
+          Mirror options:
+            - mr1: filter {'vlan': 100}
+              sample 1/10, sample_rate 0, snaplen 0, copy shallow
+              (matched: 200, unmatched: 800, mirrored: 20)
 
         """
 
@@ -141,6 +165,48 @@ class SppMirror(object):
                 # TODO(yasufum) should change 'unuse' to 'unused'
                 print("  - core:%d '' (type: unuse)" % worker['core'])
 
+        # Options, only for components not mirroring all of packets
+        if len(json_obj.get('mirror_opts', [])) > 0:
+            print('Mirror options:')
+            for ent in json_obj['mirror_opts']:
+                print('  - %s: filter %s' % (ent['name'], ent['filter']))
+                print('    sample 1/%d, sample_rate %d, snaplen %d, '
+                      'copy %s' % (ent['sample'], ent['sample_rate'],
+                                   ent['snaplen'], ent['copy']))
+                print('    (matched: %d, unmatched: %d, mirrored: %d)' % (
+                      ent['matched'], ent['unmatched'], ent['mirrored']))
+
+    def print_latency(self, json_obj):
+        """Print histograms of latency of ports.
+
+        Each entry of histogram is a pair of upper bound of latency in nano
+        sec and num of packets, and empty entries are not included.
+
+          spp > mirror 1; latency
+          Latency stats: on
+          Ports:
+            - ring:0 (max: 1520 ns)
+              - <= 206 ns: 3
+              - <= 1520 ns: 1
+          End-to-end:
+            - phy:0 -> vhost:1 (max: 8230 ns)
+              - <= 8230 ns: 2
+
+        """
+
+        print('Latency stats: %s' % json_obj['latency_stats'])
+        print('Ports:')
+        for ent in json_obj['ports']:
+            print('  - %s (max: %d ns)' % (ent['port'], ent['max']))
+            for upper, cnt in ent['hist']:
+                print('    - <= %d ns: %d' % (upper, cnt))
+        print('End-to-end:')
+        for ent in json_obj['e2e']:
+            print('  - %s -> %s (max: %d ns)' % (
+                ent['rx_port'], ent['tx_port'], ent['max']))
+            for upper, cnt in ent['hist']:
+                print('    - <= %d ns: %d' % (upper, cnt))
+
     def complete(self, sec_ids, text, line, begidx, endidx):
         """Completion for spp_mirrorcommands.
 
@@ -168,6 +234,12 @@ class SppMirror(object):
 
                     elif sub_tokens[0] == 'port':
                         completions = self._compl_port(sub_tokens)
+
+                    elif sub_tokens[0] == 'latency_stats':
+                        completions = self._compl_latency_stats(sub_tokens)
+
+                    elif sub_tokens[0] == 'filter':
+                        completions = self._compl_filter(sub_tokens)
             return completions
         except Exception as e:
             print(e)
@@ -266,6 +338,83 @@ class SppMirror(object):
                 else:
                     print('Error: unknown response.')
 
+        elif params[0] == 'move':
+            req_params = {'core': int(params[2])}
+            res = self.spp_ctl_cli.put('mirrors/%d/components/%s' % (
+                                       self.sec_id, params[1]), req_params)
+            if res is not None:
+                error_codes = self.spp_ctl_cli.rest_common_error_codes
+                if res.status_code == 204:
+                    print("Succeeded to move component '%s' to core:%d"
+                          % (params[1], req_params['core']))
+
+                    # update core IDs of moved worker
+                    old_core_id = None
+                    for wk in self.workers:
+                        if wk['name'] == params[1]:
+                            old_core_id = wk['core_id']
+                            wk['core_id'] = req_params['core']
+                            break
+                    if req_params['core'] in self.unused_core_ids:
+                        self.unused_core_ids.remove(req_params['core'])
+                    used_core_ids = [wk['core_id'] for wk in self.workers]
+                    if (old_core_id is not None and
+                            old_core_id not in used_core_ids):
+                        self.unused_core_ids.append(old_core_id)
+                elif res.status_code in error_codes:
+                    pass
+                else:
+                    print('Error: unknown response.')
+
+        elif params[0] == 'weight':
+            req_params = {'weight': int(params[2])}
+            res = self.spp_ctl_cli.put('mirrors/%d/components/%s' % (
+                                       self.sec_id, params[1]), req_params)
+            if res is not None:
+                error_codes = self.spp_ctl_cli.rest_common_error_codes
+                if res.status_code == 204:
+                    print("Succeeded to set weight of component '%s' to %d"
+                          % (params[1], req_params['weight']))
+                elif res.status_code in error_codes:
+                    pass
+                else:
+                    print('Error: unknown response.')
+
+        elif params[0] == 'copy':
+            if len(params) != 3 or params[2] not in self.COPY_MODES:
+                print('Error: copy takes NAME and one of %s.' %
+                      ', '.join(self.COPY_MODES))
+                return None
+            req_params = {'copy': params[2]}
+            res = self.spp_ctl_cli.put('mirrors/%d/components/%s' % (
+                                       self.sec_id, params[1]), req_params)
+            if res is not None:
+                error_codes = self.spp_ctl_cli.rest_common_error_codes
+                if res.status_code == 204:
+                    print("Succeeded to set copy of component '%s' to %s"
+                          % (params[1], params[2]))
+                elif res.status_code in error_codes:
+                    pass
+                else:
+                    print('Error: unknown response.')
+
+        elif params[0] in self.MIRROR_OPTS:
+            if len(params) != 3 or not params[2].isdigit():
+                print('Error: %s takes NAME and a number.' % params[0])
+                return None
+            req_params = {params[0]: int(params[2])}
+            res = self.spp_ctl_cli.put('mirrors/%d/components/%s' % (
+                                       self.sec_id, params[1]), req_params)
+            if res is not None:
+                error_codes = self.spp_ctl_cli.rest_common_error_codes
+                if res.status_code == 204:
+                    print("Succeeded to set %s of component '%s' to %d"
+                          % (params[0], params[1], req_params[params[0]]))
+                elif res.status_code in error_codes:
+                    pass
+                else:
+                    print('Error: unknown response.')
+
     def _run_port(self, params):
         if len(params) == 4:
             if params[0] == 'add':
@@ -290,6 +439,70 @@ class SppMirror(object):
             else:
                 print('Error: unknown response.')
 
+    def _run_latency_stats(self, params):
+        """Run `latency_stats` command."""
+
+        if len(params) != 1 or params[0] not in ['on', 'off']:
+            print('Error: Invalid syntax.')
+            return
+
+        req = 'mirrors/%d/latency_stats' % self.sec_id
+        res = self.spp_ctl_cli.put(req, {'enable': params[0] == 'on'})
+        if res is not None:
+            error_codes = self.spp_ctl_cli.rest_common_error_codes
+            if res.status_code == 204:
+                print('Succeeded to turn %s latency stats.' % params[0])
+            elif res.status_code in error_codes:
+                pass
+            else:
+                print('Error: unknown response.')
+
+    def _run_latency(self):
+        """Run `latency` command."""
+
+        res = self.spp_ctl_cli.get('mirrors/%d/latency' % self.sec_id)
+        if res is not None:
+            error_codes = self.spp_ctl_cli.rest_common_error_codes
+            if res.status_code == 200:
+                self.print_latency(res.json())
+            elif res.status_code in error_codes:
+                pass
+            else:
+                print('Error: unknown response.')
+
+    def _run_filter(self, params):
+        """Run `filter` command."""
+
+        if not (params[1:] == ['none'] or
+                (len(params) >= 3 and len(params) % 2 == 1)):
+            print('Error: Invalid syntax.')
+            return
+
+        req_params = {}
+        if params[1:] != ['none']:
+            for key, val in zip(params[1::2], params[2::2]):
+                if key not in self.FILTER_FIELDS:
+                    print('Error: Unknown field "%s".' % key)
+                    return
+                if key in ['vlan', 'sport', 'dport'] or val.isdigit():
+                    try:
+                        val = int(val)
+                    except ValueError:
+                        print('Error: Invalid value "%s".' % val)
+                        return
+                req_params[key] = val
+
+        req = 'mirrors/%d/components/%s/filter' % (self.sec_id, params[0])
+        res = self.spp_ctl_cli.put(req, req_params)
+        if res is not None:
+            error_codes = self.spp_ctl_cli.rest_common_error_codes
+            if res.status_code == 204:
+                print("Succeeded to set filter of '%s'." % params[0])
+            elif res.status_code in error_codes:
+                pass
+            else:
+                print('Error: unknown response.')
+
     def _run_exit(self):
         """Run `exit` command."""
 
@@ -303,9 +516,34 @@ class SppMirror(object):
             else:
                 print('Error: unknown response.')
 
+    def _compl_latency_stats(self, sub_tokens):
+        res = []
+        if len(sub_tokens) == 2:
+            for kw in ['on', 'off']:
+                if kw.startswith(sub_tokens[1]):
+                    res.append(kw)
+        return res
+
+    def _compl_filter(self, sub_tokens):
+        res = []
+        if len(sub_tokens) == 2:
+            for kw in self.worker_names:
+                if kw.startswith(sub_tokens[1]):
+                    res.append(kw)
+        elif len(sub_tokens) % 2 == 1:
+            candidates = [kw for kw in self.FILTER_FIELDS
+                          if kw not in sub_tokens[2:-1]]
+            if len(sub_tokens) == 3:
+                candidates.append('none')
+            for kw in candidates:
+                if kw.startswith(sub_tokens[-1]):
+                    res.append(kw)
+        return res
+
     def _compl_component(self, sub_tokens):
         if len(sub_tokens) < 6:
-            subsub_cmds = ['start', 'stop']
+            subsub_cmds = ['start', 'stop', 'move', 'weight'] + \
+                self.MIRROR_OPTS
             res = []
             if len(sub_tokens) == 2:
                 for kw in subsub_cmds:
@@ -317,7 +555,8 @@ class SppMirror(object):
                 if sub_tokens[1] == 'start':
                     if 'NAME'.startswith(sub_tokens[2]):
                         res.append('NAME')
-                if sub_tokens[1] == 'stop':
+                if sub_tokens[1] in ['stop', 'move', 'weight'] + \
+                        self.MIRROR_OPTS:
                     for kw in self.worker_names:
                         if kw.startswith(sub_tokens[2]):
                             res.append(kw)
@@ -326,6 +565,18 @@ class SppMirror(object):
                     for cid in [str(i) for i in self.unused_core_ids]:
                         if cid.startswith(sub_tokens[3]):
                             res.append(cid)
+                # 'move' takes any of cores including used ones
+                # because several workers can share the same core.
+                if sub_tokens[1] == 'move':
+                    core_ids = set(self.unused_core_ids)
+                    core_ids |= set([wk['core_id'] for wk in self.workers])
+                    for cid in [str(i) for i in sorted(core_ids)]:
+                        if cid.startswith(sub_tokens[3]):
+                            res.append(cid)
+                if sub_tokens[1] == 'copy':
+                    for mode in self.COPY_MODES:
+                        if mode.startswith(sub_tokens[3]):
+                            res.append(mode)
             elif len(sub_tokens) == 5:
                 if sub_tokens[1] == 'start':
                     for wk_type in self.WORKER_TYPES:
@@ -363,10 +614,13 @@ class SppMirror(object):
 
         spp_mirror is a secondary process for duplicating incoming
         packets to be used as similar to TaaS in OpenStack. This
-        command has four sub commands.
+        command has six sub commands.
           * status
           * component
           * port
+          * latency_stats
+          * latency
+          * filter
 
         Each of sub commands other than 'status' takes several parameters
         for detailed operations. Notice that 'start' for launching a worker
@@ -384,11 +638,46 @@ class SppMirror(object):
         spp > mirror 1; component start NAME CORE_ID mirror
         spp > mirror 1; component stop NAME CORE_ID mirror
 
+        # (2-1) move a worker thread to another core without stopping
+        spp > mirror 1; component move NAME CORE_ID
+
+        # (2-2) set max num of bursts in a turn of worker sharing a core
+        #   WEIGHT: from 1 to 32, default is 1
+        spp > mirror 1; component weight NAME WEIGHT
+
+        # (2-3) mirror one in N packets, at most PPS packets per sec, or
+        #       only first LEN bytes of each packet
+        #   N: 1 for all, PPS: 0 for unlimited, LEN: 0 for all, max 512
+        spp > mirror 1; component sample NAME N
+        spp > mirror 1; component sample_rate NAME PPS
+        spp > mirror 1; component snaplen NAME LEN
+
+        # (2-4) change how to copy mirrored packets, default is shallow
+        #   MODE: 'shallow', 'deep' or 'hybrid' copying only headers
+        spp > mirror 1; component copy NAME MODE
+
         # (3) add or delete a port to worker of NAME
         #   RES_UID: resource UID such as 'ring:0' or 'vhost:1'
         #   DIR: 'rx' or 'tx'
         spp > mirror 1; port add RES_UID DIR NAME
         spp > mirror 1; port del RES_UID DIR NAME
+
+        # (4) turn on or off latency stats of ports, results are shown as
+        #     'port_latency' and 'e2e_latency' in status
+        spp > mirror 1; latency_stats on
+        spp > mirror 1; latency_stats off
+
+        # (5) show histograms of latency of ports as pairs of upper bound
+        #     in nano sec and num of packets
+        spp > mirror 1; latency
+
+        # (6) mirror only packets matched with all of given fields, or all
+        #     of packets for 'none'
+        #   vlan: VLAN ID, proto: 'tcp', 'udp', 'sctp', 'icmp' or number
+        #   src, dst: IPv4 address such as '10.0.0.1' or '10.0.0.0/8'
+        #   sport, dport: port of TCP, UDP or SCTP
+        spp > mirror 1; filter NAME vlan 100 proto udp dport 4789
+        spp > mirror 1; filter NAME none
         """
 
         print(msg)
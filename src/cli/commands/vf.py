@@ -16,12 +16,18 @@ class SppVf(object):
     VF_CMDS = {
             'status': None,
             'exit': None,
-            'component': ['start', 'stop'],
+            'component': ['start', 'stop', 'move', 'weight'],
             'port': ['add', 'del'],
-            'classifier_table': ['add', 'del']}
+            'classifier_table': ['add', 'del'],
+            'latency_stats': ['on', 'off'],
+            'latency': None}
 
     WORKER_TYPES = ['forward', 'merge', 'classifier']
 
+    # Actions of port run after vlan operation.
+    PORT_ACTIONS = ['set_src_mac', 'set_dst_mac', 'set_pcp', 'set_dscp',
+                    'dec_ttl']
+
     def __init__(self, spp_ctl_cli, sec_id, use_cache=False):
         self.spp_ctl_cli = spp_ctl_cli
         self.sec_id = sec_id
@@ -74,6 +80,12 @@ class SppVf(object):
         elif cmd == 'classifier_table':
             self._run_cls_table(params)
 
+        elif cmd == 'latency_stats':
+            self._run_latency_stats(params)
+
+        elif cmd == 'latency':
+            self._run_latency()
+
         elif cmd == 'exit':
             self._run_exit()
 
@@ -102,6 +114,8 @@ class SppVf(object):
             - core:2, "mgr11" (type: merger)
               - rx: ring:1, vlan (operation: add, id: 101, pcp: 0)
               - tx: ring:2, vlan (operation: del)
+                - action: set_dst_mac 52:54:00:12:34:56
+                - action: dec_ttl
             ...
 
         """
@@ -142,6 +156,20 @@ class SppVf(object):
                                          attr['vlan']['operation'],
                                          attr['vlan']['id'],
                                          attr['vlan']['pcp']))
+                        elif attr['vlan']['operation'] == 'add_qinq':
+                            msg = '    - %s: %s (vlan operation: %s, ' + \
+                                  'id: %d, pcp: %d, tpid: %#x)'
+                            print(msg % (pt_dir, attr['port'],
+                                         attr['vlan']['operation'],
+                                         attr['vlan']['id'],
+                                         attr['vlan']['pcp'],
+                                         attr['vlan']['tpid']))
+                        elif attr['vlan']['operation'] == 'del_qinq':
+                            msg = '    - %s: %s ' + \
+                                  '(vlan operation: %s, tpid: %#x)'
+                            print(msg % (pt_dir, attr['port'],
+                                         attr['vlan']['operation'],
+                                         attr['vlan']['tpid']))
                         elif attr['vlan']['operation'] == 'del':
                             msg = '    - %s: %s (vlan operation: %s)'
                             print(msg % (pt_dir, attr['port'],
@@ -149,11 +177,77 @@ class SppVf(object):
                         else:
                             msg = '    - %s: %s'
                             print(msg % (pt_dir, attr['port']))
+                        if 'meter' in attr:
+                            m = attr['meter']
+                            print('      - meter: %s, green: %d, ' %
+                                  (m['type'], m['green']) +
+                                  'yellow: %d, red: %d (%s)' %
+                                  (m['yellow'], m['red'],
+                                   m['red_action']))
+                        if 'shaper' in attr:
+                            sh = attr['shaper']
+                            print('      - shaper: rate %d, qsize %d' %
+                                  (sh['rate'], sh['qsize']))
+                            for tc in sh['tcs']:
+                                print('        - pcp %d: pkts %d, ' %
+                                      (tc['pcp'], tc['pkts']) +
+                                      'dropped %d, qlen %d' %
+                                      (tc['dropped'], tc['qlen']))
+                        if 'vxlan' in attr:
+                            vx = attr['vxlan']
+                            if vx['operation'] == 'add_vxlan':
+                                print('      - vxlan: %s, vni %d, ' %
+                                      (vx['operation'], vx['vni']) +
+                                      '%s -> %s, %s -> %s, port %d' %
+                                      (vx['src_mac'], vx['dst_mac'],
+                                       vx['src_ip'], vx['dst_ip'],
+                                       vx['udp_port']))
+                            else:
+                                print('      - vxlan: %s, port %d' %
+                                      (vx['operation'], vx['udp_port']))
+                        for act in attr.get('actions', []):
+                            if 'value' in act:
+                                print('      - action: %s %s' % (
+                                      act['operation'], act['value']))
+                            else:
+                                print('      - action: %s' %
+                                      act['operation'])
 
             else:
                 # TODO(yasufum) should change 'unuse' to 'unused'
                 print("  - core:%d '' (type: unuse)" % worker['core'])
 
+    def print_latency(self, json_obj):
+        """Print histograms of latency of ports.
+
+        Each entry of histogram is a pair of upper bound of latency in nano
+        sec and num of packets, and empty entries are not included.
+
+          spp > vf 1; latency
+          Latency stats: on
+          Ports:
+            - ring:0 (max: 1520 ns)
+              - <= 206 ns: 3
+              - <= 1520 ns: 1
+          End-to-end:
+            - phy:0 -> vhost:1 (max: 8230 ns)
+              - <= 8230 ns: 2
+
+        """
+
+        print('Latency stats: %s' % json_obj['latency_stats'])
+        print('Ports:')
+        for ent in json_obj['ports']:
+            print('  - %s (max: %d ns)' % (ent['port'], ent['max']))
+            for upper, cnt in ent['hist']:
+                print('    - <= %d ns: %d' % (upper, cnt))
+        print('End-to-end:')
+        for ent in json_obj['e2e']:
+            print('  - %s -> %s (max: %d ns)' % (
+                ent['rx_port'], ent['tx_port'], ent['max']))
+            for upper, cnt in ent['hist']:
+                print('    - <= %d ns: %d' % (upper, cnt))
+
     def complete(self, sec_ids, text, line, begidx, endidx):
         """Completion for spp_vf commands.
 
@@ -190,6 +284,9 @@ class SppVf(object):
 
                     elif sub_tokens[0] == 'classifier_table':
                         completions = self._compl_cls_table(sub_tokens)
+
+                    elif sub_tokens[0] == 'latency_stats':
+                        completions = self._compl_latency_stats(sub_tokens)
             return completions
         except Exception as e:
             print(e)
@@ -289,9 +386,143 @@ class SppVf(object):
                 else:
                     print('Error: unknown response.')
 
+        elif params[0] == 'move':
+            req_params = {'core': int(params[2])}
+            res = self.spp_ctl_cli.put('vfs/%d/components/%s' % (
+                                       self.sec_id, params[1]), req_params)
+            if res is not None:
+                error_codes = self.spp_ctl_cli.rest_common_error_codes
+                if res.status_code == 204:
+                    print("Succeeded to move component '%s' to core:%d"
+                          % (params[1], req_params['core']))
+
+                    # update core IDs of moved worker
+                    old_core_id = None
+                    for wk in self.workers:
+                        if wk['name'] == params[1]:
+                            old_core_id = wk['core_id']
+                            wk['core_id'] = req_params['core']
+                            break
+                    if req_params['core'] in self.unused_core_ids:
+                        self.unused_core_ids.remove(req_params['core'])
+                    used_core_ids = [wk['core_id'] for wk in self.workers]
+                    if (old_core_id is not None and
+                            old_core_id not in used_core_ids):
+                        self.unused_core_ids.append(old_core_id)
+                elif res.status_code in error_codes:
+                    pass
+                else:
+                    print('Error: unknown response.')
+
+        elif params[0] == 'weight':
+            req_params = {'weight': int(params[2])}
+            res = self.spp_ctl_cli.put('vfs/%d/components/%s' % (
+                                       self.sec_id, params[1]), req_params)
+            if res is not None:
+                error_codes = self.spp_ctl_cli.rest_common_error_codes
+                if res.status_code == 204:
+                    print("Succeeded to set weight of component '%s' to %d"
+                          % (params[1], req_params['weight']))
+                elif res.status_code in error_codes:
+                    pass
+                else:
+                    print('Error: unknown response.')
+
+    def _parse_meter(self, params):
+        """Parse params of meter such as 'srtcm CIR CBS EBS drop'."""
+
+        if params[0] == 'srtcm':
+            keys = ['cir', 'cbs', 'ebs']
+        elif params[0] == 'trtcm':
+            keys = ['cir', 'pir', 'cbs', 'pbs']
+        else:
+            return None
+
+        rest = params[1 + len(keys):]
+        if len(params) < 1 + len(keys) or \
+                rest not in [[], ['drop']] and \
+                (len(rest) != 2 or rest[0] != 'mark'):
+            return None
+
+        meter = {'type': params[0]}
+        try:
+            for i, key in enumerate(keys):
+                meter[key] = int(params[1 + i])
+            if len(rest) == 2:
+                meter['pcp'] = int(rest[1])
+        except ValueError:
+            return None
+        meter['red_action'] = rest[0] if len(rest) > 0 else 'drop'
+        return meter
+
     def _run_port(self, params):
         req_params = None
-        if len(params) == 4:
+
+        # Recalculating FCS is optional and given at the end of vlan op.
+        fcs = False
+        if len(params) > 5 and params[-1] == 'fcs':
+            fcs = True
+            params = params[:-1]
+
+        if len(params) > 5 and params[4] == 'meter':
+            # Meter has params of its own and is not followed by 'fcs'.
+            meter = self._parse_meter(params[5:])
+            if fcs or meter is None:
+                print('Error: Invalid syntax.')
+                return None
+            req_params = {'action': 'attach', 'port': params[1],
+                          'dir': params[2], 'meter': meter}
+
+        elif len(params) in [6, 7] and params[4] == 'shaper':
+            # Shaper is only for TX port, and QSIZE is optional.
+            if fcs or params[2] != 'tx':
+                print('Error: Invalid syntax.')
+                return None
+            try:
+                shaper = {'rate': int(params[5])}
+                if len(params) == 7:
+                    shaper['qsize'] = int(params[6])
+            except ValueError:
+                print('Error: Invalid syntax.')
+                return None
+            req_params = {'action': 'attach', 'port': params[1],
+                          'dir': params[2], 'shaper': shaper}
+
+        elif len(params) in [10, 11] and params[4] == 'add_vxlan' or \
+                len(params) in [5, 6] and params[4] == 'del_vxlan':
+            # UDP_PORT is optional and given at the end.
+            if fcs:
+                print('Error: Invalid syntax.')
+                return None
+            vxlan = {'operation': params[4][:3]}
+            try:
+                if params[4] == 'add_vxlan':
+                    vxlan['vni'] = int(params[5])
+                    for i, key in enumerate(['src_mac', 'dst_mac',
+                                             'src_ip', 'dst_ip']):
+                        vxlan[key] = params[6 + i]
+                if len(params) in [6, 11]:
+                    vxlan['udp_port'] = int(params[-1])
+            except ValueError:
+                print('Error: Invalid syntax.')
+                return None
+            req_params = {'action': 'attach', 'port': params[1],
+                          'dir': params[2], 'vxlan': vxlan}
+
+        elif len(params) in [5, 6] and params[4] in self.PORT_ACTIONS:
+            # Action run after vlan ops, such as 'set_dst_mac MAC'.
+            if fcs or (len(params) == 6) == (params[4] == 'dec_ttl'):
+                print('Error: Invalid syntax.')
+                return None
+            act = {'operation': params[4]}
+            if params[4] in ['set_src_mac', 'set_dst_mac']:
+                act['value'] = params[5]
+            elif params[4] in ['set_pcp', 'set_dscp']:
+                act['value'] = int(params[5])
+            req_params = {'action': 'attach', 'port': params[1],
+                          'dir': params[2], 'actions': [act]}
+
+        elif len(params) == 4:
             if params[0] == 'add':
                 action = 'attach'
             elif params[0] == 'del':
@@ -306,29 +537,43 @@ class SppVf(object):
                                    'id': 'none',
                                    'pcp': 'none'}}
 
-        elif len(params) == 5:  # delete vlan with 'port add' command
+        elif len(params) in [5, 6]:  # delete vlan with 'port add' command
             # TODO(yasufum) Syntax for deleting vlan should be modified
             #               because deleting with 'port add' is terrible!
             action = 'attach'
+            op = 'del'
+            if params[4] == 'del_qinqtag':
+                op = 'del_qinq'
             req_params = {'action': action, 'port': params[1],
                           'dir': params[2],
-                          'vlan': {'operation': 'del',
+                          'vlan': {'operation': op,
                                    'id': 'none',
                                    'pcp': 'none'}}
+            # TPID of outer tag is optional for deleting QinQ tag.
+            if len(params) == 6:
+                req_params['vlan']['tpid'] = int(params[5], 0)
 
-        elif len(params) == 7:
+        elif len(params) in [7, 8]:
             action = 'attach'
             if params[4] == 'add_vlantag':
                 op = 'add'
+            elif params[4] == 'add_qinqtag':
+                op = 'add_qinq'
             elif params[4] == 'del_vlantag':
                 op = 'del'
             req_params = {'action': action, 'port': params[1],
                           'dir': params[2],
                           'vlan': {'operation': op, 'id': int(params[5]),
                                    'pcp': int(params[6])}}
+            # TPID of outer tag is optional for adding QinQ tag.
+            if len(params) == 8:
+                req_params['vlan']['tpid'] = int(params[7], 0)
         else:
             print('Error: Invalid syntax.')
 
+        if req_params is not None and 'vlan' in req_params and fcs:
+            req_params['vlan']['fcs'] = True
+
         if req_params is not None:
             res = self.spp_ctl_cli.put('vfs/%d/components/%s/ports'
                                        % (self.sec_id, params[3]), req_params)
@@ -348,9 +593,16 @@ class SppVf(object):
                           'mac_address': params[2], 'port': params[3]}
 
         elif len(params) == 5:
+            # ID is VNI for VXLAN, or VID for others.
+            id_key = 'vni' if params[1] == 'vni' else 'vlan'
             req_params = {'action': params[0], 'type': params[1],
-                          'vlan': params[2], 'mac_address': params[3],
+                          id_key: params[2], 'mac_address': params[3],
                           'port': params[4]}
+
+        elif len(params) == 6:
+            req_params = {'action': params[0], 'type': params[1],
+                          'svlan': params[2], 'vlan': params[3],
+                          'mac_address': params[4], 'port': params[5]}
         else:
             print('Error: Invalid syntax.')
 
@@ -367,6 +619,37 @@ class SppVf(object):
                 else:
                     print('Error: unknown response.')
 
+    def _run_latency_stats(self, params):
+        """Run `latency_stats` command."""
+
+        if len(params) != 1 or params[0] not in ['on', 'off']:
+            print('Error: Invalid syntax.')
+            return
+
+        req = 'vfs/%d/latency_stats' % self.sec_id
+        res = self.spp_ctl_cli.put(req, {'enable': params[0] == 'on'})
+        if res is not None:
+            error_codes = self.spp_ctl_cli.rest_common_error_codes
+            if res.status_code == 204:
+                print('Succeeded to turn %s latency stats.' % params[0])
+            elif res.status_code in error_codes:
+                pass
+            else:
+                print('Error: unknown response.')
+
+    def _run_latency(self):
+        """Run `latency` command."""
+
+        res = self.spp_ctl_cli.get('vfs/%d/latency' % self.sec_id)
+        if res is not None:
+            error_codes = self.spp_ctl_cli.rest_common_error_codes
+            if res.status_code == 200:
+                self.print_latency(res.json())
+            elif res.status_code in error_codes:
+                pass
+            else:
+                print('Error: unknown response.')
+
     def _run_exit(self):
         """Run `exit` command."""
 
@@ -380,9 +663,17 @@ class SppVf(object):
             else:
                 print('Error: unknown response.')
 
+    def _compl_latency_stats(self, sub_tokens):
+        res = []
+        if len(sub_tokens) == 2:
+            for kw in ['on', 'off']:
+                if kw.startswith(sub_tokens[1]):
+                    res.append(kw)
+        return res
+
     def _compl_component(self, sub_tokens):
         if len(sub_tokens) < 6:
-            subsub_cmds = ['start', 'stop']
+            subsub_cmds = ['start', 'stop', 'move', 'weight']
             res = []
             if len(sub_tokens) == 2:
                 for kw in subsub_cmds:
@@ -394,7 +685,7 @@ class SppVf(object):
                 if sub_tokens[1] == 'start':
                     if 'NAME'.startswith(sub_tokens[2]):
                         res.append('NAME')
-                if sub_tokens[1] == 'stop':
+                if sub_tokens[1] in ['stop', 'move', 'weight']:
                     for kw in self.worker_names:
                         if kw.startswith(sub_tokens[2]):
                             res.append(kw)
@@ -403,6 +694,14 @@ class SppVf(object):
                     for cid in [str(i) for i in self.unused_core_ids]:
                         if cid.startswith(sub_tokens[3]):
                             res.append(cid)
+                # 'move' takes any of cores including used ones
+                # because several workers can share the same core.
+                if sub_tokens[1] == 'move':
+                    core_ids = set(self.unused_core_ids)
+                    core_ids |= set([wk['core_id'] for wk in self.workers])
+                    for cid in [str(i) for i in sorted(core_ids)]:
+                        if cid.startswith(sub_tokens[3]):
+                            res.append(cid)
             elif len(sub_tokens) == 5:
                 if sub_tokens[1] == 'start':
                     for wk_type in self.WORKER_TYPES:
@@ -411,7 +710,7 @@ class SppVf(object):
             return res
 
     def _compl_port(self, sub_tokens):
-        if len(sub_tokens) < 9:
+        if len(sub_tokens) < 13:
             subsub_cmds = ['add', 'del']
             res = []
             if len(sub_tokens) == 2:
@@ -434,21 +733,94 @@ class SppVf(object):
                             res.append(kw)
             elif len(sub_tokens) == 6:
                 if sub_tokens[1] == 'add':
-                    for kw in ['add_vlantag', 'del_vlantag']:
+                    for kw in ['add_vlantag', 'del_vlantag',
+                               'add_qinqtag', 'del_qinqtag', 'meter',
+                               'shaper', 'add_vxlan', 'del_vxlan'] + \
+                            self.PORT_ACTIONS:
                         if kw.startswith(sub_tokens[5]):
                             res.append(kw)
             elif len(sub_tokens) == 7:
-                if sub_tokens[1] == 'add' and sub_tokens[5] == 'add_vlantag':
+                if sub_tokens[1] == 'add' and \
+                        sub_tokens[5] in ['add_vlantag', 'add_qinqtag']:
                     if 'VID'.startswith(sub_tokens[6]):
                         res.append('VID')
+                elif sub_tokens[1] == 'add' and \
+                        sub_tokens[5] in ['del_vlantag', 'del_qinqtag']:
+                    kws = ['fcs']
+                    if sub_tokens[5] == 'del_qinqtag':
+                        kws.append('TPID')
+                    for kw in kws:
+                        if kw.startswith(sub_tokens[6]):
+                            res.append(kw)
+                elif sub_tokens[1] == 'add' and \
+                        sub_tokens[5] in self.PORT_ACTIONS:
+                    kw = {'set_src_mac': 'MAC_ADDR',
+                          'set_dst_mac': 'MAC_ADDR',
+                          'set_pcp': 'PCP',
+                          'set_dscp': 'DSCP'}.get(sub_tokens[5])
+                    if kw is not None and kw.startswith(sub_tokens[6]):
+                        res.append(kw)
+                elif sub_tokens[1] == 'add' and sub_tokens[5] == 'meter':
+                    for kw in ['srtcm', 'trtcm']:
+                        if kw.startswith(sub_tokens[6]):
+                            res.append(kw)
+                elif sub_tokens[1] == 'add' and sub_tokens[5] == 'shaper':
+                    if 'RATE'.startswith(sub_tokens[6]):
+                        res.append('RATE')
+                elif sub_tokens[1] == 'add' and \
+                        sub_tokens[5] in ['add_vxlan', 'del_vxlan']:
+                    kw = 'VNI'
+                    if sub_tokens[5] == 'del_vxlan':
+                        kw = 'UDP_PORT'
+                    if kw.startswith(sub_tokens[6]):
+                        res.append(kw)
             elif len(sub_tokens) == 8:
-                if sub_tokens[1] == 'add' and sub_tokens[5] == 'add_vlantag':
+                if sub_tokens[1] == 'add' and \
+                        sub_tokens[5] in ['add_vlantag', 'add_qinqtag']:
                     if 'PCP'.startswith(sub_tokens[7]):
                         res.append('PCP')
+                elif sub_tokens[1] == 'add' and \
+                        sub_tokens[5] == 'del_qinqtag' and \
+                        sub_tokens[6] != 'fcs':
+                    if 'fcs'.startswith(sub_tokens[7]):
+                        res.append('fcs')
+                elif sub_tokens[1] == 'add' and sub_tokens[5] == 'shaper':
+                    if 'QSIZE'.startswith(sub_tokens[7]):
+                        res.append('QSIZE')
+                elif sub_tokens[1] == 'add' and sub_tokens[5] == 'add_vxlan':
+                    if 'SRC_MAC'.startswith(sub_tokens[7]):
+                        res.append('SRC_MAC')
+            elif len(sub_tokens) == 9:
+                if sub_tokens[1] == 'add' and \
+                        sub_tokens[5] in ['add_vlantag', 'add_qinqtag']:
+                    kws = ['fcs']
+                    if sub_tokens[5] == 'add_qinqtag':
+                        kws.append('TPID')
+                    for kw in kws:
+                        if kw.startswith(sub_tokens[8]):
+                            res.append(kw)
+                elif sub_tokens[1] == 'add' and sub_tokens[5] == 'add_vxlan':
+                    if 'DST_MAC'.startswith(sub_tokens[8]):
+                        res.append('DST_MAC')
+            elif len(sub_tokens) == 10:
+                if sub_tokens[1] == 'add' and \
+                        sub_tokens[5] == 'add_qinqtag' and \
+                        sub_tokens[8] != 'fcs':
+                    if 'fcs'.startswith(sub_tokens[9]):
+                        res.append('fcs')
+                elif sub_tokens[1] == 'add' and sub_tokens[5] == 'add_vxlan':
+                    if 'SRC_IP'.startswith(sub_tokens[9]):
+                        res.append('SRC_IP')
+            elif len(sub_tokens) in [11, 12]:
+                kw = ['DST_IP', 'UDP_PORT'][len(sub_tokens) - 11]
+                if sub_tokens[1] == 'add' and \
+                        sub_tokens[5] == 'add_vxlan' and \
+                        kw.startswith(sub_tokens[-1]):
+                    res.append(kw)
             return res
 
     def _compl_cls_table(self, sub_tokens):
-        if len(sub_tokens) < 7:
+        if len(sub_tokens) < 8:
             subsub_cmds = ['add', 'del']
             res = []
 
@@ -459,7 +831,7 @@ class SppVf(object):
 
             elif len(sub_tokens) == 3:
                 if sub_tokens[1] in subsub_cmds:
-                    for kw in ['mac', 'vlan']:
+                    for kw in ['mac', 'vlan', 'qinq', 'vni']:
                         if kw.startswith(sub_tokens[2]):
                             res.append(kw)
 
@@ -478,6 +850,12 @@ class SppVf(object):
                     if sub_tokens[2] == 'vlan':
                         if 'VID'.startswith(sub_tokens[3]):
                                 res.append('VID')
+                if sub_tokens[1] in subsub_cmds and sub_tokens[2] == 'qinq':
+                    if 'SVID'.startswith(sub_tokens[3]):
+                        res.append('SVID')
+                if sub_tokens[1] in subsub_cmds and sub_tokens[2] == 'vni':
+                    if 'VNI'.startswith(sub_tokens[3]):
+                        res.append('VNI')
 
             elif len(sub_tokens) == 5:
                 if sub_tokens[1] == 'add':
@@ -494,12 +872,28 @@ class SppVf(object):
                     elif sub_tokens[2] == 'vlan':
                         if 'MAC_ADDR'.startswith(sub_tokens[4]):
                             res.append('MAC_ADDR')
+                if sub_tokens[1] in subsub_cmds and sub_tokens[2] == 'qinq':
+                    if 'VID'.startswith(sub_tokens[4]):
+                        res.append('VID')
+                if sub_tokens[1] in subsub_cmds and sub_tokens[2] == 'vni':
+                    if 'MAC_ADDR'.startswith(sub_tokens[4]):
+                        res.append('MAC_ADDR')
 
             elif len(sub_tokens) == 6:
                 if sub_tokens[1] in subsub_cmds and \
-                        sub_tokens[2] == 'vlan':
+                        sub_tokens[2] in ['vlan', 'vni']:
                             if 'RES_UID'.startswith(sub_tokens[5]):
                                 res.append('RES_UID')
+                elif sub_tokens[1] in subsub_cmds and \
+                        sub_tokens[2] == 'qinq':
+                    if 'MAC_ADDR'.startswith(sub_tokens[5]):
+                        res.append('MAC_ADDR')
+
+            elif len(sub_tokens) == 7:
+                if sub_tokens[1] in subsub_cmds and \
+                        sub_tokens[2] == 'qinq':
+                    if 'RES_UID'.startswith(sub_tokens[6]):
+                        res.append('RES_UID')
             return res
 
     @classmethod
@@ -507,11 +901,13 @@ class SppVf(object):
         msg = """Send a command to spp_vf.
 
         SPP VF is a secondary process for pseudo SR-IOV features. This
-        command has four sub commands.
+        command has six sub commands.
           * status
           * component
           * port
           * classifier_table
+          * latency_stats
+          * latency
 
         Each of sub commands other than 'status' takes several parameters
         for detailed operations. Notice that 'start' for launching a worker
@@ -530,6 +926,13 @@ class SppVf(object):
         spp > vf 1; component start NAME CORE_ID ROLE
         spp > vf 1; component stop NAME CORE_ID ROLE
 
+        # (2-1) move a worker thread to another core without stopping
+        spp > vf 1; component move NAME CORE_ID
+
+        # (2-2) set max num of bursts in a turn of worker sharing a core
+        #   WEIGHT: from 1 to 32, default is 1
+        spp > vf 1; component weight NAME WEIGHT
+
         # (3) add or delete a port to worker of NAME
         #   RES_UID: resource UID such as 'ring:0' or 'vhost:1'
         #   DIR: 'rx' or 'tx'
@@ -545,6 +948,47 @@ class SppVf(object):
         # (5) add a port of deleting vlan tag
         spp > vf 1; port add RES_UID DIR NAME del_vlantag
 
+        # FCS is not recalculated after adding or deleting vlan tag unless
+        # 'fcs' is given at the end of (4) or (5), such as
+        spp > vf 1; port add RES_UID DIR NAME add_vlantag VID PCP fcs
+
+        # (5-1) add a port of adding or deleting outer tag of QinQ
+        #   TPID: TPID of outer tag, optional and default is 0x88a8
+        spp > vf 1; port add RES_UID DIR NAME add_qinqtag VID PCP TPID
+        spp > vf 1; port add RES_UID DIR NAME del_qinqtag TPID
+
+        # (5-2) add an action of port run after vlan operation in the
+        #     order of added, repeat it for several actions
+        #   DSCP: DSCP of IPv4 or IPv6 header, from 0 to 63
+        spp > vf 1; port add RES_UID DIR NAME set_src_mac MAC_ADDR
+        spp > vf 1; port add RES_UID DIR NAME set_dst_mac MAC_ADDR
+        spp > vf 1; port add RES_UID DIR NAME set_pcp PCP
+        spp > vf 1; port add RES_UID DIR NAME set_dscp DSCP
+        spp > vf 1; port add RES_UID DIR NAME dec_ttl
+
+        # (5-3) add a meter of srTCM or trTCM to police packets of port
+        #   CIR, PIR: committed or peak rate in bytes per second
+        #   CBS, EBS, PBS: committed, excess or peak burst size in bytes
+        #   red packets are dropped, or marked with PCP if 'mark PCP' given
+        spp > vf 1; port add RES_UID DIR NAME meter srtcm CIR CBS EBS
+        spp > vf 1; port add RES_UID DIR NAME meter trtcm CIR PIR CBS PBS
+        spp > vf 1; port add RES_UID DIR NAME meter srtcm CIR CBS EBS mark PCP
+
+        # (5-4) add a shaper to TX port, packets are sent with strict
+        #     priority of PCP within RATE
+        #   RATE: rate of the port in bytes per second
+        #   QSIZE: size of queue of each PCP, power of 2, default is 64
+        spp > vf 1; port add RES_UID tx NAME shaper RATE
+        spp > vf 1; port add RES_UID tx NAME shaper RATE QSIZE
+
+        # (5-5) encapsulate packets with VXLAN, or decapsulate packets of
+        #     VXLAN to UDP_PORT, default is 4789
+        #   OUTER: SRC_MAC DST_MAC SRC_IP DST_IP of outer header
+        spp > vf 1; port add RES_UID DIR NAME add_vxlan VNI OUTER
+        spp > vf 1; port add RES_UID DIR NAME add_vxlan VNI OUTER UDP_PORT
+        spp > vf 1; port add RES_UID DIR NAME del_vxlan
+        spp > vf 1; port add RES_UID DIR NAME del_vxlan UDP_PORT
+
         # (6) add or delete an entry of MAC address and resource to classify
         spp > vf 1; classifier_table add mac MAC_ADDR RES_UID
         spp > vf 1; classifier_table del mac MAC_ADDR RES_UID
@@ -552,6 +996,25 @@ class SppVf(object):
         # (7) add or delete an entry of MAC address and resource with vlan ID
         spp > vf 1; classifier_table add vlan VID MAC_ADDR RES_UID
         spp > vf 1; classifier_table del vlan VID MAC_ADDR RES_UID
+
+        # (8) add or delete an entry of MAC address and resource with vlan
+        #     IDs of outer and inner tags of QinQ
+        spp > vf 1; classifier_table add qinq SVID VID MAC_ADDR RES_UID
+        spp > vf 1; classifier_table del qinq SVID VID MAC_ADDR RES_UID
+
+        # (9) add or delete an entry of inner MAC address and resource with
+        #     VNI of VXLAN packets to UDP port 4789
+        spp > vf 1; classifier_table add vni VNI MAC_ADDR RES_UID
+        spp > vf 1; classifier_table del vni VNI MAC_ADDR RES_UID
+
+        # (10) turn on or off latency stats of ports, results are shown as
+        #     'port_latency' and 'e2e_latency' in status
+        spp > vf 1; latency_stats on
+        spp > vf 1; latency_stats off
+
+        # (11) show histograms of latency of ports as pairs of upper bound
+        #     in nano sec and num of packets
+        spp > vf 1; latency
         """
 
         print(msg)
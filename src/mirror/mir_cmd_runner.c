@@ -2,6 +2,8 @@
  * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
  */
 
+#include <arpa/inet.h>
+
 #include "spp_mirror.h"
 #include "shared/secondary/return_codes.h"
 #include "shared/secondary/string_buffer.h"
@@ -10,6 +12,8 @@
 #include "shared/secondary/spp_worker_th/cmd_runner.h"
 #include "shared/secondary/spp_worker_th/cmd_res_formatter.h"
 #include "shared/secondary/spp_worker_th/port_capability.h"
+#include "shared/secondary/spp_worker_th/latency_stats.h"
+#include "shared/secondary/spp_worker_th/queue_occupancy.h"
 #include "shared/secondary/spp_worker_th/mirror_deps.h"
 
 #define RTE_LOGTYPE_MIR_CMD_RUNNER RTE_LOGTYPE_USER1
@@ -69,6 +73,8 @@ update_comp(enum sppwk_action wk_action, const char *name,
 		comp_info->wk_type = wk_type;
 		comp_info->lcore_id = lcore_id;
 		comp_info->comp_id = comp_lcore_id;
+		comp_info->weight = SPPWK_WEIGHT_DEFAULT;
+		sppwk_reset_sched_stats(comp_lcore_id);
 
 		core->id[core->num] = comp_lcore_id;
 		core->num++;
@@ -121,7 +127,8 @@ check_mir_port_count(enum sppwk_port_dir dir, int nof_rx, int nof_tx)
 	RTE_LOG(INFO, MIR_CMD_RUNNER, "Num of ports after count up,"
 				" port_type=%d, rx=%d, tx=%d\n",
 				dir, nof_rx, nof_tx);
-	if (nof_rx > 1 || nof_tx > 2)
+	/* TX ports other than the first one are all for mirror. */
+	if (nof_rx > 1 || nof_tx > RTE_MAX_ETHPORTS)
 		return SPPWK_RET_NG;
 
 	return SPPWK_RET_OK;
@@ -139,7 +146,6 @@ update_port(enum sppwk_action wk_action,
 	int port_idx;
 	int ret_del = -1;
 	int comp_lcore_id = 0;
-	int cnt = 0;
 	struct sppwk_comp_info *comp_info = NULL;
 	struct sppwk_port_info *port_info = NULL;
 	int *nof_ports = NULL;
@@ -177,20 +183,12 @@ update_port(enum sppwk_action wk_action,
 		if (port_idx >= SPPWK_RET_OK) {
 			/* registered */
 			/* TODO(yasufum) confirm it is needed for spp_mirror. */
-			if (port_attrs->ops == SPPWK_PORT_OPS_ADD_VLAN) {
-				while ((cnt < PORT_CAPABL_MAX) &&
-					    (port_info->port_attrs[cnt].ops !=
-					    SPPWK_PORT_OPS_ADD_VLAN))
-					cnt++;
-				if (cnt >= PORT_CAPABL_MAX) {
-					RTE_LOG(ERR, MIR_CMD_RUNNER, "update VLAN tag "
-						"Non-registratio\n");
+			/* Update or add an action of registered port. */
+			if (port_attrs->ops != SPPWK_PORT_OPS_NONE) {
+				ret = sppwk_set_port_attrs(port_info,
+						port_attrs);
+				if (ret != SPPWK_RET_OK)
 					return SPPWK_RET_NG;
-				}
-				memcpy(&port_info->port_attrs[cnt], port_attrs,
-					sizeof(struct sppwk_port_attrs));
-
-				ret = SPPWK_RET_OK;
 				break;
 			}
 			return SPPWK_RET_OK;
@@ -203,18 +201,9 @@ update_port(enum sppwk_action wk_action,
 		}
 
 		if (port_attrs->ops != SPPWK_PORT_OPS_NONE) {
-			while ((cnt < PORT_CAPABL_MAX) &&
-					(port_info->port_attrs[cnt].ops !=
-					SPPWK_PORT_OPS_NONE)) {
-				cnt++;
-			}
-			if (cnt >= PORT_CAPABL_MAX) {
-				RTE_LOG(ERR, MIR_CMD_RUNNER,
-						"No space of port port_attrs.\n");
+			if (sppwk_set_port_attrs(port_info, port_attrs) !=
+					SPPWK_RET_OK)
 				return SPPWK_RET_NG;
-			}
-			memcpy(&port_info->port_attrs[cnt], port_attrs,
-					sizeof(struct sppwk_port_attrs));
 		}
 
 		port_info->iface_type = port->iface_type;
@@ -225,15 +214,8 @@ update_port(enum sppwk_action wk_action,
 		break;
 
 	case SPPWK_ACT_DEL:
-		for (cnt = 0; cnt < PORT_CAPABL_MAX; cnt++) {
-			if (port_info->port_attrs[cnt].ops ==
-					SPPWK_PORT_OPS_NONE)
-				continue;
-
-			if (port_info->port_attrs[cnt].dir == dir)
-				memset(&port_info->port_attrs[cnt], 0x00,
-					sizeof(struct sppwk_port_attrs));
-		}
+		/* Shaper of the port is also released. */
+		sppwk_reset_port_attrs(port_info, dir);
 
 		ret_del = delete_port_info(port_info, *nof_ports, ports);
 		if (ret_del == 0)
@@ -250,6 +232,69 @@ update_port(enum sppwk_action wk_action,
 	return ret;
 }
 
+/* Set filter of mirror, only packets matched with it are mirrored. */
+static int
+update_filter(const char *name, const struct sppwk_mir_filter *filter)
+{
+	int comp_id;
+	struct sppwk_comp_info *comp_info_base = NULL;
+	int *change_component = NULL;
+
+	comp_id = sppwk_get_lcore_id(name);
+	if (unlikely(comp_id < 0)) {
+		RTE_LOG(ERR, MIR_CMD_RUNNER, "Unknown component by filter "
+				"command. (component = %s)\n", name);
+		return SPPWK_RET_NG;
+	}
+
+	sppwk_get_mng_data(NULL, &comp_info_base, NULL, NULL,
+			&change_component, NULL);
+	memcpy(&(comp_info_base + comp_id)->mir_opts.filter, filter,
+			sizeof(struct sppwk_mir_filter));
+	*(change_component + comp_id) = 1;
+	return SPPWK_RET_OK;
+}
+
+/* Set sample, sample_rate, snaplen or copy mode of mirror. */
+static int
+update_mir_opt(enum sppwk_action wk_action, const char *name,
+		unsigned int val)
+{
+	int comp_id;
+	struct sppwk_comp_info *comp_info_base = NULL;
+	struct sppwk_mir_opts *opts = NULL;
+	int *change_component = NULL;
+
+	comp_id = sppwk_get_lcore_id(name);
+	if (unlikely(comp_id < 0)) {
+		RTE_LOG(ERR, MIR_CMD_RUNNER, "Unknown component by %s "
+				"command. (component = %s)\n",
+				sppwk_action_str(wk_action), name);
+		return SPPWK_RET_NG;
+	}
+
+	sppwk_get_mng_data(NULL, &comp_info_base, NULL, NULL,
+			&change_component, NULL);
+	opts = &(comp_info_base + comp_id)->mir_opts;
+	switch (wk_action) {
+	case SPPWK_ACT_SAMPLE:
+		/* Keep 0 as default for mirroring all. */
+		opts->sample = (val > 1) ? val : 0;
+		break;
+	case SPPWK_ACT_SAMPLE_RATE:
+		opts->sample_rate = val;
+		break;
+	case SPPWK_ACT_COPY:
+		opts->copy_mode = val;
+		break;
+	default:  /* SPPWK_ACT_SNAPLEN */
+		opts->snaplen = val;
+		break;
+	}
+	*(change_component + comp_id) = 1;
+	return SPPWK_RET_OK;
+}
+
 /* Execute one command. */
 int
 exec_one_cmd(const struct sppwk_cmd_attrs *cmd)
@@ -261,6 +306,27 @@ exec_one_cmd(const struct sppwk_cmd_attrs *cmd)
 
 	switch (cmd->type) {
 	case SPPWK_CMDTYPE_WORKER:
+		/* Moving component flushes by itself for handing over. */
+		if (cmd->spec.comp.wk_action == SPPWK_ACT_MOVE) {
+			ret = move_comp_lcore(cmd->spec.comp.name,
+					cmd->spec.comp.core);
+			break;
+		}
+		if (cmd->spec.comp.wk_action == SPPWK_ACT_WEIGHT) {
+			ret = set_comp_weight(cmd->spec.comp.name,
+					cmd->spec.comp.weight);
+			break;
+		}
+		if (SPPWK_IS_MIR_OPT_ACT(cmd->spec.comp.wk_action)) {
+			ret = update_mir_opt(cmd->spec.comp.wk_action,
+					cmd->spec.comp.name,
+					cmd->spec.comp.mir_opt);
+			if (ret == 0) {
+				RTE_LOG(INFO, MIR_CMD_RUNNER, "Exec flush.\n");
+				ret = flush_cmd();
+			}
+			break;
+		}
 		ret = update_comp(
 				cmd->spec.comp.wk_action,
 				cmd->spec.comp.name,
@@ -285,6 +351,22 @@ exec_one_cmd(const struct sppwk_cmd_attrs *cmd)
 		}
 		break;
 
+	case SPPWK_CMDTYPE_LATENCY_STATS:
+		RTE_LOG(INFO, MIR_CMD_RUNNER, "with mode `%s`.\n",
+				cmd->spec.latency_stats.enable ? "on" : "off");
+		ret = sppwk_set_latency_stats(
+				cmd->spec.latency_stats.enable);
+		break;
+
+	case SPPWK_CMDTYPE_FILTER:
+		ret = update_filter(cmd->spec.filter.name,
+				&cmd->spec.filter.filter);
+		if (ret == 0) {
+			RTE_LOG(INFO, MIR_CMD_RUNNER, "Exec flush.\n");
+			ret = flush_cmd();
+		}
+		break;
+
 	default:
 		/* Do nothing. */
 		ret = SPPWK_RET_OK;
@@ -371,6 +453,143 @@ add_core(const char *name, char **output,
 	return ret;
 }
 
+/* Make string of IPv4 address and length of prefix such as `10.0.0.0/8`. */
+static void
+get_ipv4_prefix_str(char *str, uint32_t addr, uint32_t mask)
+{
+	struct in_addr in = { .s_addr = addr };
+
+	inet_ntop(AF_INET, &in, str, INET_ADDRSTRLEN);
+	sprintf(str + strlen(str), "/%d", __builtin_popcount(mask));
+}
+
+/* Append fields of given filter of mirror as a block in JSON. */
+static int
+append_filter_value(char **output, const char *name,
+		const struct sppwk_mir_filter *filter)
+{
+	int ret = SPPWK_RET_OK;
+	char prefix_str[INET_ADDRSTRLEN + CMD_TAG_APPEND_SIZE];
+	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, MIR_CMD_RUNNER, "Failed to alloc buff.\n");
+		return SPPWK_RET_NG;
+	}
+
+	if (filter->fields & SPPWK_MIR_FILTER_VLAN)
+		ret = append_json_uint_value(&tmp_buff, "vlan", filter->vid);
+	if (ret == SPPWK_RET_OK && (filter->fields & SPPWK_MIR_FILTER_PROTO))
+		ret = append_json_uint_value(&tmp_buff, "proto",
+				filter->proto);
+	if (ret == SPPWK_RET_OK &&
+			(filter->fields & SPPWK_MIR_FILTER_SRC_IP)) {
+		get_ipv4_prefix_str(prefix_str, filter->src_ip,
+				filter->src_mask);
+		ret = append_json_str_value(&tmp_buff, "src", prefix_str);
+	}
+	if (ret == SPPWK_RET_OK &&
+			(filter->fields & SPPWK_MIR_FILTER_DST_IP)) {
+		get_ipv4_prefix_str(prefix_str, filter->dst_ip,
+				filter->dst_mask);
+		ret = append_json_str_value(&tmp_buff, "dst", prefix_str);
+	}
+	if (ret == SPPWK_RET_OK &&
+			(filter->fields & SPPWK_MIR_FILTER_SRC_PORT))
+		ret = append_json_uint_value(&tmp_buff, "sport",
+				rte_be_to_cpu_16(filter->src_port));
+	if (ret == SPPWK_RET_OK &&
+			(filter->fields & SPPWK_MIR_FILTER_DST_PORT))
+		ret = append_json_uint_value(&tmp_buff, "dport",
+				rte_be_to_cpu_16(filter->dst_port));
+
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_block_brackets(output, name, tmp_buff);
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
+/* Append options and their counters of given mirror component in JSON. */
+static int
+append_mirror_opts_value(char **output,
+		const struct sppwk_comp_info *comp_info)
+{
+	int ret;
+	const struct sppwk_mir_opts *opts = &comp_info->mir_opts;
+	uint64_t nof_matched = 0, nof_unmatched = 0, nof_mirrored = 0;
+	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, MIR_CMD_RUNNER, "Failed to alloc buff.\n");
+		return SPPWK_RET_NG;
+	}
+
+	get_mirror_opts_stats(comp_info->comp_id, &nof_matched,
+			&nof_unmatched, &nof_mirrored);
+	ret = append_json_str_value(&tmp_buff, "name", comp_info->name);
+	if (ret == SPPWK_RET_OK)
+		ret = append_filter_value(&tmp_buff, "filter", &opts->filter);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint_value(&tmp_buff, "sample",
+				(opts->sample > 1) ? opts->sample : 1);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint_value(&tmp_buff, "sample_rate",
+				opts->sample_rate);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint_value(&tmp_buff, "snaplen",
+				opts->snaplen);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_str_value(&tmp_buff, "copy",
+				sppwk_mir_copy_mode_str(opts->copy_mode));
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint64_value(&tmp_buff, "matched",
+				nof_matched);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint64_value(&tmp_buff, "unmatched",
+				nof_unmatched);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint64_value(&tmp_buff, "mirrored",
+				nof_mirrored);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_block_brackets(output, "", tmp_buff);
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
+/* Add entry of options of mirror components to a response in JSON. */
+static int
+add_mirror_opts(const char *name, char **output,
+		void *tmp __attribute__ ((unused)))
+{
+	int ret = SPPWK_RET_OK;
+	int cnt;
+	struct sppwk_comp_info *comp_info_base = NULL;
+	struct sppwk_comp_info *comp_info = NULL;
+	const struct sppwk_mir_opts *opts = NULL;
+	char *array_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(array_buff == NULL)) {
+		RTE_LOG(ERR, MIR_CMD_RUNNER, "Failed to alloc buff.\n");
+		return SPPWK_RET_NG;
+	}
+
+	/* Only components of which options are not default are included. */
+	sppwk_get_mng_data(NULL, &comp_info_base, NULL, NULL, NULL, NULL);
+	for (cnt = 0; cnt < RTE_MAX_LCORE && ret == SPPWK_RET_OK; cnt++) {
+		comp_info = (comp_info_base + cnt);
+		opts = &comp_info->mir_opts;
+		if (comp_info->wk_type != SPPWK_TYPE_MIR ||
+				(opts->filter.fields == 0 &&
+				 opts->sample <= 1 && opts->sample_rate == 0 &&
+				 opts->snaplen == 0 &&
+				 opts->copy_mode == SPPWK_MIR_COPY_SHALLOW))
+			continue;
+		ret = append_mirror_opts_value(&array_buff, comp_info);
+	}
+
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_array_brackets(output, name, array_buff);
+	spp_strbuf_free(array_buff);
+	return ret;
+}
+
 /* Activate temporarily stored component info while flushing. */
 int
 update_comp_info(struct sppwk_comp_info *p_comp_info, int *p_change_comp)
@@ -435,7 +654,14 @@ int get_status_ops(struct cmd_res_formatter_ops *ops_list)
 		{ "vhost", add_interface },
 		{ "ring", add_interface },
 		{ "master-lcore", add_master_lcore},
+		{ "lcore_stats", add_lcore_stats},
+		{ "sched", add_sched_stats},
 		{ "core", add_core},
+		{ "latency_stats", add_latency_stats_mode},
+		{ "port_latency", add_port_latency_status},
+		{ "e2e_latency", add_e2e_latency_status},
+		{ "queue_occupancy", add_queue_occupancy_status},
+		{ "mirror_opts", add_mirror_opts},
 		{ "", NULL }
 	};
 	memcpy(ops_list, tmp_ops_list, sizeof(tmp_ops_list));
@@ -8,6 +8,8 @@
 
 #include <rte_common.h>
 #include <rte_cycles.h>
+#include <rte_ethdev.h>
+#include <rte_ip.h>
 
 #include "spp_mirror.h"
 #include "shared/secondary/common.h"
@@ -19,21 +21,32 @@
 #include "shared/secondary/spp_worker_th/cmd_parser.h"
 #include "shared/secondary/spp_worker_th/cmd_utils.h"
 #include "shared/secondary/spp_worker_th/port_capability.h"
-
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
 #include "shared/secondary/spp_worker_th/latency_stats.h"
-#endif
+#include "shared/secondary/spp_worker_th/queue_occupancy.h"
 
 /* Declare global variables */
 #define RTE_LOGTYPE_MIRROR RTE_LOGTYPE_USER1
 
+/* Burst functions of ports without and with measuring latency. */
+static const struct sppwk_burst_ops g_eth_burst = {
+	sppwk_eth_rx_burst, sppwk_eth_tx_burst
+};
+static const struct sppwk_burst_ops g_eth_stats_burst = {
+	sppwk_eth_stats_rx_burst, sppwk_eth_stats_tx_burst
+};
+
 #define SPP_MIRROR_POOL_NAME "spp_mirror_pool"
+#define SPP_MIRROR_CLONE_POOL_NAME "spp_mirror_clone"
+#define SPP_MIRROR_SNAP_POOL_NAME "spp_mirror_snap"
 #define SPP_MIRROR_POOL_NAME_MAX 32
 #define MAX_PKT_MIRROR 4096
 #define MEMPOOL_CACHE_SIZE 256
 #define MIR_RX_DESC_DEFAULT 1024
 #define MIR_TX_DESC_DEFAULT 1024
 
+/* Bytes of headers copied in hybrid copy mode. */
+#define MIR_HYBRID_HDR_LEN 128
+
 /* getopt_long return value for long option */
 enum SPP_LONGOPT_RETVAL {
 	SPP_LONGOPT_RETVAL__ = 127,
@@ -54,7 +67,16 @@ struct mirror_path {
 	char name[STR_LEN_NAME];  /* component name */
 	volatile enum sppwk_worker_type wk_type;
 	int nof_rx;  /* number of receive ports */
-	int nof_tx;  /* number of mirror ports */
+	int nof_tx;  /* number of original and mirror ports */
+	int share_mbuf;  /* 1 if all of TX ports send the same mbufs. */
+	struct sppwk_mir_opts opts;  /* filter, sampling and snaplen */
+	int select_pkts;  /* 1 if not all of packets are mirrored. */
+	uint32_t sample_cnt;  /* num of packets skipped since last sampled */
+	uint64_t rate_credit;  /* credit of sample_rate, tsc hz per packet */
+	uint64_t rate_tsc;  /* tsc when rate_credit is updated */
+	uint64_t nof_matched;  /* num of packets matched with filter */
+	uint64_t nof_unmatched;  /* num of packets not matched with filter */
+	uint64_t nof_mirrored;  /* num of packets mirrored */
 	struct mirror_rxtx ports[RTE_MAX_ETHPORTS];  /* used for mirror */
 };
 
@@ -90,9 +112,15 @@ static struct cancel_backup_info g_backup_info;
 /* mirror info */
 static struct mirror_info g_mirror_info[RTE_MAX_LCORE];
 
-/* mirror mbuf pool */
+/* mirror mbuf pool for deep copy */
 static struct rte_mempool *g_mirror_pool;
 
+/* mbuf pool for clones referring original packets */
+static struct rte_mempool *g_mirror_clone_pool;
+
+/* mbuf pool for packets truncated to snaplen and headers of hybrid copy */
+static struct rte_mempool *g_mirror_snap_pool;
+
 /* Print help message */
 static void
 usage(const char *progname)
@@ -190,39 +218,47 @@ parse_app_args(int argc, char *argv[])
 	return SPPWK_RET_OK;
 }
 
-/* mirror mbuf pool create */
+/* Lookup mbuf pool of given name and id, or create it if not exist. */
+static struct rte_mempool *
+get_mirror_pool(const char *name, int id, unsigned int nb_mbufs,
+		uint16_t data_room_size)
+{
+	struct rte_mempool *pool;
+	char pool_name[SPP_MIRROR_POOL_NAME_MAX];
+
+	sprintf(pool_name, "%s_%d", name, id);
+	pool = rte_mempool_lookup(pool_name);
+	if (pool == NULL)
+		pool = rte_pktmbuf_pool_create(pool_name, nb_mbufs,
+				MEMPOOL_CACHE_SIZE, 0, data_room_size,
+				rte_socket_id());
+	if (pool == NULL)
+		RTE_LOG(ERR, MIRROR, "Cannot init mbuf pool %s\n", pool_name);
+	return pool;
+}
+
+/**
+ * mirror mbuf pool create. Copy mode is changed at runtime, so that pools
+ * for all of modes are created. Clones have no data room, and snap pool is
+ * only for snaplen or headers.
+ */
 static int
 mirror_pool_create(int id)
 {
 	unsigned int nb_mbufs;
-	char pool_name[SPP_MIRROR_POOL_NAME_MAX];
 
 	nb_mbufs = RTE_MAX(
 	    (uint16_t)(nb_rxd + nb_txd + MAX_PKT_BURST + MEMPOOL_CACHE_SIZE),
 									8192U);
-	sprintf(pool_name, "%s_%d", SPP_MIRROR_POOL_NAME, id);
-	g_mirror_pool = rte_mempool_lookup(pool_name);
-	if (g_mirror_pool == NULL) {
-#ifdef SPP_MIRROR_SHALLOWCOPY
-		g_mirror_pool = rte_pktmbuf_pool_create(pool_name,
-						nb_mbufs,
-						MEMPOOL_CACHE_SIZE,
-						0,
-						RTE_PKTMBUF_HEADROOM,
-						rte_socket_id());
-#else
-		g_mirror_pool = rte_pktmbuf_pool_create(pool_name,
-						nb_mbufs,
-						MEMPOOL_CACHE_SIZE,
-						0,
-						RTE_MBUF_DEFAULT_BUF_SIZE,
-						rte_socket_id());
-#endif /* SPP_MIRROR_SHALLOWCOPY */
-	}
-	if (g_mirror_pool == NULL) {
-		RTE_LOG(ERR, MIRROR, "Cannot init mbuf pool\n");
+	g_mirror_pool = get_mirror_pool(SPP_MIRROR_POOL_NAME, id, nb_mbufs,
+			RTE_MBUF_DEFAULT_BUF_SIZE);
+	g_mirror_clone_pool = get_mirror_pool(SPP_MIRROR_CLONE_POOL_NAME, id,
+			nb_mbufs, RTE_PKTMBUF_HEADROOM);
+	g_mirror_snap_pool = get_mirror_pool(SPP_MIRROR_SNAP_POOL_NAME, id,
+			nb_mbufs, RTE_PKTMBUF_HEADROOM + SPPWK_MIR_SNAPLEN_MAX);
+	if (g_mirror_pool == NULL || g_mirror_clone_pool == NULL ||
+			g_mirror_snap_pool == NULL)
 		return SPPWK_RET_NG;
-	}
 
 	return SPPWK_RET_OK;
 }
@@ -239,6 +275,36 @@ mirror_proc_init(void)
 	}
 }
 
+/**
+ * Return 1 if all of TX ports of given path can send the same mbufs instead
+ * of copies. Phy and vhost ports only read packets while sending, but ring
+ * port passes them to another process which might modify them. Phy port of
+ * DEV_TX_OFFLOAD_MBUF_FAST_FREE is also excluded, because the PMD frees
+ * mbufs ignoring refcnt.
+ */
+static int
+is_mbuf_sharable(const struct mirror_path *path)
+{
+	int cnt;
+
+	const struct sppwk_port_info *tx;
+	uint64_t offloads;
+
+	for (cnt = 0; cnt < path->nof_tx; cnt++) {
+		tx = &path->ports[cnt].tx;
+		if (tx->iface_type == RING)
+			return 0;
+		if (tx->iface_type != PHY)
+			continue;
+		/* Config of port is shared with primary which set it up. */
+		offloads = rte_eth_devices[tx->ethdev_port_id].data->
+				dev_conf.txmode.offloads;
+		if (offloads & DEV_TX_OFFLOAD_MBUF_FAST_FREE)
+			return 0;
+	}
+	return 1;
+}
+
 /* Update mirror info */
 int
 update_mirror(struct sppwk_comp_info *wk_comp)
@@ -249,14 +315,22 @@ update_mirror(struct sppwk_comp_info *wk_comp)
 	struct mirror_info *info = &g_mirror_info[wk_comp->comp_id];
 	struct mirror_path *path = &info->path[info->upd_index];
 
-	/* Check mirror has just one RX and two TX port. */
+	/* Update side is still referred if previous update is not taken. */
+	if (unlikely(info->ref_index == info->upd_index)) {
+		RTE_LOG(ERR, MIRROR,
+			"Previous update is not taken yet (id=%d)\n",
+			wk_comp->comp_id);
+		return SPPWK_RET_NG;
+	}
+
+	/* Check mirror has just one RX port. */
 	if (unlikely(nof_rx > 1)) {
 		RTE_LOG(ERR, MIRROR,
 			"Invalid num of RX (id=%d, type=%d, nof_rx=%d)\n",
 			wk_comp->comp_id, wk_comp->wk_type, nof_rx);
 		return SPPWK_RET_NG;
 	}
-	if (unlikely(nof_tx > 2)) {
+	if (unlikely(nof_tx > RTE_MAX_ETHPORTS)) {
 		RTE_LOG(ERR, MIRROR,
 			"Invalid num of TX (id=%d, type=%d, nof_tx=%d)\n",
 			wk_comp->comp_id, wk_comp->wk_type, nof_tx);
@@ -273,6 +347,10 @@ update_mirror(struct sppwk_comp_info *wk_comp)
 	path->wk_type = wk_comp->wk_type;
 	path->nof_rx = wk_comp->nof_rx;
 	path->nof_tx = wk_comp->nof_tx;
+	memcpy(&path->opts, &wk_comp->mir_opts,
+			sizeof(struct sppwk_mir_opts));
+	path->select_pkts = (path->opts.filter.fields != 0 ||
+			path->opts.sample > 1 || path->opts.sample_rate != 0);
 	for (cnt = 0; cnt < nof_rx; cnt++)
 		memcpy(&path->ports[cnt].rx, wk_comp->rx_ports[cnt],
 				sizeof(struct sppwk_port_info));
@@ -281,10 +359,12 @@ update_mirror(struct sppwk_comp_info *wk_comp)
 	for (cnt = 0; cnt < nof_tx; cnt++)
 		memcpy(&path->ports[cnt].tx, wk_comp->tx_ports[cnt],
 				sizeof(struct sppwk_port_info));
+	/* Truncated packets are always copied. */
+	path->share_mbuf = (path->opts.copy_mode == SPPWK_MIR_COPY_SHALLOW &&
+			path->opts.snaplen == 0 && is_mbuf_sharable(path));
 
+	/* Publish it, and the lcore is waited in sppwk_wait_update_done(). */
 	info->upd_index = info->ref_index;
-	while (likely(info->ref_index == info->upd_index))
-		rte_delay_us_block(SPPWK_UPDATE_INTERVAL);
 
 	RTE_LOG(INFO, MIRROR,
 			"Done update mirror (id=%d, name=%s, type=%d)\n",
@@ -293,149 +373,522 @@ update_mirror(struct sppwk_comp_info *wk_comp)
 	return SPPWK_RET_OK;
 }
 
+/* Check if updated mirror info is taken by its lcore. */
+int
+is_comp_update_done(int comp_id)
+{
+	struct mirror_info *info = &g_mirror_info[comp_id];
+	if (info->ref_index == info->upd_index)
+		return 0;
+	else
+		return 1;
+}
+
+/* Take updated attributes of ports of given path. */
+static void
+take_mirror_port_attrs(const struct mirror_path *path)
+{
+	int cnt;
+
+	for (cnt = 0; cnt < path->nof_rx; cnt++)
+		sppwk_take_port_attrs(path->ports[cnt].rx.ethdev_port_id,
+				SPPWK_PORT_DIR_RX);
+	for (cnt = 0; cnt < path->nof_tx; cnt++)
+		sppwk_take_port_attrs(path->ports[cnt].tx.ethdev_port_id,
+				SPPWK_PORT_DIR_TX);
+}
+
 /* Change index of mirror info */
 static inline void
 change_mirror_index(int id)
 {
+	int next_index;
+	struct mirror_path *path, *next_path;
 	struct mirror_info *info = &g_mirror_info[id];
 	if (info->ref_index == info->upd_index) {
-	/* Change reference index of port ability. */
-		sppwk_swap_two_sides(SPPWK_SWAP_REF, 0, 0);
-		info->ref_index = (info->upd_index+1) % TWO_SIDES;
+		/* Counters are taken over if options are not changed. */
+		next_index = (info->upd_index+1) % TWO_SIDES;
+		path = &info->path[info->ref_index];
+		next_path = &info->path[next_index];
+		if (memcmp(&path->opts, &next_path->opts,
+				sizeof(struct sppwk_mir_opts)) == 0) {
+			next_path->sample_cnt = path->sample_cnt;
+			next_path->rate_credit = path->rate_credit;
+			next_path->rate_tsc = path->rate_tsc;
+			next_path->nof_matched = path->nof_matched;
+			next_path->nof_unmatched = path->nof_unmatched;
+			next_path->nof_mirrored = path->nof_mirrored;
+		}
+		info->ref_index = next_index;
+
+		/* Change reference side of attributes of its ports. */
+		take_mirror_port_attrs(&info->path[info->ref_index]);
+	}
+}
+
+/**
+ * Return 1 if given packet is matched with all of fields of filter, or 0.
+ * VLAN ID is of the outermost tag, or the one stripped by NIC. Other fields
+ * are only for IPv4, and ports are only in the first fragment.
+ */
+static inline int
+is_filter_matched(const struct sppwk_mir_filter *filter,
+		struct rte_mbuf *pkt)
+{
+	int has_vid = 0;
+	uint16_t vid = 0, ether_type;
+	uint32_t offset = sizeof(struct rte_ether_hdr);
+	const struct rte_vlan_hdr *vlan;
+	const struct rte_ipv4_hdr *ip;
+	const uint16_t *l4_ports;
+
+	if (unlikely(pkt->data_len < offset))
+		return 0;
+	ether_type = rte_pktmbuf_mtod(pkt, struct rte_ether_hdr *)->ether_type;
+
+	if (pkt->ol_flags & PKT_RX_VLAN_STRIPPED) {
+		vid = pkt->vlan_tci & ETH_VLAN_ID_MAX;
+		has_vid = 1;
+	}
+	while (ether_type == rte_cpu_to_be_16(RTE_ETHER_TYPE_VLAN) ||
+			ether_type == rte_cpu_to_be_16(RTE_ETHER_TYPE_QINQ)) {
+		if (unlikely(pkt->data_len < offset + sizeof(*vlan)))
+			return 0;
+		vlan = rte_pktmbuf_mtod_offset(pkt, struct rte_vlan_hdr *,
+				offset);
+		if (!has_vid) {
+			vid = rte_be_to_cpu_16(vlan->vlan_tci) &
+					ETH_VLAN_ID_MAX;
+			has_vid = 1;
+		}
+		ether_type = vlan->eth_proto;
+		offset += sizeof(*vlan);
+	}
+	if ((filter->fields & SPPWK_MIR_FILTER_VLAN) &&
+			(!has_vid || vid != filter->vid))
+		return 0;
+	if (!(filter->fields & ~SPPWK_MIR_FILTER_VLAN))
+		return 1;
+
+	if (ether_type != rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV4) ||
+			pkt->data_len < offset + sizeof(*ip))
+		return 0;
+	ip = rte_pktmbuf_mtod_offset(pkt, struct rte_ipv4_hdr *, offset);
+	if ((filter->fields & SPPWK_MIR_FILTER_PROTO) &&
+			ip->next_proto_id != filter->proto)
+		return 0;
+	if ((filter->fields & SPPWK_MIR_FILTER_SRC_IP) &&
+			(ip->src_addr & filter->src_mask) != filter->src_ip)
+		return 0;
+	if ((filter->fields & SPPWK_MIR_FILTER_DST_IP) &&
+			(ip->dst_addr & filter->dst_mask) != filter->dst_ip)
+		return 0;
+	if (!(filter->fields & (SPPWK_MIR_FILTER_SRC_PORT |
+			SPPWK_MIR_FILTER_DST_PORT)))
+		return 1;
+
+	if (ip->next_proto_id != IPPROTO_TCP &&
+			ip->next_proto_id != IPPROTO_UDP &&
+			ip->next_proto_id != IPPROTO_SCTP)
+		return 0;
+	if (ip->fragment_offset & rte_cpu_to_be_16(RTE_IPV4_HDR_OFFSET_MASK))
+		return 0;
+	offset += (ip->version_ihl & RTE_IPV4_HDR_IHL_MASK) *
+			RTE_IPV4_IHL_MULTIPLIER;
+	if (pkt->data_len < offset + 2 * sizeof(uint16_t))
+		return 0;
+	l4_ports = rte_pktmbuf_mtod_offset(pkt, uint16_t *, offset);
+	if ((filter->fields & SPPWK_MIR_FILTER_SRC_PORT) &&
+			l4_ports[0] != filter->src_port)
+		return 0;
+	if ((filter->fields & SPPWK_MIR_FILTER_DST_PORT) &&
+			l4_ports[1] != filter->dst_port)
+		return 0;
+	return 1;
+}
+
+/* Copy metadata of given packet to its copy. */
+static inline void
+copy_mirror_meta(struct rte_mbuf *copy_mbuf, const struct rte_mbuf *org_mbuf)
+{
+	copy_mbuf->port = org_mbuf->port;
+	copy_mbuf->vlan_tci = org_mbuf->vlan_tci;
+	copy_mbuf->vlan_tci_outer = org_mbuf->vlan_tci_outer;
+	copy_mbuf->tx_offload = org_mbuf->tx_offload;
+	copy_mbuf->hash = org_mbuf->hash;
+	copy_mbuf->ol_flags = org_mbuf->ol_flags;
+	copy_mbuf->packet_type = org_mbuf->packet_type;
+	copy_mbuf->udata64 = org_mbuf->udata64;
+}
+
+/**
+ * Copy data of given packet to an mbuf of g_mirror_pool. Data is filled up
+ * to data room of each of segments, so that the copy is a single segment
+ * unless the packet is larger than data room. Return SPPWK_RET_NG if
+ * failed to alloc following segment.
+ */
+static inline int
+copy_mirror_data(struct rte_mbuf *copy_mbuf, const struct rte_mbuf *org_mbuf)
+{
+	uint32_t len, off = 0;
+	struct rte_mbuf *seg = copy_mbuf;
+	const char *src;
+	char *dst;
+
+	while (1) {
+		len = RTE_MIN((uint32_t)rte_pktmbuf_tailroom(seg),
+				org_mbuf->pkt_len - off);
+
+		/* Data is copied to dst by rte_pktmbuf_read() if segmented. */
+		dst = rte_pktmbuf_mtod(seg, char *);
+		src = rte_pktmbuf_read(org_mbuf, off, len, dst);
+		if (likely(src != dst))
+			rte_memcpy(dst, src, len);
+		seg->data_len = len;
+		off += len;
+		if (likely(off >= org_mbuf->pkt_len))
+			break;
+
+		seg->next = rte_pktmbuf_alloc(g_mirror_pool);
+		if (unlikely(seg->next == NULL)) {
+			RTE_LOG(INFO, MIRROR, "copy mbuf alloc NG!\n");
+			return SPPWK_RET_NG;
+		}
+		seg = seg->next;
+		copy_mbuf->nb_segs++;
+	}
+	copy_mbuf->pkt_len = org_mbuf->pkt_len;
+	return SPPWK_RET_OK;
+}
+
+/**
+ * Make deep copies of given packets into mbufs allocated at once, and return
+ * the num of copies.
+ */
+static inline int
+copy_mirror_pkts_deep(struct rte_mbuf **pkts, int nb_pkts,
+		struct rte_mbuf **copies)
+{
+	int cnt;
+	int nb_copy = 0;
+
+	if (unlikely(rte_pktmbuf_alloc_bulk(g_mirror_pool, copies,
+			nb_pkts) != 0)) {
+		RTE_LOG(INFO, MIRROR, "copy mbuf alloc NG!\n");
+		return 0;
+	}
+
+	for (cnt = 0; cnt < nb_pkts; cnt++) {
+		if (likely(cnt + 1 < nb_pkts))
+			rte_prefetch0(rte_pktmbuf_mtod(pkts[cnt + 1], void *));
+		copy_mirror_meta(copies[cnt], pkts[cnt]);
+		if (unlikely(copy_mirror_data(copies[cnt], pkts[cnt]) !=
+				SPPWK_RET_OK)) {
+			rte_pktmbuf_free(copies[cnt]);
+			continue;
+		}
+		copies[nb_copy++] = copies[cnt];
+	}
+	return nb_copy;
+}
+
+/* Make a deep copy of given packet, or return NULL if failed. */
+static inline struct rte_mbuf *
+copy_mirror_mbuf_deep(struct rte_mbuf *org_mbuf)
+{
+	struct rte_mbuf *copy_mbuf = NULL;
+
+	copy_mbuf = rte_pktmbuf_alloc(g_mirror_pool);
+	if (unlikely(copy_mbuf == NULL)) {
+		RTE_LOG(INFO, MIRROR, "copy mbuf alloc NG!\n");
+		return NULL;
+	}
+
+	copy_mirror_meta(copy_mbuf, org_mbuf);
+	if (unlikely(copy_mirror_data(copy_mbuf, org_mbuf) != SPPWK_RET_OK)) {
+		rte_pktmbuf_free(copy_mbuf);
+		return NULL;
+	}
+	return copy_mbuf;
+}
+
+/* Make a clone referring given packet, or return NULL if failed. */
+static inline struct rte_mbuf *
+clone_mirror_mbuf(struct rte_mbuf *org_mbuf)
+{
+	struct rte_mbuf *copy_mbuf = NULL;
+
+	copy_mbuf = rte_pktmbuf_clone(org_mbuf, g_mirror_clone_pool);
+	if (likely(copy_mbuf != NULL))
+		copy_mbuf->udata64 = org_mbuf->udata64;
+	return copy_mbuf;
+}
+
+/**
+ * Make a copy of first max_len bytes of given packet in a single mbuf of
+ * g_mirror_snap_pool, or return NULL if failed.
+ */
+static inline struct rte_mbuf *
+copy_mirror_head(struct rte_mbuf *org_mbuf, uint32_t max_len)
+{
+	uint32_t len = RTE_MIN(max_len, org_mbuf->pkt_len);
+	struct rte_mbuf *copy_mbuf = NULL;
+	const char *src;
+	char *dst;
+
+	copy_mbuf = rte_pktmbuf_alloc(g_mirror_snap_pool);
+	if (unlikely(copy_mbuf == NULL)) {
+		RTE_LOG(INFO, MIRROR, "snap mbuf alloc NG!\n");
+		return NULL;
+	}
+
+	/* Data is copied to dst by rte_pktmbuf_read() only if segmented. */
+	dst = rte_pktmbuf_mtod(copy_mbuf, char *);
+	src = rte_pktmbuf_read(org_mbuf, 0, len, dst);
+	if (likely(src != dst))
+		rte_memcpy(dst, src, len);
+
+	copy_mbuf->data_len = len;
+	copy_mbuf->pkt_len = len;
+	copy_mirror_meta(copy_mbuf, org_mbuf);
+	return copy_mbuf;
+}
+
+/**
+ * Make a copy of headers of given packet followed by a clone referring the
+ * rest of it, or return NULL if failed. Headers can be modified on TX port
+ * without affecting original while payload is not copied.
+ */
+static inline struct rte_mbuf *
+copy_mirror_mbuf_hybrid(struct rte_mbuf *org_mbuf)
+{
+	struct rte_mbuf *hdr_mbuf = NULL;
+	struct rte_mbuf *payload = NULL;
+
+	/* Clone cannot start from second segment, so copy it all. */
+	if (unlikely(org_mbuf->data_len <= MIR_HYBRID_HDR_LEN &&
+			org_mbuf->nb_segs > 1))
+		return copy_mirror_mbuf_deep(org_mbuf);
+
+	hdr_mbuf = copy_mirror_head(org_mbuf, MIR_HYBRID_HDR_LEN);
+	if (unlikely(hdr_mbuf == NULL))
+		return NULL;
+	if (hdr_mbuf->pkt_len == org_mbuf->pkt_len)
+		return hdr_mbuf;
+
+	payload = rte_pktmbuf_clone(org_mbuf, g_mirror_clone_pool);
+	if (unlikely(payload == NULL)) {
+		rte_pktmbuf_free(hdr_mbuf);
+		return NULL;
+	}
+	rte_pktmbuf_adj(payload, MIR_HYBRID_HDR_LEN);
+	if (unlikely(rte_pktmbuf_chain(hdr_mbuf, payload) != 0)) {
+		rte_pktmbuf_free(hdr_mbuf);
+		rte_pktmbuf_free(payload);
+		return NULL;
+	}
+	return hdr_mbuf;
+}
+
+/**
+ * Make a copy of first snaplen bytes of given packet in a single mbuf, or
+ * return NULL if failed. Offloads for TX are not taken for the packet
+ * might be truncated.
+ */
+static inline struct rte_mbuf *
+copy_snap_mbuf(struct rte_mbuf *org_mbuf, uint32_t snaplen)
+{
+	struct rte_mbuf *copy_mbuf = copy_mirror_head(org_mbuf, snaplen);
+
+	if (likely(copy_mbuf != NULL)) {
+		copy_mbuf->tx_offload = 0;
+		copy_mbuf->ol_flags &= ~PKT_TX_OFFLOAD_MASK;
+	}
+	return copy_mbuf;
+}
+
+/**
+ * Make copies of given packets for a mirror port in copy mode of given path,
+ * and return the num of copies.
+ */
+static inline int
+copy_mirror_pkts(const struct mirror_path *path, struct rte_mbuf **pkts,
+		int nb_pkts, struct rte_mbuf **copies)
+{
+	int cnt;
+	int nb_copy = 0;
+
+	if (path->opts.snaplen == 0 &&
+			path->opts.copy_mode == SPPWK_MIR_COPY_DEEP)
+		return copy_mirror_pkts_deep(pkts, nb_pkts, copies);
+
+	for (cnt = 0; cnt < nb_pkts; cnt++) {
+		rte_prefetch0(rte_pktmbuf_mtod(pkts[cnt], void *));
+		if (path->opts.snaplen != 0)
+			copies[nb_copy] = copy_snap_mbuf(pkts[cnt],
+					path->opts.snaplen);
+		else if (path->opts.copy_mode == SPPWK_MIR_COPY_HYBRID)
+			copies[nb_copy] = copy_mirror_mbuf_hybrid(pkts[cnt]);
+		else
+			copies[nb_copy] = clone_mirror_mbuf(pkts[cnt]);
+		if (likely(copies[nb_copy] != NULL))
+			nb_copy++;
+	}
+	return nb_copy;
+}
+
+/**
+ * Return num of packets allowed to be mirrored under sample_rate, from
+ * credit added for elapsed time. Each packet costs tsc hz, and credit is
+ * limited to a burst not to send too many packets after idle.
+ */
+static inline int
+limit_mirror_rate(struct mirror_path *path, int nb_pkts)
+{
+	int nb_allowed;
+	uint64_t hz = rte_get_tsc_hz();
+	uint64_t cur_tsc = rte_rdtsc();
+	uint64_t elapsed = RTE_MIN(cur_tsc - path->rate_tsc, hz);
+
+	path->rate_tsc = cur_tsc;
+	path->rate_credit = RTE_MIN(
+			path->rate_credit + elapsed * path->opts.sample_rate,
+			hz * MAX_PKT_BURST);
+
+	nb_allowed = RTE_MIN((uint64_t)nb_pkts, path->rate_credit / hz);
+	path->rate_credit -= hz * nb_allowed;
+	return nb_allowed;
+}
+
+/**
+ * Select packets to be mirrored into selbufs and return the num of them.
+ * Packets matched with filter are sampled one in `sample`, and then limited
+ * to `sample_rate` packets per sec.
+ */
+static inline int
+select_mirror_pkts(struct mirror_path *path, struct rte_mbuf **bufs,
+		int nb_rx, struct rte_mbuf **selbufs)
+{
+	int cnt;
+	int nb_sel = 0;
+	const struct sppwk_mir_opts *opts = &path->opts;
+
+	for (cnt = 0; cnt < nb_rx; cnt++) {
+		if (opts->filter.fields != 0) {
+			if (!is_filter_matched(&opts->filter, bufs[cnt])) {
+				path->nof_unmatched++;
+				continue;
+			}
+			path->nof_matched++;
+		}
+		if (opts->sample > 1) {
+			if (++path->sample_cnt < opts->sample)
+				continue;
+			path->sample_cnt = 0;
+		}
+		selbufs[nb_sel++] = bufs[cnt];
+	}
+
+	if (opts->sample_rate != 0 && nb_sel > 0)
+		nb_sel = limit_mirror_rate(path, nb_sel);
+	return nb_sel;
+}
+
+/* Send packets to given TX port, and release packets not sent. */
+static inline void
+send_mirror_pkts(const struct sppwk_port_info *tx,
+		struct rte_mbuf **pkts, int nb_pkts)
+{
+	int buf;
+	int nb_tx = 0;
+
+	if (likely(tx->ethdev_port_id >= 0 && nb_pkts > 0))
+		nb_tx = sppwk_port_tx_burst(tx->ethdev_port_id,
+				tx->iface_type, tx->iface_no, pkts, nb_pkts);
+
+	/* Discard remained packets to release mbuf */
+	if (unlikely(nb_tx < nb_pkts)) {
+		RTE_LOG(DEBUG, MIRROR,
+			"mirror packet drop port=%d nb_pkts=%d nb_tx=%d\n",
+			tx->ethdev_port_id, nb_pkts, nb_tx);
+		for (buf = nb_tx; buf < nb_pkts; buf++)
+			rte_pktmbuf_free(pkts[buf]);
 	}
 }
 
 /**
  * Mirroring packets as mirror_proc
  *
- * Behavior of forwarding is defined as core_info->type which is given
- * as an argument of void and typecasted to spp_config_info.
+ * Packets received from the RX port are sent to the first TX port as
+ * original, and to each of the rest of TX ports as mirror. It returns the
+ * num of received packets, or SPPWK_RET_NG if failed.
  */
 static int
 mirror_proc(int id)
 {
-	int cnt, buf;
+	int cnt, port, nb_copy, nb_mir;
 	int nb_rx = 0;
-	int nb_tx = 0;
-	int nb_tx1 = 0;
-	int nb_tx2 = 0;
 	struct mirror_info *info = &g_mirror_info[id];
 	struct mirror_path *path = NULL;
 	struct sppwk_port_info *rx = NULL;
 	struct sppwk_port_info *tx = NULL;
 	struct rte_mbuf *bufs[MAX_PKT_BURST];
+	struct rte_mbuf *selbufs[MAX_PKT_BURST];
 	struct rte_mbuf *copybufs[MAX_PKT_BURST];
-	struct rte_mbuf *org_mbuf = NULL;
+	struct rte_mbuf **mirbufs = NULL;
 
 	change_mirror_index(id);
 	path = &info->path[info->ref_index];
 
 	/* Practice condition check */
-	if (!(path->nof_tx == 2 && path->nof_rx == 1))
+	if (!(path->nof_tx >= 2 && path->nof_rx == 1))
 		return SPPWK_RET_OK;
 
 	rx = &path->ports[0].rx;
 
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
-	nb_rx = sppwk_eth_ring_stats_rx_burst(rx->ethdev_port_id,
-			rx->iface_type, rx->iface_no, 0, bufs, MAX_PKT_BURST);
-#else
-	nb_rx = rte_eth_rx_burst(rx->ethdev_port_id, 0, bufs, MAX_PKT_BURST);
-#endif
+	nb_rx = sppwk_port_rx_burst(rx->ethdev_port_id,
+			rx->iface_type, rx->iface_no, bufs, MAX_PKT_BURST);
 
 	if (unlikely(nb_rx == 0))
 		return SPPWK_RET_OK;
 
-	/* mirror */
-	tx = &path->ports[1].tx;
-	if (tx->ethdev_port_id >= 0) {
-		nb_tx2 = 0;
-		for (cnt = 0; cnt < nb_rx; cnt++) {
-			org_mbuf = bufs[cnt];
-			rte_prefetch0(rte_pktmbuf_mtod(org_mbuf, void *));
-#ifdef SPP_MIRROR_SHALLOWCOPY
-			/* Shallow Copy */
-			copybufs[cnt] = rte_pktmbuf_clone(org_mbuf,
-							g_mirror_pool);
-#else
-			struct rte_mbuf *mirror_mbuf = NULL;
-			struct rte_mbuf **mirror_mbufs = &mirror_mbuf;
-			struct rte_mbuf *copy_mbuf = NULL;
-			/* Deep Copy */
-			do {
-				copy_mbuf = rte_pktmbuf_alloc(g_mirror_pool);
-				if (unlikely(copy_mbuf == NULL)) {
-					rte_pktmbuf_free(mirror_mbuf);
-					mirror_mbuf = NULL;
-					RTE_LOG(INFO, MIRROR,
-						"copy mbuf alloc NG!\n");
-					break;
-				}
-
-				copy_mbuf->data_off = org_mbuf->data_off;
-				copy_mbuf->data_len = org_mbuf->data_len;
-				copy_mbuf->port = org_mbuf->port;
-				copy_mbuf->vlan_tci = org_mbuf->vlan_tci;
-				copy_mbuf->tx_offload = org_mbuf->tx_offload;
-				copy_mbuf->hash = org_mbuf->hash;
-
-				copy_mbuf->next = NULL;
-				copy_mbuf->pkt_len = org_mbuf->pkt_len;
-				copy_mbuf->nb_segs = org_mbuf->nb_segs;
-				copy_mbuf->ol_flags = org_mbuf->ol_flags;
-				copy_mbuf->packet_type = org_mbuf->packet_type;
-
-				rte_memcpy(rte_pktmbuf_mtod(copy_mbuf, char *),
-					rte_pktmbuf_mtod(org_mbuf, char *),
-					org_mbuf->data_len);
-
-				*mirror_mbufs = copy_mbuf;
-				mirror_mbufs = &copy_mbuf->next;
-			} while ((org_mbuf = org_mbuf->next) != NULL);
-			copybufs[cnt] = mirror_mbuf;
-
-#endif /* SPP_MIRROR_SHALLOWCOPY */
-		}
-
-		if (cnt != 0)
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
-			nb_tx2 = sppwk_eth_ring_stats_tx_burst(
-					tx->ethdev_port_id, tx->iface_type,
-					tx->iface_no, 0, copybufs, cnt);
-#else
-			nb_tx2 = rte_eth_tx_burst(tx->ethdev_port_id, 0,
-					copybufs, cnt);
-#endif
+	/* Only packets selected with options are mirrored if given. */
+	mirbufs = bufs;
+	nb_mir = nb_rx;
+	if (path->select_pkts) {
+		mirbufs = selbufs;
+		nb_mir = select_mirror_pkts(path, bufs, nb_rx, selbufs);
 	}
+	path->nof_mirrored += nb_mir;
 
-	/* orginal */
-	tx = &path->ports[0].tx;
-	if (tx->ethdev_port_id >= 0)
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
-		nb_tx1 = sppwk_eth_ring_stats_tx_burst(tx->ethdev_port_id,
-				tx->iface_type, tx->iface_no, 0, bufs, nb_rx);
-#else
-		nb_tx1 = rte_eth_tx_burst(tx->ethdev_port_id, 0, bufs, nb_rx);
-#endif
-	nb_tx = nb_tx1;
+	/**
+	 * If mbufs are shared, refcnt is incremented once for each of mirror
+	 * ports before any of TX ports sends, so that mbuf is released by the
+	 * last one.
+	 */
+	if (path->share_mbuf) {
+		for (cnt = 0; cnt < nb_mir; cnt++)
+			rte_pktmbuf_refcnt_update(mirbufs[cnt],
+					path->nof_tx - 1);
+	}
 
-	if (nb_tx1 != nb_tx2)
-		RTE_LOG(INFO, MIRROR,
-			"mirror paket drop nb_rx=%d nb_tx1=%d nb_tx2=%d\n",
-							nb_rx, nb_tx1, nb_tx2);
+	/* mirror, sent before original which might be released by sending. */
+	for (port = 1; port < path->nof_tx; port++) {
+		tx = &path->ports[port].tx;
+		if (path->share_mbuf) {
+			send_mirror_pkts(tx, mirbufs, nb_mir);
+			continue;
+		}
+		if (tx->ethdev_port_id < 0)
+			continue;
 
-	/* Discard remained packets to release mbuf */
-	if (nb_tx1 < nb_tx2)
-		nb_tx = nb_tx2;
-	if (unlikely(nb_tx < nb_rx)) {
-		for (buf = nb_tx; buf < nb_rx; buf++)
-			rte_pktmbuf_free(bufs[buf]);
-	}
-	if (unlikely(nb_tx2 < nb_rx)) {
-		for (buf = nb_tx2; buf < nb_rx; buf++)
-			rte_pktmbuf_free(copybufs[buf]);
+		nb_copy = copy_mirror_pkts(path, mirbufs, nb_mir, copybufs);
+		send_mirror_pkts(tx, copybufs, nb_copy);
 	}
-	return SPPWK_RET_OK;
+
+	/* orginal */
+	send_mirror_pkts(&path->ports[0].tx, bufs, nb_rx);
+	return nb_rx;
 }
 
 /* Main process of slave core */
@@ -444,6 +897,8 @@ slave_main(void *arg __attribute__ ((unused)))
 {
 	int ret = SPPWK_RET_OK;
 	int cnt = 0;
+	int nof_rx, nof_pkts;
+	uint64_t start_tsc;
 	unsigned int lcore_id = rte_lcore_id();
 	enum sppwk_lcore_status status = SPPWK_LCORE_STOPPED;
 	struct core_mng_info *info = &g_core_info[lcore_id];
@@ -463,15 +918,24 @@ slave_main(void *arg __attribute__ ((unused)))
 			core = get_core_info(lcore_id);
 		}
 
+		nof_pkts = 0;
+		start_tsc = rte_rdtsc();
 		for (cnt = 0; cnt < core->num; cnt++) {
 			/*
-			 * mirror returns at once.
+			 * mirror returns at once, or runs several bursts up to
+			 * its weight while it has backlog.
 			 * It is for processing multiple components.
 			 */
-			ret = mirror_proc(core->id[cnt]);
-			if (unlikely(ret != 0))
+			nof_rx = sppwk_run_comp(core->id[cnt],
+					core->weight[cnt], mirror_proc);
+			if (unlikely(nof_rx < 0)) {
+				ret = SPPWK_RET_NG;
 				break;
+			}
+			nof_pkts += nof_rx;
 		}
+		update_lcore_stats(lcore_id, rte_rdtsc() - start_tsc,
+				nof_pkts);
 		if (unlikely(ret != 0)) {
 			RTE_LOG(ERR, MIRROR,
 				"Failed to forward on lcore %d (id = %d)\n",
@@ -560,6 +1024,7 @@ main(int argc, char *argv[])
 
 		mirror_proc_init();
 		sppwk_port_capability_init();
+		init_queue_occupancy();
 
 		/* Setup connection for accepting commands from controller */
 		get_spp_ctl_ip(ctl_ip);
@@ -568,24 +1033,16 @@ main(int argc, char *argv[])
 		if (unlikely(ret_cmd_init != SPPWK_RET_OK))
 			break;
 
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
-		int port_type, port_id;
-		char dev_name[RTE_DEV_NAME_MAX_LEN] = { 0 };
-		int nof_rings = 0;
-		for (int i = 0; i < RTE_MAX_ETHPORTS; i++) {
-			if (!rte_eth_dev_is_valid_port(i))
-				continue;
-			rte_eth_dev_get_name_by_port(i, dev_name);
-			ret = parse_dev_name(dev_name, &port_type, &port_id);
-			if (port_type == RING)
-				nof_rings++;
-		}
-		int ret_ringlatency = sppwk_init_ring_latency_stats(
-				SPP_RING_LATENCY_STATS_SAMPLING_INTERVAL,
-				nof_rings);
+		/* Latency is measured after enabled with a command. */
+		sppwk_init_port_burst(&g_eth_burst, &g_eth_stats_burst);
+		int ret_ringlatency = sppwk_init_port_latency_stats(
+				SPP_RING_LATENCY_STATS_SAMPLING_INTERVAL);
+		if (unlikely(ret_ringlatency != SPPWK_RET_OK))
+			break;
+		ret_ringlatency = sppwk_init_e2e_latency_stats(
+				SPP_E2E_LATENCY_STATS_SAMPLING_RATE);
 		if (unlikely(ret_ringlatency != SPPWK_RET_OK))
 			break;
-#endif /* SPP_RINGLATENCYSTATS_ENABLE */
 
 		/* Start worker threads of classifier and forwarder */
 		lcore_id = 0;
@@ -601,13 +1058,7 @@ main(int argc, char *argv[])
 
 		/* Start forwarding */
 		set_all_core_status(SPPWK_LCORE_RUNNING);
-#ifdef SPP_MIRROR_SHALLOWCOPY
-		RTE_LOG(INFO, MIRROR,
-			"My ID %d start handling messagei(ShallowCopy)\n", 0);
-#else
-		RTE_LOG(INFO, MIRROR,
-			"My ID %d start handling message(DeepCopy)\n", 0);
-#endif /* #ifdef SPP_MIRROR_SHALLOWCOPY */
+		RTE_LOG(INFO, MIRROR, "My ID %d start handling message\n", 0);
 		RTE_LOG(INFO, MIRROR, "[Press Ctrl-C to quit ...]\n");
 
 		/* Backup the management information after initialization */
@@ -622,15 +1073,15 @@ main(int argc, char *argv[])
 			ret_do = sppwk_run_cmd();
 			if (unlikely(ret_do != SPPWK_RET_OK))
 				break;
+
+			/* Sample num of packets waiting in RX queues. */
+			run_queue_occupancy();
+
 			/*
 			 * To avoid making CPU busy, this thread waits
 			 * here for 100 ms.
 			 */
 			usleep(100);
-
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
-			print_ring_latency_stats(&g_iface_info);
-#endif /* SPP_RINGLATENCYSTATS_ENABLE */
 		}
 
 		if (unlikely(ret_do != SPPWK_RET_OK)) {
@@ -651,14 +1102,25 @@ main(int argc, char *argv[])
 	 /* Remove vhost sock file if not running in vhost-client mode. */
 	del_vhost_sockfile(g_iface_info.vhost);
 
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
-	sppwk_clean_ring_latency_stats();
-#endif /* SPP_RINGLATENCYSTATS_ENABLE */
+	sppwk_clean_latency_stats();
 
 	RTE_LOG(INFO, MIRROR, "Exit spp_mirror.\n");
 	return ret;
 }
 
+/* Get num of packets counted with options of mirror. */
+void
+get_mirror_opts_stats(int id, uint64_t *nof_matched,
+		uint64_t *nof_unmatched, uint64_t *nof_mirrored)
+{
+	struct mirror_info *info = &g_mirror_info[id];
+	const struct mirror_path *path = &info->path[info->ref_index];
+
+	*nof_matched = path->nof_matched;
+	*nof_unmatched = path->nof_unmatched;
+	*nof_mirrored = path->nof_mirrored;
+}
+
 /* Mirror get component status */
 int
 get_mirror_status(unsigned int lcore_id, int id,
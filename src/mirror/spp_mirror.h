@@ -25,4 +25,15 @@
 int get_mirror_status(unsigned int lcore_id, int id,
 		struct sppwk_lcore_params *params);
 
+/**
+ * Get num of packets counted with options of mirror.
+ *
+ * @param id Unique component ID.
+ * @param[out] nof_matched Num of packets matched with filter.
+ * @param[out] nof_unmatched Num of packets not matched with filter.
+ * @param[out] nof_mirrored Num of matched packets sampled and mirrored.
+ */
+void get_mirror_opts_stats(int id, uint64_t *nof_matched,
+		uint64_t *nof_unmatched, uint64_t *nof_mirrored);
+
 #endif /* __SPP_MIRROR_H__ */
@@ -182,7 +182,7 @@ parse_command(char *str)
 
 	if (!strcmp(token_list[0], "status")) {
 		RTE_LOG(DEBUG, SPP_NFV, "status\n");
-		memset(str, '\0', MSG_SIZE);
+		memset(str, '\0', NFV_MSG_SIZE);
 		if (cmd == FORWARD)
 			get_sec_stats_json(str, get_client_id(), "running",
 					lcore_id_used,
@@ -396,7 +396,8 @@ do_send(int *connected, int *sock, char *str)
 {
 	int ret;
 
-	ret = send(*sock, str, MSG_SIZE, 0);
+	/* Message can be larger than MSG_SIZE for status of many lcores. */
+	ret = send(*sock, str, strlen(str) + 1, 0);
 	if (ret == -1) {
 		RTE_LOG(ERR, SPP_NFV, "send failed");
 		*connected = 0;
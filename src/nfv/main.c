@@ -10,6 +10,7 @@
 #include <rte_eth_vhost.h>
 #include <rte_memzone.h>
 #include <rte_log.h>
+#include <rte_cycles.h>
 
 #include "shared/secondary/common.h"
 #include "shared/secondary/utils.h"
@@ -110,6 +111,8 @@ static void
 nfv_loop(void)
 {
 	unsigned int lcore_id = rte_lcore_id();
+	uint64_t start_tsc;
+	int nof_pkts;
 
 	RTE_LOG(INFO, SPP_NFV, "entering main loop on lcore %u\n", lcore_id);
 
@@ -119,7 +122,10 @@ nfv_loop(void)
 			/*RTE_LOG(INFO, SPP_NFV, "Idling\n");*/
 			continue;
 		} else if (cmd == FORWARD) {
-			forward();
+			start_tsc = rte_rdtsc();
+			nof_pkts = forward();
+			update_lcore_stats(lcore_id, rte_rdtsc() - start_tsc,
+					nof_pkts);
 		}
 	}
 }
@@ -144,7 +150,7 @@ main(int argc, char *argv[])
 	unsigned int lcore_id;
 	unsigned int nb_ports;
 	int connected = 0;
-	char str[MSG_SIZE] = { 0 };
+	char str[NFV_MSG_SIZE] = { 0 };
 	unsigned int i;
 	int flg_exit;  // used as res of parse_command() to exit if -1
 	int ret;
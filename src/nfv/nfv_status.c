@@ -18,6 +18,10 @@
  *   {
  *     "status": "running",
  *     "lcores": [1, 2],
+ *     "lcore_stats": [
+ *       {"lcore_id":2,"busy_cycles":3000,"idle_cycles":9000,"pkts":64,
+ *        "cycles_per_pkt":46,"usage":25}
+ *     ],
  *     "ports": ["phy:0", "phy:1", "ring:0", "vhost:0"],
  *     "patches": [
  *       {"src":"phy:0","dst": "ring:0"},
@@ -40,6 +44,10 @@ get_sec_stats_json(char *str, int cli_id,
 	append_lcore_info_json(str, lcore_id_used);
 	sprintf(str + strlen(str), ",");
 
+	/* Keep MSG_SIZE for ports and patches appended after lcore stats. */
+	append_lcore_stats_json(str, NFV_BUF_SIZE_LCORE_STATS);
+	sprintf(str + strlen(str), ",");
+
 	append_port_info_json(str, ports_fwd_array, port_map);
 	sprintf(str + strlen(str), ",");
 
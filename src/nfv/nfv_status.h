@@ -5,6 +5,13 @@
 #ifndef _NFV_STATUS_H_
 #define _NFV_STATUS_H_
 
+/*
+ * Size of message of spp_nfv. Status of ports and patches is in MSG_SIZE as
+ * before, and stats of lcores are added to it.
+ */
+#define NFV_BUF_SIZE_LCORE_STATS (LCORE_STATS_JSON_LEN * RTE_MAX_LCORE)
+#define NFV_MSG_SIZE (MSG_SIZE + NFV_BUF_SIZE_LCORE_STATS)
+
 /* Get status of spp_nfv or spp_vm as JSON format. */
 void get_sec_stats_json(char *str, int client_id,
 		const char *running_stat,
@@ -503,6 +503,45 @@ append_master_lcore_value(const char *name, char **output,
 	return ret;
 }
 
+/* append busy and idle cycles of each of slave lcores for JSON format */
+static int
+append_lcore_stats_value(const char *name, char **output,
+		void *tmp __attribute__ ((unused)))
+{
+	int ret = SPPWK_RET_OK;
+	unsigned int lcore_id;
+	char stats_str[LCORE_STATS_JSON_LEN];
+	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, PCAP_RUNNER, "Failed to alloc buff.\n");
+		return SPPWK_RET_NG;
+	}
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		lcore_stats_json(stats_str, sizeof(stats_str), lcore_id);
+		ret = append_json_block_brackets("", &tmp_buff, stats_str);
+		if (unlikely(ret != SPPWK_RET_OK)) {
+			spp_strbuf_free(tmp_buff);
+			return SPPWK_RET_NG;
+		}
+	}
+
+	ret = append_json_array_brackets(name, output, tmp_buff);
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
+/* append occupancy of ring between receiver and writers for JSON format */
+static int
+append_cap_ring_value(const char *name, char **output,
+		void *tmp __attribute__ ((unused)))
+{
+	char occ_str[QUEUE_OCC_JSON_LEN];
+
+	spp_pcap_get_cap_ring_occupancy(occ_str, sizeof(occ_str));
+	return append_json_block_brackets(name, output, occ_str);
+}
+
 /* append a list of core information for JSON format */
 static int
 append_core_value(const char *name, char **output,
@@ -604,6 +643,8 @@ struct cmd_res_formatter_ops response_info_list[] = {
 	{ "client-id",        append_client_id_value },
 	{ "status",           append_capture_status_value },
 	{ "master-lcore",     append_master_lcore_value },
+	{ "lcore_stats",      append_lcore_stats_value },
+	{ "cap_ring",         append_cap_ring_value },
 	{ "core",             append_core_value },
 	COMMAND_RESP_TAG_LIST_EMPTY
 };
@@ -23,9 +23,6 @@
 #include "shared/secondary/utils.h"
 #include "shared/secondary/spp_worker_th/port_capability.h"
 
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
-#include "shared/secondary/spp_worker_th/latency_stats.h"
-#endif
 
 /* Declare global variables */
 #define RTE_LOGTYPE_SPP_PCAP RTE_LOGTYPE_USER2
@@ -124,6 +121,8 @@ struct pcap_option {
 	char compress_file_date[PCAP_FDATE_STRLEN];  /* file name date */
 	struct sppwk_port_info port_cap;  /* capture port */
 	struct rte_ring *cap_ring;  /* RTE ring structure */
+	struct queue_occupancy cap_ring_occ;  /* Occupancy of cap_ring */
+	uint64_t prev_occ_tsc;  /* TSC of the last sample of occupancy */
 };
 
 /**
@@ -405,6 +404,31 @@ spp_pcap_get_core_status(
 	return SPPWK_RET_OK;
 }
 
+/* Get occupancy of ring between receiver and writers in JSON. */
+int
+spp_pcap_get_cap_ring_occupancy(char *str, size_t size)
+{
+	return queue_occupancy_json(str, size, &g_pcap_option.cap_ring_occ);
+}
+
+/**
+ * Sample num of packets in ring between receiver and writers. It is called
+ * from the loop of master thread and does nothing until the interval passed.
+ */
+static void
+sample_cap_ring(void)
+{
+	uint64_t cur_tsc = rte_rdtsc();
+
+	if (cur_tsc - g_pcap_option.prev_occ_tsc <
+			rte_get_tsc_hz() / 1000 * QUEUE_OCC_INTERVAL_MS)
+		return;
+	g_pcap_option.prev_occ_tsc = cur_tsc;
+
+	add_queue_occupancy(&g_pcap_option.cap_ring_occ,
+			rte_ring_count(g_pcap_option.cap_ring));
+}
+
 /* write compressed data into file  */
 static int output_pcap_file(FILE *compress_fp, void *srcbuf, size_t write_len)
 {
@@ -711,7 +735,10 @@ static int compress_file_packet(struct pcap_mng_info *info,
 	return SPPWK_RET_OK;
 }
 
-/* Receive packets from shared ring buffer */
+/**
+ * Receive packets from shared ring buffer, and return the num of received
+ * packets or SPPWK_RET_NG.
+ */
 static int pcap_proc_receive(int lcore_id)
 {
 	struct timespec cur_time;  /* Used as timestamp for the file name */
@@ -769,12 +796,7 @@ static int pcap_proc_receive(int lcore_id)
 
 	/* Receive packets */
 	rx = &g_pcap_option.port_cap;
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
-	nb_rx = sppwk_eth_ring_stats_rx_burst(rx->ethdev_port_id,
-			rx->iface_type, rx->iface_no, 0, bufs, MAX_PCAP_BURST);
-#else
 	nb_rx = rte_eth_rx_burst(rx->ethdev_port_id, 0, bufs, MAX_PCAP_BURST);
-#endif
 	if (unlikely(nb_rx == 0))
 		return SPPWK_RET_OK;
 
@@ -792,10 +814,13 @@ static int pcap_proc_receive(int lcore_id)
 	total_rx += nb_rx;
 	total_drop += nb_rx - nb_tx;
 
-	return SPPWK_RET_OK;
+	return nb_rx;
 }
 
-/* Output packets to file on writer thread */
+/**
+ * Output packets to file on writer thread, and return the num of packets
+ * read from shared ring buffer or SPPWK_RET_NG.
+ */
 static int pcap_proc_write(int lcore_id)
 {
 	int ret = SPPWK_RET_OK;
@@ -865,7 +890,9 @@ static int pcap_proc_write(int lcore_id)
 		rte_pktmbuf_free(bufs[buf]);
 
 	g_total_write[lcore_id] += nb_rx;
-	return ret;
+	if (unlikely(ret != SPPWK_RET_OK))
+		return ret;
+	return nb_rx;
 }
 
 /* Main process of slave core */
@@ -873,6 +900,8 @@ static int
 slave_main(void *arg __attribute__ ((unused)))
 {
 	int ret = SPPWK_RET_OK;
+	int nof_rx;
+	uint64_t start_tsc;
 	unsigned int lcore_id = rte_lcore_id();
 	struct pcap_mng_info *pcap_info = &g_pcap_info[lcore_id];
 
@@ -895,16 +924,20 @@ slave_main(void *arg __attribute__ ((unused)))
 				g_capture_request = SPP_CAPTURE_IDLE;
 		}
 
+		start_tsc = rte_rdtsc();
 		if (pcap_info->type == PCAP_RECEIVE)
-			ret = pcap_proc_receive(lcore_id);
+			nof_rx = pcap_proc_receive(lcore_id);
 		else
-			ret = pcap_proc_write(lcore_id);
-		if (unlikely(ret != SPPWK_RET_OK)) {
+			nof_rx = pcap_proc_write(lcore_id);
+		if (unlikely(nof_rx < 0)) {
 			RTE_LOG(ERR, SPP_PCAP,
 					"Failed to capture on lcore %d.\n",
 					lcore_id);
+			ret = SPPWK_RET_NG;
 			break;
 		}
+		update_lcore_stats(lcore_id, rte_rdtsc() - start_tsc,
+				nof_rx);
 	}
 
 	set_core_status(lcore_id, SPPWK_LCORE_STOPPED);
@@ -1045,6 +1078,9 @@ main(int argc, char *argv[])
 		RTE_LOG(DEBUG, SPP_PCAP, "Ring port name=%s, flags=0x%x\n",
 				g_pcap_option.cap_ring->name,
 				g_pcap_option.cap_ring->flags);
+		g_pcap_option.cap_ring_occ.size = rte_ring_get_capacity(
+				g_pcap_option.cap_ring);
+		g_pcap_option.prev_occ_tsc = rte_rdtsc();
 
 		/* Start worker threads of recive or write */
 		g_pcap_thread_info.thread_cnt = 0;
@@ -1076,6 +1112,9 @@ main(int argc, char *argv[])
 			if (unlikely(ret_do != SPPWK_RET_OK))
 				break;
 
+			/* Sample num of packets waiting to be written. */
+			sample_cap_ring();
+
 			/*
 			 * Wait to avoid CPU overloaded.
 			 */
@@ -21,4 +21,14 @@ int spp_pcap_get_core_status(
 		unsigned int lcore_id,
 		struct sppwk_lcore_params *params);
 
+/**
+ * Get occupancy of ring between receiver and writers in JSON without
+ * brackets as queue_occupancy_json().
+ *
+ * @param[out] str Buffer for the string.
+ * @param[in] size Size of the buffer.
+ * @return Length of the string as snprintf().
+ */
+int spp_pcap_get_cap_ring_occupancy(char *str, size_t size);
+
 #endif /* __SPP_PCAP_H__ */
@@ -274,10 +274,22 @@ init_port(uint16_t port_num, struct rte_mempool *pktmbuf_pool)
 	RTE_LOG(INFO, PRIMARY, "Port %u init ...\n", port_num);
 	fflush(stdout);
 
+	/*
+	 * DEV_TX_OFFLOAD_MBUF_FAST_FREE is not enabled because secondaries
+	 * such as spp_mirror send mbufs shared by incrementing refcnt.
+	 */
 	rte_eth_dev_info_get(port_num, &dev_info);
-	if (dev_info.tx_offload_capa & DEV_TX_OFFLOAD_MBUF_FAST_FREE)
+	/* Enabled for offloading VLAN tagging of secondaries such as spp_vf. */
+	if (dev_info.tx_offload_capa & DEV_TX_OFFLOAD_VLAN_INSERT)
+		local_port_conf.txmode.offloads |=
+			DEV_TX_OFFLOAD_VLAN_INSERT;
+	if (dev_info.tx_offload_capa & DEV_TX_OFFLOAD_QINQ_INSERT)
+		local_port_conf.txmode.offloads |=
+			DEV_TX_OFFLOAD_QINQ_INSERT;
+	/* Enabled for checksum of outer header of VXLAN encapsulation. */
+	if (dev_info.tx_offload_capa & DEV_TX_OFFLOAD_IPV4_CKSUM)
 		local_port_conf.txmode.offloads |=
-			DEV_TX_OFFLOAD_MBUF_FAST_FREE;
+			DEV_TX_OFFLOAD_IPV4_CKSUM;
 	txq_conf = dev_info.default_txconf;
 	txq_conf.offloads = local_port_conf.txmode.offloads;
 
@@ -286,7 +298,7 @@ init_port(uint16_t port_num, struct rte_mempool *pktmbuf_pool)
 	 * rx and tx rings
 	 */
 	retval = rte_eth_dev_configure(port_num, rx_rings, tx_rings,
-		&port_conf);
+		&local_port_conf);
 	if (retval != 0)
 		return retval;
 
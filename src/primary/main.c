@@ -11,6 +11,7 @@
 
 #include <rte_atomic.h>
 #include <rte_eth_ring.h>
+#include <rte_cycles.h>
 
 #include "shared/common.h"
 #include "args.h"
@@ -22,12 +23,17 @@
 #include "shared/secondary/utils.h"
 
 /*
- * Buffer sizes of status message of primary. Total number of size
- * must be equal to MSG_SIZE 2048 defined in `shared/common.h`.
+ * Buffer sizes of status message of primary. Total number of size of
+ * lcores, phy and ring ports must be equal to MSG_SIZE 2048 defined in
+ * `shared/common.h`. Stats of lcores and forwarder are added to it and
+ * the message is grown to PRI_MSG_SIZE, not to reduce ring ports.
  */
 #define PRI_BUF_SIZE_LCORE 128
 #define PRI_BUF_SIZE_PHY 512
 #define PRI_BUF_SIZE_RING (MSG_SIZE - PRI_BUF_SIZE_LCORE - PRI_BUF_SIZE_PHY)
+#define PRI_BUF_SIZE_LCORE_STATS (LCORE_STATS_JSON_LEN * RTE_MAX_LCORE)
+#define PRI_BUF_SIZE_FWD 512
+#define PRI_MSG_SIZE (MSG_SIZE + PRI_BUF_SIZE_LCORE_STATS + PRI_BUF_SIZE_FWD)
 
 #define SPP_PATH_LEN 1024  /* seems enough for path of spp procs */
 #define NOF_TOKENS 48  /* seems enough to contain tokens */
@@ -170,6 +176,8 @@ static void
 forward_loop(void)
 {
 	unsigned int lcore_id = rte_lcore_id();
+	uint64_t start_tsc;
+	int nof_pkts;
 
 	RTE_LOG(INFO, PRIMARY, "entering main loop on lcore %u\n", lcore_id);
 
@@ -178,7 +186,10 @@ forward_loop(void)
 			sleep(1);
 			continue;
 		} else if (cmd == FORWARD) {
-			forward();
+			start_tsc = rte_rdtsc();
+			nof_pkts = forward();
+			update_lcore_stats(lcore_id, rte_rdtsc() - start_tsc,
+					nof_pkts);
 		}
 	}
 }
@@ -206,8 +217,11 @@ static int
 do_send(int *connected, int *sock, char *str)
 {
 	int ret;
+	size_t len;
 
-	ret = send(*sock, str, MSG_SIZE, 0);
+	/* Send MSG_SIZE at least as before, or whole of grown message. */
+	len = RTE_MAX(strlen(str) + 1, (size_t)MSG_SIZE);
+	ret = send(*sock, str, len, 0);
 	if (ret == -1) {
 		RTE_LOG(ERR, PRIMARY, "Failed to send\n");
 		*connected = 0;
@@ -737,6 +751,16 @@ ring_port_stats_json(char *str)
  * {
  *     "master-lcore": 0,
  *     "lcores": [0,1],
+ *     "lcore_stats": [
+ *     {
+ *         "lcore_id": 1,
+ *         "busy_cycles": 3000,
+ *         "idle_cycles": 9000,
+ *         "pkts": 64,
+ *         "cycles_per_pkt": 46,
+ *         "usage": 25
+ *     }
+ *     ],
  *     "forwarder": {
  *         "status": "idling",
  *         "ports": ["phy:0", "phy:1"],
@@ -768,30 +792,34 @@ static int
 get_status_json(char *str)
 {
 	char buf_lcores[PRI_BUF_SIZE_LCORE];
+	char buf_lcore_stats[PRI_BUF_SIZE_LCORE_STATS];
 	char buf_phy_ports[PRI_BUF_SIZE_PHY];
 	char buf_ring_ports[PRI_BUF_SIZE_RING];
 	memset(buf_phy_ports, '\0', PRI_BUF_SIZE_PHY);
 	memset(buf_ring_ports, '\0', PRI_BUF_SIZE_RING);
 	memset(buf_lcores, '\0', PRI_BUF_SIZE_LCORE);
+	memset(buf_lcore_stats, '\0', PRI_BUF_SIZE_LCORE_STATS);
 
 	append_lcore_info_json(buf_lcores, lcore_id_used);
+	append_lcore_stats_json(buf_lcore_stats, PRI_BUF_SIZE_LCORE_STATS);
 	phy_port_stats_json(buf_phy_ports);
 	ring_port_stats_json(buf_ring_ports);
 
 	RTE_LOG(INFO, PRIMARY, "%s, %s\n", buf_phy_ports, buf_ring_ports);
 
 	if (get_forwarding_flg() == 1) {
-		char tmp_buf[512];
+		char tmp_buf[PRI_BUF_SIZE_FWD];
 		memset(tmp_buf, '\0', sizeof(tmp_buf));
 		forwarder_status_json(tmp_buf);
 
-		sprintf(str, "{%s,%s,%s,%s}",
-				buf_lcores, tmp_buf, buf_phy_ports,
-				buf_ring_ports);
+		sprintf(str, "{%s,%s,%s,%s,%s}",
+				buf_lcores, buf_lcore_stats, tmp_buf,
+				buf_phy_ports, buf_ring_ports);
 
 	} else {
-		sprintf(str, "{%s,%s,%s}",
-				buf_lcores, buf_phy_ports, buf_ring_ports);
+		sprintf(str, "{%s,%s,%s,%s}",
+				buf_lcores, buf_lcore_stats, buf_phy_ports,
+				buf_ring_ports);
 	}
 
 	return 0;
@@ -969,7 +997,7 @@ parse_command(char *str)
 		RTE_LOG(DEBUG, PRIMARY, "'status' command received.\n");
 
 		/* Clear str and token_list nouse already */
-		memset(str, '\0', MSG_SIZE);
+		memset(str, '\0', PRI_MSG_SIZE);
 		ret = get_status_json(str);
 
 		/* Output all of ports under management for debugging. */
@@ -1238,7 +1266,7 @@ main(int argc, char *argv[])
 	char dev_name[RTE_DEV_NAME_MAX_LEN] = { 0 };
 	unsigned int nb_ports;
 	int connected = 0;
-	char str[MSG_SIZE];
+	char str[PRI_MSG_SIZE];
 	int flg_exit;  // used as res of parse_command() to exit if -1
 	int ret;
 	int port_type;
@@ -6,9 +6,10 @@
 #include "shared/common.h"
 #include "shared/basic_forwarder.h"
 
-void
+int
 forward(void)
 {
+	int nof_pkts = 0;  /* Total num of received packets. */
 	uint16_t nb_rx;
 	uint16_t nb_tx;
 	int in_port;
@@ -38,6 +39,7 @@ forward(void)
 			continue;
 
 		port_map[in_port].stats->rx += nb_rx;
+		nof_pkts += nb_rx;
 
 		/* Send burst of TX packets, to second port of pair. */
 		nb_tx = ports_fwd_array[out_port].tx_func(out_port, 0, bufs,
@@ -52,4 +54,5 @@ forward(void)
 				rte_pktmbuf_free(bufs[buf]);
 		}
 	}
+	return nof_pkts;
 }
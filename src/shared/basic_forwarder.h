@@ -10,6 +10,7 @@
 struct port_map port_map[RTE_MAX_ETHPORTS];
 struct port ports_fwd_array[RTE_MAX_ETHPORTS];
 
-void forward(void);
+/* Forward packets of all patches, and return the num of received packets. */
+int forward(void);
 
 #endif
@@ -3,11 +3,15 @@
  * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
  */
 
+#include <inttypes.h>
 #include <rte_cycles.h>
+#include <rte_lcore.h>
 #include "common.h"
 
 #define RTE_LOGTYPE_SHARED RTE_LOGTYPE_USER1
 
+struct lcore_stats lcore_stats_info[RTE_MAX_LCORE];
+
 /**
  * Set log level of type RTE_LOGTYPE_USER* to given level, for instance,
  * RTE_LOG_INFO or RTE_LOG_DEBUG.
@@ -147,3 +151,63 @@ int parse_dev_name(char *dev_name, int *port_type, int *port_id)
 
 	return 0;
 }
+
+/* Make stats of given lcore in JSON without brackets. */
+int
+lcore_stats_json(char *str, size_t size, unsigned int lcore_id)
+{
+	struct lcore_stats *stats = &lcore_stats_info[lcore_id];
+	uint64_t busy = stats->busy_cycles;
+	uint64_t idle = stats->idle_cycles;
+	uint64_t pkts = stats->pkts;
+
+	return snprintf(str, size,
+			"\"lcore_id\":%u,\"busy_cycles\":%"PRIu64","
+			"\"idle_cycles\":%"PRIu64",\"pkts\":%"PRIu64","
+			"\"cycles_per_pkt\":%"PRIu64",\"usage\":%"PRIu64,
+			lcore_id, busy, idle, pkts,
+			(pkts == 0) ? 0 : busy / pkts,
+			(busy + idle == 0) ? 0 : busy * 100 / (busy + idle));
+}
+
+/* Make occupancy of a queue in JSON without brackets. */
+int
+queue_occupancy_json(char *str, size_t size,
+		const struct queue_occupancy *occ)
+{
+	return snprintf(str, size,
+			"\"size\":%u,\"avg\":%"PRIu64",\"hwm\":%u,"
+			"\"samples\":%"PRIu64",\"full\":%"PRIu64,
+			occ->size,
+			(occ->nof_samples == 0) ? 0 :
+				occ->sum / occ->nof_samples,
+			occ->hwm, occ->nof_samples, occ->nof_full);
+}
+
+/* Append stats of all of slave lcores to given `str`. */
+int
+append_lcore_stats_json(char *str, size_t size)
+{
+	unsigned int lcore_id;
+	int has_entry = 0;
+	size_t len = strlen(str);
+	char entry[LCORE_STATS_JSON_LEN];
+
+	len += snprintf(str + len, size - len, "\"lcore_stats\":[");
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		lcore_stats_json(entry, sizeof(entry), lcore_id);
+
+		/* Keep room for separator, brackets and null char. */
+		if (len + strlen(entry) + 5 > size) {
+			RTE_LOG(WARNING, SHARED,
+					"No room for stats of lcore %u.\n",
+					lcore_id);
+			break;
+		}
+		len += sprintf(str + len, "%s{%s}",
+				has_entry ? "," : "", entry);
+		has_entry = 1;
+	}
+	snprintf(str + len, size - len, "]");
+	return 0;
+}
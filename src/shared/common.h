@@ -133,6 +133,95 @@ int parse_server(char **server_ip, int *server_port, char *server_addr);
 
 extern uint8_t lcore_id_used[RTE_MAX_LCORE];
 
+/* Size of buffer for stats of an lcore in JSON. */
+#define LCORE_STATS_JSON_LEN 192
+
+/**
+ * Cycles and packets of polling on an lcore for measuring how loaded it is.
+ * Each entry is updated only by its own lcore.
+ */
+struct lcore_stats {
+	uint64_t busy_cycles;  /* Cycles of polls which received packets. */
+	uint64_t idle_cycles;  /* Cycles of polls which received nothing. */
+	uint64_t pkts;  /* Num of received packets. */
+} __rte_cache_aligned;
+
+extern struct lcore_stats lcore_stats_info[RTE_MAX_LCORE];
+
+/**
+ * Add cycles of a poll to stats of given lcore. It is called from the main
+ * loop of each of lcores with the num of packets received in the poll.
+ */
+static inline void
+update_lcore_stats(unsigned int lcore_id, uint64_t cycles, int nof_pkts)
+{
+	struct lcore_stats *stats = &lcore_stats_info[lcore_id];
+
+	if (nof_pkts > 0) {
+		stats->busy_cycles += cycles;
+		stats->pkts += nof_pkts;
+	} else
+		stats->idle_cycles += cycles;
+}
+
+/**
+ * Make stats of given lcore in JSON without brackets, such as
+ * `"lcore_id":1,"busy_cycles":100,"idle_cycles":300,"pkts":10,
+ * "cycles_per_pkt":10,"usage":25`. `usage` is the ratio of busy cycles
+ * in percent.
+ *
+ * @return Length of the string as snprintf().
+ */
+int lcore_stats_json(char *str, size_t size, unsigned int lcore_id);
+
+/**
+ * Append stats of all of slave lcores to given `str` of `size` bytes, such as
+ * `"lcore_stats":[{"lcore_id":1,...},{"lcore_id":2,...}]`. Entries which
+ * cannot be included in the size are omitted.
+ */
+int append_lcore_stats_json(char *str, size_t size);
+
+/* Interval of sampling num of packets in queues from master thread. */
+#define QUEUE_OCC_INTERVAL_MS 10
+
+/* Size of buffer for occupancy of a queue in JSON. */
+#define QUEUE_OCC_JSON_LEN 160
+
+/**
+ * Occupancy of a queue counted from samples of num of packets in it. It is
+ * sampled from master thread, so that it costs nothing on worker lcores.
+ */
+struct queue_occupancy {
+	unsigned int size;  /* Capacity of the queue, or 0 if unknown. */
+	unsigned int hwm;  /* High-water mark of num of packets. */
+	uint64_t nof_samples;  /* Num of samples. */
+	uint64_t sum;  /* Sum of num of packets of samples. */
+	uint64_t nof_full;  /* Num of samples the queue is full. */
+};
+
+/* Add a sample of num of packets in a queue to its occupancy. */
+static inline void
+add_queue_occupancy(struct queue_occupancy *occ, unsigned int count)
+{
+	occ->nof_samples++;
+	occ->sum += count;
+	if (occ->size > 0 && count >= occ->size)
+		occ->nof_full++;
+	if (count > occ->hwm)
+		occ->hwm = count;
+}
+
+/**
+ * Make occupancy of a queue in JSON without brackets, such as
+ * `"size":127,"avg":3,"hwm":120,"samples":1000,"full":2`. `avg` is the
+ * average num of packets rounded down, and `full` is the num of samples
+ * the queue is full. `size` is 0 if it is unknown.
+ *
+ * @return Length of the string as snprintf().
+ */
+int queue_occupancy_json(char *str, size_t size,
+		const struct queue_occupancy *occ);
+
 /**
  * Get port type and port ID from ethdev name, such as `eth_vhost1` which
  * can be retrieved with rte_eth_dev_get_name_by_port().
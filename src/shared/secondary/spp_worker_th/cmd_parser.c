@@ -2,12 +2,15 @@
  * Copyright(c) 2017-2019 Nippon Telegraph and Telephone Corporation
  */
 
+#include <errno.h>
 #include <unistd.h>
 #include <string.h>
+#include <arpa/inet.h>
 
 #include <rte_ether.h>
 #include <rte_log.h>
 #include <rte_branch_prediction.h>
+#include <rte_byteorder.h>
 
 #include "cmd_parser.h"
 #include "shared/secondary/return_codes.h"
@@ -33,6 +36,23 @@ const char *CMD_ACT_LIST[] = {
 	"stop",
 	"add",
 	"del",
+	"move",
+	"weight",
+	"sample",
+	"sample_rate",
+	"snaplen",
+	"copy",
+	"",  /* termination */
+};
+
+/**
+ * List of copy mode of mirror. The order of items should be same as the order
+ * of enum `sppwk_mir_copy_mode` in data_types.h.
+ */
+const char *MIR_COPY_MODE_LIST[] = {
+	"shallow",
+	"deep",
+	"hybrid",
 	"",  /* termination */
 };
 
@@ -51,11 +71,32 @@ sppwk_action_str(enum sppwk_action wk_action)
 		return "add";
 	case SPPWK_ACT_DEL:
 		return "del";
+	case SPPWK_ACT_MOVE:
+		return "move";
+	case SPPWK_ACT_WEIGHT:
+		return "weight";
+	case SPPWK_ACT_SAMPLE:
+		return "sample";
+	case SPPWK_ACT_SAMPLE_RATE:
+		return "sample_rate";
+	case SPPWK_ACT_SNAPLEN:
+		return "snaplen";
+	case SPPWK_ACT_COPY:
+		return "copy";
 	default:
 		return "unknown";
 	}
 }
 
+/* Get string of copy mode of mirror. */
+const char*
+sppwk_mir_copy_mode_str(enum sppwk_mir_copy_mode copy_mode)
+{
+	if (unlikely(copy_mode > SPPWK_MIR_COPY_HYBRID))
+		return "unknown";
+	return MIR_COPY_MODE_LIST[copy_mode];
+}
+
 /* Get string of cmd type. It is mainly used for logging. */
 /* TODO(yasufum) spp_vf specific vars must be localized to vf. */
 const char*
@@ -64,6 +105,7 @@ sppwk_cmd_type_str(enum sppwk_cmd_type ctype)
 	switch (ctype) {
 	case SPPWK_CMDTYPE_CLS_MAC:
 	case SPPWK_CMDTYPE_CLS_VLAN:
+	case SPPWK_CMDTYPE_CLS_QINQ:
 		return "classifier";
 	case SPPWK_CMDTYPE_CLIENT_ID:
 		return "_get_client_id";
@@ -75,6 +117,12 @@ sppwk_cmd_type_str(enum sppwk_cmd_type ctype)
 		return "component";
 	case SPPWK_CMDTYPE_PORT:
 		return "port";
+	case SPPWK_CMDTYPE_LATENCY_STATS:
+		return "latency_stats";
+	case SPPWK_CMDTYPE_LATENCY:
+		return "latency";
+	case SPPWK_CMDTYPE_FILTER:
+		return "filter";
 	default:
 		return "unknown";
 	}
@@ -89,6 +137,8 @@ const char *CLS_TYPE_LIST[] = {
 	"none",
 	"mac",
 	"vlan",
+	"qinq",
+	"vni",
 	"",  /* termination */
 };
 
@@ -113,20 +163,72 @@ const char *PORT_ABILITY_LIST[] = {
 	"none",
 	"add_vlantag",
 	"del_vlantag",
+	"add_qinqtag",
+	"del_qinqtag",
+	"set_src_mac",
+	"set_dst_mac",
+	"set_pcp",
+	"set_dscp",
+	"dec_ttl",
+	"meter",
+	"shaper",
+	"add_vxlan",
+	"del_vxlan",
+	"",  /* termination */
+};
+
+/**
+ * List of types of meter. The order of items should be same as the order of
+ * enum `sppwk_meter_type` in data_types.h.
+ */
+const char *METER_TYPE_LIST[] = {
+	"srtcm",
+	"trtcm",
+	"",  /* termination */
+};
+
+/**
+ * List of actions for red packets of meter. The order of items should be same
+ * as the order of enum `sppwk_meter_red_act` in data_types.h.
+ */
+const char *METER_RED_ACT_LIST[] = {
+	"drop",
+	"mark",
+	"",  /* termination */
+};
+
+/* List of modes of latency_stats command, index is used as enabled or not. */
+const char *LATENCY_STATS_MODE_LIST[] = {
+	"off",
+	"on",
 	"",  /* termination */
 };
 
-/* Return 1 as true if port is used with given mac_addr and vid. */
+/* Optional keyword at the end of port command for recalculating FCS. */
+#define PORT_FCS_STR "fcs"
+
+/* Num of args of port command, `port add RES DIR NAME add_vlantag VID PCP`. */
+#define PORT_ADD_VLANTAG_ARGC 8
+
+/* Index of arg of VLAN operation in port command. */
+#define PORT_VLAN_OPS_IDX 5
+
+/* Min value of TPID, as same as the smallest ether type. */
+#define PORT_TPID_MIN 0x0600
+
+/* Return 1 as true if port is used with given mac_addr, VIDs and VNI. */
 static int
 is_used_with_addr(
-		int vid, uint64_t mac_addr,
+		int svid, int vid, int vni, uint64_t mac_addr,
 		enum port_type iface_type, int iface_no)
 {
 	struct sppwk_port_info *wk_port = get_sppwk_port(
 			iface_type, iface_no);
 
 	return ((mac_addr == wk_port->cls_attrs.mac_addr) &&
-		(vid == wk_port->cls_attrs.vlantag.vid));
+		(svid == wk_port->cls_attrs.svid) &&
+		(vid == wk_port->cls_attrs.vlantag.vid) &&
+		(vni == wk_port->cls_attrs.vni));
 }
 
 /* Return 1 as true if given port is already used. */
@@ -270,6 +372,24 @@ get_int_in_range(int *output, const char *arg_val, int min, int max)
 	return SPPWK_RET_OK;
 }
 
+/* Get uint64 from given val. It is intended to get rate or size of meter. */
+static int
+get_uint64(uint64_t *output, const char *arg_val)
+{
+	unsigned long long ret;
+	char *endptr = NULL;
+
+	if (unlikely(*arg_val == '-'))
+		return SPPWK_RET_NG;
+	errno = 0;
+	ret = strtoull(arg_val, &endptr, 0);
+	if (unlikely(endptr == arg_val) || unlikely(*endptr != '\0') ||
+			unlikely(errno != 0))
+		return SPPWK_RET_NG;
+	*output = ret;
+	return SPPWK_RET_OK;
+}
+
 /**
  * Get uint from given val. It validates if the val is in the range from min to
  * max given as third and fourth args. It is intended to get lcore ID.
@@ -341,7 +461,10 @@ parse_comp_action(void *output, const char *arg_val,
 	}
 
 	if (unlikely(ret != SPPWK_ACT_START) &&
-			unlikely(ret != SPPWK_ACT_STOP)) {
+			unlikely(ret != SPPWK_ACT_STOP) &&
+			unlikely(ret != SPPWK_ACT_MOVE) &&
+			unlikely(ret != SPPWK_ACT_WEIGHT) &&
+			unlikely(!SPPWK_IS_MIR_OPT_ACT(ret))) {
 		RTE_LOG(ERR, WK_CMD_PARSER,
 				"Unknown component action. val=%s\n",
 				arg_val);
@@ -360,7 +483,7 @@ parse_comp_name(void *output, const char *arg_val,
 	int ret;
 	struct sppwk_cmd_comp *component = output;
 
-	/* Parsing the name is required only for action `start`. */
+	/* Checking the name is required for all actions except `stop`. */
 	if (component->wk_action == SPPWK_ACT_START) {
 		/* Check if lcore is already used. */
 		ret = sppwk_get_lcore_id(arg_val);  /* Get lcore ID. */
@@ -370,6 +493,17 @@ parse_comp_name(void *output, const char *arg_val,
 					arg_val);
 			return SPPWK_RET_NG;
 		}
+	} else if ((component->wk_action == SPPWK_ACT_MOVE) ||
+			(component->wk_action == SPPWK_ACT_WEIGHT) ||
+			SPPWK_IS_MIR_OPT_ACT(component->wk_action)) {
+		/* Only existing component can be moved or configured. */
+		ret = sppwk_get_lcore_id(arg_val);
+		if (unlikely(ret < 0)) {
+			RTE_LOG(ERR, WK_CMD_PARSER,
+					"Unknown comp name '%s'.\n",
+					arg_val);
+			return SPPWK_RET_NG;
+		}
 	}
 
 	if (strlen(arg_val) >= SPPWK_VAL_BUFSZ)
@@ -384,10 +518,54 @@ static int
 parse_comp_lcore_id(void *output, const char *arg_val,
 				int allow_override __attribute__ ((unused)))
 {
+	int ret;
 	struct sppwk_cmd_comp *component = output;
 
-	/* Parsing lcore is required only for action `start`. */
-	if (component->wk_action != SPPWK_ACT_START)
+	/* Third param is the weight for action `weight`. */
+	if (component->wk_action == SPPWK_ACT_WEIGHT) {
+		ret = get_int_in_range(&component->weight, arg_val, 1,
+				SPPWK_WEIGHT_MAX);
+		if (unlikely(ret < SPPWK_RET_OK)) {
+			RTE_LOG(ERR, WK_CMD_PARSER,
+					"Invalid weight '%s'.\n", arg_val);
+			return SPPWK_RET_NG;
+		}
+		return SPPWK_RET_OK;
+	}
+
+	/* Third param is the value of option for options of mirror. */
+	if (SPPWK_IS_MIR_OPT_ACT(component->wk_action)) {
+		switch (component->wk_action) {
+		case SPPWK_ACT_SAMPLE:
+			ret = get_uint_in_range(&component->mir_opt, arg_val,
+					1, INT32_MAX);
+			break;
+		case SPPWK_ACT_SAMPLE_RATE:
+			ret = get_uint_in_range(&component->mir_opt, arg_val,
+					0, SPPWK_MIR_SAMPLE_RATE_MAX);
+			break;
+		case SPPWK_ACT_COPY:
+			ret = get_list_idx(arg_val, MIR_COPY_MODE_LIST);
+			if (ret >= 0)
+				component->mir_opt = ret;
+			break;
+		default:  /* SPPWK_ACT_SNAPLEN */
+			ret = get_uint_in_range(&component->mir_opt, arg_val,
+					0, SPPWK_MIR_SNAPLEN_MAX);
+			break;
+		}
+		if (unlikely(ret < SPPWK_RET_OK)) {
+			RTE_LOG(ERR, WK_CMD_PARSER,
+					"Invalid value '%s' for %s.\n", arg_val,
+					sppwk_action_str(component->wk_action));
+			return SPPWK_RET_NG;
+		}
+		return SPPWK_RET_OK;
+	}
+
+	/* Parsing lcore is required only for action `start` and `move`. */
+	if ((component->wk_action != SPPWK_ACT_START) &&
+			(component->wk_action != SPPWK_ACT_MOVE))
 		return SPPWK_RET_OK;
 
 	return parse_lcore_id(&component->core, arg_val);
@@ -557,6 +735,10 @@ parse_port_vlan_ops(void *output, const char *arg_val,
 		}
 		port_attrs->ops = ret;
 		port_attrs->dir = port->dir;
+		if (ret == SPPWK_PORT_OPS_ADD_QINQ ||
+				ret == SPPWK_PORT_OPS_DEL_QINQ)
+			port_attrs->capability.vlantag.tpid =
+					SPP_QINQ_TPID_DEFAULT;
 		break;
 	case SPPWK_PORT_OPS_ADD_VLAN:
 		/* Nothing to do. */
@@ -569,7 +751,60 @@ parse_port_vlan_ops(void *output, const char *arg_val,
 	return SPPWK_RET_OK;
 }
 
-/* Parse VLAN ID  for port command. */
+/* Get TPID of outer tag of QinQ for port command. */
+static int
+get_port_tpid(struct sppwk_port_attrs *port_attrs, const char *arg_val)
+{
+	int ret;
+
+	ret = get_int_in_range(&port_attrs->capability.vlantag.tpid,
+			arg_val, PORT_TPID_MIN, UINT16_MAX);
+	if (unlikely(ret < SPPWK_RET_OK)) {
+		RTE_LOG(ERR, WK_CMD_PARSER,
+				"Invalid `%s` for parsing TPID.\n", arg_val);
+		return SPPWK_RET_NG;
+	}
+	return SPPWK_RET_OK;
+}
+
+/* Get MAC address for rewriting header with port command. */
+static int
+get_port_rewrite_mac(struct sppwk_port_attrs *port_attrs, const char *arg_val)
+{
+	int64_t mac_addr;
+
+	mac_addr = sppwk_convert_mac_str_to_int64(arg_val);
+	if (unlikely(mac_addr < SPPWK_RET_OK)) {
+		RTE_LOG(ERR, WK_CMD_PARSER,
+				"Invalid MAC address `%s`.\n", arg_val);
+		return SPPWK_RET_NG;
+	}
+	port_attrs->capability.rewrite.mac_addr = (uint64_t)mac_addr;
+	return SPPWK_RET_OK;
+}
+
+/* Get PCP or DSCP for remarking with port command. */
+static int
+get_port_rewrite_value(struct sppwk_port_attrs *port_attrs,
+		const char *arg_val, int max)
+{
+	int ret;
+
+	ret = get_int_in_range(&port_attrs->capability.rewrite.value,
+			arg_val, 0, max);
+	if (unlikely(ret < SPPWK_RET_OK)) {
+		RTE_LOG(ERR, WK_CMD_PARSER,
+				"Invalid `%s` for remarking.\n", arg_val);
+		return SPPWK_RET_NG;
+	}
+	return SPPWK_RET_OK;
+}
+
+/**
+ * Parse VLAN ID for port command. TPID is given instead of VLAN ID for
+ * deleting outer tag of QinQ, such as `del_qinqtag 0x9100`, and the value of
+ * rewriting header for other ops, such as `set_dst_mac MAC_ADDR`.
+ */
 static int
 parse_port_vid(void *output, const char *arg_val,
 		int allow_override __attribute__ ((unused)))
@@ -579,7 +814,19 @@ parse_port_vid(void *output, const char *arg_val,
 	struct sppwk_port_attrs *port_attrs = &port->port_attrs;
 
 	switch (port_attrs->ops) {
+	case SPPWK_PORT_OPS_DEL_QINQ:
+		return get_port_tpid(port_attrs, arg_val);
+	case SPPWK_PORT_OPS_SET_SRC_MAC:
+	case SPPWK_PORT_OPS_SET_DST_MAC:
+		return get_port_rewrite_mac(port_attrs, arg_val);
+	case SPPWK_PORT_OPS_SET_PCP:
+		return get_port_rewrite_value(port_attrs, arg_val,
+				SPP_VLAN_PCP_MAX);
+	case SPPWK_PORT_OPS_SET_DSCP:
+		return get_port_rewrite_value(port_attrs, arg_val,
+				SPP_DSCP_MAX);
 	case SPPWK_PORT_OPS_ADD_VLAN:
+	case SPPWK_PORT_OPS_ADD_QINQ:
 		vlan_id = get_int_in_range(&port_attrs->capability.vlantag.vid,
 			arg_val, 0, ETH_VLAN_ID_MAX);
 		if (unlikely(vlan_id < SPPWK_RET_OK)) {
@@ -609,6 +856,7 @@ parse_port_pcp(void *output, const char *arg_val,
 
 	switch (port_attrs->ops) {
 	case SPPWK_PORT_OPS_ADD_VLAN:
+	case SPPWK_PORT_OPS_ADD_QINQ:
 		pcp = get_int_in_range(&port_attrs->capability.vlantag.pcp,
 				arg_val, 0, SPP_VLAN_PCP_MAX);
 		if (unlikely(pcp < SPPWK_RET_OK)) {
@@ -626,6 +874,40 @@ parse_port_pcp(void *output, const char *arg_val,
 	return SPPWK_RET_OK;
 }
 
+/* Parse TPID of outer tag for adding QinQ tag with port command. */
+static int
+parse_port_tpid(void *output, const char *arg_val,
+		int allow_override __attribute__ ((unused)))
+{
+	struct sppwk_cmd_port *port = output;
+	struct sppwk_port_attrs *port_attrs = &port->port_attrs;
+
+	if (unlikely(port_attrs->ops != SPPWK_PORT_OPS_ADD_QINQ)) {
+		RTE_LOG(ERR, WK_CMD_PARSER,
+				"TPID `%s` is only for QinQ.\n", arg_val);
+		return SPPWK_RET_NG;
+	}
+	return get_port_tpid(port_attrs, arg_val);
+}
+
+/* Parse mode of latency_stats command, `on` or `off`. */
+static int
+parse_latency_stats_mode(void *output, const char *arg_val,
+		int allow_override __attribute__ ((unused)))
+{
+	int ret;
+	ret = get_list_idx(arg_val, LATENCY_STATS_MODE_LIST);
+	if (unlikely(ret < SPPWK_RET_OK)) {
+		RTE_LOG(ERR, WK_CMD_PARSER,
+				"Unknown latency_stats mode. val=%s\n",
+				arg_val);
+		return SPPWK_RET_NG;
+	}
+
+	*(int *)output = ret;
+	return SPPWK_RET_OK;
+}
+
 /* Parse mac address string. */
 static int
 parse_mac_addr(void *output, const char *arg_val,
@@ -712,6 +994,26 @@ parse_cls_vid(void *output, const char *arg_val,
 	return SPPWK_RET_OK;
 }
 
+/* Parse VLAN ID, or VNI for `vni` type, for classifier_table command. */
+static int
+parse_cls_vid_vni(void *cls_cmd_attr, const char *arg_val,
+		int allow_override)
+{
+	struct sppwk_cls_cmd_attrs *cls_attrs = cls_cmd_attr;
+
+	if (cls_attrs->cls_type != SPPWK_CLS_TYPE_VNI)
+		return parse_cls_vid(&cls_attrs->vid, arg_val,
+				allow_override);
+
+	cls_attrs->vid = ETH_VLAN_ID_MAX;
+	if (unlikely(get_int_in_range(&cls_attrs->vni, arg_val, 0,
+			SPP_VXLAN_VNI_MAX) < SPPWK_RET_OK)) {
+		RTE_LOG(ERR, WK_CMD_PARSER, "Invalid VNI `%s`.\n", arg_val);
+		return SPPWK_RET_NG;
+	}
+	return SPPWK_RET_OK;
+}
+
 /* Parse port for classifier_table command */
 static int
 parse_cls_port(void *cls_cmd_attr, const char *arg_val,
@@ -734,9 +1036,14 @@ parse_cls_port(void *cls_cmd_attr, const char *arg_val,
 
 	if (cls_attrs->cls_type == SPPWK_CLS_TYPE_MAC)
 		cls_attrs->vid = ETH_VLAN_ID_MAX;
+	if (cls_attrs->cls_type != SPPWK_CLS_TYPE_QINQ)
+		cls_attrs->svid = ETH_VLAN_ID_MAX;
+	if (cls_attrs->cls_type != SPPWK_CLS_TYPE_VNI)
+		cls_attrs->vni = SPP_VXLAN_VNI_NONE;
 
 	if (unlikely(cls_attrs->wk_action == SPPWK_ACT_ADD)) {
-		if (!is_used_with_addr(ETH_VLAN_ID_MAX, 0,
+		if (!is_used_with_addr(ETH_VLAN_ID_MAX, ETH_VLAN_ID_MAX,
+				SPP_VXLAN_VNI_NONE, 0,
 				tmp_port.iface_type, tmp_port.iface_no)) {
 			RTE_LOG(ERR, WK_CMD_PARSER, "Port in used. "
 					"(classifier_table command) val=%s\n",
@@ -748,8 +1055,8 @@ parse_cls_port(void *cls_cmd_attr, const char *arg_val,
 		if (mac_addr < 0)
 			return SPPWK_RET_NG;
 
-		if (!is_used_with_addr(cls_attrs->vid,
-				(uint64_t)mac_addr,
+		if (!is_used_with_addr(cls_attrs->svid, cls_attrs->vid,
+				cls_attrs->vni, (uint64_t)mac_addr,
 				tmp_port.iface_type, tmp_port.iface_no)) {
 			RTE_LOG(ERR, WK_CMD_PARSER, "Port in used. "
 					"(classifier_table command) val=%s\n",
@@ -806,7 +1113,7 @@ cmd_ops_list[][SPPWK_MAX_PARAMS] = {
 		},
 		SPPWK_CMD_NO_PARAMS,
 	},
-	{  /* classifier_table(VLAN) */
+	{  /* classifier_table(VLAN or VNI) */
 		{
 			.name = "action",
 			.offset = offsetof(struct sppwk_cmd_attrs,
@@ -819,6 +1126,45 @@ cmd_ops_list[][SPPWK_MAX_PARAMS] = {
 					spec.cls_table.cls_type),
 			.func = parse_cls_type
 		},
+		{
+			.name = "vlan id",
+			.offset = offsetof(struct sppwk_cmd_attrs,
+					spec.cls_table),
+			.func = parse_cls_vid_vni
+		},
+		{
+			.name = "mac address",
+			.offset = offsetof(struct sppwk_cmd_attrs,
+					spec.cls_table.mac),
+			.func = parse_mac_addr
+		},
+		{
+			.name = "port",
+			.offset = offsetof(struct sppwk_cmd_attrs,
+					spec.cls_table),
+			.func = parse_cls_port
+		},
+		SPPWK_CMD_NO_PARAMS,
+	},
+	{  /* classifier_table(QinQ) */
+		{
+			.name = "action",
+			.offset = offsetof(struct sppwk_cmd_attrs,
+					spec.cls_table.wk_action),
+			.func = parse_cls_action
+		},
+		{
+			.name = "type",
+			.offset = offsetof(struct sppwk_cmd_attrs,
+					spec.cls_table.cls_type),
+			.func = parse_cls_type
+		},
+		{
+			.name = "outer vlan id",
+			.offset = offsetof(struct sppwk_cmd_attrs,
+					spec.cls_table.svid),
+			.func = parse_cls_vid
+		},
 		{
 			.name = "vlan id",
 			.offset = offsetof(struct sppwk_cmd_attrs,
@@ -904,8 +1250,24 @@ cmd_ops_list[][SPPWK_MAX_PARAMS] = {
 			.offset = offsetof(struct sppwk_cmd_attrs, spec.port),
 			.func = parse_port_pcp
 		},
+		{
+			.name = "port tpid",
+			.offset = offsetof(struct sppwk_cmd_attrs, spec.port),
+			.func = parse_port_tpid
+		},
+		SPPWK_CMD_NO_PARAMS,
+	},
+	{  /* latency_stats */
+		{
+			.name = "mode",
+			.offset = offsetof(struct sppwk_cmd_attrs,
+					spec.latency_stats.enable),
+			.func = parse_latency_stats_mode
+		},
 		SPPWK_CMD_NO_PARAMS,
 	},
+	{ SPPWK_CMD_NO_PARAMS },  /* latency */
+	{ SPPWK_CMD_NO_PARAMS },  /* filter */
 	{ SPPWK_CMD_NO_PARAMS }, /* termination */
 };
 
@@ -945,7 +1307,7 @@ parse_cmd_cls_table(struct sppwk_cmd_req *request, int argc, char *argv[],
 	return parse_cmd_comp(request, argc, argv, wk_err_msg, maxargc);
 }
 
-/* Validate given command for clssfier_table of vlan. */
+/* Validate given command for clssfier_table of vlan or qinq. */
 /* TODO(yasufum) spp_vf specific function must be localized to vf. */
 static int
 parse_cmd_cls_table_vlan(struct sppwk_cmd_req *request, int argc, char *argv[],
@@ -956,6 +1318,7 @@ parse_cmd_cls_table_vlan(struct sppwk_cmd_req *request, int argc, char *argv[],
 	int ci = request->commands[0].type;
 	int pi = 0;
 	struct sppwk_cmd_ops *list = NULL;
+	enum sppwk_cls_type cls_type;
 	for (pi = 1; pi < argc; pi++) {
 		list = &cmd_ops_list[ci][pi-1];
 		ret = (*list->func)((void *)
@@ -969,24 +1332,268 @@ parse_cmd_cls_table_vlan(struct sppwk_cmd_req *request, int argc, char *argv[],
 					list->name, argv[pi]);
 		}
 	}
+
+	/* Num of params is decided by type, two VLAN IDs for `qinq`. */
+	cls_type = request->commands[0].spec.cls_table.cls_type;
+	if (unlikely((ci == SPPWK_CMDTYPE_CLS_QINQ) !=
+			(cls_type == SPPWK_CLS_TYPE_QINQ))) {
+		RTE_LOG(ERR, WK_CMD_PARSER, "Wrong num of params for "
+				"classifier type `%s`.\n", argv[2]);
+		return set_detailed_parse_error(wk_err_msg, "type", argv[2]);
+	}
+	return SPPWK_RET_OK;
+}
+
+/**
+ * Parse params of meter for port command, which are given as
+ * `srtcm CIR CBS EBS [drop | mark PCP]` or
+ * `trtcm CIR PIR CBS PBS [drop | mark PCP]`.
+ */
+static int
+parse_port_meter(struct sppwk_port_attrs *port_attrs, int argc, char *argv[])
+{
+	int ret, cnt;
+	int nof_rates, nof_params;
+	struct sppwk_meter *meter = &port_attrs->capability.meter;
+	uint64_t *vals[4];
+
+	ret = (argc > 0) ? get_list_idx(argv[0], METER_TYPE_LIST) :
+			SPPWK_RET_NG;
+	if (unlikely(ret < SPPWK_RET_OK)) {
+		RTE_LOG(ERR, WK_CMD_PARSER, "Unknown type of meter.\n");
+		return SPPWK_RET_NG;
+	}
+	meter->type = ret;
+
+	if (meter->type == SPPWK_METER_SRTCM) {
+		vals[0] = &meter->cir;
+		vals[1] = &meter->cbs;
+		vals[2] = &meter->ebs;
+		nof_rates = 3;
+	} else {
+		vals[0] = &meter->cir;
+		vals[1] = &meter->pir;
+		vals[2] = &meter->cbs;
+		vals[3] = &meter->pbs;
+		nof_rates = 4;
+	}
+
+	/* Action for red packets is optional, and default is drop. */
+	nof_params = argc - 1 - nof_rates;
+	if (unlikely(nof_params != 0 && nof_params != 1 && nof_params != 2)) {
+		RTE_LOG(ERR, WK_CMD_PARSER, "Wrong num of params of meter.\n");
+		return SPPWK_RET_NG;
+	}
+
+	for (cnt = 0; cnt < nof_rates; cnt++) {
+		if (unlikely(get_uint64(vals[cnt], argv[1 + cnt]) !=
+				SPPWK_RET_OK)) {
+			RTE_LOG(ERR, WK_CMD_PARSER,
+					"Invalid `%s` for meter.\n",
+					argv[1 + cnt]);
+			return SPPWK_RET_NG;
+		}
+	}
+
+	/* Same as the conditions of profile of rte_meter. */
+	if (unlikely(meter->cir == 0 ||
+			(meter->type == SPPWK_METER_SRTCM &&
+			 meter->cbs == 0 && meter->ebs == 0) ||
+			(meter->type == SPPWK_METER_TRTCM &&
+			 (meter->pir < meter->cir || meter->cbs == 0 ||
+			  meter->pbs == 0)))) {
+		RTE_LOG(ERR, WK_CMD_PARSER, "Invalid rate or size of meter.\n");
+		return SPPWK_RET_NG;
+	}
+
+	meter->red_act = SPPWK_METER_RED_DROP;
+	if (nof_params == 0)
+		return SPPWK_RET_OK;
+
+	ret = get_list_idx(argv[1 + nof_rates], METER_RED_ACT_LIST);
+	if (unlikely(ret < SPPWK_RET_OK) ||
+			((ret == SPPWK_METER_RED_MARK) != (nof_params == 2))) {
+		RTE_LOG(ERR, WK_CMD_PARSER,
+				"Invalid action `%s` for red packets.\n",
+				argv[1 + nof_rates]);
+		return SPPWK_RET_NG;
+	}
+	meter->red_act = ret;
+	if (meter->red_act == SPPWK_METER_RED_MARK &&
+			get_int_in_range(&meter->pcp, argv[2 + nof_rates],
+				0, SPP_VLAN_PCP_MAX) < SPPWK_RET_OK) {
+		RTE_LOG(ERR, WK_CMD_PARSER, "Invalid `%s` for parsing PCP.\n",
+				argv[2 + nof_rates]);
+		return SPPWK_RET_NG;
+	}
+	return SPPWK_RET_OK;
+}
+
+/**
+ * Parse params of shaper for port command, which are given as
+ * `RATE [QSIZE]`. Shaper is only for TX port.
+ */
+static int
+parse_port_shaper(struct sppwk_port_attrs *port_attrs, int argc, char *argv[])
+{
+	uint64_t rate;
+	struct sppwk_shaper *shaper = &port_attrs->capability.shaper;
+
+	if (unlikely(port_attrs->dir != SPPWK_PORT_DIR_TX)) {
+		RTE_LOG(ERR, WK_CMD_PARSER, "Shaper is only for TX port.\n");
+		return SPPWK_RET_NG;
+	}
+	if (unlikely(argc != 1 && argc != 2)) {
+		RTE_LOG(ERR, WK_CMD_PARSER,
+				"Wrong num of params of shaper.\n");
+		return SPPWK_RET_NG;
+	}
+
+	if (unlikely(get_uint64(&rate, argv[0]) != SPPWK_RET_OK ||
+			rate == 0 || rate > UINT32_MAX)) {
+		RTE_LOG(ERR, WK_CMD_PARSER,
+				"Invalid `%s` for rate of shaper.\n", argv[0]);
+		return SPPWK_RET_NG;
+	}
+	shaper->rate = rate;
+
+	/* Size of queue should be power of 2 for rte_sched. */
+	shaper->qsize = SPP_SHAPER_QSIZE_DEFAULT;
+	if (argc == 2 && (get_int_in_range(&shaper->qsize, argv[1], 1,
+			SPP_SHAPER_QSIZE_MAX) < SPPWK_RET_OK ||
+			!rte_is_power_of_2(shaper->qsize))) {
+		RTE_LOG(ERR, WK_CMD_PARSER,
+				"Invalid `%s` for size of queue.\n", argv[1]);
+		return SPPWK_RET_NG;
+	}
+	return SPPWK_RET_OK;
+}
+
+/* Get IPv4 address in network byte order for VXLAN of port command. */
+static int
+get_ipv4_addr(uint32_t *output, const char *arg_val)
+{
+	struct in_addr addr;
+
+	if (unlikely(inet_pton(AF_INET, arg_val, &addr) != 1)) {
+		RTE_LOG(ERR, WK_CMD_PARSER,
+				"Invalid IPv4 address `%s`.\n", arg_val);
+		return SPPWK_RET_NG;
+	}
+	*output = addr.s_addr;
+	return SPPWK_RET_OK;
+}
+
+/* Get MAC address of outer header for VXLAN of port command. */
+static int
+get_vxlan_mac_addr(uint64_t *output, const char *arg_val)
+{
+	int64_t mac_addr = sppwk_convert_mac_str_to_int64(arg_val);
+
+	if (unlikely(mac_addr < SPPWK_RET_OK)) {
+		RTE_LOG(ERR, WK_CMD_PARSER,
+				"Invalid MAC address `%s`.\n", arg_val);
+		return SPPWK_RET_NG;
+	}
+	*output = mac_addr;
+	return SPPWK_RET_OK;
+}
+
+/**
+ * Parse params of VXLAN for port command, which are given as
+ * `VNI SRC_MAC DST_MAC SRC_IP DST_IP [UDP_PORT]` for `add_vxlan`, or
+ * `[UDP_PORT]` for `del_vxlan`.
+ */
+static int
+parse_port_vxlan(struct sppwk_port_attrs *port_attrs, int argc, char *argv[])
+{
+	int vni;
+	int nof_params = 0;
+	struct sppwk_vxlan *vxlan = &port_attrs->capability.vxlan;
+
+	if (port_attrs->ops == SPPWK_PORT_OPS_ADD_VXLAN)
+		nof_params = 5;
+	if (unlikely(argc != nof_params && argc != nof_params + 1)) {
+		RTE_LOG(ERR, WK_CMD_PARSER,
+				"Wrong num of params of VXLAN.\n");
+		return SPPWK_RET_NG;
+	}
+
+	if (port_attrs->ops == SPPWK_PORT_OPS_ADD_VXLAN) {
+		if (unlikely(get_int_in_range(&vni, argv[0], 0,
+				SPP_VXLAN_VNI_MAX) < SPPWK_RET_OK)) {
+			RTE_LOG(ERR, WK_CMD_PARSER,
+					"Invalid VNI `%s`.\n", argv[0]);
+			return SPPWK_RET_NG;
+		}
+		vxlan->vni = vni;
+		if (unlikely(get_vxlan_mac_addr(&vxlan->src_mac, argv[1]) !=
+				SPPWK_RET_OK ||
+				get_vxlan_mac_addr(&vxlan->dst_mac, argv[2]) !=
+				SPPWK_RET_OK ||
+				get_ipv4_addr(&vxlan->src_ip, argv[3]) !=
+				SPPWK_RET_OK ||
+				get_ipv4_addr(&vxlan->dst_ip, argv[4]) !=
+				SPPWK_RET_OK))
+			return SPPWK_RET_NG;
+	}
+
+	/* UDP port is optional, and default is the one of IANA. */
+	vxlan->udp_port = SPP_VXLAN_UDP_PORT_DEFAULT;
+	if (argc == nof_params + 1 && get_int_in_range(&vxlan->udp_port,
+			argv[nof_params], 1, UINT16_MAX) < SPPWK_RET_OK) {
+		RTE_LOG(ERR, WK_CMD_PARSER, "Invalid `%s` for UDP port.\n",
+				argv[nof_params]);
+		return SPPWK_RET_NG;
+	}
 	return SPPWK_RET_OK;
 }
 
+/* Return num of params of given op required for port command. */
+static int
+get_nof_port_ops_params(enum sppwk_port_ops ops)
+{
+	switch (ops) {
+	case SPPWK_PORT_OPS_SET_SRC_MAC:
+	case SPPWK_PORT_OPS_SET_DST_MAC:
+	case SPPWK_PORT_OPS_SET_PCP:
+	case SPPWK_PORT_OPS_SET_DSCP:
+		return 1;
+	case SPPWK_PORT_OPS_DEC_TTL:
+		return 0;
+	default:
+		/* Checked for each of params of VLAN ops. */
+		return -1;
+	}
+}
+
 /* Validate given command for port. */
 static int
 parse_cmd_port(struct sppwk_cmd_req *request, int argc, char *argv[],
-		struct sppwk_parse_err_msg *wk_err_msg, int maxargc)
+		struct sppwk_parse_err_msg *wk_err_msg,
+		int maxargc __attribute__ ((unused)))
 {
 	int ret = SPPWK_RET_OK;
 	int ci = request->commands[0].type;
 	int pi = 0;
 	struct sppwk_cmd_ops *list = NULL;
 	int flag = 0;
+	int fcs = 0;
+	int nof_params;
+	struct sppwk_port_attrs *port_attrs = NULL;
+
+	/* `fcs` is accepted only if it follows VLAN operation. */
+	if ((argc > PORT_VLAN_OPS_IDX + 1) &&
+			(strcmp(argv[argc - 1], PORT_FCS_STR) == 0)) {
+		fcs = 1;
+		argc--;
+	}
 
-	/* check add vlatag */
-	if (argc == maxargc)
+	/* check add vlatag or qinqtag */
+	if (argc >= PORT_ADD_VLANTAG_ARGC)
 		flag = 1;
 
+	port_attrs = &request->commands[0].spec.port.port_attrs;
 	for (pi = 1; pi < argc; pi++) {
 		list = &cmd_ops_list[ci][pi-1];
 		ret = (*list->func)((void *)
@@ -999,6 +1606,214 @@ parse_cmd_port(struct sppwk_cmd_req *request, int argc, char *argv[],
 			return set_detailed_parse_error(wk_err_msg,
 					list->name, argv[pi]);
 		}
+
+		/* Params of meter, shaper and VXLAN are not positional. */
+		if (pi == PORT_VLAN_OPS_IDX &&
+				port_attrs->ops == SPPWK_PORT_OPS_METER) {
+			if (unlikely(fcs || parse_port_meter(port_attrs,
+					argc - pi - 1, &argv[pi + 1]) !=
+					SPPWK_RET_OK))
+				return set_detailed_parse_error(wk_err_msg,
+						"port meter", argv[pi]);
+			return SPPWK_RET_OK;
+		}
+		if (pi == PORT_VLAN_OPS_IDX &&
+				port_attrs->ops == SPPWK_PORT_OPS_SHAPER) {
+			if (unlikely(fcs || parse_port_shaper(port_attrs,
+					argc - pi - 1, &argv[pi + 1]) !=
+					SPPWK_RET_OK))
+				return set_detailed_parse_error(wk_err_msg,
+						"port shaper", argv[pi]);
+			return SPPWK_RET_OK;
+		}
+		if (pi == PORT_VLAN_OPS_IDX &&
+				(port_attrs->ops == SPPWK_PORT_OPS_ADD_VXLAN ||
+				 port_attrs->ops == SPPWK_PORT_OPS_DEL_VXLAN)) {
+			if (unlikely(fcs || parse_port_vxlan(port_attrs,
+					argc - pi - 1, &argv[pi + 1]) !=
+					SPPWK_RET_OK))
+				return set_detailed_parse_error(wk_err_msg,
+						"port vxlan", argv[pi]);
+			return SPPWK_RET_OK;
+		}
+	}
+
+	/* Params of ops other than VLAN are fixed, and `fcs` is not given. */
+	nof_params = get_nof_port_ops_params(port_attrs->ops);
+	if (unlikely(nof_params >= 0 &&
+			(argc != PORT_VLAN_OPS_IDX + 1 + nof_params || fcs))) {
+		RTE_LOG(ERR, WK_CMD_PARSER, "Wrong num of params for `%s`.\n",
+				argv[PORT_VLAN_OPS_IDX]);
+		return set_detailed_parse_error(wk_err_msg,
+				"port vlan operation",
+				argv[PORT_VLAN_OPS_IDX]);
+	}
+
+	if (fcs)
+		port_attrs->capability.vlantag.fcs = 1;
+	return SPPWK_RET_OK;
+}
+
+/**
+ * List of fields of filter of mirror. The order of items should be same as
+ * the order of bits of SPPWK_MIR_FILTER_* defined in data_types.h.
+ */
+const char *FILTER_FIELD_LIST[] = {
+	"vlan",
+	"proto",
+	"src",
+	"dst",
+	"sport",
+	"dport",
+	"",  /* termination */
+};
+
+/* Get protocol of IPv4 given as a name or a number for filter command. */
+static int
+get_filter_proto(uint8_t *output, const char *arg_val)
+{
+	int proto;
+
+	if (strcmp(arg_val, "tcp") == 0)
+		proto = IPPROTO_TCP;
+	else if (strcmp(arg_val, "udp") == 0)
+		proto = IPPROTO_UDP;
+	else if (strcmp(arg_val, "sctp") == 0)
+		proto = IPPROTO_SCTP;
+	else if (strcmp(arg_val, "icmp") == 0)
+		proto = IPPROTO_ICMP;
+	else if (get_int_in_range(&proto, arg_val, 0, UINT8_MAX) <
+			SPPWK_RET_OK)
+		return SPPWK_RET_NG;
+
+	*output = proto;
+	return SPPWK_RET_OK;
+}
+
+/**
+ * Get IPv4 address and mask in network byte order given as `ADDR[/LEN]` for
+ * filter command. Address is masked, and mask is for /32 if LEN is omitted.
+ */
+static int
+get_ipv4_prefix(uint32_t *addr, uint32_t *mask, const char *arg_val)
+{
+	int prefix_len = 32;
+	char str[SPPWK_VAL_BUFSZ];
+	char *len_str = NULL;
+
+	if (unlikely(strlen(arg_val) >= SPPWK_VAL_BUFSZ))
+		return SPPWK_RET_NG;
+	strcpy(str, arg_val);
+
+	len_str = strchr(str, '/');
+	if (len_str != NULL) {
+		*len_str++ = '\0';
+		if (unlikely(get_int_in_range(&prefix_len, len_str, 0, 32) <
+				SPPWK_RET_OK))
+			return SPPWK_RET_NG;
+	}
+	if (unlikely(get_ipv4_addr(addr, str) != SPPWK_RET_OK))
+		return SPPWK_RET_NG;
+
+	*mask = (prefix_len == 0) ? 0 :
+			rte_cpu_to_be_32(UINT32_MAX << (32 - prefix_len));
+	*addr &= *mask;
+	return SPPWK_RET_OK;
+}
+
+/* Parse a pair of field and value of filter command. */
+static int
+parse_filter_field(struct sppwk_mir_filter *filter, const char *field,
+		const char *arg_val)
+{
+	int ret, idx, val;
+	uint32_t bit;
+
+	idx = get_list_idx(field, FILTER_FIELD_LIST);
+	if (unlikely(idx < SPPWK_RET_OK)) {
+		RTE_LOG(ERR, WK_CMD_PARSER,
+				"Unknown field `%s` of filter.\n", field);
+		return SPPWK_RET_NG;
+	}
+	bit = 1 << idx;
+	if (unlikely(filter->fields & bit)) {
+		RTE_LOG(ERR, WK_CMD_PARSER,
+				"Field `%s` of filter is duplicated.\n", field);
+		return SPPWK_RET_NG;
+	}
+	filter->fields |= bit;
+
+	switch (bit) {
+	case SPPWK_MIR_FILTER_VLAN:
+		ret = get_int_in_range(&val, arg_val, 0, ETH_VLAN_ID_MAX);
+		filter->vid = val;
+		break;
+	case SPPWK_MIR_FILTER_PROTO:
+		ret = get_filter_proto(&filter->proto, arg_val);
+		break;
+	case SPPWK_MIR_FILTER_SRC_IP:
+		ret = get_ipv4_prefix(&filter->src_ip, &filter->src_mask,
+				arg_val);
+		break;
+	case SPPWK_MIR_FILTER_DST_IP:
+		ret = get_ipv4_prefix(&filter->dst_ip, &filter->dst_mask,
+				arg_val);
+		break;
+	case SPPWK_MIR_FILTER_SRC_PORT:
+		ret = get_int_in_range(&val, arg_val, 0, UINT16_MAX);
+		filter->src_port = rte_cpu_to_be_16(val);
+		break;
+	default:  /* SPPWK_MIR_FILTER_DST_PORT */
+		ret = get_int_in_range(&val, arg_val, 0, UINT16_MAX);
+		filter->dst_port = rte_cpu_to_be_16(val);
+		break;
+	}
+
+	if (unlikely(ret < SPPWK_RET_OK)) {
+		RTE_LOG(ERR, WK_CMD_PARSER,
+				"Invalid `%s` for field `%s` of filter.\n",
+				arg_val, field);
+		return SPPWK_RET_NG;
+	}
+	return SPPWK_RET_OK;
+}
+
+/**
+ * Validate given command for filter of mirror, which is given as
+ * `NAME none` for mirroring all packets, or `NAME FIELD VAL [FIELD VAL ...]`.
+ */
+static int
+parse_cmd_filter(struct sppwk_cmd_req *request, int argc, char *argv[],
+		struct sppwk_parse_err_msg *wk_err_msg,
+		int maxargc __attribute__ ((unused)))
+{
+	int pi;
+	struct sppwk_cmd_filter *cmd = &request->commands[0].spec.filter;
+
+	if (unlikely(sppwk_get_lcore_id(argv[1]) < 0) ||
+			unlikely(strlen(argv[1]) >= SPPWK_NAME_BUFSZ)) {
+		RTE_LOG(ERR, WK_CMD_PARSER, "Unknown comp name '%s'.\n",
+				argv[1]);
+		return set_detailed_parse_error(wk_err_msg, "component name",
+				argv[1]);
+	}
+	strcpy(cmd->name, argv[1]);
+
+	memset(&cmd->filter, 0x00, sizeof(cmd->filter));
+	if (argc == 3 && strcmp(argv[2], "none") == 0)
+		return SPPWK_RET_OK;
+
+	if (unlikely(argc % 2 != 0)) {
+		RTE_LOG(ERR, WK_CMD_PARSER,
+				"Wrong num of params of filter.\n");
+		return set_detailed_parse_error(wk_err_msg, "filter",
+				argv[argc - 1]);
+	}
+	for (pi = 2; pi < argc; pi += 2) {
+		if (unlikely(parse_filter_field(&cmd->filter, argv[pi],
+				argv[pi + 1]) != SPPWK_RET_OK))
+			return set_detailed_parse_error(wk_err_msg,
+					"filter", argv[pi + 1]);
 	}
 	return SPPWK_RET_OK;
 }
@@ -1024,11 +1839,15 @@ struct cmd_parse_attrs {
 static struct cmd_parse_attrs cmd_attr_list[] = {
 	{ "classifier_table", 5, 5, parse_cmd_cls_table },
 	{ "classifier_table", 6, 6, parse_cmd_cls_table_vlan },
+	{ "classifier_table", 7, 7, parse_cmd_cls_table_vlan },
 	{ "_get_client_id", 1, 1, NULL },
 	{ "status", 1, 1, NULL },
 	{ "exit", 1, 1, NULL },
 	{ "component", 3, 5, parse_cmd_comp },
-	{ "port", 5, 8, parse_cmd_port },
+	{ "port", 5, 13, parse_cmd_port },
+	{ "latency_stats", 2, 2, parse_cmd_comp },
+	{ "latency", 1, 1, NULL },
+	{ "filter", 3, SPPWK_MAX_PARAMS, parse_cmd_filter },
 	{ "", 0, 0, NULL }  /* termination */
 };
 
@@ -1140,6 +1959,9 @@ sppwk_parse_req(
 		case SPPWK_CMDTYPE_STATUS:
 			request->is_requested_status = 1;
 			break;
+		case SPPWK_CMDTYPE_LATENCY:
+			request->is_requested_latency = 1;
+			break;
 		case SPPWK_CMDTYPE_EXIT:
 			request->is_requested_exit = 1;
 			break;
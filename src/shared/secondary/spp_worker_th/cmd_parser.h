@@ -16,7 +16,7 @@
 #define SPPWK_MAX_CMDS 32
 
 /* Maximum number of parameters per command. */
-#define SPPWK_MAX_PARAMS 8
+#define SPPWK_MAX_PARAMS 14
 
 /* Size of string buffer of message including null char. */
 #define SPPWK_NAME_BUFSZ  32
@@ -39,7 +39,8 @@ enum sppwk_parse_error_code {
 /**
  * Define actions of SPP worker threads. Each of targeting objects and actions
  * is defined as following.
- *   - compomnent      : start, stop
+ *   - compomnent      : start, stop, move, weight, sample, sample_rate,
+ *                       snaplen, copy
  *   - port            : add, del
  *   - classifier_table: add, del
  */
@@ -49,10 +50,23 @@ enum sppwk_action {
 	SPPWK_ACT_STOP,  /**< stop */
 	SPPWK_ACT_ADD,   /**< add */
 	SPPWK_ACT_DEL,   /**< delete */
+	SPPWK_ACT_MOVE,  /**< move */
+	SPPWK_ACT_WEIGHT,  /**< weight */
+	SPPWK_ACT_SAMPLE,  /**< sample, only for mirror */
+	SPPWK_ACT_SAMPLE_RATE,  /**< sample_rate, only for mirror */
+	SPPWK_ACT_SNAPLEN,  /**< snaplen, only for mirror */
+	SPPWK_ACT_COPY,  /**< copy, only for mirror */
 };
 
+/** Check if given action is for setting an option of mirror component. */
+#define SPPWK_IS_MIR_OPT_ACT(act) \
+	((act) == SPPWK_ACT_SAMPLE || (act) == SPPWK_ACT_SAMPLE_RATE || \
+	 (act) == SPPWK_ACT_SNAPLEN || (act) == SPPWK_ACT_COPY)
+
 const char *sppwk_action_str(enum sppwk_action wk_action);
 
+const char *sppwk_mir_copy_mode_str(enum sppwk_mir_copy_mode copy_mode);
+
 /**
  * SPP command type.
  *
@@ -68,11 +82,15 @@ const char *sppwk_action_str(enum sppwk_action wk_action);
 enum sppwk_cmd_type {
 	SPPWK_CMDTYPE_CLS_MAC,
 	SPPWK_CMDTYPE_CLS_VLAN,
+	SPPWK_CMDTYPE_CLS_QINQ,
 	SPPWK_CMDTYPE_CLIENT_ID,  /**< get_client_id */
 	SPPWK_CMDTYPE_STATUS,  /**< status */
 	SPPWK_CMDTYPE_EXIT,  /**< exit */
 	SPPWK_CMDTYPE_WORKER,  /**< worker thread */
 	SPPWK_CMDTYPE_PORT,  /**< port */
+	SPPWK_CMDTYPE_LATENCY_STATS,  /**< latency_stats */
+	SPPWK_CMDTYPE_LATENCY,  /**< latency */
+	SPPWK_CMDTYPE_FILTER,  /**< filter */
 };
 
 const char *sppwk_cmd_type_str(enum sppwk_cmd_type ctype);
@@ -80,7 +98,9 @@ const char *sppwk_cmd_type_str(enum sppwk_cmd_type ctype);
 /* `classifier_table` command specific parameters. */
 struct sppwk_cls_cmd_attrs {
 	enum sppwk_action wk_action;  /**< add or del */
-	enum sppwk_cls_type cls_type;  /**< currently only for MAC. */
+	enum sppwk_cls_type cls_type;  /**< mac, vlan, qinq or vni. */
+	int svid;  /**< VLAN ID of outer tag for QinQ */
+	int vni;  /**< VNI of VXLAN */
 	int vid;  /**< VLAN ID  */
 	char mac[SPPWK_VAL_BUFSZ];  /**< MAC address  */
 	struct sppwk_port_idx port;/**< Destination port type and number */
@@ -93,9 +113,11 @@ struct sppwk_cmd_flush {
 
 /* `component` command parameters. */
 struct sppwk_cmd_comp {
-	enum sppwk_action wk_action;  /**< start or stop */
+	enum sppwk_action wk_action;  /**< start, stop, move, weight, etc. */
 	char name[SPPWK_NAME_BUFSZ];  /**< component name */
 	unsigned int core;  /**< logical core number */
+	int weight;  /**< max num of bursts in a round */
+	unsigned int mir_opt;  /**< value of option of mirror */
 	enum sppwk_worker_type wk_type;  /**< worker thread type */
 };
 
@@ -108,6 +130,17 @@ struct sppwk_cmd_port {
 	struct sppwk_port_attrs port_attrs;  /**< port attrs for spp_vf. */
 };
 
+/* `latency_stats` command parameters. */
+struct sppwk_cmd_latency_stats {
+	int enable;  /**< 1 for `on` or 0 for `off` */
+};
+
+/* `filter` command parameters. */
+struct sppwk_cmd_filter {
+	char name[SPPWK_NAME_BUFSZ];  /**< component name */
+	struct sppwk_mir_filter filter;  /**< fields of filter of mirror */
+};
+
 /* TODO(yasufum) Add usage and desc for members. What's command descriptors? */
 struct sppwk_cmd_attrs {
 	enum sppwk_cmd_type type; /**< command type */
@@ -117,6 +150,8 @@ struct sppwk_cmd_attrs {
 		struct sppwk_cmd_flush flush;
 		struct sppwk_cmd_comp comp;
 		struct sppwk_cmd_port port;
+		struct sppwk_cmd_latency_stats latency_stats;
+		struct sppwk_cmd_filter filter;
 	} spec;  /* TODO(yasufum) rename no reasonable name */
 };
 
@@ -128,6 +163,7 @@ struct sppwk_cmd_req {
 
 	int is_requested_client_id;
 	int is_requested_status;
+	int is_requested_latency;
 	int is_requested_exit;
 };
 
@@ -2,9 +2,11 @@
  * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
  */
 
+#include <arpa/inet.h>
 #include "cmd_res_formatter.h"
 #include "port_capability.h"
 #include "cmd_utils.h"
+#include "latency_stats.h"
 #include "shared/secondary/json_helper.h"
 
 #ifdef SPP_VF_MODULE
@@ -30,9 +32,26 @@ const char *PORT_ABILITY_STAT_LIST[] = {
 	"none",
 	"add",
 	"del",
+	"add_qinq",
+	"del_qinq",
+	"set_src_mac",
+	"set_dst_mac",
+	"set_pcp",
+	"set_dscp",
+	"dec_ttl",
+	"meter",
+	"shaper",
+	"add_vxlan",
+	"del_vxlan",
 	"",  /* termination */
 };
 
+/* Names of types of meter, the order is same as enum `sppwk_meter_type`. */
+static const char *METER_TYPE_STAT_LIST[] = { "srtcm", "trtcm" };
+
+/* Names of actions for red packets of meter. */
+static const char *METER_RED_ACT_STAT_LIST[] = { "drop", "mark" };
+
 /* command response result string list */
 struct cmd_res_formatter_ops response_result_list[] = {
 	{ "result", append_result_value },
@@ -160,11 +179,23 @@ append_vlan_block(const char *name, char **output,
 		switch (port_attrs[i].ops) {
 		case SPPWK_PORT_OPS_ADD_VLAN:
 		case SPPWK_PORT_OPS_DEL_VLAN:
+		case SPPWK_PORT_OPS_ADD_QINQ:
+		case SPPWK_PORT_OPS_DEL_QINQ:
 			ret = append_vlan_value(&tmp_buff, port_attrs[i].ops,
 					port_attrs[i].capability.vlantag.vid,
 					port_attrs[i].capability.vlantag.pcp);
 			if (unlikely(ret < SPPWK_RET_OK))
 				return SPPWK_RET_NG;
+			ret = append_json_int_value(&tmp_buff, "fcs",
+					port_attrs[i].capability.vlantag.fcs);
+			if (unlikely(ret < SPPWK_RET_OK))
+				return SPPWK_RET_NG;
+			if (port_attrs[i].ops >= SPPWK_PORT_OPS_ADD_QINQ) {
+				ret = append_json_int_value(&tmp_buff, "tpid",
+					port_attrs[i].capability.vlantag.tpid);
+				if (unlikely(ret < SPPWK_RET_OK))
+					return SPPWK_RET_NG;
+			}
 
 			/*
 			 * Change counter to "maximum+1" for exit the loop.
@@ -183,6 +214,9 @@ append_vlan_block(const char *name, char **output,
 				0, 0);
 		if (unlikely(ret < SPPWK_RET_OK))
 			return SPPWK_RET_NG;
+		ret = append_json_int_value(&tmp_buff, "fcs", 0);
+		if (unlikely(ret < SPPWK_RET_OK))
+			return SPPWK_RET_NG;
 	}
 
 	ret = append_json_block_brackets(output, name, tmp_buff);
@@ -190,6 +224,325 @@ append_vlan_block(const char *name, char **output,
 	return ret;
 }
 
+/* Append an action of rewriting header for JSON format. */
+static int
+append_action_value(char **output, const struct sppwk_port_attrs *attrs)
+{
+	int ret;
+	struct rte_ether_addr addr;
+	char mac_str[RTE_ETHER_ADDR_FMT_SIZE];
+	const struct sppwk_hdr_rewrite *rewrite = &attrs->capability.rewrite;
+
+	ret = append_json_str_value(output, "operation",
+			PORT_ABILITY_STAT_LIST[attrs->ops]);
+	if (unlikely(ret < SPPWK_RET_OK))
+		return SPPWK_RET_NG;
+
+	switch (attrs->ops) {
+	case SPPWK_PORT_OPS_SET_SRC_MAC:
+	case SPPWK_PORT_OPS_SET_DST_MAC:
+		memcpy(&addr, &rewrite->mac_addr, RTE_ETHER_ADDR_LEN);
+		rte_ether_format_addr(mac_str, sizeof(mac_str), &addr);
+		return append_json_str_value(output, "value", mac_str);
+	case SPPWK_PORT_OPS_SET_PCP:
+	case SPPWK_PORT_OPS_SET_DSCP:
+		return append_json_int_value(output, "value", rewrite->value);
+	default:
+		/* No value for dec_ttl. */
+		return SPPWK_RET_OK;
+	}
+}
+
+/**
+ * Append an array of actions of rewriting header for JSON format. VLAN ops
+ * are not included because they are in the block of vlan.
+ */
+static int
+append_actions_array(const char *name, char **output,
+		const int port_id, const enum sppwk_port_dir dir)
+{
+	int ret = SPPWK_RET_OK;
+	int i;
+	struct sppwk_port_attrs *port_attrs = NULL;
+	char *tmp_buff, *array_buff;
+
+	array_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(array_buff == NULL)) {
+		RTE_LOG(ERR, WK_CMD_RES_FMT,
+				"Failed to allocate buffer (name = %s).\n",
+				name);
+		return SPPWK_RET_NG;
+	}
+
+	sppwk_get_port_attrs(&port_attrs, port_id, dir);
+	for (i = 0; i < PORT_CAPABL_MAX; i++) {
+		if (port_attrs[i].ops == SPPWK_PORT_OPS_NONE)
+			break;
+		if (SPPWK_IS_VLAN_OPS(port_attrs[i].ops) ||
+				port_attrs[i].ops == SPPWK_PORT_OPS_METER ||
+				port_attrs[i].ops == SPPWK_PORT_OPS_SHAPER ||
+				port_attrs[i].ops == SPPWK_PORT_OPS_ADD_VXLAN ||
+				port_attrs[i].ops == SPPWK_PORT_OPS_DEL_VXLAN)
+			continue;
+
+		tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+		if (unlikely(tmp_buff == NULL)) {
+			ret = SPPWK_RET_NG;
+			break;
+		}
+		ret = append_action_value(&tmp_buff, &port_attrs[i]);
+		if (likely(ret == SPPWK_RET_OK))
+			ret = append_json_block_brackets(&array_buff, "",
+					tmp_buff);
+		spp_strbuf_free(tmp_buff);
+		if (unlikely(ret != SPPWK_RET_OK))
+			break;
+	}
+
+	if (likely(ret == SPPWK_RET_OK))
+		ret = append_json_array_brackets(output, name, array_buff);
+	spp_strbuf_free(array_buff);
+	return ret;
+}
+
+/* Append params and counters of meter of the port for JSON format. */
+static int
+append_meter_params(char **output, const struct sppwk_meter *meter,
+		const struct sppwk_meter_stats *stats)
+{
+	int ret;
+
+	ret = append_json_str_value(output, "type",
+			METER_TYPE_STAT_LIST[meter->type]);
+	if (likely(ret == SPPWK_RET_OK))
+		ret = append_json_uint64_value(output, "cir", meter->cir);
+	if (likely(ret == SPPWK_RET_OK) && meter->type == SPPWK_METER_TRTCM)
+		ret = append_json_uint64_value(output, "pir", meter->pir);
+	if (likely(ret == SPPWK_RET_OK))
+		ret = append_json_uint64_value(output, "cbs", meter->cbs);
+	if (likely(ret == SPPWK_RET_OK)) {
+		if (meter->type == SPPWK_METER_SRTCM)
+			ret = append_json_uint64_value(output, "ebs",
+					meter->ebs);
+		else
+			ret = append_json_uint64_value(output, "pbs",
+					meter->pbs);
+	}
+	if (likely(ret == SPPWK_RET_OK))
+		ret = append_json_str_value(output, "red_action",
+				METER_RED_ACT_STAT_LIST[meter->red_act]);
+	if (likely(ret == SPPWK_RET_OK) &&
+			meter->red_act == SPPWK_METER_RED_MARK)
+		ret = append_json_int_value(output, "pcp", meter->pcp);
+	if (likely(ret == SPPWK_RET_OK))
+		ret = append_json_uint64_value(output, "green", stats->green);
+	if (likely(ret == SPPWK_RET_OK))
+		ret = append_json_uint64_value(output, "yellow", stats->yellow);
+	if (likely(ret == SPPWK_RET_OK))
+		ret = append_json_uint64_value(output, "red", stats->red);
+	return ret;
+}
+
+/* Append a block of meter for JSON format if the port has meter. */
+static int
+append_meter_block(const char *name, char **output,
+		const int port_id, const enum sppwk_port_dir dir)
+{
+	int ret;
+	int i;
+	struct sppwk_port_attrs *port_attrs = NULL;
+	struct sppwk_meter_stats stats;
+	char *tmp_buff;
+
+	sppwk_get_port_attrs(&port_attrs, port_id, dir);
+	for (i = 0; i < PORT_CAPABL_MAX; i++) {
+		if (port_attrs[i].ops == SPPWK_PORT_OPS_METER)
+			break;
+	}
+	if (i == PORT_CAPABL_MAX)
+		return SPPWK_RET_OK;
+
+	tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, WK_CMD_RES_FMT,
+				"Failed to allocate buffer (name = %s).\n",
+				name);
+		return SPPWK_RET_NG;
+	}
+
+	sppwk_get_meter_stats(&stats, port_id, dir);
+	ret = append_meter_params(&tmp_buff,
+			&port_attrs[i].capability.meter, &stats);
+	if (likely(ret == SPPWK_RET_OK))
+		ret = append_json_block_brackets(output, name, tmp_buff);
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
+/* Append stats of traffic classes of shaper for JSON format. */
+static int
+append_shaper_tcs(const char *name, char **output,
+		const struct sppwk_shaper_stats *stats)
+{
+	int ret = SPPWK_RET_OK;
+	int pcp;
+	char *tmp_buff, *array_buff;
+
+	array_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(array_buff == NULL)) {
+		RTE_LOG(ERR, WK_CMD_RES_FMT,
+				"Failed to allocate buffer (name = %s).\n",
+				name);
+		return SPPWK_RET_NG;
+	}
+
+	for (pcp = 0; pcp < SPPWK_SHAPER_NOF_TCS; pcp++) {
+		tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+		if (unlikely(tmp_buff == NULL)) {
+			ret = SPPWK_RET_NG;
+			break;
+		}
+		ret = append_json_int_value(&tmp_buff, "pcp", pcp);
+		if (likely(ret == SPPWK_RET_OK))
+			ret = append_json_uint64_value(&tmp_buff, "pkts",
+					stats->nof_pkts[pcp]);
+		if (likely(ret == SPPWK_RET_OK))
+			ret = append_json_uint64_value(&tmp_buff, "dropped",
+					stats->nof_dropped[pcp]);
+		if (likely(ret == SPPWK_RET_OK))
+			ret = append_json_uint_value(&tmp_buff, "qlen",
+					stats->qlen[pcp]);
+		if (likely(ret == SPPWK_RET_OK))
+			ret = append_json_block_brackets(&array_buff, "",
+					tmp_buff);
+		spp_strbuf_free(tmp_buff);
+		if (unlikely(ret != SPPWK_RET_OK))
+			break;
+	}
+
+	if (likely(ret == SPPWK_RET_OK))
+		ret = append_json_array_brackets(output, name, array_buff);
+	spp_strbuf_free(array_buff);
+	return ret;
+}
+
+/* Append a block of shaper for JSON format if the TX port has shaper. */
+static int
+append_shaper_block(const char *name, char **output,
+		const int port_id, const enum sppwk_port_dir dir)
+{
+	int ret;
+	int i;
+	struct sppwk_port_attrs *port_attrs = NULL;
+	struct sppwk_shaper_stats stats;
+	char *tmp_buff;
+
+	if (dir != SPPWK_PORT_DIR_TX)
+		return SPPWK_RET_OK;
+
+	sppwk_get_port_attrs(&port_attrs, port_id, dir);
+	for (i = 0; i < PORT_CAPABL_MAX; i++) {
+		if (port_attrs[i].ops == SPPWK_PORT_OPS_SHAPER)
+			break;
+	}
+	if (i == PORT_CAPABL_MAX)
+		return SPPWK_RET_OK;
+
+	tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, WK_CMD_RES_FMT,
+				"Failed to allocate buffer (name = %s).\n",
+				name);
+		return SPPWK_RET_NG;
+	}
+
+	sppwk_get_shaper_stats(&stats, port_id);
+	ret = append_json_uint_value(&tmp_buff, "rate",
+			port_attrs[i].capability.shaper.rate);
+	if (likely(ret == SPPWK_RET_OK))
+		ret = append_json_int_value(&tmp_buff, "qsize",
+				port_attrs[i].capability.shaper.qsize);
+	if (likely(ret == SPPWK_RET_OK))
+		ret = append_shaper_tcs("tcs", &tmp_buff, &stats);
+	if (likely(ret == SPPWK_RET_OK))
+		ret = append_json_block_brackets(output, name, tmp_buff);
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
+/* Append params of VXLAN encapsulation for JSON format. */
+static int
+append_vxlan_params(char **output, const struct sppwk_vxlan *vxlan)
+{
+	int ret;
+	struct rte_ether_addr addr;
+	char mac_str[RTE_ETHER_ADDR_FMT_SIZE];
+	char ip_str[INET_ADDRSTRLEN];
+
+	ret = append_json_uint_value(output, "vni", vxlan->vni);
+	if (likely(ret == SPPWK_RET_OK)) {
+		memcpy(&addr, &vxlan->src_mac, RTE_ETHER_ADDR_LEN);
+		rte_ether_format_addr(mac_str, sizeof(mac_str), &addr);
+		ret = append_json_str_value(output, "src_mac", mac_str);
+	}
+	if (likely(ret == SPPWK_RET_OK)) {
+		memcpy(&addr, &vxlan->dst_mac, RTE_ETHER_ADDR_LEN);
+		rte_ether_format_addr(mac_str, sizeof(mac_str), &addr);
+		ret = append_json_str_value(output, "dst_mac", mac_str);
+	}
+	if (likely(ret == SPPWK_RET_OK)) {
+		inet_ntop(AF_INET, &vxlan->src_ip, ip_str, sizeof(ip_str));
+		ret = append_json_str_value(output, "src_ip", ip_str);
+	}
+	if (likely(ret == SPPWK_RET_OK)) {
+		inet_ntop(AF_INET, &vxlan->dst_ip, ip_str, sizeof(ip_str));
+		ret = append_json_str_value(output, "dst_ip", ip_str);
+	}
+	return ret;
+}
+
+/* Append a block of VXLAN for JSON format if the port has VXLAN op. */
+static int
+append_vxlan_block(const char *name, char **output,
+		const int port_id, const enum sppwk_port_dir dir)
+{
+	int ret;
+	int i;
+	struct sppwk_port_attrs *port_attrs = NULL;
+	char *tmp_buff;
+
+	sppwk_get_port_attrs(&port_attrs, port_id, dir);
+	for (i = 0; i < PORT_CAPABL_MAX; i++) {
+		if (port_attrs[i].ops == SPPWK_PORT_OPS_ADD_VXLAN ||
+				port_attrs[i].ops == SPPWK_PORT_OPS_DEL_VXLAN)
+			break;
+	}
+	if (i == PORT_CAPABL_MAX)
+		return SPPWK_RET_OK;
+
+	tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, WK_CMD_RES_FMT,
+				"Failed to allocate buffer (name = %s).\n",
+				name);
+		return SPPWK_RET_NG;
+	}
+
+	ret = append_json_str_value(&tmp_buff, "operation",
+			PORT_ABILITY_STAT_LIST[port_attrs[i].ops]);
+	if (likely(ret == SPPWK_RET_OK) &&
+			port_attrs[i].ops == SPPWK_PORT_OPS_ADD_VXLAN)
+		ret = append_vxlan_params(&tmp_buff,
+				&port_attrs[i].capability.vxlan);
+	if (likely(ret == SPPWK_RET_OK))
+		ret = append_json_int_value(&tmp_buff, "udp_port",
+				port_attrs[i].capability.vxlan.udp_port);
+	if (likely(ret == SPPWK_RET_OK))
+		ret = append_json_block_brackets(output, name, tmp_buff);
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
 /**
  * Get consistent port ID of rte ethdev from resource UID such as `phy:0`.
  * It returns a port ID, or error code if it's failed to.
@@ -239,6 +592,34 @@ append_port_block(char **output, const struct sppwk_port_idx *port,
 	if (unlikely(ret < SPPWK_RET_OK))
 		return SPPWK_RET_NG;
 
+	ret = append_actions_array("actions", &tmp_buff,
+			get_ethdev_port_id(
+				port->iface_type, port->iface_no),
+			dir);
+	if (unlikely(ret < SPPWK_RET_OK))
+		return SPPWK_RET_NG;
+
+	ret = append_meter_block("meter", &tmp_buff,
+			get_ethdev_port_id(
+				port->iface_type, port->iface_no),
+			dir);
+	if (unlikely(ret < SPPWK_RET_OK))
+		return SPPWK_RET_NG;
+
+	ret = append_shaper_block("shaper", &tmp_buff,
+			get_ethdev_port_id(
+				port->iface_type, port->iface_no),
+			dir);
+	if (unlikely(ret < SPPWK_RET_OK))
+		return SPPWK_RET_NG;
+
+	ret = append_vxlan_block("vxlan", &tmp_buff,
+			get_ethdev_port_id(
+				port->iface_type, port->iface_no),
+			dir);
+	if (unlikely(ret < SPPWK_RET_OK))
+		return SPPWK_RET_NG;
+
 	ret = append_json_block_brackets(output, "", tmp_buff);
 	spp_strbuf_free(tmp_buff);
 	return ret;
@@ -505,6 +886,51 @@ append_info_value(const char *name, char **output)
 	return ret;
 }
 
+/**
+ * Setup `latency` section in JSON msg for `latency` command. Histograms are
+ * given as pairs of upper bound in nano sec and num of samples of non-empty
+ * entries. This is an example.
+ *   "latency": {
+ *       "latency_stats": "on",
+ *       "ports": [
+ *           { "port": "ring:0", "max": 412, "hist": [ [ 206, 3 ], ... ] }
+ *       ],
+ *       "e2e": [
+ *           { "rx_port": "phy:0", "tx_port": "vhost:1", "max": 9120,
+ *             "hist": [ [ 8572, 1 ], ... ] }
+ *       ]
+ *   }
+ */
+int
+append_latency_info_value(const char *name, char **output)
+{
+	int ret = SPPWK_RET_NG;
+	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	struct cmd_res_formatter_ops ops_list[] = {
+		{ "latency_stats", add_latency_stats_mode },
+		{ "ports", add_port_latency_hist },
+		{ "e2e", add_e2e_latency_hist },
+		{ "", NULL }
+	};
+
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, WK_CMD_RES_FMT,
+				"Failed to get empty buf for append `%s`.\n",
+				name);
+		return SPPWK_RET_NG;
+	}
+
+	ret = append_response_list_value(&tmp_buff, ops_list, NULL);
+	if (unlikely(ret < SPPWK_RET_OK)) {
+		spp_strbuf_free(tmp_buff);
+		return SPPWK_RET_NG;
+	}
+
+	ret = append_json_block_brackets(output, name, tmp_buff);
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
 /**
  * Operation functions start with prefix `add_` defined in get_status_ops()
  * of struct `cmd_res_formatter_ops` which are for making each of parts of
@@ -562,3 +988,98 @@ add_master_lcore(const char *name, char **output,
 	ret = append_json_int_value(output, name, rte_get_master_lcore());
 	return ret;
 }
+
+/* Add busy and idle cycles of each of slave lcores to a response in JSON. */
+int
+add_lcore_stats(const char *name, char **output,
+		void *tmp __attribute__ ((unused)))
+{
+	int ret = SPPWK_RET_OK;
+	unsigned int lcore_id;
+	char stats_str[LCORE_STATS_JSON_LEN];
+	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, WK_CMD_RES_FMT, "Failed to alloc buff.\n");
+		return SPPWK_RET_NG;
+	}
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		lcore_stats_json(stats_str, sizeof(stats_str), lcore_id);
+		ret = append_json_block_brackets(&tmp_buff, "", stats_str);
+		if (unlikely(ret != SPPWK_RET_OK)) {
+			spp_strbuf_free(tmp_buff);
+			return SPPWK_RET_NG;
+		}
+	}
+
+	ret = append_json_array_brackets(output, name, tmp_buff);
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
+/* Add weight and stats of scheduling of each of components in JSON. */
+int
+add_sched_stats(const char *name, char **output,
+		void *tmp __attribute__ ((unused)))
+{
+	int ret = SPPWK_RET_OK;
+	int cnt;
+	unsigned int lcore_id;
+	struct core_info *core = NULL;
+	struct sppwk_comp_info *comp_info_base = NULL;
+	struct sppwk_comp_info *comp_info = NULL;
+	struct sppwk_sched_stats *stats = NULL;
+	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	char *comp_buff = NULL;
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, WK_CMD_RES_FMT, "Failed to alloc buff.\n");
+		return SPPWK_RET_NG;
+	}
+
+	sppwk_get_mng_data(NULL, &comp_info_base, NULL, NULL, NULL, NULL);
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		core = get_core_info(lcore_id);
+		for (cnt = 0; cnt < core->num; cnt++) {
+			comp_info = (comp_info_base + core->id[cnt]);
+			stats = sppwk_get_sched_stats(core->id[cnt]);
+
+			comp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+			if (unlikely(comp_buff == NULL)) {
+				ret = SPPWK_RET_NG;
+				break;
+			}
+			ret = append_json_str_value(&comp_buff, "name",
+					comp_info->name);
+			if (ret == SPPWK_RET_OK)
+				ret = append_json_uint_value(&comp_buff,
+						"lcore_id", lcore_id);
+			if (ret == SPPWK_RET_OK)
+				ret = append_json_int_value(&comp_buff,
+						"weight", comp_info->weight);
+			if (ret == SPPWK_RET_OK)
+				ret = append_json_uint64_value(&comp_buff,
+						"rounds", stats->nof_rounds);
+			if (ret == SPPWK_RET_OK)
+				ret = append_json_uint64_value(&comp_buff,
+						"bursts", stats->nof_bursts);
+			if (ret == SPPWK_RET_OK)
+				ret = append_json_uint64_value(&comp_buff,
+						"exhausted",
+						stats->nof_exhausted);
+			if (ret == SPPWK_RET_OK)
+				ret = append_json_block_brackets(&tmp_buff, "",
+						comp_buff);
+			spp_strbuf_free(comp_buff);
+			if (unlikely(ret != SPPWK_RET_OK))
+				break;
+		}
+		if (unlikely(ret != SPPWK_RET_OK))
+			break;
+	}
+
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_array_brackets(output, name, tmp_buff);
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
@@ -61,6 +61,17 @@ int append_command_results_value(const char *name, char **output,
 
 int append_info_value(const char *name, char **output);
 
+/**
+ * Setup `latency` section of response of `latency` command, which has
+ * histograms of latency of ports and end-to-end latency.
+ *
+ * @param[in] name Name of the section.
+ * @param[in,out] output Placeholder of JSON msg.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int append_latency_info_value(const char *name, char **output);
+
 /**
  * Operation functions start with prefix `add_` defined in `response_info_list`
  * of struct `cmd_res_formatter_ops` which are for making each of parts of
@@ -74,4 +85,10 @@ int add_interface(const char *name, char **output,
 
 int add_master_lcore(const char *name, char **output,
 		void *tmp __attribute__ ((unused)));
+
+int add_lcore_stats(const char *name, char **output,
+		void *tmp __attribute__ ((unused)));
+
+int add_sched_stats(const char *name, char **output,
+		void *tmp __attribute__ ((unused)));
 #endif
@@ -17,6 +17,7 @@
 
 #ifdef SPP_VF_MODULE
 #include "vf_deps.h"
+#include "ring_fusion.h"
 #endif
 
 #ifdef SPP_MIRROR_MODULE
@@ -56,10 +57,186 @@ flush_cmd(void)
 	/* TODO(yasufum) confirm why no checking for returned value. */
 	ret = update_comp_info(p_comp_info, p_change_comp);
 
+	/* Wait for all of published lcores and components at once. */
+	if (sppwk_wait_update_done() != SPPWK_RET_OK)
+		ret = SPPWK_RET_NG;
+	else
+		/* Shapers replaced are not referred by lcores anymore. */
+		sppwk_free_retired_shapers();
+
+#ifdef SPP_VF_MODULE
+	/* Fuse ring ports between components on the same lcore. */
+	if (update_ring_fusion() != SPPWK_RET_OK)
+		ret = SPPWK_RET_NG;
+#endif
+
 	backup_mng_info(backup_info);
 	return ret;
 }
 
+/* Move component to given lcore with handing over its state. */
+int
+move_comp_lcore(const char *name, unsigned int lcore_id)
+{
+	int ret;
+	int comp_id;
+	unsigned int old_lcore_id;
+	struct sppwk_comp_info *comp_info = NULL;
+	struct core_info *core = NULL;
+	struct core_mng_info *info = NULL;
+	struct sppwk_comp_info *comp_info_base = NULL;
+	struct core_mng_info *core_info = NULL;
+	int *change_core = NULL;
+
+	sppwk_get_mng_data(NULL, &comp_info_base, &core_info, &change_core,
+			NULL, NULL);
+
+	comp_id = sppwk_get_lcore_id(name);
+	if (unlikely(comp_id < 0)) {
+		RTE_LOG(ERR, WK_CMD_RUNNER, "Unknown component '%s'.\n",
+				name);
+		return SPPWK_RET_NG;
+	}
+
+	info = (core_info + lcore_id);
+	if (unlikely(info->status == SPPWK_LCORE_UNUSED)) {
+		RTE_LOG(ERR, WK_CMD_RUNNER,
+				"Not available lcore %d for %s.\n",
+				lcore_id, "SPPWK_LCORE_UNUSED");
+		return SPPWK_RET_NG;
+	}
+
+	comp_info = (comp_info_base + comp_id);
+	old_lcore_id = comp_info->lcore_id;
+	if (old_lcore_id == lcore_id)
+		return SPPWK_RET_OK;
+
+	RTE_LOG(INFO, WK_CMD_RUNNER, "Move '%s' from lcore %d to %d.\n",
+			name, old_lcore_id, lcore_id);
+
+	/**
+	 * Release the component from current lcore and wait until the lcore
+	 * is quiescent before assigning it to the new one, so that it is never
+	 * run on two lcores at once. Its state, such as packets remained in TX
+	 * buffers of classifier, is kept while moving because it is managed
+	 * per component ID, not per lcore. Incoming packets are just kept in
+	 * RX queue for a moment and not dropped or reordered.
+	 */
+	info = (core_info + old_lcore_id);
+	core = &info->core[info->upd_index];
+	if (del_comp_info(comp_id, core->num, core->id) >= 0)
+		core->num--;
+	*(change_core + old_lcore_id) = 1;
+
+	ret = flush_cmd();
+	if (unlikely(ret != SPPWK_RET_OK)) {
+		RTE_LOG(ERR, WK_CMD_RUNNER,
+				"Failed to release '%s' from lcore %d.\n",
+				name, old_lcore_id);
+		return ret;
+	}
+
+	info = (core_info + lcore_id);
+	core = &info->core[info->upd_index];
+	core->id[core->num] = comp_id;
+	core->num++;
+	comp_info->lcore_id = lcore_id;
+	*(change_core + lcore_id) = 1;
+
+	ret = flush_cmd();
+	if (likely(ret == SPPWK_RET_OK))
+		return ret;
+
+	/**
+	 * Put the component back to old lcore, or it is left on no lcore and
+	 * stops forwarding. Sides of new lcore are not edited while its update
+	 * is pending, because it can take the update at any moment. So it is
+	 * waited again, and the component is released from the update side in
+	 * a flush before assigned to old lcore. It is left on no lcore if new
+	 * lcore does not respond, not to be run on two lcores at once.
+	 */
+	RTE_LOG(ERR, WK_CMD_RUNNER,
+			"Failed to assign '%s' to lcore %d, back to lcore %d.\n",
+			name, lcore_id, old_lcore_id);
+	info = (core_info + lcore_id);
+	if (info->ref_index == info->upd_index) {
+		*(change_core + lcore_id) = 1;
+		sppwk_wait_update_done();
+	}
+	*(change_core + lcore_id) = 0;
+	if (unlikely(info->ref_index == info->upd_index)) {
+		RTE_LOG(ERR, WK_CMD_RUNNER,
+				"'%s' is left pending on lcore %d.\n",
+				name, lcore_id);
+		return ret;
+	}
+
+	core = &info->core[info->upd_index];
+	if (del_comp_info(comp_id, core->num, core->id) >= 0)
+		core->num--;
+	*(change_core + lcore_id) = 1;
+
+	flush_cmd();
+	if (unlikely(info->ref_index == info->upd_index)) {
+		RTE_LOG(ERR, WK_CMD_RUNNER,
+				"Failed to release '%s' from lcore %d, %s.\n",
+				name, lcore_id, "left on no lcore");
+		return ret;
+	}
+
+	info = (core_info + old_lcore_id);
+	core = &info->core[info->upd_index];
+	core->id[core->num] = comp_id;
+	core->num++;
+	comp_info->lcore_id = old_lcore_id;
+	*(change_core + old_lcore_id) = 1;
+
+	if (unlikely(flush_cmd() != SPPWK_RET_OK))
+		RTE_LOG(ERR, WK_CMD_RUNNER,
+				"Failed to put '%s' back to lcore %d.\n",
+				name, old_lcore_id);
+	return ret;
+}
+
+/* Set weight of component, which is the max num of bursts in a round. */
+int
+set_comp_weight(const char *name, int weight)
+{
+	int comp_id;
+	struct sppwk_comp_info *comp_info = NULL;
+	struct sppwk_comp_info *comp_info_base = NULL;
+	int *change_core = NULL;
+
+	sppwk_get_mng_data(NULL, &comp_info_base, NULL, &change_core,
+			NULL, NULL);
+
+	comp_id = sppwk_get_lcore_id(name);
+	if (unlikely(comp_id < 0)) {
+		RTE_LOG(ERR, WK_CMD_RUNNER, "Unknown component '%s'.\n",
+				name);
+		return SPPWK_RET_NG;
+	}
+
+	if (unlikely(weight < 1) || unlikely(weight > SPPWK_WEIGHT_MAX)) {
+		RTE_LOG(ERR, WK_CMD_RUNNER, "Invalid weight %d for '%s'.\n",
+				weight, name);
+		return SPPWK_RET_NG;
+	}
+
+	/**
+	 * Weight is referred by the lcore from its core info, so the lcore
+	 * running the component is updated for taking it in flush.
+	 */
+	RTE_LOG(INFO, WK_CMD_RUNNER, "Set weight of '%s' to %d.\n",
+			name, weight);
+	comp_info = (comp_info_base + comp_id);
+	comp_info->weight = weight;
+	if (comp_info->lcore_id < RTE_MAX_LCORE)
+		*(change_core + comp_info->lcore_id) = 1;
+	sppwk_reset_sched_stats(comp_id);
+	return flush_cmd();
+}
+
 /* Get error message of parsing from given wk_err_msg object. */
 static const char *
 get_parse_err_msg(
@@ -259,6 +436,17 @@ send_result_spp_ctl(int *sock,
 		}
 	}
 
+	/* append latency value */
+	if (request->is_requested_latency) {
+		ret = append_latency_info_value("latency", &tmp_buff);
+		if (unlikely(ret < SPPWK_RET_OK)) {
+			spp_strbuf_free(tmp_buff);
+			RTE_LOG(ERR, WK_CMD_RUNNER,
+					"Failed to make latency response.\n");
+			return;
+		}
+	}
+
 	msg = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
 	if (unlikely(msg == NULL)) {
 		spp_strbuf_free(tmp_buff);
@@ -19,6 +19,32 @@
  */
 int flush_cmd(void);
 
+/**
+ * Move component to given lcore without stopping it. The component is
+ * released from current lcore and assigned to the new one after the current
+ * lcore becomes quiescent, so that its state is handed over without
+ * dropping or reordering packets.
+ *
+ * @param[in] name Name of component to be moved.
+ * @param[in] lcore_id Lcore ID of destination.
+ *
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int move_comp_lcore(const char *name, unsigned int lcore_id);
+
+/**
+ * Set weight of component, which is the max num of bursts run in a turn of
+ * the component while its RX queue has remained packets.
+ *
+ * @param[in] name Name of component.
+ * @param[in] weight Weight from 1 to SPPWK_WEIGHT_MAX.
+ *
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int set_comp_weight(const char *name, int weight);
+
 /**
  * Setup connection for accepting commands from spp-ctl.
  *
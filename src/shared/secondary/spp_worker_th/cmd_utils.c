@@ -44,6 +44,9 @@ struct mng_data_info {
 /* Logical core ID for main process */
 static struct mng_data_info g_mng_data;
 
+/* Stats of scheduling components, indexed by component ID. */
+static struct sppwk_sched_stats g_sched_stats[RTE_MAX_LCORE];
+
 /* Hexdump `addr` for logging, used for core_info or component info. */
 void
 log_hexdumped(const char *obj_name, const void *obj_addr, const size_t size)
@@ -364,16 +367,25 @@ init_iface_info(void)
 		p_iface_info->phy[port_cnt].ethdev_port_id = -1;
 		p_iface_info->phy[port_cnt].cls_attrs.vlantag.vid =
 			ETH_VLAN_ID_MAX;
+		p_iface_info->phy[port_cnt].cls_attrs.svid = ETH_VLAN_ID_MAX;
+		p_iface_info->phy[port_cnt].cls_attrs.vni =
+			SPP_VXLAN_VNI_NONE;
 		p_iface_info->vhost[port_cnt].iface_type = UNDEF;
 		p_iface_info->vhost[port_cnt].iface_no = port_cnt;
 		p_iface_info->vhost[port_cnt].ethdev_port_id = -1;
 		p_iface_info->vhost[port_cnt].cls_attrs.vlantag.vid =
 			ETH_VLAN_ID_MAX;
+		p_iface_info->vhost[port_cnt].cls_attrs.svid = ETH_VLAN_ID_MAX;
+		p_iface_info->vhost[port_cnt].cls_attrs.vni =
+			SPP_VXLAN_VNI_NONE;
 		p_iface_info->ring[port_cnt].iface_type = UNDEF;
 		p_iface_info->ring[port_cnt].iface_no = port_cnt;
 		p_iface_info->ring[port_cnt].ethdev_port_id = -1;
 		p_iface_info->ring[port_cnt].cls_attrs.vlantag.vid =
 			ETH_VLAN_ID_MAX;
+		p_iface_info->ring[port_cnt].cls_attrs.svid = ETH_VLAN_ID_MAX;
+		p_iface_info->ring[port_cnt].cls_attrs.vni =
+			SPP_VXLAN_VNI_NONE;
 	}
 }
 
@@ -502,6 +514,20 @@ sppwk_get_comp_type(int id)
 	return ci->wk_type;
 }
 
+/* Get stats of scheduling of component. */
+struct sppwk_sched_stats *
+sppwk_get_sched_stats(int id)
+{
+	return &g_sched_stats[id];
+}
+
+/* Clear stats of scheduling of component. */
+void
+sppwk_reset_sched_stats(int id)
+{
+	memset(&g_sched_stats[id], 0x00, sizeof(struct sppwk_sched_stats));
+}
+
 /* Get core information which is in use */
 struct core_info *
 get_core_info(unsigned int lcore_id)
@@ -628,6 +654,42 @@ get_idx_port_info(struct sppwk_port_info *p_info, int nof_ports,
 	return ret;
 }
 
+/* Update attrs of the same op and dir, or add it to the end of actions. */
+int
+sppwk_set_port_attrs(struct sppwk_port_info *port,
+		const struct sppwk_port_attrs *port_attrs)
+{
+	int cnt;
+	int free_idx = -1;
+	struct sppwk_port_attrs *attrs = NULL;
+
+	for (cnt = 0; cnt < PORT_CAPABL_MAX; cnt++) {
+		attrs = &port->port_attrs[cnt];
+		if (attrs->ops == SPPWK_PORT_OPS_NONE) {
+			if (free_idx < 0)
+				free_idx = cnt;
+			continue;
+		}
+		if (attrs->dir != port_attrs->dir)
+			continue;
+		if (attrs->ops == port_attrs->ops) {
+			memcpy(attrs, port_attrs,
+					sizeof(struct sppwk_port_attrs));
+			return SPPWK_RET_OK;
+		}
+		/* Keep the order of actions of the same direction. */
+		free_idx = -1;
+	}
+
+	if (free_idx < 0) {
+		RTE_LOG(ERR, WK_CMD_UTILS, "No space of port ability.\n");
+		return SPPWK_RET_NG;
+	}
+	memcpy(&port->port_attrs[free_idx], port_attrs,
+			sizeof(struct sppwk_port_attrs));
+	return SPPWK_RET_OK;
+}
+
 /* Delete given port info from the port info array. */
 int
 delete_port_info(struct sppwk_port_info *p_info, int nof_ports,
@@ -690,30 +752,107 @@ void
 update_lcore_info(void)
 {
 	int cnt = 0;
+	int comp_cnt;
 	struct core_mng_info *info = NULL;
+	struct core_info *core = NULL;
 	struct core_mng_info *p_core_info = g_mng_data.p_core_info;
+	struct sppwk_comp_info *p_comp_info = g_mng_data.p_component_info;
 	int *p_change_core = g_mng_data.p_change_core;
 
-	/* Changed core has changed index. */
+	/**
+	 * Changed core has changed index. It is not waited here, but in
+	 * sppwk_wait_update_done() with updated components at once.
+	 * Weights of components are published with the info of lcore, so
+	 * that the lcore does not refer comp info being updated.
+	 */
 	for (cnt = 0; cnt < RTE_MAX_LCORE; cnt++) {
 		if (*(p_change_core + cnt) != 0) {
 			info = (p_core_info + cnt);
+			core = &info->core[info->upd_index];
+			for (comp_cnt = 0; comp_cnt < core->num; comp_cnt++)
+				core->weight[comp_cnt] = (p_comp_info +
+						core->id[comp_cnt])->weight;
 			info->upd_index = info->ref_index;
 		}
 	}
+}
+
+/* Count lcores and components which are not taken updated info yet. */
+static int
+count_update_pending(int is_logged)
+{
+	int cnt;
+	int nof_pending = 0;
+	struct core_mng_info *p_core_info = g_mng_data.p_core_info;
+	int *p_change_core = g_mng_data.p_change_core;
+	int *p_change_comp = g_mng_data.p_change_component;
 
-	/* Waiting for changed core change. */
 	for (cnt = 0; cnt < RTE_MAX_LCORE; cnt++) {
-		if (*(p_change_core + cnt) != 0) {
-			info = (p_core_info + cnt);
-			while (likely(info->ref_index == info->upd_index))
-				rte_delay_us_block(SPPWK_UPDATE_INTERVAL);
+		if (*(p_change_core + cnt) == 0)
+			continue;
+		if ((p_core_info + cnt)->ref_index !=
+				(p_core_info + cnt)->upd_index)
+			continue;
+		nof_pending++;
+		if (is_logged)
+			RTE_LOG(ERR, WK_CMD_UTILS,
+					"Lcore %d is not updated.\n", cnt);
+	}
 
-			memcpy(&info->core[info->upd_index],
-					&info->core[info->ref_index],
-					sizeof(struct core_info));
+	for (cnt = 0; cnt < RTE_MAX_LCORE; cnt++) {
+		if (*(p_change_comp + cnt) == 0)
+			continue;
+		if (is_comp_update_done(cnt) == 1)
+			continue;
+		nof_pending++;
+		if (is_logged)
+			RTE_LOG(ERR, WK_CMD_UTILS,
+					"Component %d is not updated.\n", cnt);
+	}
+
+	return nof_pending;
+}
+
+/* Wait for updated lcores and components while flushing at once. */
+int
+sppwk_wait_update_done(void)
+{
+	int cnt;
+	int ret = SPPWK_RET_OK;
+	struct core_mng_info *info = NULL;
+	struct core_mng_info *p_core_info = g_mng_data.p_core_info;
+	int *p_change_core = g_mng_data.p_change_core;
+	const uint64_t timeout_tsc = rte_get_timer_cycles() +
+			rte_get_timer_hz() / US_PER_S * SPPWK_UPDATE_TIMEOUT;
+
+	/**
+	 * All of changed lcores and components are already published, so
+	 * wait just one grace period for them instead of one by one.
+	 */
+	while (count_update_pending(0) != 0) {
+		if (unlikely(rte_get_timer_cycles() > timeout_tsc)) {
+			count_update_pending(1);
+			RTE_LOG(ERR, WK_CMD_UTILS,
+					"Timed out for waiting update.\n");
+			ret = SPPWK_RET_NG;
+			break;
 		}
+		rte_delay_us_block(SPPWK_UPDATE_INTERVAL);
+	}
+
+	/* Copy ref side to update side of lcores which are swapped. */
+	for (cnt = 0; cnt < RTE_MAX_LCORE; cnt++) {
+		if (*(p_change_core + cnt) == 0)
+			continue;
+		info = (p_core_info + cnt);
+		if (info->ref_index == info->upd_index)
+			continue;
+		memcpy(&info->core[info->upd_index],
+				&info->core[info->ref_index],
+				sizeof(struct core_info));
 	}
+
+	return ret;
 }
 
 /* Return port uid such as `phy:0`, `ring:1` or so. */
@@ -30,6 +30,9 @@
 /** Waiting time for checking update (not used for spp_pcap). */
 #define SPPWK_UPDATE_INTERVAL 10  /* micro sec */
 
+/** Timeout of waiting for all of updates while flushing (not for spp_pcap). */
+#define SPPWK_UPDATE_TIMEOUT 1000000  /* micro sec */
+
 /**
  * Used for index of arrary of management data which has two sides. It is not
  * used for spp_pcap.
@@ -39,6 +42,23 @@
 /** Maximum VLAN PCP, used only for spp_vf. */
 #define SPP_VLAN_PCP_MAX 7
 
+/** Maximum DSCP, used only for spp_vf. */
+#define SPP_DSCP_MAX 63
+
+/** Default and max size of queue of each traffic class of shaper. */
+#define SPP_SHAPER_QSIZE_DEFAULT 64
+#define SPP_SHAPER_QSIZE_MAX 4096
+
+/** Default TPID of outer tag of QinQ defined in IEEE 802.1ad. */
+#define SPP_QINQ_TPID_DEFAULT RTE_ETHER_TYPE_QINQ
+
+/** Max VNI of VXLAN, and VNI for classifier entries other than VXLAN. */
+#define SPP_VXLAN_VNI_MAX 0xffffff
+#define SPP_VXLAN_VNI_NONE -1
+
+/** Default UDP destination port of VXLAN assigned by IANA. */
+#define SPP_VXLAN_UDP_PORT_DEFAULT RTE_VXLAN_DEFAULT_PORT
+
 /* Max number of core status check */
 #define SPP_CORE_STATUS_CHECK_MAX 5
 
@@ -54,6 +74,9 @@
 /* Sampling interval timer for latency evaluation */
 #define SPP_RING_LATENCY_STATS_SAMPLING_INTERVAL 1000000
 
+/* One of this num of packets is sampled for end-to-end latency. */
+#define SPP_E2E_LATENCY_STATS_SAMPLING_RATE 1024
+
 /**
  * TODO(Yamashita) change type names.
  *  "merge" -> "merger", "forward" -> "forwarder".
@@ -68,7 +91,9 @@
 enum sppwk_cls_type {
 	SPPWK_CLS_TYPE_NONE,
 	SPPWK_CLS_TYPE_MAC,
-	SPPWK_CLS_TYPE_VLAN
+	SPPWK_CLS_TYPE_VLAN,
+	SPPWK_CLS_TYPE_QINQ,
+	SPPWK_CLS_TYPE_VNI
 };
 
 /* Flag of processing type to copy management information */
@@ -83,6 +108,7 @@ enum copy_mng_flg {
 struct core_info {
 	int num;  /* Number of IDs below */
 	int id[RTE_MAX_LCORE];  /* IDs of components run on the lcore. */
+	int weight[RTE_MAX_LCORE];  /* Weights of components above. */
 };
 
 /**
@@ -138,6 +164,70 @@ enum sppwk_lcore_status sppwk_get_lcore_status(unsigned int lcore_id);
  */
 enum sppwk_worker_type sppwk_get_comp_type(int id);
 
+/* Default and max weight of component, the num of bursts in a round. */
+#define SPPWK_WEIGHT_DEFAULT 1
+#define SPPWK_WEIGHT_MAX 32
+
+/* Stats of scheduling of a component sharing an lcore with others. */
+struct sppwk_sched_stats {
+	uint64_t nof_rounds;  /* Num of turns given to the component. */
+	uint64_t nof_bursts;  /* Num of bursts run in the turns. */
+	uint64_t nof_exhausted;  /* Num of turns ended with backlog. */
+} __rte_cache_aligned;
+
+/**
+ * Get stats of scheduling of component.
+ *
+ * @param id Component ID.
+ * @return Pointer to stats of the component.
+ */
+struct sppwk_sched_stats *sppwk_get_sched_stats(int id);
+
+/**
+ * Clear stats of scheduling of component, called before it is started.
+ *
+ * @param id Component ID.
+ */
+void sppwk_reset_sched_stats(int id);
+
+/**
+ * Run a component for its turn in a round of lcore. It runs `comp_proc` up to
+ * the weight of the component while a burst is full, which means packets are
+ * remained in RX queue, so that a busy component can run several bursts
+ * without giving extra turns to idle ones sharing the lcore.
+ *
+ * @param id Component ID.
+ * @param weight Weight of the component taken from info of the lcore.
+ * @param comp_proc Function of a burst of the component, which returns the
+ *  num of received packets or SPPWK_RET_NG.
+ * @return Total num of received packets, or SPPWK_RET_NG if failed.
+ */
+static inline int
+sppwk_run_comp(int id, int weight, int (*comp_proc)(int))
+{
+	int cnt;
+	int nof_rx = 0;
+	int nof_pkts = 0;
+	struct sppwk_sched_stats *stats = sppwk_get_sched_stats(id);
+
+	for (cnt = 0; cnt < weight; cnt++) {
+		nof_rx = comp_proc(id);
+		if (unlikely(nof_rx < 0))
+			return nof_rx;
+		nof_pkts += nof_rx;
+		if (nof_rx < MAX_PKT_BURST) {
+			cnt++;
+			break;
+		}
+	}
+
+	stats->nof_rounds++;
+	stats->nof_bursts += cnt;
+	if (nof_rx >= MAX_PKT_BURST)
+		stats->nof_exhausted++;
+	return nof_pkts;
+}
+
 /* TODO(yasufum) revise the name of func. */
 /**
  * Run check_core_status() several times with interval, up to
@@ -269,6 +359,19 @@ int sppwk_get_lcore_id(const char *comp_name);
 int get_idx_port_info(struct sppwk_port_info *p_info, int nof_ports,
 		struct sppwk_port_info *p_info_ary[]);
 
+/**
+ * Set port attrs to given port. Attrs of the same op and direction are
+ * updated, or added to the end of actions of the port. Actions are run in
+ * the order of added.
+ *
+ * @param[in,out] port Target port.
+ * @param[in] port_attrs Port attrs to be set.
+ * @retval SPPWK_RET_OK if succeeded.
+ * @retval SPPWK_RET_NG if no space for the attrs.
+ */
+int sppwk_set_port_attrs(struct sppwk_port_info *port,
+		const struct sppwk_port_attrs *port_attrs);
+
 /**
  *  search matched port_info from array and delete it.
  *
@@ -290,9 +393,24 @@ int delete_port_info(struct sppwk_port_info *p_info, int nof_ports,
  */
 int update_port_info(void);
 
-/* Activate temporarily stored lcore info while flushing. */
+/**
+ * Activate temporarily stored lcore info while flushing. It only publishes
+ * updated info and does not wait for lcores. Call sppwk_wait_update_done()
+ * after all of components are also published.
+ */
 void update_lcore_info(void);
 
+/**
+ * Wait for all of lcores and components updated while flushing to take
+ * the updated info. They are waited in one grace period up to
+ * SPPWK_UPDATE_TIMEOUT, not one by one, so it does not depend on the number
+ * of updated components.
+ *
+ * @retval SPPWK_RET_OK If all of updates are taken.
+ * @retval SPPWK_RET_NG If timed out.
+ */
+int sppwk_wait_update_done(void);
+
 /**
  * Return port uid such as `phy:0`, `ring:1` or so.
  *
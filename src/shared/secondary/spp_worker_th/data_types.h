@@ -15,8 +15,8 @@
 #define SPPWK_VHOST_STR "vhost"
 #define SPPWK_RING_STR "ring"
 
-/* TODO(yasufum) confirm usage of this value and why it is 4. */
-#define PORT_CAPABL_MAX 4  /* Max num of port abilities. */
+/* Max num of port abilities, or actions of a port for both of directions. */
+#define PORT_CAPABL_MAX 8
 
 /* Status of a component on lcore. */
 enum sppwk_lcore_status {
@@ -36,26 +36,97 @@ enum sppwk_port_dir {
 };
 
 /**
- * Port ability operation which indicates vlan tag operation on the port
- * (e.g. add vlan tag or delete vlan tag)
+ * Port ability operation which indicates vlan tag operation or rewriting
+ * header on the port (e.g. add vlan tag or set destination MAC address)
  */
 enum sppwk_port_ops {
 	SPPWK_PORT_OPS_NONE,
 	SPPWK_PORT_OPS_ADD_VLAN,  /* Add vlan tag. */
 	SPPWK_PORT_OPS_DEL_VLAN,  /* Delete vlan tag. */
+	SPPWK_PORT_OPS_ADD_QINQ,  /* Add outer tag of QinQ. */
+	SPPWK_PORT_OPS_DEL_QINQ,  /* Delete outer tag of QinQ. */
+	SPPWK_PORT_OPS_SET_SRC_MAC,  /* Rewrite source MAC address. */
+	SPPWK_PORT_OPS_SET_DST_MAC,  /* Rewrite destination MAC address. */
+	SPPWK_PORT_OPS_SET_PCP,  /* Remark PCP of the first VLAN tag. */
+	SPPWK_PORT_OPS_SET_DSCP,  /* Remark DSCP of IPv4 or IPv6. */
+	SPPWK_PORT_OPS_DEC_TTL,  /* Decrement TTL or hop limit. */
+	SPPWK_PORT_OPS_METER,  /* Police packets with srTCM or trTCM. */
+	SPPWK_PORT_OPS_SHAPER,  /* Shape TX packets with rte_sched. */
+	SPPWK_PORT_OPS_ADD_VXLAN,  /* Encapsulate packets with VXLAN. */
+	SPPWK_PORT_OPS_DEL_VXLAN,  /* Decapsulate packets of VXLAN. */
 };
 
+/* Check if given op is for VLAN tag, or rewriting header. */
+#define SPPWK_IS_VLAN_OPS(ops) \
+	((ops) >= SPPWK_PORT_OPS_ADD_VLAN && (ops) <= SPPWK_PORT_OPS_DEL_QINQ)
+
 /** VLAN tag information */
 struct sppwk_vlan_tag {
 	int vid; /**< VLAN ID */
 	int pcp; /**< Priority Code Point */
 	int tci; /**< Tag Control Information */
+	int fcs; /**< 1 if FCS is recalculated after adding or deleting tag */
+	int tpid; /**< TPID of outer tag, only for QinQ */
+};
+
+/** Values for rewriting header of packets */
+struct sppwk_hdr_rewrite {
+	uint64_t mac_addr; /**< MAC address for set_src_mac or set_dst_mac */
+	int value; /**< PCP for set_pcp, or DSCP for set_dscp */
+};
+
+/** Type of meter of port */
+enum sppwk_meter_type {
+	SPPWK_METER_SRTCM,  /* Single rate three color marker, RFC 2697. */
+	SPPWK_METER_TRTCM,  /* Two rate three color marker, RFC 2698. */
+};
+
+/** Action for packets colored red by meter */
+enum sppwk_meter_red_act {
+	SPPWK_METER_RED_DROP,  /* Drop red packets. */
+	SPPWK_METER_RED_MARK,  /* Remark PCP of red packets. */
+};
+
+/** Params of meter for policing packets of port */
+struct sppwk_meter {
+	enum sppwk_meter_type type; /**< srTCM or trTCM */
+	uint64_t cir; /**< Committed information rate in bytes per second */
+	uint64_t pir; /**< Peak information rate in bytes per second, trTCM */
+	uint64_t cbs; /**< Committed burst size in bytes */
+	uint64_t ebs; /**< Excess burst size in bytes, srTCM */
+	uint64_t pbs; /**< Peak burst size in bytes, trTCM */
+	enum sppwk_meter_red_act red_act; /**< Drop or mark red packets */
+	int pcp; /**< PCP marked on red packets */
+};
+
+/** Params of shaper of TX port */
+struct sppwk_shaper {
+	uint32_t rate; /**< Rate of the port in bytes per second */
+	int qsize; /**< Num of packets of queue of each traffic class */
+};
+
+/** Params of VXLAN encapsulation or decapsulation */
+struct sppwk_vxlan {
+	uint32_t vni; /**< VXLAN network identifier, only for encap */
+	uint64_t src_mac; /**< Source MAC address of outer header */
+	uint64_t dst_mac; /**< Destination MAC address of outer header */
+	uint32_t src_ip; /**< Source IPv4 address in network byte order */
+	uint32_t dst_ip; /**< Destination IPv4 address in network byte order */
+	int udp_port; /**< UDP destination port */
 };
 
-/* Ability for vlantag for a port. */
+/* Ability for vlantag, rewriting header, meter, shaper or VXLAN of port. */
 union sppwk_port_capability {
 	/** VLAN tag information */
 	struct sppwk_vlan_tag vlantag;
+	/** Values for rewriting header */
+	struct sppwk_hdr_rewrite rewrite;
+	/** Params of meter */
+	struct sppwk_meter meter;
+	/** Params of shaper */
+	struct sppwk_shaper shaper;
+	/** Params of VXLAN */
+	struct sppwk_vxlan vxlan;
 };
 
 /* Port attributes of SPP worker processes. */
@@ -63,6 +134,7 @@ struct sppwk_port_attrs {
 	enum sppwk_port_ops ops;  /**< Port capability Operations */
 	enum sppwk_port_dir dir;  /**< Direction of RX, TX or both */
 	union sppwk_port_capability capability;   /**< Port capability */
+	int hw_offload;  /**< 1 if VLAN op is offloaded to NIC of phy port */
 };
 
 /* Type of SPP worker thread. */
@@ -80,6 +152,8 @@ struct sppwk_cls_attrs {
 	uint64_t mac_addr;  /**< Mac address (binary) */
 	char mac_addr_str[STR_LEN_SHORT];  /**< Mac address (text) */
 	struct sppwk_vlan_tag vlantag;   /**< VLAN tag information */
+	int svid;  /**< VLAN ID of outer tag, or ETH_VLAN_ID_MAX if not QinQ */
+	int vni;  /**< VNI of VXLAN, or SPP_VXLAN_VNI_NONE if not VXLAN */
 };
 
 /**
@@ -100,16 +174,67 @@ struct sppwk_port_info {
 	struct sppwk_port_attrs port_attrs[PORT_CAPABL_MAX];
 };
 
+/* Fields of packet matched by filter of mirror. */
+#define SPPWK_MIR_FILTER_VLAN     (1 << 0)
+#define SPPWK_MIR_FILTER_PROTO    (1 << 1)
+#define SPPWK_MIR_FILTER_SRC_IP   (1 << 2)
+#define SPPWK_MIR_FILTER_DST_IP   (1 << 3)
+#define SPPWK_MIR_FILTER_SRC_PORT (1 << 4)
+#define SPPWK_MIR_FILTER_DST_PORT (1 << 5)
+
+/**
+ * Filter of mirror, only packets matched with all of given fields are
+ * mirrored. Addresses and ports are in network byte order.
+ */
+struct sppwk_mir_filter {
+	uint32_t fields; /**< Bitmask of SPPWK_MIR_FILTER_*, or 0 for all */
+	uint16_t vid; /**< VLAN ID of outermost tag */
+	uint8_t proto; /**< Protocol of IPv4 header */
+	uint32_t src_ip; /**< Source IPv4 address masked with src_mask */
+	uint32_t src_mask; /**< Mask of source IPv4 address */
+	uint32_t dst_ip; /**< Destination IPv4 address masked with dst_mask */
+	uint32_t dst_mask; /**< Mask of destination IPv4 address */
+	uint16_t src_port; /**< Source port of TCP, UDP or SCTP */
+	uint16_t dst_port; /**< Destination port of TCP, UDP or SCTP */
+};
+
+/* Max length of data of truncated packets copied for mirror. */
+#define SPPWK_MIR_SNAPLEN_MAX 512
+
+/* Max sample_rate of mirror, not to overflow credit of tsc hz per packet. */
+#define SPPWK_MIR_SAMPLE_RATE_MAX 100000000
+
+/* How to copy packets for mirror, shallow copy is default. */
+enum sppwk_mir_copy_mode {
+	SPPWK_MIR_COPY_SHALLOW,  /**< Clone referring original packet */
+	SPPWK_MIR_COPY_DEEP,  /**< Copy whole of packet */
+	SPPWK_MIR_COPY_HYBRID,  /**< Copy headers and refer payload */
+};
+
+/**
+ * Options of mirror for reducing packets mirrored. Packets matched with
+ * filter are sampled, and copied up to snaplen bytes.
+ */
+struct sppwk_mir_opts {
+	struct sppwk_mir_filter filter; /**< Filter of packets */
+	uint32_t sample; /**< Mirror one in this num of packets, or 0 for all */
+	uint32_t sample_rate; /**< Max packets per sec, or 0 for unlimited */
+	uint32_t snaplen; /**< Bytes copied from each packet, or 0 for all */
+	enum sppwk_mir_copy_mode copy_mode; /**< How to copy packets */
+};
+
 /* Attributes of SPP worker thread named as `component`. */
 struct sppwk_comp_info {
 	char name[STR_LEN_NAME];  /**< Component name */
 	enum sppwk_worker_type wk_type;  /**< Type of worker thread */
 	unsigned int lcore_id;
 	int comp_id;  /**< Component ID */
+	int weight;  /**< Max num of bursts in a round of lcore */
 	int nof_rx;  /**< The number of rx ports */
 	int nof_tx;  /**< The number of tx ports */
 	struct sppwk_port_info *rx_ports[RTE_MAX_ETHPORTS]; /**< rx ports */
 	struct sppwk_port_info *tx_ports[RTE_MAX_ETHPORTS]; /**< tx ports */
+	struct sppwk_mir_opts mir_opts; /**< Options, only for mirror */
 };
 
 /* Manage number of interfaces  and port information as global variable. */
@@ -6,7 +6,7 @@
 #include <sys/types.h>
 #include <stdio.h>
 #include <stddef.h>
-#include <math.h>
+#include <inttypes.h>
 
 #include <rte_mbuf.h>
 #include <rte_log.h>
@@ -17,86 +17,256 @@
 #include "latency_stats.h"
 #include "cmd_utils.h"
 #include "port_capability.h"
+#include "cmd_res_formatter.h"
 #include "../return_codes.h"
+#include "../string_buffer.h"
+#include "../json_helper.h"
 
-#define NS_PER_SEC 1E9
+#define NS_PER_SEC 1000000000ULL
+
+/* Max length of an entry of histogram in JSON such as `, [ 206, 3 ]`. */
+#define LATENCY_HIST_ENT_JSON_LEN 48
+
+/* Percentiles reported in units of 0.01%. */
+#define LATENCY_P50 5000
+#define LATENCY_P99 9900
+#define LATENCY_P999 9990
+
+/**
+ * Time for packets stamped before enabling to be out of ports, before
+ * measuring latency of them is started.
+ */
+#define LATENCY_STATS_SWITCH_WAIT_MS 10
 
 #define RTE_LOGTYPE_SPP_RING_LATENCY_STATS RTE_LOGTYPE_USER1
 
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
+struct sppwk_burst_ops g_port_burst[RTE_MAX_ETHPORTS];
+
+/** plain and instrumented burst functions */
+static struct sppwk_burst_ops g_plain_burst;
+static struct sppwk_burst_ops g_stats_burst;
+
+/** 1 if measuring latency is enabled */
+static int g_latency_enabled;
 
-/** ring latency statistics information */
-struct ring_latency_stats_info {
+/** Num of port types measured, PHY, RING and VHOST. */
+#define LATENCY_STATS_PORT_TYPES (VHOST + 1)
+
+/** latency statistics information of a port */
+struct port_latency_stats_info {
 	uint64_t timer_tsc;  /**< sampling interval */
 	uint64_t prev_tsc;   /**< previous time */
 	struct ring_latency_stats_t stats;  /**< list of stats */
-};
+} __rte_cache_aligned;
 
 /** sampling interval */
 static uint64_t g_samp_intvl;
 
-/** ring latency statistics information instance */
-static struct ring_latency_stats_info *g_stats_info;
+/** latency statistics indexed by port type and port ID of the type */
+static struct port_latency_stats_info *g_stats_info;
+
+/** end-to-end latency of packets from an ingress port */
+struct e2e_latency_path {
+	uint16_t rx_key;  /**< ingress port in the stamp */
+	struct ring_latency_stats_t stats;  /**< histogram of latency */
+};
+
+/** end-to-end latency of packets to an egress port */
+struct e2e_latency_info {
+	uint16_t tx_key;  /**< egress port as same format as ingress */
+	volatile int nof_paths;  /**< num of ingress ports counted */
+	struct e2e_latency_path paths[E2E_LATENCY_MAX_PATHS];
+} __rte_cache_aligned;
+
+/** counter for sampling packets of an ingress port */
+struct e2e_latency_samp {
+	uint32_t cnt;  /**< num of packets since previous sample */
+} __rte_cache_aligned;
 
-/** number of ring latency statistics */
-static uint16_t g_stats_count;
+/** sampling rate of end-to-end latency */
+static uint32_t g_e2e_samp_rate;
 
-/* clock cycles per nano second */
+/** end-to-end latency indexed by etherdev ID of egress port */
+static struct e2e_latency_info *g_e2e_info;
+
+/** sampling counter indexed by etherdev ID of ingress port */
+static struct e2e_latency_samp g_e2e_samp[RTE_MAX_ETHPORTS];
+
+/* Convert TSC cycles to nano sec. */
 static inline uint64_t
-cycles_per_ns(void)
+cycles_to_ns(uint64_t cycles)
 {
-	return rte_get_timer_hz() / NS_PER_SEC;
+	return cycles * NS_PER_SEC / rte_get_timer_hz();
 }
 
-/**
- * TODO(Hideyuki Yamashita) This function has a fatal bug in rte_zmalloc()
- * for `g_stats_info` and should be fixed. rte_zmalloc() returns NULL for
- * unknow reason.
- */
+/* Get stats of given port, or NULL if the port is not measured. */
+static inline struct port_latency_stats_info *
+get_port_stats_info(enum port_type iface_type, int iface_no)
+{
+	if (unlikely(iface_type >= LATENCY_STATS_PORT_TYPES) ||
+			unlikely(iface_no < 0) ||
+			unlikely(iface_no >= RTE_MAX_ETHPORTS))
+		return NULL;
+	return &g_stats_info[iface_type * RTE_MAX_ETHPORTS + iface_no];
+}
+
+/* Set burst functions of all ports to plain ones. */
+void
+sppwk_init_port_burst(const struct sppwk_burst_ops *plain,
+		const struct sppwk_burst_ops *stats)
+{
+	int cnt;
+
+	g_plain_burst = *plain;
+	g_stats_burst = *stats;
+	for (cnt = 0; cnt < RTE_MAX_ETHPORTS; cnt++)
+		g_port_burst[cnt] = g_plain_burst;
+	g_latency_enabled = 0;
+}
+
+/* Clear all of latency statistics. */
+static void
+clear_latency_stats(void)
+{
+	if (g_stats_info != NULL)
+		memset(g_stats_info, 0x00,
+				sizeof(struct port_latency_stats_info) *
+				LATENCY_STATS_PORT_TYPES * RTE_MAX_ETHPORTS);
+	if (g_e2e_info != NULL)
+		memset(g_e2e_info, 0x00,
+				sizeof(struct e2e_latency_info) *
+				RTE_MAX_ETHPORTS);
+	memset(g_e2e_samp, 0x00, sizeof(g_e2e_samp));
+}
+
+/* Return 1 if packets are stamped on TX of the port, or 0 for RX. */
+static int
+is_stamped_on_tx(uint16_t port_id)
+{
+	int port_type, iface_no;
+	char dev_name[RTE_DEV_NAME_MAX_LEN] = { 0 };
+
+	if (rte_eth_dev_get_name_by_port(port_id, dev_name) != 0)
+		return 0;
+	if (parse_dev_name(dev_name, &port_type, &iface_no) < 0)
+		return 0;
+	return port_type == RING;
+}
+
+/* Swap burst functions of ports for enabling or disabling latency stats. */
+int
+sppwk_set_latency_stats(int enable)
+{
+	int cnt;
+
+	if (unlikely(g_stats_burst.rx_func == NULL)) {
+		RTE_LOG(ERR, SPP_RING_LATENCY_STATS,
+				"Latency stats is not supported.\n");
+		return SPPWK_RET_NG;
+	}
+	if (enable == g_latency_enabled)
+		return SPPWK_RET_OK;
+
+	if (!enable) {
+		for (cnt = 0; cnt < RTE_MAX_ETHPORTS; cnt++)
+			g_port_burst[cnt] = g_plain_burst;
+		g_latency_enabled = 0;
+		RTE_LOG(INFO, SPP_RING_LATENCY_STATS,
+				"Latency stats is disabled.\n");
+		return SPPWK_RET_OK;
+	}
+
+	/* Nothing is measured while disabled, so that clear it safely. */
+	clear_latency_stats();
+
+	/**
+	 * Start stamping first, TX of ring and RX of others, and wait for
+	 * packets not stamped or stamped long ago to be out before measuring.
+	 */
+	for (cnt = 0; cnt < RTE_MAX_ETHPORTS; cnt++) {
+		if (is_stamped_on_tx(cnt))
+			g_port_burst[cnt].tx_func = g_stats_burst.tx_func;
+		else
+			g_port_burst[cnt].rx_func = g_stats_burst.rx_func;
+	}
+	rte_delay_ms(LATENCY_STATS_SWITCH_WAIT_MS);
+	for (cnt = 0; cnt < RTE_MAX_ETHPORTS; cnt++)
+		g_port_burst[cnt] = g_stats_burst;
+
+	g_latency_enabled = 1;
+	RTE_LOG(INFO, SPP_RING_LATENCY_STATS, "Latency stats is enabled.\n");
+	return SPPWK_RET_OK;
+}
+
+/* Check if measuring latency is enabled. */
+int
+sppwk_is_latency_stats_enabled(void)
+{
+	return g_latency_enabled;
+}
+
+/* Allocate stats of all ports indexed by port type and port ID. */
 int
-sppwk_init_ring_latency_stats(uint64_t samp_intvl, uint16_t stats_count)
+sppwk_init_port_latency_stats(uint64_t samp_intvl)
 {
-	/* allocate memory for ring latency statistics information */
-	g_stats_info = rte_zmalloc(
-			"global ring_latency_stats_info",
-			sizeof(struct ring_latency_stats_info) * stats_count,
-			0);
+	g_stats_info = rte_zmalloc("global port_latency_stats_info",
+			sizeof(struct port_latency_stats_info) *
+			LATENCY_STATS_PORT_TYPES * RTE_MAX_ETHPORTS,
+			RTE_CACHE_LINE_SIZE);
 	if (unlikely(g_stats_info == NULL)) {
 		RTE_LOG(ERR, SPP_RING_LATENCY_STATS, "Cannot allocate memory "
-				"for ring latency stats info\n");
+				"for port latency stats info\n");
 		return SPPWK_RET_NG;
 	}
 
-	/* store global information for ring latency statistics */
-	g_samp_intvl = samp_intvl * cycles_per_ns();
-	g_stats_count = stats_count;
+	/* store global information for latency statistics */
+	g_samp_intvl = samp_intvl * rte_get_timer_hz() / NS_PER_SEC;
 
 	RTE_LOG(DEBUG, SPP_RING_LATENCY_STATS,
-			"g_samp_intvl=%lu, g_stats_count=%hu, "
-			"cpns=%lu, NS_PER_SEC=%f\n",
-			g_samp_intvl, g_stats_count,
-			cycles_per_ns(), NS_PER_SEC);
+			"g_samp_intvl=%lu, hz=%lu\n",
+			g_samp_intvl, rte_get_timer_hz());
 
 	return SPPWK_RET_OK;
 }
 
 void
-sppwk_clean_ring_latency_stats(void)
+sppwk_clean_latency_stats(void)
 {
-	/* free memory for ring latency statistics information */
 	if (likely(g_stats_info != NULL)) {
 		rte_free(g_stats_info);
-		g_stats_count = 0;
+		g_stats_info = NULL;
+	}
+	if (likely(g_e2e_info != NULL)) {
+		rte_free(g_e2e_info);
+		g_e2e_info = NULL;
 	}
 }
 
+int
+sppwk_init_e2e_latency_stats(uint32_t samp_rate)
+{
+	g_e2e_info = rte_zmalloc("global e2e_latency_info",
+			sizeof(struct e2e_latency_info) * RTE_MAX_ETHPORTS,
+			RTE_CACHE_LINE_SIZE);
+	if (unlikely(g_e2e_info == NULL)) {
+		RTE_LOG(ERR, SPP_RING_LATENCY_STATS, "Cannot allocate memory "
+				"for e2e latency stats info\n");
+		return SPPWK_RET_NG;
+	}
+
+	memset(g_e2e_samp, 0x00, sizeof(g_e2e_samp));
+	g_e2e_samp_rate = samp_rate;
+	return SPPWK_RET_OK;
+}
+
 void
 sppwk_add_ring_latency_time(int ring_id,
 		struct rte_mbuf **pkts, uint16_t nb_pkts)
 {
 	unsigned int i;
 	uint64_t diff_tsc, now;
-	struct ring_latency_stats_info *stats_info = &g_stats_info[ring_id];
+	struct port_latency_stats_info *stats_info =
+			get_port_stats_info(RING, ring_id);
 
 	for (i = 0; i < nb_pkts; i++) {
 
@@ -115,6 +285,9 @@ sppwk_add_ring_latency_time(int ring_id,
 					ring_id, i, now);
 			pkts[i]->timestamp = now;
 			stats_info->timer_tsc = 0;
+		} else {
+			/* Clear stamp remained in reused mbuf. */
+			pkts[i]->timestamp = 0;
 		}
 
 		/* update previous tsc */
@@ -127,81 +300,483 @@ sppwk_calc_ring_latency(int ring_id,
 		struct rte_mbuf **pkts, uint16_t nb_pkts)
 {
 	unsigned int i;
-	uint64_t now;
-	int64_t latency;
-	struct ring_latency_stats_info *stats_info = &g_stats_info[ring_id];
+	uint64_t now, latency;
+	struct port_latency_stats_info *stats_info =
+			get_port_stats_info(RING, ring_id);
 
 	now = rte_rdtsc();
 	for (i = 0; i < nb_pkts; i++) {
 		if (likely(pkts[i]->timestamp == 0))
 			continue;
 
-		/* calc latency if mbuf `timestamp` is non-zero. */
-		latency = (uint64_t)floor((now - pkts[i]->timestamp) /
-				cycles_per_ns());
-		if (likely(latency < TOTAL_LATENCY_ENT-1))
-			stats_info->stats.distr[latency]++;
-		else
-			stats_info->stats.distr[TOTAL_LATENCY_ENT-1]++;
+		/**
+		 * calc latency if mbuf `timestamp` is non-zero. Stamp from
+		 * the future or over the range is stale one remained in mbuf
+		 * sent to the ring by other processes.
+		 */
+		latency = now - pkts[i]->timestamp;
+		if (unlikely(latency >= LATENCY_HIST_RANGE))
+			continue;
+		stats_info->stats.distr[latency_hist_index(latency)]++;
+		if (unlikely(latency > stats_info->stats.max))
+			stats_info->stats.max = latency;
 	}
 }
 
-int
-sppwk_get_ring_latency_stats_count(void)
+uint64_t
+sppwk_start_tx_burst_time(enum port_type iface_type, int iface_no)
 {
-	return g_stats_count;
+	uint64_t now;
+	struct port_latency_stats_info *stats_info =
+			get_port_stats_info(iface_type, iface_no);
+
+	if (unlikely(stats_info == NULL))
+		return 0;
+
+	/* A burst is timed once in the sampling interval. */
+	now = rte_rdtsc();
+	stats_info->timer_tsc += now - stats_info->prev_tsc;
+	stats_info->prev_tsc = now;
+	if (likely(stats_info->timer_tsc < g_samp_intvl))
+		return 0;
+
+	stats_info->timer_tsc = 0;
+	return now;
 }
 
 void
-sppwk_get_ring_latency_stats(int ring_id,
+sppwk_calc_tx_burst_time(enum port_type iface_type, int iface_no,
+		uint64_t start)
+{
+	uint64_t latency = rte_rdtsc() - start;
+	struct port_latency_stats_info *stats_info =
+			get_port_stats_info(iface_type, iface_no);
+
+	stats_info->stats.distr[latency_hist_index(latency)]++;
+	if (unlikely(latency > stats_info->stats.max))
+		stats_info->stats.max = latency;
+}
+
+/* Get key of port in the stamp of end-to-end latency. */
+static inline uint16_t
+e2e_port_key(enum port_type iface_type, int iface_no)
+{
+	return ((uint16_t)iface_type << E2E_PORT_NO_BITS) |
+		(iface_no & E2E_PORT_NO_MASK);
+}
+
+/* Return 1 if the port can be given as a key of stamp, or 0. */
+static inline int
+is_e2e_port_keyable(int iface_no)
+{
+	return iface_no >= 0 && iface_no <= E2E_PORT_NO_MASK;
+}
+
+void
+sppwk_add_e2e_latency_time(uint16_t port_id, enum port_type iface_type,
+		int iface_no, struct rte_mbuf **pkts, uint16_t nb_pkts)
+{
+	unsigned int i;
+	uint64_t stamp = 0;
+	struct e2e_latency_samp *samp = &g_e2e_samp[port_id];
+
+	/* Not initialized in process without egress, such as spp_pcap. */
+	if (unlikely(g_e2e_samp_rate == 0))
+		return;
+
+	for (i = 0; i < nb_pkts; i++) {
+		/* Clear stamp remained in reused mbuf. */
+		if (likely(++samp->cnt < g_e2e_samp_rate) ||
+				unlikely(!is_e2e_port_keyable(iface_no))) {
+			pkts[i]->udata64 = 0;
+			continue;
+		}
+
+		samp->cnt = 0;
+		if (stamp == 0)
+			stamp = (E2E_STAMP_MAGIC << E2E_STAMP_MAGIC_SHIFT) |
+				((uint64_t)e2e_port_key(iface_type, iface_no)
+					<< E2E_STAMP_KEY_SHIFT) |
+				(rte_rdtsc() & E2E_STAMP_TSC_MASK);
+		pkts[i]->udata64 = stamp;
+	}
+}
+
+/* Get path of given ingress port, or add it if not counted yet. */
+static struct e2e_latency_path *
+get_e2e_latency_path(struct e2e_latency_info *info, uint16_t rx_key)
+{
+	int cnt;
+	struct e2e_latency_path *path = NULL;
+
+	for (cnt = 0; cnt < info->nof_paths; cnt++) {
+		if (info->paths[cnt].rx_key == rx_key)
+			return &info->paths[cnt];
+	}
+	if (unlikely(info->nof_paths >= E2E_LATENCY_MAX_PATHS))
+		return NULL;
+
+	/* Only egress lcore adds a path, and master refers it. */
+	path = &info->paths[info->nof_paths];
+	memset(path, 0x00, sizeof(*path));
+	path->rx_key = rx_key;
+	rte_smp_wmb();
+	info->nof_paths++;
+	return path;
+}
+
+void
+sppwk_calc_e2e_latency(uint16_t port_id, enum port_type iface_type,
+		int iface_no, struct rte_mbuf **pkts, uint16_t nb_pkts)
+{
+	unsigned int i;
+	uint64_t now, stamp, latency;
+	struct e2e_latency_info *info = &g_e2e_info[port_id];
+	struct e2e_latency_path *path = NULL;
+
+	if (unlikely(!is_e2e_port_keyable(iface_no)))
+		return;
+
+	now = rte_rdtsc() & E2E_STAMP_TSC_MASK;
+	for (i = 0; i < nb_pkts; i++) {
+		stamp = pkts[i]->udata64;
+		if (likely(stamp == 0))
+			continue;
+		if (unlikely(stamp >> E2E_STAMP_MAGIC_SHIFT !=
+				E2E_STAMP_MAGIC))
+			continue;
+
+		/* Over the range is of a stamp remained in reused mbuf. */
+		latency = (now - stamp) & E2E_STAMP_TSC_MASK;
+		if (unlikely(latency >= LATENCY_HIST_RANGE))
+			continue;
+
+		if (unlikely(info->nof_paths == 0))
+			info->tx_key = e2e_port_key(iface_type, iface_no);
+		path = get_e2e_latency_path(info, (stamp >>
+				E2E_STAMP_KEY_SHIFT) & E2E_STAMP_KEY_MASK);
+		if (unlikely(path == NULL))
+			continue;
+
+		path->stats.distr[latency_hist_index(latency)]++;
+		if (unlikely(latency > path->stats.max))
+			path->stats.max = latency;
+	}
+}
+
+int
+sppwk_get_port_latency_stats(enum port_type iface_type, int iface_no,
 		struct ring_latency_stats_t *stats)
 {
-	struct ring_latency_stats_info *stats_info = &g_stats_info[ring_id];
+	struct port_latency_stats_info *stats_info =
+			get_port_stats_info(iface_type, iface_no);
+
+	if (unlikely(stats_info == NULL))
+		return SPPWK_RET_NG;
 
 	rte_memcpy(stats, &stats_info->stats,
 			sizeof(struct ring_latency_stats_t));
+	return SPPWK_RET_OK;
 }
 
-/* Print statistics of time for packet processing in ring interface */
-void
-print_ring_latency_stats(struct iface_info *if_info)
+/* Get num of packets measured in ring latency statistics. */
+static uint64_t
+get_ring_latency_samples(const struct ring_latency_stats_t *stats)
 {
-	/* Clear screen and move cursor to top left */
-	const char topLeft[] = { 27, '[', '1', ';', '1', 'H', '\0' };
-	const char clr[] = { 27, '[', '2', 'J', '\0' };
-	printf("%s%s", clr, topLeft);
+	int cnt;
+	uint64_t total = 0;
 
-	int ring_cnt, stats_cnt;
-	struct ring_latency_stats_t stats[RTE_MAX_ETHPORTS];
-	memset(&stats, 0x00, sizeof(stats));
+	for (cnt = 0; cnt < TOTAL_LATENCY_ENT; cnt++)
+		total += stats->distr[cnt];
+	return total;
+}
 
-	printf("RING Latency\n");
-	printf(" RING");
-	for (ring_cnt = 0; ring_cnt < RTE_MAX_ETHPORTS; ring_cnt++) {
-		if (if_info->ring[ring_cnt].iface_type == UNDEF)
+/* Get latency of given percentile in nano sec. */
+uint64_t
+sppwk_get_ring_latency_percentile(const struct ring_latency_stats_t *stats,
+		unsigned int per_10k)
+{
+	int cnt;
+	uint64_t target, sum = 0;
+	uint64_t total = get_ring_latency_samples(stats);
+
+	if (total == 0)
+		return 0;
+
+	/* Rank of the packet of the percentile, rounded up. */
+	target = (total * per_10k + 9999) / 10000;
+	for (cnt = 0; cnt < TOTAL_LATENCY_ENT; cnt++) {
+		sum += stats->distr[cnt];
+		if (sum >= target)
+			break;
+	}
+	return cycles_to_ns(RTE_MIN(latency_hist_upper(cnt), stats->max));
+}
+
+/* Function to add latency stats of a port or a path to JSON object. */
+typedef int (*append_latency_f)(char **output,
+		const struct ring_latency_stats_t *stats);
+
+/* Add percentiles of latency to given JSON object. */
+static int
+append_latency_value(char **output,
+		const struct ring_latency_stats_t *stats)
+{
+	int ret;
+
+	ret = append_json_uint64_value(output, "samples",
+			get_ring_latency_samples(stats));
+	if (likely(ret == SPPWK_RET_OK))
+		ret = append_json_uint64_value(output, "p50",
+				sppwk_get_ring_latency_percentile(stats,
+					LATENCY_P50));
+	if (likely(ret == SPPWK_RET_OK))
+		ret = append_json_uint64_value(output, "p99",
+				sppwk_get_ring_latency_percentile(stats,
+					LATENCY_P99));
+	if (likely(ret == SPPWK_RET_OK))
+		ret = append_json_uint64_value(output, "p999",
+				sppwk_get_ring_latency_percentile(stats,
+					LATENCY_P999));
+	if (likely(ret == SPPWK_RET_OK))
+		ret = append_json_uint64_value(output, "max",
+				cycles_to_ns(stats->max));
+	return ret;
+}
+
+/**
+ * Add histogram to given JSON object as pairs of upper bound in nano sec and
+ * num of samples of non-empty entries, such as `[ [ 206, 3 ], [ 213, 1 ] ]`.
+ * Upper bound of the last entry is the max, because it has all of latency
+ * larger than the range.
+ */
+static int
+append_latency_hist(char **output, const struct ring_latency_stats_t *stats)
+{
+	int ret;
+	int cnt, nof_ents = 0;
+	uint64_t upper;
+	char tmp_str[LATENCY_HIST_ENT_JSON_LEN];
+	char *hist_buff;
+
+	hist_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(hist_buff == NULL)) {
+		RTE_LOG(ERR, SPP_RING_LATENCY_STATS, "Failed to alloc buff.\n");
+		return SPPWK_RET_NG;
+	}
+
+	for (cnt = 0; cnt < TOTAL_LATENCY_ENT; cnt++) {
+		if (stats->distr[cnt] == 0)
 			continue;
 
-		sppwk_get_ring_latency_stats(ring_cnt, &stats[ring_cnt]);
-		printf(", %-18d", ring_cnt);
+		upper = latency_hist_upper(cnt);
+		if (cnt == TOTAL_LATENCY_ENT - 1)
+			upper = stats->max;
+		sprintf(tmp_str, "%s[ %"PRIu64", %"PRIu64" ]",
+				JSON_APPEND_COMMA(nof_ents),
+				cycles_to_ns(upper), stats->distr[cnt]);
+		hist_buff = spp_strbuf_append(hist_buff, tmp_str,
+				strlen(tmp_str));
+		if (unlikely(hist_buff == NULL)) {
+			RTE_LOG(ERR, SPP_RING_LATENCY_STATS,
+					"Failed to add entry of histogram.\n");
+			return SPPWK_RET_NG;
+		}
+		nof_ents++;
+	}
+
+	ret = append_json_uint64_value(output, "max",
+			cycles_to_ns(stats->max));
+	if (likely(ret == SPPWK_RET_OK))
+		ret = append_json_array_brackets(output, "hist", hist_buff);
+	spp_strbuf_free(hist_buff);
+	return ret;
+}
+
+/* Add entry of latency of each of ports measured in JSON. */
+static int
+append_port_latency_array(const char *name, char **output,
+		append_latency_f append_func)
+{
+	int ret = SPPWK_RET_OK;
+	int cnt;
+	char port_uid[CMD_TAG_APPEND_SIZE];
+	struct ring_latency_stats_t stats;
+	char *tmp_buff, *array_buff;
+
+	array_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(array_buff == NULL)) {
+		RTE_LOG(ERR, SPP_RING_LATENCY_STATS, "Failed to alloc buff.\n");
+		return SPPWK_RET_NG;
 	}
-	printf("\n");
 
-	for (stats_cnt = 0; stats_cnt < TOTAL_LATENCY_ENT;
-			stats_cnt++) {
-		printf("%3dns", stats_cnt);
-		for (ring_cnt = 0; ring_cnt < RTE_MAX_ETHPORTS; ring_cnt++) {
-			if (if_info->ring[ring_cnt].iface_type == UNDEF)
-				continue;
+	for (cnt = 0; cnt < LATENCY_STATS_PORT_TYPES * RTE_MAX_ETHPORTS;
+			cnt++) {
+		/* Ports never measured are not shown. */
+		sppwk_get_port_latency_stats(cnt / RTE_MAX_ETHPORTS,
+				cnt % RTE_MAX_ETHPORTS, &stats);
+		if (get_ring_latency_samples(&stats) == 0)
+			continue;
 
-			printf(", 0x%-16lx", stats[ring_cnt].distr[stats_cnt]);
+		tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+		if (unlikely(tmp_buff == NULL)) {
+			ret = SPPWK_RET_NG;
+			break;
 		}
-		printf("\n");
+
+		sppwk_port_uid(port_uid, cnt / RTE_MAX_ETHPORTS,
+				cnt % RTE_MAX_ETHPORTS);
+		ret = append_json_str_value(&tmp_buff, "port", port_uid);
+		if (likely(ret == SPPWK_RET_OK))
+			ret = append_func(&tmp_buff, &stats);
+		if (likely(ret == SPPWK_RET_OK))
+			ret = append_json_block_brackets(&array_buff, "",
+					tmp_buff);
+		spp_strbuf_free(tmp_buff);
+		if (unlikely(ret != SPPWK_RET_OK))
+			break;
 	}
+
+	if (likely(ret == SPPWK_RET_OK))
+		ret = append_json_array_brackets(output, name, array_buff);
+	spp_strbuf_free(array_buff);
+	return ret;
 }
 
-/* Wrapper function for rte_eth_rx_burst() with calc ring latency. */
+/* Add a pair of ingress and egress ports and its latency to JSON object. */
+static int
+append_e2e_latency_value(char **output, uint16_t tx_key,
+		const struct e2e_latency_path *path,
+		append_latency_f append_func)
+{
+	int ret;
+	char port_uid[CMD_TAG_APPEND_SIZE];
+
+	sppwk_port_uid(port_uid, path->rx_key >> E2E_PORT_NO_BITS,
+			path->rx_key & E2E_PORT_NO_MASK);
+	ret = append_json_str_value(output, "rx_port", port_uid);
+	if (likely(ret == SPPWK_RET_OK)) {
+		sppwk_port_uid(port_uid, tx_key >> E2E_PORT_NO_BITS,
+				tx_key & E2E_PORT_NO_MASK);
+		ret = append_json_str_value(output, "tx_port", port_uid);
+	}
+	if (likely(ret == SPPWK_RET_OK))
+		ret = append_func(output, &path->stats);
+	return ret;
+}
+
+/* Add entry of end-to-end latency of each pair of ports in JSON. */
+static int
+append_e2e_latency_array(const char *name, char **output,
+		append_latency_f append_func)
+{
+	int ret = SPPWK_RET_OK;
+	int port_id, cnt, nof_paths;
+	struct e2e_latency_info *info = NULL;
+	char *tmp_buff, *array_buff;
+
+	array_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(array_buff == NULL)) {
+		RTE_LOG(ERR, SPP_RING_LATENCY_STATS, "Failed to alloc buff.\n");
+		return SPPWK_RET_NG;
+	}
+
+	for (port_id = 0; port_id < RTE_MAX_ETHPORTS; port_id++) {
+		info = &g_e2e_info[port_id];
+		nof_paths = info->nof_paths;
+		rte_smp_rmb();
+		for (cnt = 0; cnt < nof_paths; cnt++) {
+			tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+			if (unlikely(tmp_buff == NULL)) {
+				ret = SPPWK_RET_NG;
+				break;
+			}
+
+			ret = append_e2e_latency_value(&tmp_buff, info->tx_key,
+					&info->paths[cnt], append_func);
+			if (likely(ret == SPPWK_RET_OK))
+				ret = append_json_block_brackets(&array_buff,
+						"", tmp_buff);
+			spp_strbuf_free(tmp_buff);
+			if (unlikely(ret != SPPWK_RET_OK))
+				break;
+		}
+		if (unlikely(ret != SPPWK_RET_OK))
+			break;
+	}
+
+	if (likely(ret == SPPWK_RET_OK))
+		ret = append_json_array_brackets(output, name, array_buff);
+	spp_strbuf_free(array_buff);
+	return ret;
+}
+
+/* Add entry of percentiles of latency of each of ports in JSON. */
+int
+add_port_latency_status(const char *name, char **output,
+		void *tmp __attribute__ ((unused)))
+{
+	return append_port_latency_array(name, output, append_latency_value);
+}
+
+/* Add entry of percentiles of end-to-end latency in JSON. */
+int
+add_e2e_latency_status(const char *name, char **output,
+		void *tmp __attribute__ ((unused)))
+{
+	return append_e2e_latency_array(name, output, append_latency_value);
+}
+
+/* Add entry of histograms of latency of each of ports in JSON. */
+int
+add_port_latency_hist(const char *name, char **output,
+		void *tmp __attribute__ ((unused)))
+{
+	return append_port_latency_array(name, output, append_latency_hist);
+}
+
+/* Add entry of histograms of end-to-end latency in JSON. */
+int
+add_e2e_latency_hist(const char *name, char **output,
+		void *tmp __attribute__ ((unused)))
+{
+	return append_e2e_latency_array(name, output, append_latency_hist);
+}
+
+/* Add entry of whether measuring latency is enabled in JSON. */
+int
+add_latency_stats_mode(const char *name, char **output,
+		void *tmp __attribute__ ((unused)))
+{
+	return append_json_str_value(output, name,
+			g_latency_enabled ? "on" : "off");
+}
+
+/* Wrapper function for rte_eth_rx_burst() as plain burst function. */
+uint16_t
+sppwk_eth_rx_burst(uint16_t port_id,
+		enum port_type iface_type __attribute__ ((unused)),
+		int iface_no __attribute__ ((unused)),
+		uint16_t queue_id __attribute__ ((unused)),
+		struct rte_mbuf **rx_pkts, const uint16_t nb_pkts)
+{
+	return rte_eth_rx_burst(port_id, 0, rx_pkts, nb_pkts);
+}
+
+/* Wrapper function for rte_eth_tx_burst() as plain burst function. */
 uint16_t
-sppwk_eth_ring_stats_rx_burst(uint16_t port_id,
+sppwk_eth_tx_burst(uint16_t port_id,
+		enum port_type iface_type __attribute__ ((unused)),
+		int iface_no __attribute__ ((unused)),
+		uint16_t queue_id __attribute__ ((unused)),
+		struct rte_mbuf **tx_pkts, const uint16_t nb_pkts)
+{
+	return rte_eth_tx_burst(port_id, 0, tx_pkts, nb_pkts);
+}
+
+/* Wrapper function for rte_eth_rx_burst() with latency stats. */
+uint16_t
+sppwk_eth_stats_rx_burst(uint16_t port_id,
 		enum port_type iface_type,
 		int iface_no,
 		uint16_t queue_id  __attribute__ ((unused)),
@@ -216,25 +791,35 @@ sppwk_eth_ring_stats_rx_burst(uint16_t port_id,
 		return SPPWK_RET_OK;
 
 	if (iface_type == RING)
-		sppwk_calc_ring_latency(iface_no, rx_pkts, nb_pkts);
+		sppwk_calc_ring_latency(iface_no, rx_pkts, nb_rx);
+	else
+		sppwk_add_e2e_latency_time(port_id, iface_type, iface_no,
+				rx_pkts, nb_rx);
 	return nb_rx;
 }
 
-/* Wrapper function for rte_eth_tx_burst() with calc ring latency. */
+/* Wrapper function for rte_eth_tx_burst() with latency stats. */
 uint16_t
-sppwk_eth_ring_stats_tx_burst(uint16_t port_id,
+sppwk_eth_stats_tx_burst(uint16_t port_id,
 		enum port_type iface_type,
 		int iface_no,
 		uint16_t queue_id __attribute__ ((unused)),
-		struct rte_mbuf **tx_pkts, uint16_t nb_pkts)
+		struct rte_mbuf **tx_pkts, const uint16_t nb_pkts)
 {
 	uint16_t nb_tx;
+	uint64_t start;
 
-	nb_tx = rte_eth_tx_burst(port_id, 0, tx_pkts, nb_pkts);
-
-	if (iface_type == RING)
+	/* Packets should not be referred after sent. */
+	if (iface_type == RING) {
 		sppwk_add_ring_latency_time(iface_no, tx_pkts, nb_pkts);
+		return rte_eth_tx_burst(port_id, 0, tx_pkts, nb_pkts);
+	}
+
+	sppwk_calc_e2e_latency(port_id, iface_type, iface_no, tx_pkts,
+			nb_pkts);
+	start = sppwk_start_tx_burst_time(iface_type, iface_no);
+	nb_tx = rte_eth_tx_burst(port_id, 0, tx_pkts, nb_pkts);
+	if (unlikely(start != 0))
+		sppwk_calc_tx_burst_time(iface_type, iface_no, start);
 	return nb_tx;
 }
-
-#endif /* SPP_RINGLATENCYSTATS_ENABLE */
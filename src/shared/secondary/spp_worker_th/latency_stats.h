@@ -7,45 +7,246 @@
 
 /**
  * @file
- * SPP RING latency statistics
+ * SPP latency statistics of ports
  *
- * Util functions for measuring latency of ring-PMD.
+ * Util functions for measuring latency of ports. It is latency of packets in
+ * the ring for ring-PMD, and time taken by a TX burst for phy and vhost, which
+ * is mostly in rte_vhost_enqueue_burst() for vhost. Statistics are kept for
+ * each of ports and shown with port UID such as `vhost:1`.
  */
 
 #include <rte_mbuf.h>
 #include "cmd_utils.h"
 
 /**
- * Statistics of latency of ring is counted with histgram like data structure.
- * To count frequency of each of time in nano sec, this data is implemented as
- * an array in which frequency counts of 1-100[ns] are contained. If the
- * latency is larger than 100[ns], it is added to the last entry. It means
- * this array has 101 entries, 100 entries for 1-100[ns] and 1 entry for over
- * 100[ns].
+ * Statistics of latency of port is counted with a log-linear histogram of
+ * TSC cycles, which covers from a few nano sec to over 10 milli sec with
+ * relative error of 1 / LATENCY_HIST_SUB_CNT.
+ *
+ * Entries are grouped by the most significant bit of latency. The first group
+ * has entries of 0 to LATENCY_HIST_SUB_CNT - 1 cycles in steps of 1 cycle.
+ * Group `g` has LATENCY_HIST_SUB_CNT entries of
+ * [LATENCY_HIST_SUB_CNT << (g - 1), LATENCY_HIST_SUB_CNT << g) in steps of
+ * 1 << (g - 1) cycles. Time of TX burst larger than the range is added to
+ * the last entry. Latency of packets larger than it is not counted, because
+ * it is of a stale stamp such as one remained in a reused mbuf, or given by
+ * other processes. Index of an entry is calculated only with shifts.
  */
-#define TOTAL_LATENCY_ENT 101
+#define LATENCY_HIST_SUB_BITS 5
+#define LATENCY_HIST_SUB_CNT (1 << LATENCY_HIST_SUB_BITS)
+#define LATENCY_HIST_SUB_MASK (LATENCY_HIST_SUB_CNT - 1)
+
+/* 2^26 cycles is over 10 milli sec for TSC of 6GHz or less. */
+#define LATENCY_HIST_MAX_BITS 26
+#define LATENCY_HIST_RANGE (1ULL << LATENCY_HIST_MAX_BITS)
 
-/** statistics of latency of ring */
+#define TOTAL_LATENCY_ENT \
+	((LATENCY_HIST_MAX_BITS - LATENCY_HIST_SUB_BITS + 1) << \
+	 LATENCY_HIST_SUB_BITS)
+
+/** statistics of latency of port */
 struct ring_latency_stats_t {
-	uint64_t distr[TOTAL_LATENCY_ENT]; /* distribution of time */
+	uint64_t distr[TOTAL_LATENCY_ENT]; /* distribution of cycles */
+	uint64_t max;  /* max latency in cycles */
+};
+
+/**
+ * Get index of histogram entry for given latency.
+ *
+ * @param cycles Latency in TSC cycles.
+ * @return Index of entry in `distr` of struct ring_latency_stats_t.
+ */
+static inline unsigned int
+latency_hist_index(uint64_t cycles)
+{
+	unsigned int shift;
+
+	if (cycles < LATENCY_HIST_SUB_CNT)
+		return cycles;
+	if (unlikely(cycles >= (1ULL << LATENCY_HIST_MAX_BITS)))
+		return TOTAL_LATENCY_ENT - 1;
+
+	/* Num of low bits dropped for the group of the MSB. */
+	shift = 63 - __builtin_clzll(cycles) - LATENCY_HIST_SUB_BITS;
+	return ((shift + 1) << LATENCY_HIST_SUB_BITS) +
+		((cycles >> shift) & LATENCY_HIST_SUB_MASK);
+}
+
+/**
+ * Get the largest latency counted in given entry of histogram.
+ *
+ * @param index Index of entry.
+ * @return Latency in TSC cycles.
+ */
+static inline uint64_t
+latency_hist_upper(unsigned int index)
+{
+	unsigned int group = index >> LATENCY_HIST_SUB_BITS;
+	uint64_t sub = index & LATENCY_HIST_SUB_MASK;
+
+	if (group == 0)
+		return sub;
+	return ((LATENCY_HIST_SUB_CNT + sub + 1) << (group - 1)) - 1;
+}
+
+/**
+ * End-to-end latency in the host is measured from the first ingress of
+ * a packet on phy or vhost port to the final egress on phy or vhost port.
+ * One of every `samp_rate` packets of ingress is stamped with its ingress port
+ * and TSC in `udata64` of mbuf, because dynamic field of mbuf is not supported
+ * in DPDK 19.08. It is 0 for packets not sampled. The stamp is kept while the
+ * packet is passed through ring ports, even of other SPP processes.
+ *
+ * Upper 8 bits of the stamp are E2E_STAMP_MAGIC, next 16 bits are the ingress
+ * port as `(iface_type << 12) | iface_no`, and the rest is lower bits of TSC.
+ * A stamp remained in a reused mbuf, such as one received by spp_nfv, is not
+ * counted if its latency is over the range of histogram. Ports of which
+ * iface_no is over E2E_PORT_NO_MASK are not measured.
+ */
+#define E2E_STAMP_MAGIC 0xe2ULL
+#define E2E_STAMP_MAGIC_SHIFT 56
+#define E2E_STAMP_KEY_SHIFT 40
+#define E2E_STAMP_KEY_MASK 0xffff
+#define E2E_STAMP_TSC_BITS E2E_STAMP_KEY_SHIFT
+#define E2E_STAMP_TSC_MASK ((1ULL << E2E_STAMP_TSC_BITS) - 1)
+#define E2E_PORT_NO_BITS 12
+#define E2E_PORT_NO_MASK ((1 << E2E_PORT_NO_BITS) - 1)
+
+/* Max num of ingress ports counted for each of egress ports. */
+#define E2E_LATENCY_MAX_PATHS 4
+
+/**
+ * Burst function of a port. Latency is measured only while burst functions
+ * of ports are swapped with instrumented ones, so that no branch is added
+ * to the path of packets while it is disabled.
+ */
+typedef uint16_t (*sppwk_burst_f)(uint16_t port_id,
+		enum port_type iface_type, int iface_no, uint16_t queue_id,
+		struct rte_mbuf **pkts, const uint16_t nb_pkts);
+
+/* A pair of RX and TX burst functions. */
+struct sppwk_burst_ops {
+	sppwk_burst_f rx_func;
+	sppwk_burst_f tx_func;
 };
 
+/* Burst functions of each of ports indexed by etherdev ID. */
+extern struct sppwk_burst_ops g_port_burst[RTE_MAX_ETHPORTS];
+
+/**
+ * Receive packets with burst function of the port.
+ *
+ * @param[in] port_id Etherdev ID.
+ * @param[in] iface_type Type of port.
+ * @param[in] iface_no Port ID of the type.
+ * @param[in] rx_pkts Pointers to mbuf should be enough to store nb_pkts.
+ * @param nb_pkts Maximum number of RX packets.
+ * @return Number of RX packets as number of pointers to mbuf.
+ */
+static inline uint16_t
+sppwk_port_rx_burst(uint16_t port_id, enum port_type iface_type,
+		int iface_no, struct rte_mbuf **rx_pkts, const uint16_t nb_pkts)
+{
+	return g_port_burst[port_id].rx_func(port_id, iface_type, iface_no, 0,
+			rx_pkts, nb_pkts);
+}
+
+/**
+ * Send packets with burst function of the port.
+ *
+ * @param[in] port_id Etherdev ID.
+ * @param[in] iface_type Type of port.
+ * @param[in] iface_no Port ID of the type.
+ * @param[in] tx_pkts Pointers to mbuf should be enough to store nb_pkts.
+ * @param nb_pkts Maximum number of TX packets.
+ * @return Number of TX packets as number of pointers to mbuf.
+ */
+static inline uint16_t
+sppwk_port_tx_burst(uint16_t port_id, enum port_type iface_type,
+		int iface_no, struct rte_mbuf **tx_pkts, uint16_t nb_pkts)
+{
+	return g_port_burst[port_id].tx_func(port_id, iface_type, iface_no, 0,
+			tx_pkts, nb_pkts);
+}
+
+/**
+ * Set burst functions of all ports to given plain ones, and keep
+ * instrumented ones for measuring latency.
+ *
+ * @param plain Burst functions without measuring latency.
+ * @param stats Burst functions with measuring latency.
+ */
+void sppwk_init_port_burst(const struct sppwk_burst_ops *plain,
+		const struct sppwk_burst_ops *stats);
+
+/**
+ * Enable or disable measuring latency by swapping burst functions of ports.
+ * Statistics are cleared when enabled.
+ *
+ * @param enable 1 for enabling, or 0 for disabling.
+ * @retval SPPWK_RET_OK: succeeded.
+ * @retval SPPWK_RET_NG: failed.
+ */
+int sppwk_set_latency_stats(int enable);
+
+/**
+ * Check if measuring latency is enabled.
+ *
+ * @return 1 if enabled, or 0.
+ */
+int sppwk_is_latency_stats_enabled(void);
 
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
 /**
- * initialize ring latency statistics.
+ * Initialize latency statistics of phy, ring and vhost ports.
  *
  * @param samp_intvl
  *  The interval timer(ns) to refer the counter.
- * @param stats_count
- *  The number of ring to be measured.
  *
  * @retval SPPWK_RET_OK: succeeded.
  * @retval SPPWK_RET_NG: failed.
  */
-int sppwk_init_ring_latency_stats(uint64_t samp_intvl, uint16_t stats_count);
+int sppwk_init_port_latency_stats(uint64_t samp_intvl);
+
+/* Release latency statistics of ports and end-to-end latency. */
+void sppwk_clean_latency_stats(void);
+
+/**
+ * Initialize end-to-end latency statistics.
+ *
+ * @param samp_rate One of `samp_rate` packets of ingress is measured.
+ * @retval SPPWK_RET_OK: succeeded.
+ * @retval SPPWK_RET_NG: failed.
+ */
+int sppwk_init_e2e_latency_stats(uint32_t samp_rate);
+
+/**
+ * Stamp sampled packets of ingress on phy or vhost port.
+ *
+ * @note call at dequeue.
+ *
+ * @param port_id Etherdev ID.
+ * @param iface_type Type of port.
+ * @param iface_no Port ID of the type.
+ * @param pkts Pointer to nb_pkts rte_mbuf containing packets.
+ * @param nb_pkts Num of packets.
+ */
+void sppwk_add_e2e_latency_time(uint16_t port_id, enum port_type iface_type,
+		int iface_no, struct rte_mbuf **pkts, uint16_t nb_pkts);
 
-void sppwk_clean_ring_latency_stats(void);
+/**
+ * Calculate end-to-end latency of stamped packets of egress on phy or vhost
+ * port. It is counted for each pair of ingress and egress ports.
+ *
+ * @note call before enqueue.
+ *
+ * @param port_id Etherdev ID.
+ * @param iface_type Type of port.
+ * @param iface_no Port ID of the type.
+ * @param pkts Pointer to nb_pkts rte_mbuf containing packets.
+ * @param nb_pkts Num of packets.
+ */
+void sppwk_calc_e2e_latency(uint16_t port_id, enum port_type iface_type,
+		int iface_no, struct rte_mbuf **pkts, uint16_t nb_pkts);
 
 /**
  * add time-stamp to mbuf's member.
@@ -72,28 +273,148 @@ void sppwk_calc_ring_latency(int ring_id,
 		struct rte_mbuf **pkts, uint16_t nb_pkts);
 
 /**
- * get number of ring latency statistics.
+ * Get start time of TX burst of phy or vhost port if it is sampled.
+ *
+ * @note call just before TX burst.
+ *
+ * @param iface_type Type of port.
+ * @param iface_no Port ID of the type.
+ * @return TSC, or 0 if the burst is not sampled.
+ */
+uint64_t sppwk_start_tx_burst_time(enum port_type iface_type, int iface_no);
+
+/**
+ * Count time taken by sampled TX burst of phy or vhost port.
  *
- * @return sppwk_init_ring_latency_stats's parameter "stats_count"
+ * @note call just after TX burst if sppwk_start_tx_burst_time() returned
+ * non-zero.
+ *
+ * @param iface_type Type of port.
+ * @param iface_no Port ID of the type.
+ * @param start TSC returned from sppwk_start_tx_burst_time().
  */
-int sppwk_get_ring_latency_stats_count(void);
+void sppwk_calc_tx_burst_time(enum port_type iface_type, int iface_no,
+		uint64_t start);
 
 /**
- *get specific ring latency statistics.
+ * Get latency statistics of given port.
  *
- * @param ring_id
- *  The ring id.
- * @param stats
- *  The statistics values.
+ * @param iface_type Type of port.
+ * @param iface_no Port ID of the type.
+ * @param stats The statistics values.
+ * @retval SPPWK_RET_OK: succeeded.
+ * @retval SPPWK_RET_NG: the port is not measured.
  */
-void sppwk_get_ring_latency_stats(int ring_id,
+int sppwk_get_port_latency_stats(enum port_type iface_type, int iface_no,
 		struct ring_latency_stats_t *stats);
 
-/* Print statistics of time for packet processing in ring interface */
-void print_ring_latency_stats(struct iface_info *if_info);
+/**
+ * Get latency of given percentile from latency statistics.
+ *
+ * @param stats The statistics values.
+ * @param per_10k Percentile in units of 0.01%, such as 9990 for p99.9.
+ * @return Latency in nano sec, or 0 if no packet is measured.
+ */
+uint64_t sppwk_get_ring_latency_percentile(
+		const struct ring_latency_stats_t *stats, unsigned int per_10k);
+
+/**
+ * Add entry of percentiles of latency of each of ports to a response in
+ * JSON. Latency is in nano sec.
+ *
+ * @param[in] name Name of the entry.
+ * @param[in,out] output Placeholder of JSON msg.
+ * @param tmp Not used.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int add_port_latency_status(const char *name, char **output,
+		void *tmp __attribute__ ((unused)));
+
+/**
+ * Add entry of percentiles of end-to-end latency of each pair of ingress and
+ * egress ports to a response in JSON. Latency is in nano sec.
+ *
+ * @param[in] name Name of the entry.
+ * @param[in,out] output Placeholder of JSON msg.
+ * @param tmp Not used.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int add_e2e_latency_status(const char *name, char **output,
+		void *tmp __attribute__ ((unused)));
+
+/**
+ * Add entry of histograms of latency of each of ports to a response in JSON.
+ * Histogram is an array of pairs of upper bound of latency in nano sec and
+ * num of packets, and empty entries are omitted.
+ *
+ * @param[in] name Name of the entry.
+ * @param[in,out] output Placeholder of JSON msg.
+ * @param tmp Not used.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int add_port_latency_hist(const char *name, char **output,
+		void *tmp __attribute__ ((unused)));
+
+/**
+ * Add entry of histograms of end-to-end latency of each pair of ingress and
+ * egress ports to a response in JSON. The format of histogram is the same as
+ * add_port_latency_hist().
+ *
+ * @param[in] name Name of the entry.
+ * @param[in,out] output Placeholder of JSON msg.
+ * @param tmp Not used.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int add_e2e_latency_hist(const char *name, char **output,
+		void *tmp __attribute__ ((unused)));
+
+/**
+ * Add entry of whether measuring latency is enabled, such as
+ * `"latency_stats": "on"`, to a response in JSON.
+ *
+ * @param[in] name Name of the entry.
+ * @param[in,out] output Placeholder of JSON msg.
+ * @param tmp Not used.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int add_latency_stats_mode(const char *name, char **output,
+		void *tmp __attribute__ ((unused)));
+
+/**
+ * Wrapper function for rte_eth_rx_burst() to be a plain burst function.
+ *
+ * @param[in] port_id Etherdev ID.
+ * @param[in] queue_id RX queue ID, but fixed value 0 in SPP.
+ * @param[in] rx_pkts Pointers to mbuf should be enough to store nb_pkts.
+ * @param nb_pkts Maximum number of RX packets.
+ * @return Number of RX packets as number of pointers to mbuf.
+ */
+uint16_t sppwk_eth_rx_burst(uint16_t port_id,
+		enum port_type iface_type,
+		int iface_no, uint16_t queue_id,
+		struct rte_mbuf **rx_pkts, const uint16_t nb_pkts);
+
+/**
+ * Wrapper function for rte_eth_tx_burst() to be a plain burst function.
+ *
+ * @param port_id Etherdev ID.
+ * @param[in] queue_id TX queue ID, but fixed value 0 in SPP.
+ * @param[in] tx_pkts Pointers to mbuf should be enough to store nb_pkts.
+ * @param nb_pkts Maximum number of TX packets.
+ * @return Number of TX packets as number of pointers to mbuf.
+ */
+uint16_t sppwk_eth_tx_burst(uint16_t port_id,
+		enum port_type iface_type,
+		int iface_no, uint16_t queue_id,
+		struct rte_mbuf **tx_pkts, const uint16_t nb_pkts);
 
 /**
- * Wrapper function for rte_eth_rx_burst() with ring latency feature.
+ * Wrapper function for rte_eth_rx_burst() with latency stats.
  *
  * @param[in] port_id Etherdev ID.
  * @param[in] queue_id RX queue ID, but fixed value 0 in SPP.
@@ -101,13 +422,13 @@ void print_ring_latency_stats(struct iface_info *if_info);
  * @param nb_pkts Maximum number of RX packets.
  * @return Number of RX packets as number of pointers to mbuf.
  */
-uint16_t sppwk_eth_ring_stats_rx_burst(uint16_t port_id,
+uint16_t sppwk_eth_stats_rx_burst(uint16_t port_id,
 		enum port_type iface_type,
 		int iface_no, uint16_t queue_id,
 		struct rte_mbuf **rx_pkts, const uint16_t nb_pkts);
 
 /**
- * Wrapper function for rte_eth_tx_burst() with ring latency feature.
+ * Wrapper function for rte_eth_tx_burst() with latency stats.
  *
  * @param port_id Etherdev ID.
  * @param[in] queue_id TX queue ID, but fixed value 0 in SPP.
@@ -115,13 +436,13 @@ uint16_t sppwk_eth_ring_stats_rx_burst(uint16_t port_id,
  * @param nb_pkts Maximum number of TX packets.
  * @return Number of TX packets as number of pointers to mbuf.
  */
-uint16_t sppwk_eth_ring_stats_tx_burst(uint16_t port_id,
+uint16_t sppwk_eth_stats_tx_burst(uint16_t port_id,
 		enum port_type iface_type,
 		int iface_no, uint16_t queue_id,
-		struct rte_mbuf **tx_pkts, uint16_t nb_pkts);
+		struct rte_mbuf **tx_pkts, const uint16_t nb_pkts);
 
 /**
- * Wrapper function for rte_eth_rx_burst() with VLAN and ring latency feature.
+ * Wrapper function for rte_eth_rx_burst() with VLAN and latency stats.
  *
  * @param[in] port_id Etherdev ID.
  * @param[in] queue_id RX queue ID, but fixed value 0 in SPP.
@@ -129,13 +450,13 @@ uint16_t sppwk_eth_ring_stats_tx_burst(uint16_t port_id,
  * @param nb_pkts Maximum number of RX packets.
  * @return Number of RX packets as number of pointers to mbuf.
  */
-uint16_t sppwk_eth_vlan_ring_stats_rx_burst(uint16_t port_id,
+uint16_t sppwk_eth_vlan_stats_rx_burst(uint16_t port_id,
 		enum port_type iface_type,
 		int iface_no, uint16_t queue_id,
 		struct rte_mbuf **rx_pkts, const uint16_t nb_pkts);
 
 /**
- * Wrapper function for rte_eth_tx_burst() with VLAN and ring latency feature.
+ * Wrapper function for rte_eth_tx_burst() with VLAN and latency stats.
  *
  * @param port_id Etherdev ID.
  * @param[in] queue_id TX queue ID, but fixed value 0 in SPP.
@@ -143,25 +464,9 @@ uint16_t sppwk_eth_vlan_ring_stats_rx_burst(uint16_t port_id,
  * @param nb_pkts Maximum number of TX packets.
  * @return Number of TX packets as number of pointers to mbuf.
  */
-uint16_t sppwk_eth_vlan_ring_stats_tx_burst(uint16_t port_id,
+uint16_t sppwk_eth_vlan_stats_tx_burst(uint16_t port_id,
 		enum port_type iface_type,
 		int iface_no, uint16_t queue_id,
-		struct rte_mbuf **tx_pkts, uint16_t nb_pkts);
-
-#else
-
-#define sppwk_init_ring_latency_stats(arg1, arg2) 0
-#define sppwk_clean_ring_latency_stats()
-#define sppwk_add_ring_latency_time(arg1, arg2, arg3)
-#define sppwk_calc_ring_latency(arg1, arg2, arg3)
-#define sppwk_get_ring_latency_stats_count() 0
-#define sppwk_get_ring_latency_stats(arg1, arg2)
-#define print_ringlatencystats_stats(arg)
-#define sppwk_eth_ring_stats_rx_burst(arg1, arg2, arg3, arg4, arg5, arg6)
-#define sppwk_eth_ring_stats_tx_burst(arg1, arg2, arg3, arg4, arg5, arg6)
-#define sppwk_eth_vlan_ring_stats_rx_burst(arg1, arg2, arg3, arg4, arg5, arg6)
-#define sppwk_eth_vlan_ring_stats_tx_burst(arg1, arg2, arg3, arg4, arg5, arg6)
-
-#endif /* SPP_RINGLATENCYSTATS_ENABLE */
+		struct rte_mbuf **tx_pkts, const uint16_t nb_pkts);
 
 #endif /* _RINGLATENCYSTATS_H_ */
@@ -12,7 +12,7 @@
 #define SPPWK_PROC_TYPE "mirror"
 
 /* Num of entries of ops_list in mir_cmd_runner.c. */
-#define NOF_STAT_OPS 7
+#define NOF_STAT_OPS 14
 
 int exec_one_cmd(const struct sppwk_cmd_attrs *cmd);
 
@@ -28,6 +28,16 @@ int add_core(const char *name, char **output,
  */
 int update_mirror(struct sppwk_comp_info *wk_comp_info);
 
+/**
+ * Check if updated info of component is taken by its lcore, used for
+ * waiting for all of updated components in sppwk_wait_update_done().
+ *
+ * @param comp_id Component ID.
+ * @retval 1 If it is taken, or nothing is published.
+ * @retval 0 If it is not taken yet.
+ */
+int is_comp_update_done(int comp_id);
+
 /**
  * Activate temporarily stored component info while flushing.
  *
@@ -7,12 +7,25 @@
 #include <rte_udp.h>
 #include <rte_tcp.h>
 #include <rte_net_crc.h>
+#include <rte_prefetch.h>
+#include <rte_cycles.h>
+#include <rte_meter.h>
+#include <rte_sched.h>
+#include <rte_hash_crc.h>
+#include <netinet/in.h>
+
+#ifdef RTE_ARCH_X86
+#include <rte_cpuflags.h>
+#include <immintrin.h>
+#endif
 
 #include "port_capability.h"
 #include "shared/secondary/return_codes.h"
 
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
 #include "latency_stats.h"
+
+#ifdef SPP_VF_MODULE
+#include "ring_fusion.h"
 #endif
 
 /**
@@ -26,45 +39,234 @@
  * This problem should be fixed in a future update.
  */
 
-/* Port capability management information used as a member of port_mng_info. */
+/**
+ * Function for VLAN op of a burst. It returns num of processed packets, and
+ * packets from the index are discarded.
+ */
+typedef int (*vlan_f)(
+		struct rte_mbuf **pkts, int nb_pkts,
+		const union sppwk_port_capability *capability);
+
+/* Type of action compiled from port attrs. */
+enum port_act_type {
+	PORT_ACT_PUSH_VLAN,  /* Add VLAN tag, or update TCI if tagged. */
+	PORT_ACT_PUSH_VLAN_HW,  /* Add VLAN tag with TX VLAN insert. */
+	PORT_ACT_POP_VLAN,  /* Delete VLAN tag. */
+	PORT_ACT_POP_VLAN_HW,  /* Delete VLAN tag if not stripped by NIC. */
+	PORT_ACT_PUSH_QINQ,  /* Add outer tag of QinQ. */
+	PORT_ACT_PUSH_QINQ_HW,  /* Add outer tag with TX QinQ insert. */
+	PORT_ACT_POP_QINQ,  /* Delete outer tag of QinQ. */
+	PORT_ACT_SET_SRC_MAC,  /* Rewrite source MAC address. */
+	PORT_ACT_SET_DST_MAC,  /* Rewrite destination MAC address. */
+	PORT_ACT_SET_PCP,  /* Remark PCP of the first tag. */
+	PORT_ACT_SET_DSCP,  /* Remark DSCP of IPv4 or IPv6. */
+	PORT_ACT_DEC_TTL,  /* Decrement TTL or hop limit. */
+	PORT_ACT_METER,  /* Police packets with meter of the port. */
+	PORT_ACT_ENCAP_VXLAN,  /* Prepend outer headers of VXLAN. */
+	PORT_ACT_DECAP_VXLAN,  /* Strip outer headers of VXLAN. */
+};
+
+/* Action compiled from port attrs, of which values are ready to be written. */
+struct port_act {
+	enum port_act_type type;
+	uint16_t tpid;  /* TPID in network byte order. */
+	uint16_t tci;  /* TCI, or PCP shifted for TCI, in network byte order. */
+	uint8_t dscp;  /* DSCP. */
+	struct rte_ether_addr mac;  /* MAC address for rewriting. */
+	enum sppwk_meter_red_act red_act;  /* Drop or mark red packets. */
+	uint16_t udp_port;  /* UDP port of VXLAN in network byte order. */
+};
+
+/**
+ * Meter compiled from port attrs. Profile is fixed while the port is not
+ * updated, and state of token buckets is updated by the lcore of the port.
+ */
+struct port_meter {
+	enum sppwk_meter_type type;
+	union {
+		struct rte_meter_srtcm_profile srtcm;
+		struct rte_meter_trtcm_profile trtcm;
+	} prof;
+	union {
+		struct rte_meter_srtcm srtcm;
+		struct rte_meter_trtcm trtcm;
+	} state;
+};
+
+/* Outer headers of VXLAN, which are prepended to a packet with one copy. */
+struct vxlan_outer_hdrs {
+	struct rte_ether_hdr eth;
+	struct rte_ipv4_hdr ipv4;
+	struct rte_udp_hdr udp;
+	struct rte_vxlan_hdr vxlan;
+} __attribute__((__packed__));
+
+/**
+ * VXLAN compiled from port attrs. Headers are built as a template of which
+ * lengths are zero, and lengths, source port of UDP and checksum are only
+ * updated for each packet.
+ */
+struct port_vxlan {
+	struct vxlan_outer_hdrs hdrs;  /* Template of outer headers. */
+	int cksum_offload;  /* 1 if IPv4 checksum is calculated by NIC. */
+};
+
+/**
+ * List of actions compiled from port attrs of a direction. Actions are run
+ * for each packet in one pass, or the burst function is called instead if
+ * the port has only one VLAN op.
+ */
+struct port_act_prog {
+	int nof_acts;  /* Num of actions, or 0 if nothing to do. */
+	int fcs;  /* 1 if FCS is recalculated after all of actions. */
+	vlan_f burst_f;  /* Burst function of VLAN op, or NULL. */
+	const union sppwk_port_capability *burst_cap;  /* Arg of burst_f. */
+	int has_meter;  /* 1 if meter is included in actions. */
+	struct port_meter meter;  /* Meter of the port if has_meter. */
+	struct rte_sched_port *sched;  /* Shaper of TX port, or NULL. */
+	struct port_vxlan vxlan;  /* Outer headers if it has VXLAN encap. */
+	struct port_act acts[PORT_CAPABL_MAX];
+};
+
+/**
+ * Port capability management information used as a member of port_mng_info.
+ * Attrs of generation `gen` are in side PORT_GEN_SIDE(gen). Master writes
+ * the side next to the one taken by lcore and publishes it as `upd_gen`,
+ * then the lcore of the component using the port takes it as `ref_gen` when
+ * it takes updated info of the component. Each of them is written by only
+ * one thread, because a port of a direction is used by only one component.
+ */
 struct port_capabl_mng_info {
-	/* TODO(yasufum) rename ref_index and upd_index because flag. */
-	/* TODO(yasufum) consider to not use two flags for (0,1) and (1,0). */
-	volatile int ref_index; /* Flag to indicate using reference side. */
-	volatile int upd_index; /* Flag to indicate using update side. */
+	volatile uint32_t upd_gen;  /* Generation published by master. */
+	volatile uint32_t ref_gen;  /* Generation taken by lcore. */
 
 	/* A set of attrs including sppwk_port_capability. */
 	/* TODO(yasufum) confirm why using PORT_CAPABL_MAX. */
 	struct sppwk_port_attrs port_attrs[TWO_SIDES][PORT_CAPABL_MAX];
+
+	/* Actions compiled from port_attrs of each side. */
+	struct port_act_prog progs[TWO_SIDES];
+
+	/* Num of packets colored by meter, updated for each burst. */
+	uint64_t nof_colored[RTE_COLORS];
+};
+
+/**
+ * Shaper of TX port with rte_sched. Scheduler is kept while its params are
+ * not changed. Replaced one is drained by the lcore taking updated info, and
+ * freed at the end of flush because it is referred until then.
+ */
+struct port_shaper {
+	struct rte_sched_port *sched;  /* Scheduler, or NULL if not shaped. */
+	struct rte_sched_port *retired;  /* Scheduler replaced at last. */
+	struct sppwk_shaper params;  /* Params of sched. */
+	unsigned int nof_created;  /* Num of created for unique name. */
+	uint64_t stats_period;  /* Interval of reading stats in TSC. */
+	uint64_t stats_tsc;  /* TSC of reading stats at last. */
+	struct sppwk_shaper_stats stats;  /* Stats accumulated by lcore. */
 };
 
 /* Port ability port information */
 struct port_mng_info {
 	enum port_type iface_type;  /* Interface type (phy, vhost or so). */
 	int iface_no;  /* Interface number. */
+	uint16_t hw_qinq_tpid;  /* Outer TPID set to NIC by SPP, or 0. */
 	struct port_capabl_mng_info rx;  /* Mng data of capability for RX. */
 	struct port_capabl_mng_info tx;  /* Mng data of capability for Tx. */
+	struct port_shaper shaper;  /* Shaper of TX. */
 };
 
 /* Information for VLAN tag management. */
 struct port_mng_info g_port_mng_info[RTE_MAX_ETHPORTS];
 
-/* TPID of VLAN. */
-static uint16_t g_vlan_tpid;
+/* TPID of VLAN in network byte order. */
+#define VLAN_TPID_BE RTE_BE16(RTE_ETHER_TYPE_VLAN)
+
+/* Offset of ether type following VLAN tag, or inner one of tagged packet. */
+#define VLAN_INNER_TYPE_OFS \
+	(2 * RTE_ETHER_ADDR_LEN + sizeof(struct rte_vlan_hdr))
+
+/* Frequency of reading stats of shaper from rte_sched per second. */
+#define SHAPER_STATS_HZ 10
+
+/* Size of token bucket of subport and pipe of shaper in bytes. */
+#define SHAPER_TB_SIZE 1000000
+
+/* Period of refilling credits of traffic classes of shaper in msec. */
+#define SHAPER_TC_PERIOD 10
+
+/**
+ * Traffic class of shaper for PCP. Higher PCP is sent first with strict
+ * priority, and PCP 0 or untagged is best effort.
+ */
+#define SHAPER_TC(pcp) \
+	((pcp) == 0 ? RTE_SCHED_TRAFFIC_CLASS_BE : (uint32_t)(7 - (pcp)))
+
+/* Num of packets of which ether types are classified at once. */
+#define VLAN_BURST_CHUNK 16
+
+/* Side of two sides of port attrs for given generation. */
+#define PORT_GEN_SIDE(gen) ((gen) % TWO_SIDES)
+
+/* Version and IHL of outer IPv4 header of VXLAN without options. */
+#define VXLAN_IPV4_VHL \
+	(0x40 | (sizeof(struct rte_ipv4_hdr) / RTE_IPV4_IHL_MULTIPLIER))
 
-/* Initialize g_port_mng_info, and set ref side to 0 and update side to 1. */
+/* TTL of outer IPv4 header of VXLAN. */
+#define VXLAN_IPV4_TTL 64
+
+/**
+ * Source port of outer UDP header of VXLAN is taken from the range of
+ * dynamic ports as recommended in RFC 7348.
+ */
+#define VXLAN_SRC_PORT_MIN 0xc000
+#define VXLAN_SRC_PORT_MASK 0x3fff
+
+/* Length of inner headers for hash, including L4 ports of IPv4. */
+#define VXLAN_INNER_HASH_LEN \
+	(RTE_ETHER_HDR_LEN + sizeof(struct rte_ipv4_hdr) + 2 * sizeof(uint16_t))
+
+/**
+ * Function for classifying packets. It returns a bitmask of packets of which
+ * ether type is given TPID in network byte order, and num of packets should
+ * be VLAN_BURST_CHUNK or less.
+ */
+typedef uint32_t (*vlan_classify_f)(struct rte_mbuf **pkts, int nb_pkts,
+		uint16_t tpid);
+
+static uint32_t classify_vlan_pkts_default(struct rte_mbuf **pkts,
+		int nb_pkts, uint16_t tpid);
+#ifdef RTE_ARCH_X86
+static __attribute__ ((target("avx2"))) uint32_t
+classify_vlan_pkts_avx2(struct rte_mbuf **pkts, int nb_pkts, uint16_t tpid);
+#endif
+
+/* Classifier selected for the CPU in sppwk_port_capability_init(). */
+static vlan_classify_f classify_vlan_pkts = classify_vlan_pkts_default;
+
+/* Length of headers copied to a private mbuf for a shared packet. */
+#define UNSHARE_HDR_LEN 128
+
+/* Pool of mbufs for private headers of shared packets. */
+static struct rte_mempool *g_hdr_pool;
+
+/* Initialize g_port_mng_info, and generation of all ports to 0. */
 void
 sppwk_port_capability_init(void)
 {
-	int cnt = 0;
-	g_vlan_tpid = rte_cpu_to_be_16(RTE_ETHER_TYPE_VLAN);
 	memset(g_port_mng_info, 0x00, sizeof(g_port_mng_info));
-	for (cnt = 0; cnt < RTE_MAX_ETHPORTS; cnt++) {
-		g_port_mng_info[cnt].rx.ref_index = 0;
-		g_port_mng_info[cnt].rx.upd_index = 1;
-		g_port_mng_info[cnt].tx.ref_index = 0;
-		g_port_mng_info[cnt].tx.upd_index = 1;
+
+	g_hdr_pool = rte_mempool_lookup(PKTMBUF_POOL_NAME);
+	if (unlikely(g_hdr_pool == NULL))
+		RTE_LOG(ERR, PORT, "Cannot find mempool %s.\n",
+				PKTMBUF_POOL_NAME);
+
+#ifdef RTE_ARCH_X86
+	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2) > 0) {
+		classify_vlan_pkts = classify_vlan_pkts_avx2;
+		RTE_LOG(DEBUG, PORT, "Use AVX2 for classifying VLAN.\n");
 	}
+#endif
 }
 
 /* Get port attributes of given ID and direction from g_port_mng_info. */
@@ -86,10 +288,42 @@ sppwk_get_port_attrs(struct sppwk_port_attrs **p_attrs,
 		break;
 	}
 
-	*p_attrs = mng->port_attrs[mng->ref_index];
+	/* Master refers the latest one written by itself. */
+	*p_attrs = mng->port_attrs[PORT_GEN_SIDE(mng->upd_gen)];
+}
+
+/* Get stats of each traffic class of shaper of given port. */
+void
+sppwk_get_shaper_stats(struct sppwk_shaper_stats *stats, int port_id)
+{
+	memcpy(stats, &g_port_mng_info[port_id].shaper.stats,
+			sizeof(struct sppwk_shaper_stats));
 }
 
-/* Calculation and Setting of FCS. */
+/* Get num of packets colored by meter of given port and direction. */
+void
+sppwk_get_meter_stats(struct sppwk_meter_stats *stats,
+		int port_id, enum sppwk_port_dir dir)
+{
+	struct port_capabl_mng_info *mng = NULL;
+
+	if (unlikely(port_id < 0 || port_id >= RTE_MAX_ETHPORTS))
+		return;
+
+	if (dir == SPPWK_PORT_DIR_RX)
+		mng = &g_port_mng_info[port_id].rx;
+	else
+		mng = &g_port_mng_info[port_id].tx;
+
+	stats->green = mng->nof_colored[RTE_COLOR_GREEN];
+	stats->yellow = mng->nof_colored[RTE_COLOR_YELLOW];
+	stats->red = mng->nof_colored[RTE_COLOR_RED];
+}
+
+/**
+ * Calculation and Setting of FCS. It is not required for NICs appending FCS
+ * by themselves, so called only if `fcs` is given for VLAN op of the port.
+ */
 static inline void
 set_fcs_packet(struct rte_mbuf *pkt)
 {
@@ -99,7 +333,117 @@ set_fcs_packet(struct rte_mbuf *pkt)
 			pkt->data_len, RTE_NET_CRC32_ETH);
 }
 
-/* Add VLAN tag to a packet. It is called from add_vlan_tag_all(). */
+/* Prefetch headers of packets to be classified. */
+static inline void
+prefetch_pkt_hdrs(struct rte_mbuf **pkts, int nb_pkts)
+{
+	int cnt;
+	for (cnt = 0; cnt < nb_pkts; cnt++)
+		rte_prefetch0(rte_pktmbuf_mtod(pkts[cnt], void *));
+}
+
+/* Get ether types of packets, and fill zero for the rest of chunk. */
+static inline void
+get_ether_types(struct rte_mbuf **pkts, int nb_pkts, uint16_t *types)
+{
+	int cnt;
+	struct rte_ether_hdr *ether = NULL;
+
+	for (cnt = 0; cnt < nb_pkts; cnt++) {
+		ether = rte_pktmbuf_mtod(pkts[cnt], struct rte_ether_hdr *);
+		types[cnt] = ether->ether_type;
+	}
+	for (; cnt < VLAN_BURST_CHUNK; cnt++)
+		types[cnt] = 0;
+}
+
+#ifdef RTE_ARCH_X86
+/* Classify packets by comparing ether types with two SSE registers. */
+static uint32_t
+classify_vlan_pkts_default(struct rte_mbuf **pkts, int nb_pkts, uint16_t tpid)
+{
+	uint16_t types[VLAN_BURST_CHUNK] __rte_aligned(16);
+	__m128i tpids = _mm_set1_epi16(tpid);
+	__m128i lo, hi;
+
+	get_ether_types(pkts, nb_pkts, types);
+	lo = _mm_cmpeq_epi16(_mm_load_si128((const __m128i *)types), tpids);
+	hi = _mm_cmpeq_epi16(_mm_load_si128((const __m128i *)&types[8]),
+			tpids);
+	return (uint32_t)_mm_movemask_epi8(_mm_packs_epi16(lo, hi));
+}
+
+/**
+ * Classify packets by comparing ether types with an AVX2 register. It is
+ * selected at runtime because SPP might not be compiled for AVX2.
+ */
+static __attribute__ ((target("avx2"))) uint32_t
+classify_vlan_pkts_avx2(struct rte_mbuf **pkts, int nb_pkts, uint16_t tpid)
+{
+	uint16_t types[VLAN_BURST_CHUNK] __rte_aligned(32);
+	__m256i eq;
+
+	get_ether_types(pkts, nb_pkts, types);
+	eq = _mm256_cmpeq_epi16(_mm256_load_si256((const __m256i *)types),
+			_mm256_set1_epi16(tpid));
+	/* Packing is done in each of 128-bit lanes, so reorder them. */
+	eq = _mm256_permute4x64_epi64(
+			_mm256_packs_epi16(eq, _mm256_setzero_si256()), 0xd8);
+	return (uint32_t)_mm256_movemask_epi8(eq) & 0xffff;
+}
+#else
+/* Classify packets by comparing ether types one by one. */
+static uint32_t
+classify_vlan_pkts_default(struct rte_mbuf **pkts, int nb_pkts, uint16_t tpid)
+{
+	int cnt;
+	uint32_t tagged = 0;
+	uint16_t types[VLAN_BURST_CHUNK];
+
+	get_ether_types(pkts, nb_pkts, types);
+	for (cnt = 0; cnt < nb_pkts; cnt++) {
+		if (types[cnt] == tpid)
+			tagged |= 1U << cnt;
+	}
+	return tagged;
+}
+#endif
+
+/**
+ * Move MAC addresses to the head of prepended area, and put TPID and TCI
+ * given as a word after them. Original ether type is remained as the one
+ * following VLAN tag.
+ */
+static inline void
+push_vlan_hdr(uint8_t *hdr, uint32_t tpid_tci)
+{
+#ifdef RTE_ARCH_X86
+	_mm_storeu_si128((__m128i *)hdr, _mm_loadu_si128(
+			(const __m128i *)(hdr + sizeof(struct rte_vlan_hdr))));
+#else
+	memmove(hdr, hdr + sizeof(struct rte_vlan_hdr), 2 * RTE_ETHER_ADDR_LEN);
+#endif
+	*(unaligned_uint32_t *)(hdr + 2 * RTE_ETHER_ADDR_LEN) = tpid_tci;
+}
+
+/* Move MAC addresses over VLAN tag of given header, and clear old area. */
+static inline void
+pop_vlan_hdr(uint8_t *hdr)
+{
+#ifdef RTE_ARCH_X86
+	uint32_t inner = *(unaligned_uint32_t *)(hdr + VLAN_INNER_TYPE_OFS);
+
+	_mm_storeu_si128((__m128i *)(hdr + sizeof(struct rte_vlan_hdr)),
+			_mm_loadu_si128((const __m128i *)hdr));
+	/* Restore inner ether type overwritten by TPID and TCI. */
+	*(unaligned_uint32_t *)(hdr + VLAN_INNER_TYPE_OFS) = inner;
+#else
+	memmove(hdr + sizeof(struct rte_vlan_hdr), hdr, 2 * RTE_ETHER_ADDR_LEN);
+#endif
+	*(unaligned_uint32_t *)hdr = 0;
+}
+
+/* Add VLAN tag to a packet. It is called for packets not offloaded. */
 static inline int
 add_vlan_tag_one(
 		struct rte_mbuf *pkt,
@@ -111,7 +455,7 @@ add_vlan_tag_one(
 	const struct sppwk_vlan_tag *vlantag = &capability->vlantag;
 
 	old_ether = rte_pktmbuf_mtod(pkt, struct rte_ether_hdr *);
-	if (old_ether->ether_type == g_vlan_tpid) {
+	if (old_ether->ether_type == VLAN_TPID_BE) {
 		/* For packets with VLAN tags, only VLAN ID is updated */
 		new_ether = old_ether;
 		vlan = (struct rte_vlan_hdr *)&new_ether[1];
@@ -125,133 +469,1177 @@ add_vlan_tag_one(
 			return SPPWK_RET_NG;
 		}
 
-		rte_memcpy(new_ether, old_ether, sizeof(struct rte_ether_hdr));
-		vlan = (struct rte_vlan_hdr *)&new_ether[1];
-		vlan->eth_proto = new_ether->ether_type;
-		new_ether->ether_type = g_vlan_tpid;
+		rte_memcpy(new_ether, old_ether, sizeof(struct rte_ether_hdr));
+		vlan = (struct rte_vlan_hdr *)&new_ether[1];
+		vlan->eth_proto = new_ether->ether_type;
+		new_ether->ether_type = VLAN_TPID_BE;
+	}
+
+	vlan->vlan_tci = vlantag->tci;
+	if (unlikely(vlantag->fcs))
+		set_fcs_packet(pkt);
+	return SPPWK_RET_OK;
+}
+
+/**
+ * Add VLAN tag to all packets. Headers of a chunk of packets are prefetched
+ * and classified at once, and MAC addresses are moved with a vector.
+ */
+static inline int
+add_vlan_tag_all(
+		struct rte_mbuf **pkts, int nb_pkts,
+		const union sppwk_port_capability *capability)
+{
+	int base, cnt, nb_chunk;
+	uint32_t tagged;
+	uint8_t *hdr = NULL;
+	struct rte_mbuf *pkt = NULL;
+	const struct sppwk_vlan_tag *vlantag = &capability->vlantag;
+	const uint16_t tci = vlantag->tci;
+	const int fcs = vlantag->fcs;
+	union {
+		uint32_t word;
+		uint16_t half[2];
+	} tag = { .half = { VLAN_TPID_BE, tci } };
+
+	for (base = 0; base < nb_pkts; base += VLAN_BURST_CHUNK) {
+		nb_chunk = RTE_MIN(nb_pkts - base, VLAN_BURST_CHUNK);
+		prefetch_pkt_hdrs(&pkts[base], nb_chunk);
+		tagged = classify_vlan_pkts(&pkts[base], nb_chunk,
+				VLAN_TPID_BE);
+
+		for (cnt = 0; cnt < nb_chunk; cnt++) {
+			pkt = pkts[base + cnt];
+			if (unlikely(tagged & (1U << cnt))) {
+				/* Only TCI is updated for tagged packets. */
+				hdr = rte_pktmbuf_mtod(pkt, uint8_t *);
+				*(unaligned_uint16_t *)(hdr +
+						RTE_ETHER_HDR_LEN) = tci;
+			} else {
+				hdr = (uint8_t *)rte_pktmbuf_prepend(pkt,
+						sizeof(struct rte_vlan_hdr));
+				if (unlikely(hdr == NULL)) {
+					RTE_LOG(ERR, PORT,
+						"Failed to add VLAN tag."
+						"(pkts %d/%d)\n",
+						base + cnt, nb_pkts);
+					return base + cnt;
+				}
+				push_vlan_hdr(hdr, tag.word);
+			}
+
+			if (unlikely(fcs))
+				set_fcs_packet(pkt);
+		}
+	}
+	return nb_pkts;
+}
+
+/* Delete VLAN tag from a packet. It is called for packets not stripped. */
+static inline int
+del_vlan_tag_one(
+		struct rte_mbuf *pkt,
+		const union sppwk_port_capability *capability)
+{
+	struct rte_ether_hdr *old_ether = NULL;
+	struct rte_ether_hdr *new_ether = NULL;
+	uint32_t *old, *new;
+
+	old_ether = rte_pktmbuf_mtod(pkt, struct rte_ether_hdr *);
+	if (old_ether->ether_type == VLAN_TPID_BE) {
+		/* For packets without VLAN tag, delete VLAN tag. */
+		new_ether = (struct rte_ether_hdr *)rte_pktmbuf_adj(pkt,
+				sizeof(struct rte_vlan_hdr));
+		if (unlikely(new_ether == NULL)) {
+			RTE_LOG(ERR, PORT, "Failed to "
+					"delete unnecessary header area.\n");
+			return SPPWK_RET_NG;
+		}
+
+		old = (uint32_t *)old_ether;
+		new = (uint32_t *)new_ether;
+		new[2] = old[2];
+		new[1] = old[1];
+		new[0] = old[0];
+		old[0] = 0;
+		if (unlikely(capability->vlantag.fcs))
+			set_fcs_packet(pkt);
+	}
+	return SPPWK_RET_OK;
+}
+
+/**
+ * Delete VLAN tag from all packets. Headers are prefetched and classified
+ * for each chunk as same as add_vlan_tag_all().
+ */
+static inline int
+del_vlan_tag_all(
+		struct rte_mbuf **pkts, int nb_pkts,
+		const union sppwk_port_capability *capability)
+{
+	int base, cnt, nb_chunk;
+	uint32_t tagged;
+	uint8_t *hdr = NULL;
+	struct rte_mbuf *pkt = NULL;
+	const int fcs = capability->vlantag.fcs;
+
+	for (base = 0; base < nb_pkts; base += VLAN_BURST_CHUNK) {
+		nb_chunk = RTE_MIN(nb_pkts - base, VLAN_BURST_CHUNK);
+		prefetch_pkt_hdrs(&pkts[base], nb_chunk);
+		tagged = classify_vlan_pkts(&pkts[base], nb_chunk,
+				VLAN_TPID_BE);
+
+		/* Packets without VLAN tag are not changed. */
+		while (tagged != 0) {
+			cnt = __builtin_ctz(tagged);
+			tagged &= tagged - 1;
+
+			pkt = pkts[base + cnt];
+			hdr = rte_pktmbuf_mtod(pkt, uint8_t *);
+			if (unlikely(rte_pktmbuf_adj(pkt,
+					sizeof(struct rte_vlan_hdr)) == NULL)) {
+				RTE_LOG(ERR, PORT,
+						"Failed to del VLAN tag."
+						"(pkts %d/%d)\n",
+						base + cnt, nb_pkts);
+				return base + cnt;
+			}
+			pop_vlan_hdr(hdr);
+
+			if (unlikely(fcs))
+				set_fcs_packet(pkt);
+		}
+	}
+	return nb_pkts;
+}
+
+/**
+ * Add outer tag of QinQ to all packets. It is pushed in front of VLAN tag
+ * of the packet even if it is already tagged. Inner tag remained in mbuf
+ * for TX VLAN insert is written to the packet before.
+ */
+static inline int
+add_qinq_tag_all(
+		struct rte_mbuf **pkts, int nb_pkts,
+		const union sppwk_port_capability *capability)
+{
+	int base, cnt, nb_chunk;
+	uint8_t *hdr = NULL;
+	struct rte_mbuf *pkt = NULL;
+	const struct sppwk_vlan_tag *vlantag = &capability->vlantag;
+	const int fcs = vlantag->fcs;
+	union {
+		uint32_t word;
+		uint16_t half[2];
+	} tag = { .half = { rte_cpu_to_be_16(vlantag->tpid), vlantag->tci } };
+
+	for (base = 0; base < nb_pkts; base += VLAN_BURST_CHUNK) {
+		nb_chunk = RTE_MIN(nb_pkts - base, VLAN_BURST_CHUNK);
+		prefetch_pkt_hdrs(&pkts[base], nb_chunk);
+
+		for (cnt = 0; cnt < nb_chunk; cnt++) {
+			/**
+			 * Inner tag is inserted in place. Shared packet is
+			 * not given here, because it is given a private
+			 * header in vlan_operation() before.
+			 */
+			pkt = pkts[base + cnt];
+			if (unlikely(pkt->ol_flags & PKT_TX_VLAN)) {
+				if (rte_vlan_insert(&pkts[base + cnt]) != 0)
+					return base + cnt;
+			}
+
+			hdr = (uint8_t *)rte_pktmbuf_prepend(pkt,
+					sizeof(struct rte_vlan_hdr));
+			if (unlikely(hdr == NULL)) {
+				RTE_LOG(ERR, PORT,
+						"Failed to add QinQ tag."
+						"(pkts %d/%d)\n",
+						base + cnt, nb_pkts);
+				return base + cnt;
+			}
+			push_vlan_hdr(hdr, tag.word);
+
+			if (unlikely(fcs))
+				set_fcs_packet(pkt);
+		}
+	}
+	return nb_pkts;
+}
+
+/**
+ * Delete outer tag of QinQ from all packets. Packets of which ether type is
+ * not the TPID of the port are not changed, and inner tag is remained.
+ */
+static inline int
+del_qinq_tag_all(
+		struct rte_mbuf **pkts, int nb_pkts,
+		const union sppwk_port_capability *capability)
+{
+	int base, cnt, nb_chunk;
+	uint32_t tagged;
+	uint8_t *hdr = NULL;
+	struct rte_mbuf *pkt = NULL;
+	const int fcs = capability->vlantag.fcs;
+	const uint16_t tpid = rte_cpu_to_be_16(capability->vlantag.tpid);
+
+	for (base = 0; base < nb_pkts; base += VLAN_BURST_CHUNK) {
+		nb_chunk = RTE_MIN(nb_pkts - base, VLAN_BURST_CHUNK);
+		prefetch_pkt_hdrs(&pkts[base], nb_chunk);
+		tagged = classify_vlan_pkts(&pkts[base], nb_chunk, tpid);
+
+		while (tagged != 0) {
+			cnt = __builtin_ctz(tagged);
+			tagged &= tagged - 1;
+
+			pkt = pkts[base + cnt];
+			hdr = rte_pktmbuf_mtod(pkt, uint8_t *);
+			if (unlikely(rte_pktmbuf_adj(pkt,
+					sizeof(struct rte_vlan_hdr)) == NULL)) {
+				RTE_LOG(ERR, PORT,
+						"Failed to del QinQ tag."
+						"(pkts %d/%d)\n",
+						base + cnt, nb_pkts);
+				return base + cnt;
+			}
+			pop_vlan_hdr(hdr);
+
+			if (unlikely(fcs))
+				set_fcs_packet(pkt);
+		}
+	}
+	return nb_pkts;
+}
+
+/**
+ * Add VLAN tag to all packets with TX VLAN insert of NIC. Only VLAN ID is
+ * updated in software for packets already tagged as same as
+ * add_vlan_tag_one(), because NIC inserts another tag for them.
+ */
+static inline int
+add_vlan_tag_hw_all(
+		struct rte_mbuf **pkts, int nb_pkts,
+		const union sppwk_port_capability *capability)
+{
+	int ret = SPPWK_RET_OK;
+	int cnt = 0;
+	struct rte_ether_hdr *ether = NULL;
+	uint16_t tci = rte_be_to_cpu_16(capability->vlantag.tci);
+
+	for (cnt = 0; cnt < nb_pkts; cnt++) {
+		ether = rte_pktmbuf_mtod(pkts[cnt], struct rte_ether_hdr *);
+		if (unlikely(ether->ether_type == VLAN_TPID_BE)) {
+			ret = add_vlan_tag_one(pkts[cnt], capability);
+			if (unlikely(ret < 0)) {
+				RTE_LOG(ERR, PORT,
+						"Failed to add VLAN tag."
+						"(pkts %d/%d)\n", cnt, nb_pkts);
+				break;
+			}
+			continue;
+		}
+
+		pkts[cnt]->vlan_tci = tci;
+		pkts[cnt]->ol_flags |= PKT_TX_VLAN;
+	}
+	return cnt;
+}
+
+/**
+ * Delete VLAN tag from all packets with RX VLAN strip of NIC. Packets which
+ * are not stripped by NIC, such as received before enabling it, are
+ * processed in software.
+ */
+static inline int
+del_vlan_tag_hw_all(
+		struct rte_mbuf **pkts, int nb_pkts,
+		const union sppwk_port_capability *capability)
+{
+	int ret = SPPWK_RET_OK;
+	int cnt = 0;
+	for (cnt = 0; cnt < nb_pkts; cnt++) {
+		if (likely(pkts[cnt]->ol_flags & PKT_RX_VLAN_STRIPPED))
+			continue;
+
+		ret = del_vlan_tag_one(pkts[cnt], capability);
+		if (unlikely(ret < 0)) {
+			RTE_LOG(ERR, PORT,
+					"Failed to del VLAN tag."
+					"(pkts %d/%d)\n", cnt, nb_pkts);
+			break;
+		}
+	}
+	return cnt;
+}
+
+/**
+ * Add outer tag of QinQ with TX QinQ insert of NIC. It is only for packets
+ * of which inner tag is also remained in mbuf for TX VLAN insert, and
+ * others are processed in software.
+ */
+static inline int
+add_qinq_tag_hw_all(
+		struct rte_mbuf **pkts, int nb_pkts,
+		const union sppwk_port_capability *capability)
+{
+	int cnt = 0;
+	uint16_t tci = rte_be_to_cpu_16(capability->vlantag.tci);
+
+	for (cnt = 0; cnt < nb_pkts; cnt++) {
+		if (unlikely((pkts[cnt]->ol_flags &
+				(PKT_TX_VLAN | PKT_TX_QINQ)) != PKT_TX_VLAN)) {
+			if (add_qinq_tag_all(&pkts[cnt], 1, capability) != 1)
+				break;
+			continue;
+		}
+
+		pkts[cnt]->vlan_tci_outer = tci;
+		pkts[cnt]->ol_flags |= PKT_TX_QINQ;
+	}
+	return cnt;
+}
+
+/**
+ * Check if given TX offload is enabled for the TX queue of the port. It
+ * should be enabled in configuring the port, or NIC might ignore the flag of
+ * mbuf.
+ */
+static int
+is_hw_tx_offload_enabled(uint16_t port_id, uint64_t offload)
+{
+	struct rte_eth_txq_info qinfo;
+
+	if (rte_eth_tx_queue_info_get(port_id, 0, &qinfo) != 0)
+		return 0;
+	return (qinfo.conf.offloads & offload) ? 1 : 0;
+}
+
+/**
+ * Check if TX QinQ insert is available for given TPID. TPID of outer tag is
+ * set to NIC for whole of the port, so it is only for the TPID set first.
+ */
+static int
+is_hw_qinq_insert_enabled(const struct port_mng_info *port_mng,
+		uint16_t port_id, uint16_t tpid)
+{
+	if (!is_hw_tx_offload_enabled(port_id, DEV_TX_OFFLOAD_QINQ_INSERT))
+		return 0;
+	return (port_mng->hw_qinq_tpid == 0 || port_mng->hw_qinq_tpid == tpid);
+}
+
+/**
+ * Set TPID of outer tag inserted by NIC. It is set just once for the port
+ * and not overwritten, because packets of the TPID might be still sent.
+ */
+static int
+set_hw_qinq_tpid(struct port_mng_info *port_mng, uint16_t port_id,
+		uint16_t tpid)
+{
+	if (port_mng->hw_qinq_tpid == tpid)
+		return SPPWK_RET_OK;
+	if (port_mng->hw_qinq_tpid != 0)
+		return SPPWK_RET_NG;
+
+	if (unlikely(rte_eth_dev_set_vlan_ether_type(port_id,
+			ETH_VLAN_TYPE_OUTER, tpid) != 0)) {
+		RTE_LOG(ERR, PORT, "Failed to set outer TPID of port %d.\n",
+				port_id);
+		return SPPWK_RET_NG;
+	}
+	port_mng->hw_qinq_tpid = tpid;
+	RTE_LOG(INFO, PORT, "Set outer TPID 0x%04x of port %d.\n",
+			tpid, port_id);
+	return SPPWK_RET_OK;
+}
+
+/**
+ * Check if given RX offload is enabled in configuring the port by primary.
+ * It is not changed by SPP, because it affects all of processes receiving
+ * from the port.
+ */
+static int
+is_hw_rx_offload_enabled(uint16_t port_id, uint64_t offload)
+{
+	return (rte_eth_devices[port_id].data->dev_conf.rxmode.offloads &
+			offload) ? 1 : 0;
+}
+
+/**
+ * Decide if VLAN op of given attrs is offloaded to NIC. It is only for
+ * adding VLAN or QinQ tag on TX and deleting VLAN tag on RX of phy port, and
+ * other ops or ring and vhost ports are processed in software. RX QinQ strip
+ * is not used because it strips inner tag as well. For adding VXLAN on TX,
+ * it means that IPv4 checksum of outer header is calculated by NIC.
+ */
+static int
+is_hw_vlan_offload(const struct port_mng_info *port_mng, uint16_t port_id,
+		const struct sppwk_port_attrs *attrs, enum sppwk_port_dir dir)
+{
+	if (port_mng->iface_type != PHY)
+		return 0;
+
+	if (dir == SPPWK_PORT_DIR_TX && attrs->ops == SPPWK_PORT_OPS_ADD_VLAN)
+		return is_hw_tx_offload_enabled(port_id,
+				DEV_TX_OFFLOAD_VLAN_INSERT);
+
+	if (dir == SPPWK_PORT_DIR_TX && attrs->ops == SPPWK_PORT_OPS_ADD_QINQ)
+		return is_hw_qinq_insert_enabled(port_mng, port_id,
+				attrs->capability.vlantag.tpid);
+
+	if (dir == SPPWK_PORT_DIR_TX && attrs->ops == SPPWK_PORT_OPS_ADD_VXLAN)
+		return is_hw_tx_offload_enabled(port_id,
+				DEV_TX_OFFLOAD_IPV4_CKSUM);
+
+	if (dir == SPPWK_PORT_DIR_RX && attrs->ops == SPPWK_PORT_OPS_DEL_VLAN)
+		return is_hw_rx_offload_enabled(port_id,
+				DEV_RX_OFFLOAD_VLAN_STRIP);
+
+	return 0;
+}
+
+static void flush_shaper(uint16_t port_id, struct rte_sched_port *sched);
+
+/* Take port attrs of given ID and direction published by master. */
+void
+sppwk_take_port_attrs(int port_id, enum sppwk_port_dir dir)
+{
+	uint32_t gen;
+	struct port_capabl_mng_info *mng = NULL;
+	struct rte_sched_port *old_sched = NULL;
+
+	if (dir == SPPWK_PORT_DIR_RX)
+		mng = &g_port_mng_info[port_id].rx;
+	else
+		mng = &g_port_mng_info[port_id].tx;
+
+	gen = mng->upd_gen;
+	if (gen == mng->ref_gen)
+		return;
+
+	/* Attrs of the generation should be read after it is published. */
+	rte_smp_rmb();
+	old_sched = mng->progs[PORT_GEN_SIDE(mng->ref_gen)].sched;
+	mng->ref_gen = gen;
+
+	/* Packets queued in replaced shaper are sent before it is freed. */
+	if (unlikely(old_sched != NULL) &&
+			old_sched != mng->progs[PORT_GEN_SIDE(gen)].sched)
+		flush_shaper(port_id, old_sched);
+}
+
+/* List of VLAN operation functions of a burst, indexed by port ops. */
+vlan_f vlan_ops[] = {
+	NULL,              /* None */
+	add_vlan_tag_all,  /* Add VLAN tag */
+	del_vlan_tag_all,  /* Del VLAN tag */
+	add_qinq_tag_all,  /* Add outer tag of QinQ */
+	del_qinq_tag_all,  /* Del outer tag of QinQ */
+	NULL               /* Termination */
+};
+
+/* VLAN operation functions offloaded to NIC, only for phy port. */
+vlan_f vlan_hw_ops[] = {
+	NULL,                 /* None */
+	add_vlan_tag_hw_all,  /* Add VLAN tag with TX VLAN insert */
+	del_vlan_tag_hw_all,  /* Del VLAN tag with RX VLAN strip */
+	add_qinq_tag_hw_all,  /* Add outer tag with TX QinQ insert */
+	del_qinq_tag_all,     /* Del outer tag, not offloaded */
+	NULL                  /* Termination */
+};
+
+/* Check if given ether type in network byte order is TPID of tag. */
+static inline int
+is_tag_tpid(uint16_t ether_type)
+{
+	return ether_type == VLAN_TPID_BE ||
+		ether_type == RTE_BE16(RTE_ETHER_TYPE_QINQ) ||
+		ether_type == RTE_BE16(0x9100);
+}
+
+/**
+ * Update IP checksum for a word changed from `old` to `new` as defined in
+ * RFC 1624. All of them should be the same byte order.
+ */
+static inline uint16_t
+update_cksum16(uint16_t cksum, uint16_t old, uint16_t new)
+{
+	uint32_t sum = (uint16_t)~cksum + (uint16_t)~old + new;
+
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
+	return (uint16_t)~sum;
+}
+
+/**
+ * Get header of IPv4 or IPv6 following up to two tags. It returns NULL if
+ * the packet is not IP or too short, and ether type is set to `l3_type`.
+ */
+static inline void *
+get_l3_hdr(struct rte_mbuf *pkt, uint16_t *l3_type)
+{
+	int cnt;
+	uint16_t ofs = 2 * RTE_ETHER_ADDR_LEN;
+	uint8_t *hdr = rte_pktmbuf_mtod(pkt, uint8_t *);
+	uint16_t type = *(unaligned_uint16_t *)(hdr + ofs);
+
+	for (cnt = 0; cnt < 2 && is_tag_tpid(type); cnt++) {
+		ofs += sizeof(struct rte_vlan_hdr);
+		type = *(unaligned_uint16_t *)(hdr + ofs);
+	}
+	ofs += sizeof(type);
+
+	*l3_type = type;
+	if (type == RTE_BE16(RTE_ETHER_TYPE_IPV4)) {
+		if (unlikely(pkt->data_len < ofs + sizeof(struct rte_ipv4_hdr)))
+			return NULL;
+	} else if (type == RTE_BE16(RTE_ETHER_TYPE_IPV6)) {
+		if (unlikely(pkt->data_len < ofs + sizeof(struct rte_ipv6_hdr)))
+			return NULL;
+	} else
+		return NULL;
+	return hdr + ofs;
+}
+
+/* Remark DSCP of IPv4 or IPv6. Other packets are not changed. */
+static inline void
+set_dscp(struct rte_mbuf *pkt, uint8_t dscp)
+{
+	uint16_t l3_type, old;
+	uint32_t vtc_flow;
+	struct rte_ipv4_hdr *ipv4 = NULL;
+	struct rte_ipv6_hdr *ipv6 = NULL;
+	void *l3 = get_l3_hdr(pkt, &l3_type);
+
+	if (unlikely(l3 == NULL))
+		return;
+
+	if (l3_type == RTE_BE16(RTE_ETHER_TYPE_IPV4)) {
+		ipv4 = l3;
+		old = *(unaligned_uint16_t *)ipv4;
+		ipv4->type_of_service = (ipv4->type_of_service & 0x03) |
+				(dscp << 2);
+		ipv4->hdr_checksum = update_cksum16(ipv4->hdr_checksum, old,
+				*(unaligned_uint16_t *)ipv4);
+	} else {
+		/* DSCP is the upper 6 bits of traffic class. */
+		ipv6 = l3;
+		vtc_flow = rte_be_to_cpu_32(ipv6->vtc_flow);
+		vtc_flow = (vtc_flow & ~(0x3fU << 22)) |
+				((uint32_t)dscp << 22);
+		ipv6->vtc_flow = rte_cpu_to_be_32(vtc_flow);
+	}
+}
+
+/* Decrement TTL or hop limit. It returns NG if it is expired. */
+static inline int
+dec_ttl(struct rte_mbuf *pkt)
+{
+	uint16_t l3_type, old;
+	struct rte_ipv4_hdr *ipv4 = NULL;
+	struct rte_ipv6_hdr *ipv6 = NULL;
+	void *l3 = get_l3_hdr(pkt, &l3_type);
+
+	if (unlikely(l3 == NULL))
+		return SPPWK_RET_OK;
+
+	if (l3_type == RTE_BE16(RTE_ETHER_TYPE_IPV4)) {
+		ipv4 = l3;
+		if (unlikely(ipv4->time_to_live <= 1))
+			return SPPWK_RET_NG;
+		old = *(unaligned_uint16_t *)&ipv4->time_to_live;
+		ipv4->time_to_live--;
+		ipv4->hdr_checksum = update_cksum16(ipv4->hdr_checksum, old,
+				*(unaligned_uint16_t *)&ipv4->time_to_live);
+	} else {
+		ipv6 = l3;
+		if (unlikely(ipv6->hop_limits <= 1))
+			return SPPWK_RET_NG;
+		ipv6->hop_limits--;
+	}
+	return SPPWK_RET_OK;
+}
+
+/* Remark PCP of the first tag, which might be inserted by NIC. */
+static inline void
+set_pcp(struct rte_mbuf *pkt, uint16_t pcp_tci)
+{
+	uint16_t *tci;
+	struct rte_ether_hdr *ether = NULL;
+	const uint16_t mask = RTE_BE16(0x1fff);
+
+	if (pkt->ol_flags & PKT_TX_QINQ) {
+		pkt->vlan_tci_outer = (pkt->vlan_tci_outer & 0x1fff) |
+				rte_be_to_cpu_16(pcp_tci);
+		return;
+	}
+	if (pkt->ol_flags & PKT_TX_VLAN) {
+		pkt->vlan_tci = (pkt->vlan_tci & 0x1fff) |
+				rte_be_to_cpu_16(pcp_tci);
+		return;
+	}
+
+	ether = rte_pktmbuf_mtod(pkt, struct rte_ether_hdr *);
+	if (!is_tag_tpid(ether->ether_type))
+		return;
+	tci = (uint16_t *)((uint8_t *)ether + RTE_ETHER_HDR_LEN);
+	*tci = (*tci & mask) | pcp_tci;
+}
+
+/* Push a tag of given TPID and TCI to a packet. */
+static inline int
+push_tag(struct rte_mbuf *pkt, uint16_t tpid, uint16_t tci)
+{
+	uint8_t *hdr;
+	union {
+		uint32_t word;
+		uint16_t half[2];
+	} tag = { .half = { tpid, tci } };
+
+	hdr = (uint8_t *)rte_pktmbuf_prepend(pkt,
+			sizeof(struct rte_vlan_hdr));
+	if (unlikely(hdr == NULL))
+		return SPPWK_RET_NG;
+	push_vlan_hdr(hdr, tag.word);
+	return SPPWK_RET_OK;
+}
+
+/* Pop the first tag of a packet if its TPID is the given one. */
+static inline int
+pop_tag(struct rte_mbuf *pkt, uint16_t tpid)
+{
+	uint8_t *hdr = rte_pktmbuf_mtod(pkt, uint8_t *);
+
+	if (*(unaligned_uint16_t *)(hdr + 2 * RTE_ETHER_ADDR_LEN) != tpid)
+		return SPPWK_RET_OK;
+	if (unlikely(rte_pktmbuf_adj(pkt,
+			sizeof(struct rte_vlan_hdr)) == NULL))
+		return SPPWK_RET_NG;
+	pop_vlan_hdr(hdr);
+	return SPPWK_RET_OK;
+}
+
+/**
+ * Encapsulate a packet with outer headers of VXLAN. Source port of UDP is
+ * taken from RSS hash, or hash of inner headers if not given by NIC, for
+ * spreading flows over ECMP paths and RSS queues of the receiver.
+ */
+static inline int
+encap_vxlan(struct rte_mbuf *pkt, const struct port_vxlan *vxlan)
+{
+	uint32_t hash;
+	uint16_t ip_len;
+	struct vxlan_outer_hdrs *hdrs = NULL;
+
+	if (pkt->ol_flags & PKT_RX_RSS_HASH)
+		hash = pkt->hash.rss;
+	else
+		hash = rte_hash_crc(rte_pktmbuf_mtod(pkt, void *),
+				RTE_MIN(pkt->data_len, VXLAN_INNER_HASH_LEN),
+				0);
+
+	hdrs = (struct vxlan_outer_hdrs *)rte_pktmbuf_prepend(pkt,
+			sizeof(struct vxlan_outer_hdrs));
+	if (unlikely(hdrs == NULL))
+		return SPPWK_RET_NG;
+	rte_memcpy(hdrs, &vxlan->hdrs, sizeof(struct vxlan_outer_hdrs));
+
+	ip_len = rte_pktmbuf_pkt_len(pkt) - RTE_ETHER_HDR_LEN;
+	hdrs->ipv4.total_length = rte_cpu_to_be_16(ip_len);
+	hdrs->udp.dgram_len = rte_cpu_to_be_16(ip_len -
+			sizeof(struct rte_ipv4_hdr));
+	hdrs->udp.src_port = rte_cpu_to_be_16(VXLAN_SRC_PORT_MIN |
+			(hash & VXLAN_SRC_PORT_MASK));
+
+	/* Checksum of template is for zero length, or zero if offloaded. */
+	if (vxlan->cksum_offload) {
+		pkt->ol_flags |= PKT_TX_IPV4 | PKT_TX_IP_CKSUM;
+		pkt->l2_len = RTE_ETHER_HDR_LEN;
+		pkt->l3_len = sizeof(struct rte_ipv4_hdr);
+	} else
+		hdrs->ipv4.hdr_checksum = update_cksum16(
+				hdrs->ipv4.hdr_checksum, 0,
+				hdrs->ipv4.total_length);
+	return SPPWK_RET_OK;
+}
+
+/**
+ * Decapsulate a packet of VXLAN to given UDP port in network byte order.
+ * Other packets are not changed.
+ */
+static inline int
+decap_vxlan(struct rte_mbuf *pkt, uint16_t udp_port)
+{
+	uint16_t hdrs_len;
+	struct rte_ether_hdr *ether = NULL;
+	struct rte_ipv4_hdr *ipv4 = NULL;
+	struct rte_udp_hdr *udp = NULL;
+
+	ether = rte_pktmbuf_mtod(pkt, struct rte_ether_hdr *);
+	if (ether->ether_type != RTE_BE16(RTE_ETHER_TYPE_IPV4) ||
+			pkt->data_len < sizeof(struct vxlan_outer_hdrs))
+		return SPPWK_RET_OK;
+
+	ipv4 = (struct rte_ipv4_hdr *)(ether + 1);
+	if (ipv4->next_proto_id != IPPROTO_UDP)
+		return SPPWK_RET_OK;
+
+	/* IPv4 options might be included in outer header. */
+	hdrs_len = sizeof(struct vxlan_outer_hdrs) -
+			sizeof(struct rte_ipv4_hdr) +
+			(ipv4->version_ihl & RTE_IPV4_HDR_IHL_MASK) *
+			RTE_IPV4_IHL_MULTIPLIER;
+	if (unlikely(pkt->data_len < hdrs_len))
+		return SPPWK_RET_OK;
+
+	udp = (struct rte_udp_hdr *)((uint8_t *)ether + hdrs_len -
+			sizeof(struct rte_vxlan_hdr) -
+			sizeof(struct rte_udp_hdr));
+	if (udp->dst_port != udp_port)
+		return SPPWK_RET_OK;
+
+	if (unlikely(rte_pktmbuf_adj(pkt, hdrs_len) == NULL))
+		return SPPWK_RET_NG;
+	return SPPWK_RET_OK;
+}
+
+/* Check color of a packet with meter at given TSC. */
+static inline enum rte_color
+check_meter_color(struct port_meter *meter, uint64_t tsc, uint32_t pkt_len)
+{
+	if (meter->type == SPPWK_METER_SRTCM)
+		return rte_meter_srtcm_color_blind_check(&meter->state.srtcm,
+				&meter->prof.srtcm, tsc, pkt_len);
+	return rte_meter_trtcm_color_blind_check(&meter->state.trtcm,
+			&meter->prof.trtcm, tsc, pkt_len);
+}
+
+/**
+ * Run all of actions for a packet. Packet should not be shared, because a
+ * tag remained in mbuf is inserted in place. It returns NG if the packet
+ * should be discarded.
+ * TSC of the burst and counters of colors are given for meter.
+ */
+static inline int
+run_port_acts(struct rte_mbuf **pkt, struct port_act_prog *prog,
+		uint64_t tsc, uint16_t *nof_colored)
+{
+	int cnt;
+	int ret = SPPWK_RET_OK;
+	enum rte_color color;
+	struct rte_mbuf *m = *pkt;
+	struct rte_ether_hdr *ether = NULL;
+	const struct port_act *act = NULL;
+
+	for (cnt = 0; cnt < prog->nof_acts && ret == SPPWK_RET_OK; cnt++) {
+		act = &prog->acts[cnt];
+		ether = rte_pktmbuf_mtod(m, struct rte_ether_hdr *);
+		switch (act->type) {
+		case PORT_ACT_PUSH_VLAN:
+		case PORT_ACT_PUSH_VLAN_HW:
+			if (ether->ether_type == VLAN_TPID_BE) {
+				/* Only TCI is updated for tagged packets. */
+				*(unaligned_uint16_t *)(ether + 1) = act->tci;
+			} else if (act->type == PORT_ACT_PUSH_VLAN_HW) {
+				m->vlan_tci = rte_be_to_cpu_16(act->tci);
+				m->ol_flags |= PKT_TX_VLAN;
+			} else
+				ret = push_tag(m, act->tpid, act->tci);
+			break;
+		case PORT_ACT_POP_VLAN_HW:
+			if (m->ol_flags & PKT_RX_VLAN_STRIPPED)
+				break;
+			/* Not stripped by NIC. */
+			/* Falls through. */
+		case PORT_ACT_POP_VLAN:
+		case PORT_ACT_POP_QINQ:
+			ret = pop_tag(m, act->tpid);
+			break;
+		case PORT_ACT_PUSH_QINQ_HW:
+			if ((m->ol_flags & (PKT_TX_VLAN | PKT_TX_QINQ)) ==
+					PKT_TX_VLAN) {
+				m->vlan_tci_outer = rte_be_to_cpu_16(act->tci);
+				m->ol_flags |= PKT_TX_QINQ;
+				break;
+			}
+			/* Falls through. */
+		case PORT_ACT_PUSH_QINQ:
+			if (unlikely(m->ol_flags & PKT_TX_VLAN)) {
+				if (rte_vlan_insert(pkt) != 0)
+					return SPPWK_RET_NG;
+				m = *pkt;
+			}
+			ret = push_tag(m, act->tpid, act->tci);
+			break;
+		case PORT_ACT_SET_SRC_MAC:
+			rte_ether_addr_copy(&act->mac, &ether->s_addr);
+			break;
+		case PORT_ACT_SET_DST_MAC:
+			rte_ether_addr_copy(&act->mac, &ether->d_addr);
+			break;
+		case PORT_ACT_SET_PCP:
+			set_pcp(m, act->tci);
+			break;
+		case PORT_ACT_SET_DSCP:
+			set_dscp(m, act->dscp);
+			break;
+		case PORT_ACT_DEC_TTL:
+			ret = dec_ttl(m);
+			break;
+		case PORT_ACT_METER:
+			color = check_meter_color(&prog->meter, tsc,
+					rte_pktmbuf_pkt_len(m));
+			nof_colored[color]++;
+			if (likely(color != RTE_COLOR_RED))
+				break;
+			if (act->red_act == SPPWK_METER_RED_DROP)
+				ret = SPPWK_RET_NG;
+			else
+				set_pcp(m, act->tci);
+			break;
+		case PORT_ACT_ENCAP_VXLAN:
+			/* Tag remained in mbuf is for inner frame. */
+			if (unlikely(m->ol_flags & PKT_TX_VLAN)) {
+				if (rte_vlan_insert(pkt) != 0)
+					return SPPWK_RET_NG;
+				m = *pkt;
+			}
+			ret = encap_vxlan(m, &prog->vxlan);
+			break;
+		case PORT_ACT_DECAP_VXLAN:
+			ret = decap_vxlan(m, act->udp_port);
+			break;
+		default:
+			/* Not used. */
+			break;
+		}
+	}
+
+	if (unlikely(prog->fcs) && ret == SPPWK_RET_OK)
+		set_fcs_packet(m);
+	return ret;
+}
+
+/**
+ * Run actions for all of packets in one pass. Packets discarded are moved
+ * to the end of `pkts` keeping the order of others, and it returns the num
+ * of remained packets. Discarded ones are swapped with remained ones in
+ * place, so that any num of packets can be given without a buffer for them.
+ * TSC is read once for meter, and counters of colors are updated once for
+ * the burst.
+ */
+static inline int
+run_port_acts_all(struct rte_mbuf **pkts, int nb_pkts,
+		struct port_act_prog *prog, uint64_t *nof_colored)
+{
+	int base, cnt, nb_chunk;
+	int nb_ok = 0;
+	uint64_t tsc = 0;
+	uint16_t nof_burst_colored[RTE_COLORS] = { 0 };
+	struct rte_mbuf *ng_pkt = NULL;
+
+	if (prog->has_meter)
+		tsc = rte_rdtsc();
+	for (base = 0; base < nb_pkts; base += VLAN_BURST_CHUNK) {
+		nb_chunk = RTE_MIN(nb_pkts - base, VLAN_BURST_CHUNK);
+		prefetch_pkt_hdrs(&pkts[base], nb_chunk);
+
+		for (cnt = base; cnt < base + nb_chunk; cnt++) {
+			if (unlikely(run_port_acts(&pkts[cnt], prog, tsc,
+					nof_burst_colored) != SPPWK_RET_OK))
+				continue;
+
+			/* Slots from nb_ok to cnt are of discarded ones. */
+			if (unlikely(cnt != nb_ok)) {
+				ng_pkt = pkts[nb_ok];
+				pkts[nb_ok] = pkts[cnt];
+				pkts[cnt] = ng_pkt;
+			}
+			nb_ok++;
+		}
 	}
 
-	vlan->vlan_tci = vlantag->tci;
-	set_fcs_packet(pkt);
-	return SPPWK_RET_OK;
+	if (prog->has_meter) {
+		for (cnt = 0; cnt < RTE_COLORS; cnt++)
+			nof_colored[cnt] += nof_burst_colored[cnt];
+	}
+	return nb_ok;
 }
 
-/* Add VLAN tag to all packets. */
-static inline int
-add_vlan_tag_all(
-		struct rte_mbuf **pkts, int nb_pkts,
-		const union sppwk_port_capability *capability)
+/* Compile an action from port attrs, or return NG for unknown ops. */
+static int
+compile_port_act(struct port_act *act, const struct sppwk_port_attrs *attrs)
 {
-	int ret = SPPWK_RET_OK;
-	int cnt = 0;
-	for (cnt = 0; cnt < nb_pkts; cnt++) {
-		ret = add_vlan_tag_one(pkts[cnt], capability);
-		if (unlikely(ret < 0)) {
-			RTE_LOG(ERR, PORT,
-					"Failed to add VLAN tag."
-					"(pkts %d/%d)\n", cnt, nb_pkts);
-			break;
-		}
+	const struct sppwk_vlan_tag *tag = &attrs->capability.vlantag;
+	const struct sppwk_hdr_rewrite *rewrite = &attrs->capability.rewrite;
+
+	memset(act, 0x00, sizeof(*act));
+	switch (attrs->ops) {
+	case SPPWK_PORT_OPS_ADD_VLAN:
+		act->type = attrs->hw_offload ?
+			PORT_ACT_PUSH_VLAN_HW : PORT_ACT_PUSH_VLAN;
+		act->tpid = VLAN_TPID_BE;
+		act->tci = tag->tci;
+		break;
+	case SPPWK_PORT_OPS_DEL_VLAN:
+		act->type = attrs->hw_offload ?
+			PORT_ACT_POP_VLAN_HW : PORT_ACT_POP_VLAN;
+		act->tpid = VLAN_TPID_BE;
+		break;
+	case SPPWK_PORT_OPS_ADD_QINQ:
+		act->type = attrs->hw_offload ?
+			PORT_ACT_PUSH_QINQ_HW : PORT_ACT_PUSH_QINQ;
+		act->tpid = rte_cpu_to_be_16(tag->tpid);
+		act->tci = tag->tci;
+		break;
+	case SPPWK_PORT_OPS_DEL_QINQ:
+		act->type = PORT_ACT_POP_QINQ;
+		act->tpid = rte_cpu_to_be_16(tag->tpid);
+		break;
+	case SPPWK_PORT_OPS_SET_SRC_MAC:
+	case SPPWK_PORT_OPS_SET_DST_MAC:
+		act->type = attrs->ops == SPPWK_PORT_OPS_SET_SRC_MAC ?
+			PORT_ACT_SET_SRC_MAC : PORT_ACT_SET_DST_MAC;
+		rte_memcpy(&act->mac, &rewrite->mac_addr, RTE_ETHER_ADDR_LEN);
+		break;
+	case SPPWK_PORT_OPS_SET_PCP:
+		act->type = PORT_ACT_SET_PCP;
+		act->tci = rte_cpu_to_be_16(rewrite->value << 13);
+		break;
+	case SPPWK_PORT_OPS_SET_DSCP:
+		act->type = PORT_ACT_SET_DSCP;
+		act->dscp = rewrite->value;
+		break;
+	case SPPWK_PORT_OPS_METER:
+		act->type = PORT_ACT_METER;
+		act->red_act = attrs->capability.meter.red_act;
+		act->tci = rte_cpu_to_be_16(attrs->capability.meter.pcp << 13);
+		break;
+	case SPPWK_PORT_OPS_ADD_VXLAN:
+		act->type = PORT_ACT_ENCAP_VXLAN;
+		break;
+	case SPPWK_PORT_OPS_DEL_VXLAN:
+		act->type = PORT_ACT_DECAP_VXLAN;
+		act->udp_port = rte_cpu_to_be_16(
+				attrs->capability.vxlan.udp_port);
+		break;
+	case SPPWK_PORT_OPS_DEC_TTL:
+		act->type = PORT_ACT_DEC_TTL;
+		break;
+	default:
+		RTE_LOG(ERR, PORT, "Unknown port ops %d is not compiled.\n",
+				attrs->ops);
+		return SPPWK_RET_NG;
 	}
-	return cnt;
+	return SPPWK_RET_OK;
 }
 
-/* Delete VLAN tag from a packet. It is called from del_vlan_tag_all(). */
-static inline int
-del_vlan_tag_one(
-		struct rte_mbuf *pkt,
-		const union sppwk_port_capability *cbl __attribute__ ((unused)))
+/* Configure profile and initial state of meter from port attrs. */
+static int
+compile_port_meter(struct port_meter *meter,
+		const struct sppwk_meter *params)
 {
-	struct rte_ether_hdr *old_ether = NULL;
-	struct rte_ether_hdr *new_ether = NULL;
-	uint32_t *old, *new;
+	int ret;
+	struct rte_meter_srtcm_params srtcm = {
+		.cir = params->cir, .cbs = params->cbs, .ebs = params->ebs,
+	};
+	struct rte_meter_trtcm_params trtcm = {
+		.cir = params->cir, .pir = params->pir,
+		.cbs = params->cbs, .pbs = params->pbs,
+	};
 
-	old_ether = rte_pktmbuf_mtod(pkt, struct rte_ether_hdr *);
-	if (old_ether->ether_type == g_vlan_tpid) {
-		/* For packets without VLAN tag, delete VLAN tag. */
-		new_ether = (struct rte_ether_hdr *)rte_pktmbuf_adj(pkt,
-				sizeof(struct rte_vlan_hdr));
-		if (unlikely(new_ether == NULL)) {
-			RTE_LOG(ERR, PORT, "Failed to "
-					"delete unnecessary header area.\n");
-			return SPPWK_RET_NG;
-		}
+	meter->type = params->type;
+	if (meter->type == SPPWK_METER_SRTCM) {
+		ret = rte_meter_srtcm_profile_config(&meter->prof.srtcm,
+				&srtcm);
+		if (ret == 0)
+			ret = rte_meter_srtcm_config(&meter->state.srtcm,
+					&meter->prof.srtcm);
+	} else {
+		ret = rte_meter_trtcm_profile_config(&meter->prof.trtcm,
+				&trtcm);
+		if (ret == 0)
+			ret = rte_meter_trtcm_config(&meter->state.trtcm,
+					&meter->prof.trtcm);
+	}
 
-		old = (uint32_t *)old_ether;
-		new = (uint32_t *)new_ether;
-		new[2] = old[2];
-		new[1] = old[1];
-		new[0] = old[0];
-		old[0] = 0;
-		set_fcs_packet(pkt);
+	if (unlikely(ret != 0)) {
+		RTE_LOG(ERR, PORT, "Failed to configure meter (%d).\n", ret);
+		return SPPWK_RET_NG;
 	}
 	return SPPWK_RET_OK;
 }
 
-/* Delete VLAN tag from all packets. */
-static inline int
-del_vlan_tag_all(
-		struct rte_mbuf **pkts, int nb_pkts,
-		const union sppwk_port_capability *capability)
+/**
+ * Build template of outer headers of VXLAN from port attrs. Checksum is
+ * calculated for zero length, and left zero if it is offloaded to NIC.
+ */
+static void
+compile_port_vxlan(struct port_vxlan *vxlan,
+		const struct sppwk_vxlan *params, int cksum_offload)
 {
-	int ret = SPPWK_RET_OK;
-	int cnt = 0;
-	for (cnt = 0; cnt < nb_pkts; cnt++) {
-		ret = del_vlan_tag_one(pkts[cnt], capability);
-		if (unlikely(ret < 0)) {
-			RTE_LOG(ERR, PORT,
-					"Failed to del VLAN tag."
-					"(pkts %d/%d)\n", cnt, nb_pkts);
-			break;
-		}
-	}
-	return cnt;
+	struct vxlan_outer_hdrs *hdrs = &vxlan->hdrs;
+
+	memset(vxlan, 0x00, sizeof(*vxlan));
+	rte_memcpy(&hdrs->eth.s_addr, &params->src_mac, RTE_ETHER_ADDR_LEN);
+	rte_memcpy(&hdrs->eth.d_addr, &params->dst_mac, RTE_ETHER_ADDR_LEN);
+	hdrs->eth.ether_type = RTE_BE16(RTE_ETHER_TYPE_IPV4);
+
+	hdrs->ipv4.version_ihl = VXLAN_IPV4_VHL;
+	hdrs->ipv4.time_to_live = VXLAN_IPV4_TTL;
+	hdrs->ipv4.next_proto_id = IPPROTO_UDP;
+	hdrs->ipv4.src_addr = params->src_ip;
+	hdrs->ipv4.dst_addr = params->dst_ip;
+
+	/* Checksum of UDP is zero as allowed for VXLAN over IPv4. */
+	hdrs->udp.dst_port = rte_cpu_to_be_16(params->udp_port);
+
+	/* Flag `I` of VXLAN header means VNI is valid. */
+	hdrs->vxlan.vx_flags = RTE_BE32(0x08000000);
+	hdrs->vxlan.vx_vni = rte_cpu_to_be_32(params->vni << 8);
+
+	vxlan->cksum_offload = cksum_offload;
+	if (!cksum_offload)
+		hdrs->ipv4.hdr_checksum = rte_ipv4_cksum(&hdrs->ipv4);
 }
 
-/* Swap ref side and update side. */
-/* TODO(yasufum) add desc for this function. */
-void
-sppwk_swap_two_sides(
-		enum sppwk_swap_type swap_type,
-		int port_id, enum sppwk_port_dir dir)
+/**
+ * Compile port attrs of a direction into a list of actions. FCS is
+ * recalculated only once after all of actions if any of VLAN ops requires.
+ */
+static void
+compile_port_acts(struct port_act_prog *prog,
+		const struct sppwk_port_attrs *attrs, int nof_attrs)
 {
 	int cnt;
-	static int num_rx;
-	static int num_tx;
-	static int rx_list[RTE_MAX_ETHPORTS];
-	static int tx_list[RTE_MAX_ETHPORTS];
-	struct port_capabl_mng_info *mng = NULL;
+	const struct sppwk_port_attrs *last_attrs = NULL;
 
-	if (swap_type == SPPWK_SWAP_UPD) {
-		switch (dir) {
-		case SPPWK_PORT_DIR_RX:
-			mng = &g_port_mng_info[port_id].rx;
-			mng->upd_index = mng->ref_index;
-			rx_list[num_rx++] = port_id;
-			break;
-		case SPPWK_PORT_DIR_TX:
-			mng = &g_port_mng_info[port_id].tx;
-			mng->upd_index = mng->ref_index;
-			tx_list[num_tx++] = port_id;
-			break;
-		default:
-			/* Not used. */
-			break;
+	memset(prog, 0x00, sizeof(*prog));
+	for (cnt = 0; cnt < nof_attrs; cnt++) {
+		/* Shaper is not an action for each packet. */
+		if (attrs[cnt].ops == SPPWK_PORT_OPS_SHAPER)
+			continue;
+
+		/* Meter is not applied if it is failed to be configured. */
+		if (attrs[cnt].ops == SPPWK_PORT_OPS_METER) {
+			if (compile_port_meter(&prog->meter,
+					&attrs[cnt].capability.meter) !=
+					SPPWK_RET_OK)
+				continue;
+			prog->has_meter = 1;
 		}
-		return;
+		if (attrs[cnt].ops == SPPWK_PORT_OPS_ADD_VXLAN)
+			compile_port_vxlan(&prog->vxlan,
+					&attrs[cnt].capability.vxlan,
+					attrs[cnt].hw_offload);
+		if (compile_port_act(&prog->acts[prog->nof_acts],
+				&attrs[cnt]) != SPPWK_RET_OK)
+			continue;
+		prog->nof_acts++;
+		if (SPPWK_IS_VLAN_OPS(attrs[cnt].ops) &&
+				attrs[cnt].capability.vlantag.fcs)
+			prog->fcs = 1;
+		last_attrs = &attrs[cnt];
+	}
+
+	/* Vectorized burst function is faster for only one VLAN op. */
+	if (prog->nof_acts == 1 && SPPWK_IS_VLAN_OPS(last_attrs->ops)) {
+		prog->burst_f = last_attrs->hw_offload ?
+			vlan_hw_ops[last_attrs->ops] :
+			vlan_ops[last_attrs->ops];
+		prog->burst_cap = &last_attrs->capability;
+	}
+}
+
+/* Create scheduler of one subport and one pipe for shaping given port. */
+static struct rte_sched_port *
+create_shaper(uint16_t port_id, struct port_shaper *shaper,
+		const struct sppwk_shaper *params)
+{
+	int cnt, ret;
+	char name[RTE_MEMZONE_NAMESIZE];
+	struct rte_sched_port *sched = NULL;
+	struct rte_sched_pipe_params pipe = {
+		.tb_rate = params->rate,
+		.tb_size = SHAPER_TB_SIZE,
+		.tc_period = SHAPER_TC_PERIOD,
+		.tc_ov_weight = 1,
+		.wrr_weights = { 1, 1, 1, 1 },
+	};
+	struct rte_sched_subport_params subport = {
+		.tb_rate = params->rate,
+		.tb_size = SHAPER_TB_SIZE,
+		.tc_period = SHAPER_TC_PERIOD,
+	};
+	struct rte_sched_port_params port = {
+		.name = name,
+		.socket = rte_eth_dev_socket_id(port_id),
+		.rate = params->rate,
+		.mtu = RTE_ETHER_MTU,
+		.frame_overhead = RTE_SCHED_FRAME_OVERHEAD_DEFAULT,
+		.n_subports_per_port = 1,
+		.n_pipes_per_subport = 1,
+		.pipe_profiles = &pipe,
+		.n_pipe_profiles = 1,
+	};
+
+	/* Each of traffic classes can use whole of the rate. */
+	for (cnt = 0; cnt < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; cnt++) {
+		pipe.tc_rate[cnt] = params->rate;
+		subport.tc_rate[cnt] = params->rate;
+		port.qsize[cnt] = params->qsize;
 	}
 
-	for (cnt = 0; cnt < num_rx; cnt++) {
-		mng = &g_port_mng_info[rx_list[cnt]].rx;
-		mng->ref_index = (mng->upd_index+1) % TWO_SIDES;
-		rx_list[cnt] = 0;
+	snprintf(name, sizeof(name), "sppwk_sched_%u_%u", port_id,
+			shaper->nof_created++);
+	sched = rte_sched_port_config(&port);
+	if (unlikely(sched == NULL)) {
+		RTE_LOG(ERR, PORT, "Failed to create shaper of port %u.\n",
+				port_id);
+		return NULL;
 	}
 
-	for (cnt = 0; cnt < num_tx; cnt++) {
-		mng = &g_port_mng_info[tx_list[cnt]].tx;
-		mng->ref_index = (mng->upd_index+1) % TWO_SIDES;
-		tx_list[cnt] = 0;
+	ret = rte_sched_subport_config(sched, 0, &subport);
+	if (likely(ret == 0))
+		ret = rte_sched_pipe_config(sched, 0, 0, 0);
+	if (unlikely(ret != 0)) {
+		RTE_LOG(ERR, PORT, "Failed to configure shaper of port %u "
+				"(%d).\n", port_id, ret);
+		rte_sched_port_free(sched);
+		return NULL;
 	}
+	return sched;
+}
+
+/**
+ * Update shaper of TX port if its params are changed, or release it if
+ * params is NULL. Scheduler replaced is freed at the end of flush, or at the
+ * next update.
+ */
+static void
+update_port_shaper(uint16_t port_id, struct port_shaper *shaper,
+		const struct sppwk_shaper *params)
+{
+	if (params != NULL && shaper->sched != NULL &&
+			memcmp(params, &shaper->params, sizeof(*params)) == 0)
+		return;
+	if (params == NULL && shaper->sched == NULL)
+		return;
+
+	if (shaper->retired != NULL)
+		rte_sched_port_free(shaper->retired);
+	shaper->retired = shaper->sched;
+	shaper->sched = NULL;
+	memset(&shaper->params, 0x00, sizeof(shaper->params));
+	if (params == NULL)
+		return;
+
+	shaper->sched = create_shaper(port_id, shaper, params);
+	if (shaper->sched == NULL)
+		return;
+	memcpy(&shaper->params, params, sizeof(*params));
+	memset(&shaper->stats, 0x00, sizeof(shaper->stats));
+	shaper->stats_period = rte_get_tsc_hz() / SHAPER_STATS_HZ;
+	shaper->stats_tsc = rte_rdtsc();
 }
 
 /* Update port attributes of given direction. */
@@ -260,12 +1648,15 @@ update_port_attrs(struct sppwk_port_info *port,
 		enum sppwk_port_dir dir)
 {
 	int in_cnt, out_cnt = 0;
+	int has_encap = 0;
 	int port_id = port->ethdev_port_id;
 	struct port_mng_info *port_mng = &g_port_mng_info[port_id];
 	struct port_capabl_mng_info *mng = NULL;
 	struct sppwk_port_attrs *port_attrs_in = port->port_attrs;
 	struct sppwk_port_attrs *port_attrs_out = NULL;
 	struct sppwk_vlan_tag *tag = NULL;
+	const struct sppwk_shaper *shaper_params = NULL;
+	uint32_t gen;
 
 	port_mng->iface_type = port->iface_type;
 	port_mng->iface_no   = port->iface_no;
@@ -282,9 +1673,27 @@ update_port_attrs(struct sppwk_port_info *port,
 		break;
 	}
 
-	port_attrs_out = mng->port_attrs[mng->upd_index];
+	/**
+	 * Side next to the one taken by lcore is not referred. It is written
+	 * again if previous update is not taken, because lcore takes it only
+	 * after the component is published in the same flush.
+	 */
+	gen = mng->ref_gen + 1;
+	if (unlikely(mng->upd_gen == gen))
+		RTE_LOG(DEBUG, PORT, "Update of port %d is not taken yet, "
+				"and overwritten.\n", port_id);
+	port_attrs_out = mng->port_attrs[PORT_GEN_SIDE(gen)];
 	memset(port_attrs_out, 0x00, sizeof(struct sppwk_port_attrs)
 			* PORT_CAPABL_MAX);
+
+	/* Tag inserted by NIC would be put on outer header of VXLAN. */
+	for (in_cnt = 0; in_cnt < PORT_CAPABL_MAX; in_cnt++) {
+		if (dir == SPPWK_PORT_DIR_TX &&
+				port_attrs_in[in_cnt].dir == dir &&
+				port_attrs_in[in_cnt].ops ==
+				SPPWK_PORT_OPS_ADD_VXLAN)
+			has_encap = 1;
+	}
 	for (in_cnt = 0; in_cnt < PORT_CAPABL_MAX; in_cnt++) {
 		if (port_attrs_in[in_cnt].dir != dir)
 			continue;
@@ -294,6 +1703,7 @@ update_port_attrs(struct sppwk_port_info *port,
 
 		switch (port_attrs_out[out_cnt].ops) {
 		case SPPWK_PORT_OPS_ADD_VLAN:
+		case SPPWK_PORT_OPS_ADD_QINQ:
 			tag = &port_attrs_out[out_cnt].capability.vlantag;
 			tag->tci = rte_cpu_to_be_16(SPP_VLANTAG_CALC_TCI(
 					tag->vid, tag->pcp));
@@ -304,10 +1714,85 @@ update_port_attrs(struct sppwk_port_info *port,
 			break;
 		}
 
+		if (has_encap && SPPWK_IS_VLAN_OPS(
+				port_attrs_out[out_cnt].ops))
+			port_attrs_out[out_cnt].hw_offload = 0;
+		else
+			port_attrs_out[out_cnt].hw_offload =
+				is_hw_vlan_offload(port_mng, port_id,
+						&port_attrs_out[out_cnt], dir);
+
+		/* Outer TPID is set to NIC, or added in software if failed. */
+		if (port_attrs_out[out_cnt].hw_offload &&
+				port_attrs_out[out_cnt].ops ==
+				SPPWK_PORT_OPS_ADD_QINQ) {
+			tag = &port_attrs_out[out_cnt].capability.vlantag;
+			if (set_hw_qinq_tpid(port_mng, port_id, tag->tpid) !=
+					SPPWK_RET_OK)
+				port_attrs_out[out_cnt].hw_offload = 0;
+		}
+
 		out_cnt++;
 	}
 
-	sppwk_swap_two_sides(SPPWK_SWAP_UPD, port_id, dir);
+	compile_port_acts(&mng->progs[PORT_GEN_SIDE(gen)], port_attrs_out,
+			out_cnt);
+
+	/* Shaper is kept for the port because it has queued packets. */
+	if (dir == SPPWK_PORT_DIR_TX) {
+		shaper_params = NULL;
+		for (in_cnt = 0; in_cnt < out_cnt; in_cnt++) {
+			if (port_attrs_out[in_cnt].ops ==
+					SPPWK_PORT_OPS_SHAPER)
+				shaper_params = &port_attrs_out[in_cnt].
+						capability.shaper;
+		}
+		update_port_shaper(port_id, &port_mng->shaper, shaper_params);
+		mng->progs[PORT_GEN_SIDE(gen)].sched =
+				port_mng->shaper.sched;
+	}
+
+	/* Publish it, and the lcore takes it in sppwk_take_port_attrs(). */
+	rte_smp_wmb();
+	mng->upd_gen = gen;
+}
+
+/* Publish empty attrs of given direction of port deleted from component. */
+void
+sppwk_reset_port_attrs(struct sppwk_port_info *port,
+		enum sppwk_port_dir dir)
+{
+	int cnt;
+
+	if (port->ethdev_port_id < 0)
+		return;
+
+	for (cnt = 0; cnt < PORT_CAPABL_MAX; cnt++) {
+		if (port->port_attrs[cnt].ops != SPPWK_PORT_OPS_NONE &&
+				port->port_attrs[cnt].dir == dir)
+			memset(&port->port_attrs[cnt], 0x00,
+					sizeof(struct sppwk_port_attrs));
+	}
+	update_port_attrs(port, dir);
+}
+
+/* Free shapers replaced or released in flush with their queued packets. */
+void
+sppwk_free_retired_shapers(void)
+{
+	int cnt;
+	struct port_shaper *shaper = NULL;
+
+	for (cnt = 0; cnt < RTE_MAX_ETHPORTS; cnt++) {
+		shaper = &g_port_mng_info[cnt].shaper;
+		if (likely(shaper->retired == NULL))
+			continue;
+
+		/* Packets remained in it are freed by rte_sched. */
+		RTE_LOG(DEBUG, PORT, "Free shaper of port %d.\n", cnt);
+		rte_sched_port_free(shaper->retired);
+		shaper->retired = NULL;
+	}
 }
 
 /* Update port direction of given component. */
@@ -328,46 +1813,131 @@ sppwk_update_port_dir(const struct sppwk_comp_info *comp)
 	}
 }
 
+/* Return 1 if data of the packet is shared with other mbufs, or 0. */
+static inline int
+is_pkt_shared(struct rte_mbuf *pkt)
+{
+	return !RTE_MBUF_DIRECT(pkt) || rte_mbuf_refcnt_read(pkt) > 1;
+}
+
 /**
- * Define list of VLAN opeartion functions. It is only used in
- * vlan_operation().
+ * Replace a packet shared with others, such as a clone of spp_mirror, with a
+ * copy of its headers followed by a clone of the rest, so that headers can be
+ * changed without changing data of others. Packet is not changed if failed.
  */
-typedef int (*vlan_f)(
-		struct rte_mbuf **pkts, int nb_pkts,
-		const union sppwk_port_capability *capability);
+static int
+unshare_pkt_hdr(struct rte_mbuf **pkt)
+{
+	struct rte_mbuf *org = *pkt;
+	struct rte_mbuf *hdr = NULL;
+	struct rte_mbuf *payload = NULL;
+	uint16_t len = RTE_MIN(org->data_len, UNSHARE_HDR_LEN);
 
-vlan_f vlan_ops[] = {
-	NULL,              /* None */
-	add_vlan_tag_all,  /* Add VLAN tag */
-	del_vlan_tag_all,  /* Del VLAN tag */
-	NULL               /* Termination */
-};
+	hdr = rte_pktmbuf_alloc(g_hdr_pool);
+	if (unlikely(hdr == NULL))
+		return SPPWK_RET_NG;
+
+	rte_memcpy(rte_pktmbuf_mtod(hdr, void *),
+			rte_pktmbuf_mtod(org, void *), len);
+	hdr->data_len = len;
+	hdr->pkt_len = len;
+	hdr->port = org->port;
+	hdr->vlan_tci = org->vlan_tci;
+	hdr->vlan_tci_outer = org->vlan_tci_outer;
+	hdr->tx_offload = org->tx_offload;
+	hdr->hash = org->hash;
+	hdr->ol_flags = org->ol_flags &
+			~(IND_ATTACHED_MBUF | EXT_ATTACHED_MBUF);
+	hdr->packet_type = org->packet_type;
+	hdr->timestamp = org->timestamp;
+	hdr->udata64 = org->udata64;
+
+	if (len < org->pkt_len) {
+		payload = rte_pktmbuf_clone(org, g_hdr_pool);
+		if (unlikely(payload == NULL)) {
+			rte_pktmbuf_free(hdr);
+			return SPPWK_RET_NG;
+		}
+		rte_pktmbuf_adj(payload, len);
+		if (unlikely(rte_pktmbuf_chain(hdr, payload) != 0)) {
+			rte_pktmbuf_free(hdr);
+			rte_pktmbuf_free(payload);
+			return SPPWK_RET_NG;
+		}
+	}
+
+	/* Release only reference of this port, others are not changed. */
+	rte_pktmbuf_free(org);
+	*pkt = hdr;
+	return SPPWK_RET_OK;
+}
+
+/**
+ * Give private headers to shared packets before changing them. Packets
+ * failed are moved to the end of `pkts` keeping the order of others, and it
+ * returns the num of remained packets.
+ */
+static inline int
+unshare_pkt_hdrs(struct rte_mbuf **pkts, int nb_pkts)
+{
+	int cnt = 0;
+	struct rte_mbuf *ng_pkt = NULL;
+
+	while (cnt < nb_pkts) {
+		if (likely(!is_pkt_shared(pkts[cnt])) ||
+				likely(unshare_pkt_hdr(&pkts[cnt]) ==
+					SPPWK_RET_OK)) {
+			cnt++;
+			continue;
+		}
+
+		RTE_LOG(DEBUG, PORT, "Failed to unshare header of packet.\n");
+		ng_pkt = pkts[cnt];
+		nb_pkts--;
+		memmove(&pkts[cnt], &pkts[cnt + 1],
+				sizeof(struct rte_mbuf *) * (nb_pkts - cnt));
+		pkts[nb_pkts] = ng_pkt;
+	}
+	return nb_pkts;
+}
 
-/* Add or delete VLAN tag. */
+/* Run compiled actions of the port, such as adding or deleting VLAN tag. */
 static inline int
 vlan_operation(uint16_t port_id, struct rte_mbuf **pkts, const uint16_t nb_pkts,
 		enum sppwk_port_dir dir)
 {
-	int cnt, buf;
-	int ok_pkts = nb_pkts;
-	struct sppwk_port_attrs *port_attrs = NULL;
+	int buf;
+	int ok_pkts;
+	int nb_own;
+	struct port_capabl_mng_info *mng = NULL;
+	struct port_act_prog *prog = NULL;
+
+	if (dir == SPPWK_PORT_DIR_RX)
+		mng = &g_port_mng_info[port_id].rx;
+	else
+		mng = &g_port_mng_info[port_id].tx;
+	prog = &mng->progs[PORT_GEN_SIDE(mng->ref_gen)];
 
-	sppwk_get_port_attrs(&port_attrs, port_id, dir);
-	if (unlikely(port_attrs[0].ops == SPPWK_PORT_OPS_NONE))
+	if (likely(prog->nof_acts == 0))
 		return nb_pkts;
 
-	for (cnt = 0; cnt < PORT_CAPABL_MAX; cnt++) {
-		/* Do nothing if the port is assigned no VLAN feature. */
-		if (port_attrs[cnt].ops == SPPWK_PORT_OPS_NONE)
-			break;
+	/**
+	 * Packets shared with others, such as clones of spp_mirror, cannot
+	 * be changed in place and rte_vlan_insert() fails for them.
+	 */
+	nb_own = unshare_pkt_hdrs(pkts, nb_pkts);
 
-		/* Add or delete VLAN tag with operation function. */
-		ok_pkts = vlan_ops[port_attrs[cnt].ops](
-				pkts, ok_pkts, &port_attrs->capability);
-	}
+	if (prog->burst_f != NULL)
+		ok_pkts = prog->burst_f(pkts, nb_own, prog->burst_cap);
+	else
+		ok_pkts = run_port_acts_all(pkts, nb_own, prog,
+				mng->nof_colored);
 
-	/* Discard remained packets to release mbuf. */
-	if (unlikely(ok_pkts < nb_pkts)) {
+	/**
+	 * Discard remained packets to release mbuf. Remained ones of TX are
+	 * released by caller as same as packets failed to send.
+	 */
+	if (unlikely(ok_pkts < nb_pkts) && dir == SPPWK_PORT_DIR_RX) {
 		for (buf = ok_pkts; buf < nb_pkts; buf++)
 			rte_pktmbuf_free(pkts[buf]);
 	}
@@ -375,14 +1945,170 @@ vlan_operation(uint16_t port_id, struct rte_mbuf **pkts, const uint16_t nb_pkts,
 	return ok_pkts;
 }
 
+/**
+ * Receive packets from given port, or from buffer of ring fusion if the port
+ * is fused on current lcore.
+ */
+static inline uint16_t
+eth_rx_burst(uint16_t port_id, struct rte_mbuf **rx_pkts,
+		const uint16_t nb_pkts)
+{
+#ifdef SPP_VF_MODULE
+	if (unlikely(is_ring_fused(port_id)))
+		return ring_fusion_dequeue(port_id, rx_pkts, nb_pkts);
+#endif
+	return rte_eth_rx_burst(port_id, 0, rx_pkts, nb_pkts);
+}
+
+/**
+ * Send packets to given port, or to buffer of ring fusion if the port is
+ * fused on current lcore.
+ */
+static inline uint16_t
+eth_tx_burst(uint16_t port_id, struct rte_mbuf **tx_pkts, uint16_t nb_pkts)
+{
+#ifdef SPP_VF_MODULE
+	if (unlikely(is_ring_fused(port_id)))
+		return ring_fusion_enqueue(port_id, tx_pkts, nb_pkts);
+#endif
+	return rte_eth_tx_burst(port_id, 0, tx_pkts, nb_pkts);
+}
+
+/* Get PCP of the first tag of packet, which might be inserted by NIC. */
+static inline uint32_t
+get_pkt_pcp(struct rte_mbuf *pkt)
+{
+	struct rte_ether_hdr *ether = NULL;
+
+	if (pkt->ol_flags & PKT_TX_QINQ)
+		return pkt->vlan_tci_outer >> 13;
+	if (pkt->ol_flags & PKT_TX_VLAN)
+		return pkt->vlan_tci >> 13;
+
+	ether = rte_pktmbuf_mtod(pkt, struct rte_ether_hdr *);
+	if (!is_tag_tpid(ether->ether_type))
+		return 0;
+	return rte_be_to_cpu_16(*(unaligned_uint16_t *)(ether + 1)) >> 13;
+}
+
+/* Read stats of traffic classes from scheduler and accumulate them. */
+static void
+read_shaper_stats(struct port_shaper *shaper, struct rte_sched_port *sched)
+{
+	uint32_t pcp, tc, tc_ov;
+	uint16_t qlen;
+	struct rte_sched_subport_stats subport;
+	struct rte_sched_queue_stats queue;
+
+	/* Counters of rte_sched are cleared for each reading. */
+	if (unlikely(rte_sched_subport_read_stats(sched, 0, &subport,
+			&tc_ov) != 0))
+		return;
+
+	for (pcp = 0; pcp < SPPWK_SHAPER_NOF_TCS; pcp++) {
+		tc = SHAPER_TC(pcp);
+		shaper->stats.nof_pkts[pcp] += subport.n_pkts_tc[tc];
+		shaper->stats.nof_dropped[pcp] += subport.n_pkts_tc_dropped[tc];
+
+		/* ID of the first queue of the TC of the only one pipe. */
+		if (likely(rte_sched_queue_read_stats(sched, tc, &queue,
+				&qlen) == 0))
+			shaper->stats.qlen[pcp] = qlen;
+	}
+}
+
+/* Send packets dequeued from shaper of the port. */
+static inline void
+drain_shaper(uint16_t port_id, struct port_shaper *shaper,
+		struct rte_sched_port *sched)
+{
+	int buf, nb_deq, nb_tx;
+	uint64_t tsc;
+	struct rte_mbuf *pkts[MAX_PKT_BURST];
+
+	nb_deq = rte_sched_port_dequeue(sched, pkts, MAX_PKT_BURST);
+	if (nb_deq > 0) {
+		nb_tx = eth_tx_burst(port_id, pkts, nb_deq);
+		for (buf = nb_tx; buf < nb_deq; buf++)
+			rte_pktmbuf_free(pkts[buf]);
+	}
+
+	tsc = rte_rdtsc();
+	if (unlikely(tsc - shaper->stats_tsc > shaper->stats_period)) {
+		read_shaper_stats(shaper, sched);
+		shaper->stats_tsc = tsc;
+	}
+}
+
+/**
+ * Send packets which can be dequeued from a shaper being replaced. Packets
+ * not dequeued for its rate are freed with the shaper by master.
+ */
+static void
+flush_shaper(uint16_t port_id, struct rte_sched_port *sched)
+{
+	int buf, nb_deq, nb_tx;
+	struct rte_mbuf *pkts[MAX_PKT_BURST];
+
+	while ((nb_deq = rte_sched_port_dequeue(sched, pkts,
+			MAX_PKT_BURST)) > 0) {
+		nb_tx = eth_tx_burst(port_id, pkts, nb_deq);
+		for (buf = nb_tx; buf < nb_deq; buf++)
+			rte_pktmbuf_free(pkts[buf]);
+	}
+}
+
+/**
+ * Send packets to the port through its shaper if it is shaped. All of
+ * packets are owned by shaper, and dropped ones are freed in it.
+ */
+static inline uint16_t
+eth_tx_burst_shaped(uint16_t port_id, struct rte_mbuf **tx_pkts,
+		uint16_t nb_pkts)
+{
+	uint16_t cnt;
+	struct port_mng_info *port_mng = &g_port_mng_info[port_id];
+	struct port_capabl_mng_info *mng = &port_mng->tx;
+	struct rte_sched_port *sched =
+			mng->progs[PORT_GEN_SIDE(mng->ref_gen)].sched;
+
+	if (likely(sched == NULL))
+		return eth_tx_burst(port_id, tx_pkts, nb_pkts);
+
+	for (cnt = 0; cnt < nb_pkts; cnt++)
+		rte_sched_port_pkt_write(sched, tx_pkts[cnt], 0, 0,
+				SHAPER_TC(get_pkt_pcp(tx_pkts[cnt])), 0,
+				RTE_COLOR_GREEN);
+	rte_sched_port_enqueue(sched, tx_pkts, nb_pkts);
+
+	drain_shaper(port_id, &port_mng->shaper, sched);
+	return nb_pkts;
+}
+
+/* Send packets remained in shaper of the port while nothing is sent. */
+void
+sppwk_eth_vlan_tx_drain(uint16_t port_id)
+{
+	struct port_mng_info *port_mng = &g_port_mng_info[port_id];
+	struct port_capabl_mng_info *mng = &port_mng->tx;
+	struct rte_sched_port *sched =
+			mng->progs[PORT_GEN_SIDE(mng->ref_gen)].sched;
+
+	if (likely(sched == NULL))
+		return;
+	drain_shaper(port_id, &port_mng->shaper, sched);
+}
+
 /* Wrapper function for rte_eth_rx_burst() with VLAN feature. */
 uint16_t
 sppwk_eth_vlan_rx_burst(uint16_t port_id,
+		enum port_type iface_type __attribute__ ((unused)),
+		int iface_no __attribute__ ((unused)),
 		uint16_t queue_id __attribute__ ((unused)),
 		struct rte_mbuf **rx_pkts, const uint16_t nb_pkts)
 {
 	uint16_t nb_rx;
-	nb_rx = rte_eth_rx_burst(port_id, 0, rx_pkts, nb_pkts);
+	nb_rx = eth_rx_burst(port_id, rx_pkts, nb_pkts);
 	if (unlikely(nb_rx == 0))
 		return SPPWK_RET_OK;
 
@@ -393,8 +2119,10 @@ sppwk_eth_vlan_rx_burst(uint16_t port_id,
 /* Wrapper function for rte_eth_tx_burst() with VLAN feature. */
 uint16_t
 sppwk_eth_vlan_tx_burst(uint16_t port_id,
+		enum port_type iface_type __attribute__ ((unused)),
+		int iface_no __attribute__ ((unused)),
 		uint16_t queue_id __attribute__ ((unused)),
-		struct rte_mbuf **tx_pkts, uint16_t nb_pkts)
+		struct rte_mbuf **tx_pkts, const uint16_t nb_pkts)
 {
 	uint16_t nb_tx;
 
@@ -404,38 +2132,40 @@ sppwk_eth_vlan_tx_burst(uint16_t port_id,
 	if (unlikely(nb_tx == 0))
 		return SPPWK_RET_OK;
 
-	return rte_eth_tx_burst(port_id, 0, tx_pkts, nb_tx);
+	return eth_tx_burst_shaped(port_id, tx_pkts, nb_tx);
 }
 
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
-
-/* Wrapper function for rte_eth_rx_burst() with VLAN feature. */
+/* Wrapper function for rte_eth_rx_burst() with VLAN and latency stats. */
 uint16_t
-sppwk_eth_vlan_ring_stats_rx_burst(uint16_t port_id,
+sppwk_eth_vlan_stats_rx_burst(uint16_t port_id,
 		enum port_type iface_type, int iface_no,
 		uint16_t queue_id __attribute__ ((unused)),
 		struct rte_mbuf **rx_pkts, const uint16_t nb_pkts)
 {
 	uint16_t nb_rx;
-	nb_rx = rte_eth_rx_burst(port_id, 0, rx_pkts, nb_pkts);
+	nb_rx = eth_rx_burst(port_id, rx_pkts, nb_pkts);
 	if (unlikely(nb_rx == 0))
 		return SPPWK_RET_OK;
 
 	if (iface_type == RING)
-		sppwk_calc_ring_latency(iface_no, rx_pkts, nb_pkts);
+		sppwk_calc_ring_latency(iface_no, rx_pkts, nb_rx);
+	else
+		sppwk_add_e2e_latency_time(port_id, iface_type, iface_no,
+				rx_pkts, nb_rx);
 
 	/* Add or delete VLAN tag. */
 	return vlan_operation(port_id, rx_pkts, nb_rx, SPPWK_PORT_DIR_RX);
 }
 
-/* Wrapper function for rte_eth_tx_burst() with VLAN feature. */
+/* Wrapper function for rte_eth_tx_burst() with VLAN and latency stats. */
 uint16_t
-sppwk_eth_vlan_ring_stats_tx_burst(uint16_t port_id,
+sppwk_eth_vlan_stats_tx_burst(uint16_t port_id,
 		enum port_type iface_type, int iface_no,
 		uint16_t queue_id __attribute__ ((unused)),
-		struct rte_mbuf **tx_pkts, uint16_t nb_pkts)
+		struct rte_mbuf **tx_pkts, const uint16_t nb_pkts)
 {
 	uint16_t nb_tx;
+	uint64_t start;
 
 	/* Add or delete VLAN tag. */
 	nb_tx = vlan_operation(port_id, tx_pkts, nb_pkts, SPPWK_PORT_DIR_TX);
@@ -444,10 +2174,16 @@ sppwk_eth_vlan_ring_stats_tx_burst(uint16_t port_id,
 		return SPPWK_RET_OK;
 
 	if (iface_type == RING) {
-		sppwk_add_ring_latency_time(iface_no, tx_pkts, nb_pkts);
+		sppwk_add_ring_latency_time(iface_no, tx_pkts, nb_tx);
+		return eth_tx_burst_shaped(port_id, tx_pkts, nb_tx);
 	}
 
-	return rte_eth_tx_burst(port_id, 0, tx_pkts, nb_tx);
+	/* Time in TX burst, in rte_vhost_enqueue_burst() for vhost. */
+	sppwk_calc_e2e_latency(port_id, iface_type, iface_no, tx_pkts,
+			nb_tx);
+	start = sppwk_start_tx_burst_time(iface_type, iface_no);
+	nb_tx = eth_tx_burst_shaped(port_id, tx_pkts, nb_tx);
+	if (unlikely(start != 0))
+		sppwk_calc_tx_burst_time(iface_type, iface_no, start);
+	return nb_tx;
 }
-
-#endif /* SPP_RINGLATENCYSTATS_ENABLE */
@@ -17,15 +17,9 @@
 /** Calculate TCI of VLAN tag. */
 #define SPP_VLANTAG_CALC_TCI(id, pcp) (((pcp & 0x07) << 13) | (id & 0x0fff))
 
-/** Type for swaping sides . */
-enum sppwk_swap_type {
-	SPPWK_SWAP_REF,  /** Swap to reference area. */
-	SPPWK_SWAP_UPD,  /** Swap to update area. */
-};
-
 /**
- * Initialize global variable g_port_mng_info, and set ref side to 0 and
- * update side to 1.
+ * Initialize global variable g_port_mng_info, and set generation of port
+ * attributes of all ports to 0.
  */
 void sppwk_port_capability_init(void);
 
@@ -40,17 +34,54 @@ void sppwk_get_port_attrs(
 		struct sppwk_port_attrs **p_attrs,
 		int port_id, enum sppwk_port_dir dir);
 
+/** Num of packets colored by meter of a port. */
+struct sppwk_meter_stats {
+	uint64_t green;  /**< Packets conformed to committed rate. */
+	uint64_t yellow;  /**< Packets exceeded committed rate. */
+	uint64_t red;  /**< Packets dropped or marked. */
+};
+
 /**
- * Swap ref side and update side.
+ * Get num of packets colored by meter of given port and direction. Counters
+ * are not cleared while the process is running.
  *
- * @param port_id Etherdev ID.
- * @param rxtx RX/TX ID of port_id.
- * @param type Type for changing index.
+ * @param[out] stats Num of packets of each color.
+ * @param[in] port_id Etherdev ID.
+ * @param[in] dir Direction of the port of sppwk_port_dir.
  */
-void sppwk_swap_two_sides(
-		enum sppwk_swap_type swap_type,
+void sppwk_get_meter_stats(struct sppwk_meter_stats *stats,
 		int port_id, enum sppwk_port_dir dir);
 
+/** Num of traffic classes of shaper, one for each PCP. */
+#define SPPWK_SHAPER_NOF_TCS 8
+
+/** Stats of shaper of a TX port indexed by PCP. */
+struct sppwk_shaper_stats {
+	uint64_t nof_pkts[SPPWK_SHAPER_NOF_TCS];  /**< Packets sent. */
+	uint64_t nof_dropped[SPPWK_SHAPER_NOF_TCS];  /**< Packets dropped. */
+	uint32_t qlen[SPPWK_SHAPER_NOF_TCS];  /**< Queue depth. */
+};
+
+/**
+ * Get stats of each traffic class of shaper of given port. Stats are read
+ * from the scheduler periodically by the lcore sending to the port.
+ *
+ * @param[out] stats Stats indexed by PCP.
+ * @param[in] port_id Etherdev ID.
+ */
+void sppwk_get_shaper_stats(struct sppwk_shaper_stats *stats, int port_id);
+
+/**
+ * Take the latest generation of port attributes of given ID and direction
+ * published by master. It is called from the lcore of the component using
+ * the port when it takes updated info of the component, so that only ports
+ * of updated components are switched.
+ *
+ * @param[in] port_id Etherdev ID.
+ * @param[in] dir Direction of the port of sppwk_port_dir.
+ */
+void sppwk_take_port_attrs(int port_id, enum sppwk_port_dir dir);
+
 /**
  * Update port direction of given component.
  *
@@ -59,7 +90,26 @@ void sppwk_swap_two_sides(
 void sppwk_update_port_dir(const struct sppwk_comp_info *comp);
 
 /**
- * Wrapper function for rte_eth_rx_burst() with VLAN feature.
+ * Publish empty attributes of given direction of a port deleted from a
+ * component. Shaper of TX port is retired, and freed in
+ * sppwk_free_retired_shapers() after lcores take updated info.
+ *
+ * @param port Pointer to sppwk_port_info of which attrs are cleared.
+ * @param[in] dir Direction of the port of sppwk_port_dir.
+ */
+void sppwk_reset_port_attrs(struct sppwk_port_info *port,
+		enum sppwk_port_dir dir);
+
+/**
+ * Free shapers replaced or released in flush with their queued packets. It
+ * should be called after updated components are taken by lcores, because
+ * they are not referred anymore.
+ */
+void sppwk_free_retired_shapers(void);
+
+/**
+ * Wrapper function for rte_eth_rx_burst() with VLAN feature. It is a plain
+ * burst function of sppwk_burst_ops, and type and ID of port are not used.
  *
  * @param[in] port_id Etherdev ID.
  * @param[in] queue_id RX queue ID, but fixed value 0 in SPP.
@@ -67,11 +117,13 @@ void sppwk_update_port_dir(const struct sppwk_comp_info *comp);
  * @param nb_pkts Maximum number of RX packets.
  * @return Number of RX packets as number of pointers to mbuf.
  */
-uint16_t sppwk_eth_vlan_rx_burst(uint16_t port_id, uint16_t queue_id,
+uint16_t sppwk_eth_vlan_rx_burst(uint16_t port_id,
+		enum port_type iface_type, int iface_no, uint16_t queue_id,
 		struct rte_mbuf **rx_pkts, const uint16_t nb_pkts);
 
 /**
- * Wrapper function for rte_eth_tx_burst() with VLAN feature.
+ * Wrapper function for rte_eth_tx_burst() with VLAN feature. It is a plain
+ * burst function of sppwk_burst_ops, and type and ID of port are not used.
  *
  * @param port_id Etherdev ID.
  * @param[in] queue_id TX queue ID, but fixed value 0 in SPP.
@@ -79,7 +131,17 @@ uint16_t sppwk_eth_vlan_rx_burst(uint16_t port_id, uint16_t queue_id,
  * @param nb_pkts Maximum number of TX packets.
  * @return Number of TX packets as number of pointers to mbuf.
  */
-uint16_t sppwk_eth_vlan_tx_burst(uint16_t port_id, uint16_t queue_id,
-		struct rte_mbuf **tx_pkts, uint16_t nb_pkts);
+uint16_t sppwk_eth_vlan_tx_burst(uint16_t port_id,
+		enum port_type iface_type, int iface_no, uint16_t queue_id,
+		struct rte_mbuf **tx_pkts, const uint16_t nb_pkts);
+
+/**
+ * Send packets remained in shaper of the port. It should be called by the
+ * lcore sending to the port while it has nothing to be sent, because packets
+ * are dequeued from shaper only when sending.
+ *
+ * @param port_id Etherdev ID.
+ */
+void sppwk_eth_vlan_tx_drain(uint16_t port_id);
 
 #endif /*  __PORT_CAPABILITY_H__ */
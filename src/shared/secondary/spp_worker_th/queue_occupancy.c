@@ -0,0 +1,213 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <rte_ethdev.h>
+#include <rte_eth_vhost.h>
+#include <rte_vhost.h>
+#include <rte_cycles.h>
+#include <rte_ring.h>
+#include "queue_occupancy.h"
+#include "cmd_res_formatter.h"
+#include "shared/secondary/return_codes.h"
+#include "shared/secondary/string_buffer.h"
+#include "shared/secondary/json_helper.h"
+
+#define RTE_LOGTYPE_WK_QUEUE_OCC RTE_LOGTYPE_USER1
+
+/* Num of types of port sampled, it should be larger than PHY, RING, VHOST. */
+#define QUEUE_OCC_PORT_TYPES (VHOST + 1)
+
+/* Virtqueue of packets sent from the guest, which is RX queue of vhost. */
+#define QUEUE_OCC_VHOST_RXQ 1
+
+/* Occupancy of RX queue of a port and how to get it. */
+struct port_occupancy {
+	int ethdev_port_id;  /* Etherdev ID sampled, or -1 if not yet. */
+	struct rte_ring *ring;  /* Ring of ring port, or NULL for others. */
+	int supported;  /* 0 if PMD does not support counting RX queue. */
+	struct queue_occupancy occ;
+};
+
+static struct port_occupancy g_port_occ[QUEUE_OCC_PORT_TYPES][RTE_MAX_ETHPORTS];
+static uint64_t g_prev_tsc;
+
+/* Clear occupancy of all of ports, and start sampling. */
+void
+init_queue_occupancy(void)
+{
+	int type, cnt;
+
+	memset(g_port_occ, 0x00, sizeof(g_port_occ));
+	for (type = 0; type < QUEUE_OCC_PORT_TYPES; type++) {
+		for (cnt = 0; cnt < RTE_MAX_ETHPORTS; cnt++)
+			g_port_occ[type][cnt].ethdev_port_id = -1;
+	}
+	g_prev_tsc = rte_rdtsc();
+}
+
+/**
+ * Clear occupancy of given port and setup how to count its RX queue, for
+ * the port sampled first time or added again.
+ */
+static void
+setup_port_occupancy(struct port_occupancy *port_occ,
+		const struct sppwk_port_info *port)
+{
+	struct rte_eth_rxq_info qinfo;
+
+	memset(port_occ, 0x00, sizeof(*port_occ));
+	port_occ->ethdev_port_id = port->ethdev_port_id;
+
+	if (port->iface_type == RING) {
+		port_occ->ring = rte_ring_lookup(
+				get_rx_queue_name(port->iface_no));
+		if (port_occ->ring != NULL) {
+			port_occ->occ.size = rte_ring_get_capacity(
+					port_occ->ring);
+			port_occ->supported = 1;
+		}
+	} else if (port->iface_type == VHOST) {
+		/* Size is got from vring after the guest is connected. */
+		port_occ->supported = 1;
+	} else {
+		if (rte_eth_rx_queue_count(port->ethdev_port_id, 0) >= 0)
+			port_occ->supported = 1;
+		if (rte_eth_rx_queue_info_get(port->ethdev_port_id, 0,
+				&qinfo) == 0)
+			port_occ->occ.size = qinfo.nb_desc;
+	}
+
+	if (!port_occ->supported)
+		RTE_LOG(INFO, WK_QUEUE_OCC,
+				"Occupancy of port %d is not supported.\n",
+				port->ethdev_port_id);
+}
+
+/**
+ * Count packets sent from the guest and not received yet on vhost port, or
+ * return -1 if the guest is not connected.
+ */
+static int
+count_vhost_rx_queue(struct port_occupancy *port_occ, uint16_t port_id)
+{
+	int vid = rte_eth_vhost_get_vid_from_port_id(port_id);
+	struct rte_vhost_vring vring;
+
+	if (vid < 0)
+		return -1;
+	if (port_occ->occ.size == 0 && rte_vhost_get_vhost_vring(vid,
+			QUEUE_OCC_VHOST_RXQ, &vring) == 0)
+		port_occ->occ.size = vring.size;
+	return (int)rte_vhost_rx_queue_count(vid, QUEUE_OCC_VHOST_RXQ);
+}
+
+/* Sample num of packets in RX queue of given port. */
+static void
+sample_port_occupancy(const struct sppwk_port_info *port)
+{
+	int count;
+	struct port_occupancy *port_occ;
+
+	if (port->ethdev_port_id < 0 ||
+			port->iface_type >= QUEUE_OCC_PORT_TYPES)
+		return;
+
+	port_occ = &g_port_occ[port->iface_type][port->iface_no];
+	if (port_occ->ethdev_port_id != port->ethdev_port_id)
+		setup_port_occupancy(port_occ, port);
+	if (!port_occ->supported)
+		return;
+
+	if (port_occ->ring != NULL)
+		count = rte_ring_count(port_occ->ring);
+	else if (port->iface_type == VHOST)
+		count = count_vhost_rx_queue(port_occ, port->ethdev_port_id);
+	else
+		count = rte_eth_rx_queue_count(port->ethdev_port_id, 0);
+	if (unlikely(count < 0))
+		return;
+
+	add_queue_occupancy(&port_occ->occ, count);
+}
+
+/* Sample num of packets in RX queue of each of ports. */
+void
+run_queue_occupancy(void)
+{
+	int cnt;
+	uint64_t cur_tsc = rte_rdtsc();
+	struct iface_info *iface_info = NULL;
+
+	if (cur_tsc - g_prev_tsc <
+			rte_get_tsc_hz() / 1000 * QUEUE_OCC_INTERVAL_MS)
+		return;
+	g_prev_tsc = cur_tsc;
+
+	sppwk_get_mng_data(&iface_info, NULL, NULL, NULL, NULL, NULL);
+	for (cnt = 0; cnt < RTE_MAX_ETHPORTS; cnt++) {
+		sample_port_occupancy(&iface_info->phy[cnt]);
+		sample_port_occupancy(&iface_info->vhost[cnt]);
+		sample_port_occupancy(&iface_info->ring[cnt]);
+	}
+}
+
+/* Add occupancy of RX queue of a port to given JSON array if sampled. */
+static int
+append_port_occupancy_value(char **output,
+		const struct sppwk_port_info *port)
+{
+	int len;
+	char port_uid[CMD_TAG_APPEND_SIZE];
+	char occ_str[CMD_TAG_APPEND_SIZE + QUEUE_OCC_JSON_LEN];
+	const struct port_occupancy *port_occ;
+
+	if (port->ethdev_port_id < 0 ||
+			port->iface_type >= QUEUE_OCC_PORT_TYPES)
+		return SPPWK_RET_OK;
+	port_occ = &g_port_occ[port->iface_type][port->iface_no];
+	if (port_occ->ethdev_port_id != port->ethdev_port_id ||
+			!port_occ->supported)
+		return SPPWK_RET_OK;
+
+	sppwk_port_uid(port_uid, port->iface_type, port->iface_no);
+	len = sprintf(occ_str, "\"port\":\"%s\",", port_uid);
+	queue_occupancy_json(occ_str + len, sizeof(occ_str) - len,
+			&port_occ->occ);
+	return append_json_block_brackets(output, "", occ_str);
+}
+
+/* Add entry of occupancy of RX queue of each of ports in JSON. */
+int
+add_queue_occupancy_status(const char *name, char **output,
+		void *tmp __attribute__ ((unused)))
+{
+	int ret = SPPWK_RET_OK;
+	int cnt;
+	struct iface_info *iface_info = NULL;
+	char *array_buff;
+
+	array_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(array_buff == NULL)) {
+		RTE_LOG(ERR, WK_QUEUE_OCC, "Failed to alloc buff.\n");
+		return SPPWK_RET_NG;
+	}
+
+	sppwk_get_mng_data(&iface_info, NULL, NULL, NULL, NULL, NULL);
+	for (cnt = 0; cnt < RTE_MAX_ETHPORTS && ret == SPPWK_RET_OK; cnt++)
+		ret = append_port_occupancy_value(&array_buff,
+				&iface_info->phy[cnt]);
+	for (cnt = 0; cnt < RTE_MAX_ETHPORTS && ret == SPPWK_RET_OK; cnt++)
+		ret = append_port_occupancy_value(&array_buff,
+				&iface_info->vhost[cnt]);
+	for (cnt = 0; cnt < RTE_MAX_ETHPORTS && ret == SPPWK_RET_OK; cnt++)
+		ret = append_port_occupancy_value(&array_buff,
+				&iface_info->ring[cnt]);
+
+	if (likely(ret == SPPWK_RET_OK))
+		ret = append_json_array_brackets(output, name, array_buff);
+	else
+		RTE_LOG(ERR, WK_QUEUE_OCC, "Failed to add occupancy.\n");
+	spp_strbuf_free(array_buff);
+	return ret;
+}
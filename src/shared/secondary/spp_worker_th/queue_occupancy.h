@@ -0,0 +1,51 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#ifndef __SPPWK_QUEUE_OCCUPANCY_H__
+#define __SPPWK_QUEUE_OCCUPANCY_H__
+
+/**
+ * @file
+ * SPP queue occupancy
+ *
+ * Num of packets waiting in the RX queue of each of ports is sampled from
+ * the loop of master thread, so that it costs nothing on worker lcores. It is
+ * the count of the ring for ring port, rte_eth_rx_queue_count() for phy port,
+ * which is not supported by some of PMDs, and rte_vhost_rx_queue_count() for
+ * vhost port because vhost PMD does not support rte_eth_rx_queue_count().
+ * Queue of vhost to the guest is not sampled, because it is consumed by the
+ * guest and not by SPP.
+ *
+ * A queue kept almost full means its consumer is too slow, and a queue
+ * getting full only for a moment while the average is low means bursts of
+ * the producer overflow it.
+ */
+
+#include "shared/common.h"
+#include "cmd_utils.h"
+
+/* Clear occupancy of all of ports, and start sampling. */
+void init_queue_occupancy(void);
+
+/**
+ * Sample num of packets in the RX queue of each of ports. It is called from
+ * the loop of master thread and does nothing until the interval is passed.
+ * Occupancy of a port is cleared if its etherdev ID is changed.
+ */
+void run_queue_occupancy(void);
+
+/**
+ * Add entry of occupancy of RX queue of each of ports to a response in JSON.
+ * Ports of which PMD does not support counting RX queue are not included.
+ *
+ * @param[in] name Name of the entry.
+ * @param[in,out] output Placeholder of JSON msg.
+ * @param tmp Not used.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int add_queue_occupancy_status(const char *name, char **output,
+		void *tmp __attribute__ ((unused)));
+
+#endif /* __SPPWK_QUEUE_OCCUPANCY_H__ */
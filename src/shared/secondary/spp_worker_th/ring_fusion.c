@@ -0,0 +1,258 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#include "ring_fusion.h"
+#include "cmd_res_formatter.h"
+#include "shared/secondary/return_codes.h"
+#include "shared/secondary/string_buffer.h"
+#include "shared/secondary/json_helper.h"
+
+#define RTE_LOGTYPE_WK_RING_FUSION RTE_LOGTYPE_USER1
+
+struct ring_fusion g_ring_fusion[RTE_MAX_ETHPORTS];
+
+/* Clear g_ring_fusion and release fusion of all ports. */
+void
+init_ring_fusion(void)
+{
+	int cnt;
+	memset(g_ring_fusion, 0x00, sizeof(g_ring_fusion));
+	for (cnt = 0; cnt < RTE_MAX_ETHPORTS; cnt++) {
+		g_ring_fusion[cnt].lcore_id = RING_FUSION_NONE;
+		g_ring_fusion[cnt].next_lcore_id = RING_FUSION_NONE;
+	}
+}
+
+/* Return 1 if given component is assigned to given lcore, or 0. */
+static int
+is_comp_on_lcore(int comp_id, unsigned int lcore_id)
+{
+	int cnt;
+	struct core_info *core = get_core_info(lcore_id);
+
+	for (cnt = 0; cnt < core->num; cnt++) {
+		if (core->id[cnt] == comp_id)
+			return 1;
+	}
+	return 0;
+}
+
+/**
+ * Get lcore on which given ring port can be fused. It is the lcore running
+ * both of the only component sending to the port and the only one receiving
+ * from it, or RING_FUSION_NONE.
+ */
+static unsigned int
+get_fusible_lcore(const struct sppwk_port_info *ring,
+		const struct sppwk_comp_info *comp_info_base)
+{
+	int cnt, port_cnt;
+	int nof_tx_comps = 0, nof_rx_comps = 0;
+	const struct sppwk_comp_info *tx_comp = NULL;
+	const struct sppwk_comp_info *rx_comp = NULL;
+	const struct sppwk_comp_info *comp = NULL;
+
+	for (cnt = 0; cnt < RTE_MAX_LCORE; cnt++) {
+		comp = (comp_info_base + cnt);
+		if (comp->wk_type == SPPWK_TYPE_NONE)
+			continue;
+
+		for (port_cnt = 0; port_cnt < comp->nof_tx; port_cnt++) {
+			if (comp->tx_ports[port_cnt] == ring) {
+				tx_comp = comp;
+				nof_tx_comps++;
+			}
+		}
+		for (port_cnt = 0; port_cnt < comp->nof_rx; port_cnt++) {
+			if (comp->rx_ports[port_cnt] == ring) {
+				rx_comp = comp;
+				nof_rx_comps++;
+			}
+		}
+	}
+
+	if (nof_tx_comps != 1 || nof_rx_comps != 1 || tx_comp == rx_comp)
+		return RING_FUSION_NONE;
+	if (tx_comp->lcore_id != rx_comp->lcore_id)
+		return RING_FUSION_NONE;
+
+	/* Component being moved is not on any lcore for a while. */
+	if (!is_comp_on_lcore(tx_comp->comp_id, tx_comp->lcore_id) ||
+			!is_comp_on_lcore(rx_comp->comp_id, rx_comp->lcore_id))
+		return RING_FUSION_NONE;
+	return tx_comp->lcore_id;
+}
+
+/* Publish lcores requested to change fusion and wait for them. */
+static int
+publish_ring_fusion(int nof_changed)
+{
+	if (nof_changed == 0)
+		return SPPWK_RET_OK;
+
+	update_lcore_info();
+	return sppwk_wait_update_done();
+}
+
+/* Decide ring ports to be fused, and wait for lcores applying it. */
+int
+update_ring_fusion(void)
+{
+	int cnt, ret;
+	int nof_changed = 0;
+	unsigned int lcore_id;
+	unsigned int fusible[RTE_MAX_ETHPORTS];
+	struct iface_info *iface_info = NULL;
+	struct sppwk_comp_info *comp_info_base = NULL;
+	struct sppwk_port_info *ring = NULL;
+	struct ring_fusion *fusion = NULL;
+	int *change_core = NULL;
+
+	sppwk_get_mng_data(&iface_info, &comp_info_base, NULL, &change_core,
+			NULL, NULL);
+
+	for (cnt = 0; cnt < RTE_MAX_ETHPORTS; cnt++)
+		fusible[cnt] = RING_FUSION_NONE;
+	for (cnt = 0; cnt < RTE_MAX_ETHPORTS; cnt++) {
+		ring = &iface_info->ring[cnt];
+		if (ring->ethdev_port_id < 0)
+			continue;
+		fusible[ring->ethdev_port_id] = get_fusible_lcore(ring,
+				comp_info_base);
+	}
+
+	/**
+	 * Release fusion first, because a port should not be fused on two
+	 * lcores at once if its components are moved to another lcore.
+	 */
+	for (cnt = 0; cnt < RTE_MAX_ETHPORTS; cnt++) {
+		fusion = &g_ring_fusion[cnt];
+		lcore_id = fusion->lcore_id;
+		if (lcore_id == RING_FUSION_NONE || lcore_id == fusible[cnt])
+			continue;
+		RTE_LOG(INFO, WK_RING_FUSION,
+				"Release fusion of port %d on lcore %u.\n",
+				cnt, lcore_id);
+		fusion->next_lcore_id = RING_FUSION_NONE;
+		*(change_core + lcore_id) = 1;
+		nof_changed++;
+	}
+	ret = publish_ring_fusion(nof_changed);
+	if (unlikely(ret != SPPWK_RET_OK))
+		return ret;
+
+	nof_changed = 0;
+	for (cnt = 0; cnt < RTE_MAX_ETHPORTS; cnt++) {
+		fusion = &g_ring_fusion[cnt];
+		lcore_id = fusible[cnt];
+		if (lcore_id == RING_FUSION_NONE ||
+				fusion->lcore_id != RING_FUSION_NONE)
+			continue;
+		RTE_LOG(INFO, WK_RING_FUSION,
+				"Fuse port %d on lcore %u.\n", cnt, lcore_id);
+		fusion->next_lcore_id = lcore_id;
+		*(change_core + lcore_id) = 1;
+		nof_changed++;
+	}
+	return publish_ring_fusion(nof_changed);
+}
+
+/* Send packets remained in the buffer of fused port to the ring. */
+static void
+flush_fused_pkts(uint16_t port_id)
+{
+	uint16_t buf, nb_pkts, nb_tx;
+	struct rte_mbuf *pkts[MAX_PKT_BURST];
+	struct ring_fusion *fusion = &g_ring_fusion[port_id];
+
+	while ((nb_pkts = ring_fusion_dequeue_buf(fusion, pkts,
+			MAX_PKT_BURST)) > 0) {
+		nb_tx = rte_eth_tx_burst(port_id, 0, pkts, nb_pkts);
+		for (buf = nb_tx; buf < nb_pkts; buf++)
+			rte_pktmbuf_free(pkts[buf]);
+	}
+}
+
+/* Apply fusion requested by master to ports of given lcore. */
+void
+apply_ring_fusion(unsigned int lcore_id)
+{
+	int cnt;
+	struct ring_fusion *fusion = NULL;
+
+	for (cnt = 0; cnt < RTE_MAX_ETHPORTS; cnt++) {
+		fusion = &g_ring_fusion[cnt];
+		if (fusion->lcore_id == lcore_id &&
+				fusion->next_lcore_id != lcore_id) {
+			fusion->draining = 0;
+			flush_fused_pkts(cnt);
+			fusion->head = fusion->tail = 0;
+			fusion->lcore_id = RING_FUSION_NONE;
+		} else if (fusion->lcore_id == RING_FUSION_NONE &&
+				fusion->next_lcore_id == lcore_id) {
+			fusion->draining = 1;
+			fusion->head = fusion->tail = 0;
+			fusion->lcore_id = lcore_id;
+		}
+	}
+}
+
+/* Add entry of fused ring ports to a response in JSON. */
+int
+add_ring_fusion_status(const char *name, char **output,
+		void *tmp __attribute__ ((unused)))
+{
+	int ret = SPPWK_RET_OK;
+	int cnt;
+	char port_uid[CMD_TAG_APPEND_SIZE];
+	struct iface_info *iface_info = NULL;
+	struct sppwk_port_info *ring = NULL;
+	struct ring_fusion *fusion = NULL;
+	char *tmp_buff, *array_buff;
+
+	array_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(array_buff == NULL)) {
+		RTE_LOG(ERR, WK_RING_FUSION, "Failed to alloc buff.\n");
+		return SPPWK_RET_NG;
+	}
+
+	sppwk_get_mng_data(&iface_info, NULL, NULL, NULL, NULL, NULL);
+	for (cnt = 0; cnt < RTE_MAX_ETHPORTS; cnt++) {
+		ring = &iface_info->ring[cnt];
+		if (ring->ethdev_port_id < 0)
+			continue;
+		fusion = &g_ring_fusion[ring->ethdev_port_id];
+		if (fusion->lcore_id == RING_FUSION_NONE)
+			continue;
+
+		tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+		if (unlikely(tmp_buff == NULL)) {
+			ret = SPPWK_RET_NG;
+			break;
+		}
+
+		sppwk_port_uid(port_uid, RING, cnt);
+		ret = append_json_str_value(&tmp_buff, "port", port_uid);
+		if (likely(ret == SPPWK_RET_OK))
+			ret = append_json_uint_value(&tmp_buff, "lcore_id",
+					fusion->lcore_id);
+		if (likely(ret == SPPWK_RET_OK))
+			ret = append_json_uint64_value(&tmp_buff, "pkts",
+					fusion->nof_pkts);
+		if (likely(ret == SPPWK_RET_OK))
+			ret = append_json_uint64_value(&tmp_buff, "dropped",
+					fusion->nof_dropped);
+		if (likely(ret == SPPWK_RET_OK))
+			ret = append_json_block_brackets(&array_buff, "",
+					tmp_buff);
+		spp_strbuf_free(tmp_buff);
+		if (unlikely(ret != SPPWK_RET_OK))
+			break;
+	}
+
+	if (likely(ret == SPPWK_RET_OK))
+		ret = append_json_array_brackets(output, name, array_buff);
+	spp_strbuf_free(array_buff);
+	return ret;
+}
@@ -0,0 +1,177 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#ifndef __SPPWK_RING_FUSION_H__
+#define __SPPWK_RING_FUSION_H__
+
+/**
+ * @file
+ * SPP ring fusion
+ *
+ * If a ring port is the only TX port of a component and the only RX port of
+ * another one in the same process, and both of them are run on the same lcore,
+ * packets are handed over through a buffer of the lcore instead of ring PMD.
+ * It skips ethdev dispatch and CAS of ring for sending. Ring is still used
+ * for components on different lcores, and polled by the receiver after the
+ * buffer because it might be shared with other processes.
+ *
+ * Fusion of ports is decided by master at the end of flush, and applied by
+ * each of lcores when it takes updated info. Packets remained in the buffer
+ * are sent to the ring when fusion is released, and packets remained in the
+ * ring are received before the buffer when fusion is started, so that packets
+ * are not reordered.
+ */
+
+#include <rte_lcore.h>
+#include <rte_ethdev.h>
+#include "cmd_utils.h"
+
+/* Size of buffer for each port, enough for bursts of a turn of component. */
+#define RING_FUSION_BUFSZ (MAX_PKT_BURST * SPPWK_WEIGHT_MAX)
+
+/* Lcore ID means the ring port is not fused. */
+#define RING_FUSION_NONE RTE_MAX_LCORE
+
+/* Buffer and state of fusion of a ring port. */
+struct ring_fusion {
+	/* Lcore running both ends of the ring, or RING_FUSION_NONE. */
+	volatile unsigned int lcore_id;
+	/* Lcore requested by master, applied by the lcore itself. */
+	volatile unsigned int next_lcore_id;
+	int draining;  /* 1 while packets remained in ring are received. */
+	uint32_t head;  /* Index of next packet to be dequeued. */
+	uint32_t tail;  /* Index of next packet to be enqueued. */
+	uint64_t nof_pkts;  /* Num of packets handed over in the buffer. */
+	uint64_t nof_dropped;  /* Num of packets dropped for buffer full. */
+	struct rte_mbuf *pkts[RING_FUSION_BUFSZ];
+} __rte_cache_aligned;
+
+/* State of fusion indexed by ethdev port ID. */
+extern struct ring_fusion g_ring_fusion[RTE_MAX_ETHPORTS];
+
+/**
+ * Check if the port is fused on current lcore.
+ *
+ * @param[in] port_id Etherdev ID.
+ * @return 1 if fused, or 0.
+ */
+static inline int
+is_ring_fused(uint16_t port_id)
+{
+	return g_ring_fusion[port_id].lcore_id == rte_lcore_id();
+}
+
+/**
+ * Enqueue packets to the buffer of fused port instead of rte_eth_tx_burst().
+ * Packets over the size of buffer are not enqueued, and should be freed by
+ * caller as same as ring PMD.
+ *
+ * @param[in] port_id Etherdev ID.
+ * @param[in] pkts Pointers to mbuf.
+ * @param[in] nb_pkts Num of packets.
+ * @return Num of enqueued packets.
+ */
+static inline uint16_t
+ring_fusion_enqueue(uint16_t port_id, struct rte_mbuf **pkts,
+		uint16_t nb_pkts)
+{
+	uint16_t cnt;
+	struct ring_fusion *fusion = &g_ring_fusion[port_id];
+	uint32_t nof_free = RING_FUSION_BUFSZ - (fusion->tail - fusion->head);
+
+	if (unlikely(nof_free < nb_pkts)) {
+		fusion->nof_dropped += nb_pkts - nof_free;
+		nb_pkts = nof_free;
+	}
+
+	for (cnt = 0; cnt < nb_pkts; cnt++)
+		fusion->pkts[(fusion->tail + cnt) & (RING_FUSION_BUFSZ - 1)] =
+				pkts[cnt];
+	fusion->tail += nb_pkts;
+	fusion->nof_pkts += nb_pkts;
+	return nb_pkts;
+}
+
+/* Dequeue packets only from the buffer of fused port. */
+static inline uint16_t
+ring_fusion_dequeue_buf(struct ring_fusion *fusion, struct rte_mbuf **pkts,
+		uint16_t nb_pkts)
+{
+	uint16_t cnt;
+	uint16_t nb_rx;
+
+	nb_rx = RTE_MIN((uint32_t)nb_pkts, fusion->tail - fusion->head);
+	for (cnt = 0; cnt < nb_rx; cnt++)
+		pkts[cnt] = fusion->pkts[(fusion->head + cnt) &
+				(RING_FUSION_BUFSZ - 1)];
+	fusion->head += nb_rx;
+	return nb_rx;
+}
+
+/**
+ * Dequeue packets from the buffer of fused port instead of
+ * rte_eth_rx_burst(). Packets remained in the ring are received first after
+ * fusion is started. The ring is also polled for the rest of nb_pkts after
+ * the buffer, for packets sent from other processes sharing it.
+ *
+ * @param[in] port_id Etherdev ID.
+ * @param[in,out] pkts Pointers to mbuf should be enough to store nb_pkts.
+ * @param[in] nb_pkts Maximum num of packets.
+ * @return Num of dequeued packets.
+ */
+static inline uint16_t
+ring_fusion_dequeue(uint16_t port_id, struct rte_mbuf **pkts,
+		uint16_t nb_pkts)
+{
+	uint16_t nb_rx;
+	struct ring_fusion *fusion = &g_ring_fusion[port_id];
+
+	if (unlikely(fusion->draining)) {
+		nb_rx = rte_eth_rx_burst(port_id, 0, pkts, nb_pkts);
+		if (nb_rx > 0)
+			return nb_rx;
+		fusion->draining = 0;
+	}
+
+	nb_rx = ring_fusion_dequeue_buf(fusion, pkts, nb_pkts);
+	if (nb_rx < nb_pkts)
+		nb_rx += rte_eth_rx_burst(port_id, 0, pkts + nb_rx,
+				nb_pkts - nb_rx);
+	return nb_rx;
+}
+
+/* Clear g_ring_fusion and release fusion of all ports. */
+void init_ring_fusion(void);
+
+/**
+ * Decide ring ports to be fused from current components, and wait for lcores
+ * applying it. It is called from master at the end of flush. Fusion is
+ * released before started for ports moved to another lcore.
+ *
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int update_ring_fusion(void);
+
+/**
+ * Apply fusion requested by master to ports of given lcore. It is called from
+ * the lcore itself when taking updated info.
+ *
+ * @param[in] lcore_id Lcore ID of caller.
+ */
+void apply_ring_fusion(unsigned int lcore_id);
+
+/**
+ * Add entry of fused ring ports to a response in JSON.
+ *
+ * @param[in] name Name of the entry.
+ * @param[in,out] output Placeholder of JSON msg.
+ * @param tmp Not used.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int add_ring_fusion_status(const char *name, char **output,
+		void *tmp __attribute__ ((unused)));
+
+#endif /* __SPPWK_RING_FUSION_H__ */
@@ -18,7 +18,7 @@
 #define NOF_VLAN 4096
 
 /* Num of entries of ops_list in vf_cmd_runner.c. */
-#define NOF_STAT_OPS 8
+#define NOF_STAT_OPS 16
 
 /* Classifier for MAC addresses. */
 struct mac_classifier {
@@ -44,6 +44,8 @@ struct cls_comp_info {
 	char name[STR_LEN_NAME];  /* component name */
 	int mac_addr_entry;  /* mac address entry flag */
 	struct mac_classifier *mac_clfs[NOF_VLAN];  /* classifiers per VLAN. */
+	struct rte_hash *qinq_clfs;  /* classifiers per S-VID and C-VID. */
+	struct rte_hash *vni_clfs;  /* classifiers per VNI of VXLAN. */
 	int nof_tx_ports;  /* Number of TX ports info entries. */
 	/* Classifier has one RX port and several TX ports. */
 	struct cls_port_info rx_port_i;  /* RX port info classified. */
@@ -84,6 +86,24 @@ int update_classifier(struct sppwk_comp_info *wk_comp_info);
  */
 int update_forwarder(struct sppwk_comp_info *wk_comp_info);
 
+/**
+ * Check if updated classifier info is taken by its lcore.
+ *
+ * @param comp_id Component ID.
+ * @retval 1 If it is taken, or nothing is published.
+ * @retval 0 If it is not taken yet.
+ */
+int is_classifier_update_done(int comp_id);
+
+/**
+ * Check if updated forwarder info is taken by its lcore.
+ *
+ * @param comp_id Component ID.
+ * @retval 1 If it is taken, or nothing is published.
+ * @retval 0 If it is not taken yet.
+ */
+int is_forwarder_update_done(int comp_id);
+
 void init_classifier_info(int component_id);
 
 /**
@@ -96,6 +116,16 @@ void init_classifier_info(int component_id);
  */
 int update_comp_info(struct sppwk_comp_info *p_comp_info, int *p_change_comp);
 
+/**
+ * Check if updated info of component is taken by its lcore, used for
+ * waiting for all of updated components in sppwk_wait_update_done().
+ *
+ * @param comp_id Component ID.
+ * @retval 1 If it is taken, or nothing is published.
+ * @retval 0 If it is not taken yet.
+ */
+int is_comp_update_done(int comp_id);
+
 enum sppwk_worker_type get_comp_type_from_str(const char *type_str);
 
 int get_status_ops(struct cmd_res_formatter_ops *ops_list);
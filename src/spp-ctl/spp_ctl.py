@@ -172,6 +172,9 @@ class Controller(object):
     def get_cpu_usage(self):
         """Get cpu usage from each of status of SPP processes.
 
+        Busy and idle cycles of polling on each of lcores are included
+        as `lcore_stats` if the process supports it.
+
         If process returns invalid message or cannot connect, remove
         it from `self.procs` as in _update_procs().
         """
@@ -187,24 +190,28 @@ class Controller(object):
                     cpus.append(
                             {'proc-type': proc.type,
                                 'master-lcore': stat['lcores'][0],
-                                'lcores': stat['lcores']})
+                                'lcores': stat['lcores'],
+                                'lcore_stats': stat.get('lcore_stats', [])})
                 elif proc.type == 'nfv':
                     cpus.append(
                             {'proc-type': proc.type,
                                 'client-id': proc.id,
                                 'master-lcore': stat['master-lcore'],
-                                'lcores': stat['lcores']})
+                                'lcores': stat['lcores'],
+                                'lcore_stats': stat.get('lcore_stats', [])})
                 elif proc.type in ['vf', 'mirror', 'pcap']:
                     master_lcore = stat['info']['master-lcore']
                     lcores = [stat['info']['master-lcore']]
                     # TODO(yasufum) revise tag name 'core'.
                     for val in stat['info']['core']:
                         lcores.append(val['core'])
+                    lcore_stats = stat['info'].get('lcore_stats', [])
                     cpus.append(
                             {'proc-type': proc.type,
                                 'client-id': proc.id,
                                 'master-lcore': master_lcore,
-                                'lcores': lcores})
+                                'lcores': lcores,
+                                'lcore_stats': lcore_stats})
                 else:
                     LOG.debug('No supported proc type: {}'.format(
                         roc.type))
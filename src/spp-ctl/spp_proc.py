@@ -72,7 +72,9 @@ APP_OPTS = {
         [
             '--client-id',  # sec ID
             '-s',  # address nd port
-            '--vhost-client'  # enable client mode
+            '--vhost-client',  # enable client mode
+            '--rebalance',  # lcores for moving components
+            '--rebalance-threshold'  # lcore usage to start moving
             ],
         'spp_mirror':
         [
@@ -174,10 +176,28 @@ class VfCommon(SppProc):
     def stop_component(self, comp_name):
         return "component stop {comp_name}".format(**locals())
 
+    @exec_command
+    def move_component(self, comp_name, core_id):
+        return ("component move {comp_name} {core_id}"
+                .format(**locals()))
+
+    @exec_command
+    def set_component_weight(self, comp_name, weight):
+        return ("component weight {comp_name} {weight}"
+                .format(**locals()))
+
     @exec_command
     def port_del(self, port, direction, comp_name):
         return "port del {port} {direction} {comp_name}".format(**locals())
 
+    @exec_command
+    def set_latency_stats(self, mode):
+        return "latency_stats {mode}".format(**locals())
+
+    @exec_command
+    def get_latency(self):
+        return "latency"
+
     @exec_command
     def do_exit(self):
         return "exit"
@@ -193,12 +213,61 @@ class VfProc(VfCommon):
         return SppProc._decode_client_id_common(data, TYPE_VF)
 
     @exec_command
-    def port_add(self, port, direction, comp_name, op, vlan_id, pcp):
+    def port_add(self, port, direction, comp_name, op, vlan_id, pcp,
+                 fcs=False, tpid=None):
         command = "port add {port} {direction} {comp_name}".format(**locals())
         if op != "none":
             command += " %s" % op
-            if op == "add_vlantag":
+            if op in ["add_vlantag", "add_qinqtag"]:
                 command += " %d %d" % (vlan_id, pcp)
+            if op in ["add_qinqtag", "del_qinqtag"] and tpid is not None:
+                command += " %#x" % int(tpid)
+            if fcs:
+                command += " fcs"
+        return command
+
+    @exec_command
+    def port_add_action(self, port, direction, comp_name, op, value=None):
+        command = "port add {port} {direction} {comp_name} {op}".format(
+            **locals())
+        if value is not None:
+            command += " %s" % value
+        return command
+
+    @exec_command
+    def port_add_meter(self, port, direction, comp_name, meter_type, cir,
+                       cbs, ebs_or_pbs, pir=None, red_action="drop",
+                       pcp=None):
+        command = "port add {port} {direction} {comp_name} meter".format(
+            **locals())
+        command += " %s %d" % (meter_type, cir)
+        if meter_type == "trtcm":
+            command += " %d" % pir
+        command += " %d %d %s" % (cbs, ebs_or_pbs, red_action)
+        if red_action == "mark":
+            command += " %d" % pcp
+        return command
+
+    @exec_command
+    def port_add_shaper(self, port, direction, comp_name, rate, qsize=None):
+        command = "port add {port} {direction} {comp_name} shaper".format(
+            **locals())
+        command += " %d" % rate
+        if qsize is not None:
+            command += " %d" % qsize
+        return command
+
+    @exec_command
+    def port_add_vxlan(self, port, direction, comp_name, operation,
+                       vni=None, src_mac=None, dst_mac=None, src_ip=None,
+                       dst_ip=None, udp_port=None):
+        command = "port add {port} {direction} {comp_name} {operation}".format(
+            **locals())
+        if operation == "add_vxlan":
+            command += " %d %s %s %s %s" % (vni, src_mac, dst_mac, src_ip,
+                                            dst_ip)
+        if udp_port is not None:
+            command += " %d" % udp_port
         return command
 
     @exec_command
@@ -223,6 +292,28 @@ class VfProc(VfCommon):
         return ("classifier_table del vlan {vlan_id} {mac_address} {port}"
                 .format(**locals()))
 
+    @exec_command
+    def set_classifier_table_with_qinq(self, mac_address, port,
+                                       svlan_id, vlan_id):
+        return ("classifier_table add qinq {svlan_id} {vlan_id} "
+                "{mac_address} {port}".format(**locals()))
+
+    @exec_command
+    def clear_classifier_table_with_qinq(self, mac_address, port,
+                                         svlan_id, vlan_id):
+        return ("classifier_table del qinq {svlan_id} {vlan_id} "
+                "{mac_address} {port}".format(**locals()))
+
+    @exec_command
+    def set_classifier_table_with_vni(self, mac_address, port, vni):
+        return ("classifier_table add vni {vni} {mac_address} {port}"
+                .format(**locals()))
+
+    @exec_command
+    def clear_classifier_table_with_vni(self, mac_address, port, vni):
+        return ("classifier_table del vni {vni} {mac_address} {port}"
+                .format(**locals()))
+
 
 class MirrorProc(VfCommon):
 
@@ -237,6 +328,19 @@ class MirrorProc(VfCommon):
     def port_add(self, port, direction, comp_name):
         return "port add {port} {direction} {comp_name}".format(**locals())
 
+    @exec_command
+    def set_mirror_opt(self, opt, comp_name, val):
+        return "component {opt} {comp_name} {val}".format(**locals())
+
+    @exec_command
+    def set_filter(self, comp_name, fields):
+        command = "filter {comp_name}".format(**locals())
+        if len(fields) == 0:
+            return command + " none"
+        for key, val in fields:
+            command += " %s %s" % (key, val)
+        return command
+
 
 class NfvProc(SppProc):
 
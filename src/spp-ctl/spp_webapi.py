@@ -183,9 +183,27 @@ class V1VFCommon(object):
             for idx in info[key]:
                 vf["ports"].append(key + ":" + str(idx))
         vf["master-lcore"] = info["master-lcore"]
+        if "lcore_stats" in info:
+            vf["lcore_stats"] = info["lcore_stats"]
         vf["components"] = info["core"]
         if "classifier_table" in info:
             vf["classifier_table"] = info["classifier_table"]
+        if "rebalance" in info:
+            vf["rebalance"] = info["rebalance"]
+        if "sched" in info:
+            vf["sched"] = info["sched"]
+        if "ring_fusion" in info:
+            vf["ring_fusion"] = info["ring_fusion"]
+        if "latency_stats" in info:
+            vf["latency_stats"] = info["latency_stats"]
+        if "port_latency" in info:
+            vf["port_latency"] = info["port_latency"]
+        if "e2e_latency" in info:
+            vf["e2e_latency"] = info["e2e_latency"]
+        if "queue_occupancy" in info:
+            vf["queue_occupancy"] = info["queue_occupancy"]
+        if "mirror_opts" in info:
+            vf["mirror_opts"] = info["mirror_opts"]
 
         return vf
 
@@ -200,6 +218,20 @@ class V1VFCommon(object):
         if body['type'] not in types:
             raise KeyInvalid('type', body['type'])
 
+    def validate_comp_update(self, body):
+        if 'core' not in body and 'weight' not in body:
+            raise KeyRequired('core')
+        for key in ['core', 'weight']:
+            if key in body and not isinstance(body[key], int):
+                raise KeyInvalid(key, body[key])
+
+    def update_comp(self, proc, name, body):
+        self.validate_comp_update(body)
+        if 'weight' in body:
+            proc.set_component_weight(name, body['weight'])
+        if 'core' in body:
+            proc.move_component(name, body['core'])
+
     def validate_comp_port(self, body):
         for key in ['action', 'port', 'dir']:
             if key not in body:
@@ -210,6 +242,16 @@ class V1VFCommon(object):
             raise KeyInvalid('dir', body['dir'])
         self._validate_port(body['port'])
 
+    def set_latency_stats(self, proc, body):
+        if 'enable' not in body:
+            raise KeyRequired('enable')
+        if not isinstance(body['enable'], bool):
+            raise KeyInvalid('enable', body['enable'])
+        proc.set_latency_stats("on" if body['enable'] else "off")
+
+    def get_latency(self, proc):
+        return proc.get_latency()["latency"]
+
     def vf_exit(self, proc):
         self.ctrl.do_exit(proc.type, proc.id)
         proc.do_exit()
@@ -234,10 +276,16 @@ class V1VFHandler(BaseHandler, V1VFCommon):
                    callback=self.vf_comp_start)
         self.route('/<sec_id:int>/components/<name>', 'DELETE',
                    callback=self.vf_comp_stop)
+        self.route('/<sec_id:int>/components/<name>', 'PUT',
+                   callback=self.vf_comp_update)
         self.route('/<sec_id:int>/components/<name>/ports', 'PUT',
                    callback=self.vf_comp_port)
         self.route('/<sec_id:int>/classifier_table', 'PUT',
                    callback=self.vf_classifier)
+        self.route('/<sec_id:int>/latency_stats', 'PUT',
+                   callback=self.set_latency_stats)
+        self.route('/<sec_id:int>/latency', 'GET',
+                   callback=self.get_latency)
 
     def vf_get(self, proc):
         return self.convert_info(proc.get_status())
@@ -249,19 +297,93 @@ class V1VFHandler(BaseHandler, V1VFCommon):
     def vf_comp_stop(self, proc, name):
         proc.stop_component(name)
 
+    def vf_comp_update(self, proc, name, body):
+        self.update_comp(proc, name, body)
+
     def _validate_vf_comp_port(self, body):
         self.validate_comp_port(body)
         if body['action'] == "attach":
             vlan = body.get('vlan')
             if vlan:
                 try:
-                    if vlan['operation'] not in ["none", "add", "del"]:
+                    if vlan['operation'] not in ["none", "add", "del",
+                                                 "add_qinq", "del_qinq"]:
                         raise
-                    if vlan['operation'] == "add":
+                    if vlan['operation'] in ["add", "add_qinq"]:
                         int(vlan['id'])
                         int(vlan['pcp'])
+                    if 'tpid' in vlan:
+                        if vlan['operation'] not in ["add_qinq",
+                                                     "del_qinq"]:
+                            raise
+                        int(vlan['tpid'])
+                    if not isinstance(vlan.get('fcs', False), bool):
+                        raise
                 except Exception:
                     raise KeyInvalid('vlan', vlan)
+            actions = body.get('actions', [])
+            try:
+                if not isinstance(actions, list):
+                    raise
+                for act in actions:
+                    if act['operation'] in ["set_src_mac", "set_dst_mac"]:
+                        netaddr.EUI(act['value'])
+                    elif act['operation'] in ["set_pcp", "set_dscp"]:
+                        int(act['value'])
+                    elif act['operation'] != "dec_ttl":
+                        raise
+            except Exception:
+                raise KeyInvalid('actions', actions)
+            meter = body.get('meter')
+            if meter:
+                try:
+                    if meter['type'] == "srtcm":
+                        sizes = ['cbs', 'ebs']
+                    elif meter['type'] == "trtcm":
+                        sizes = ['pir', 'cbs', 'pbs']
+                    else:
+                        raise
+                    for key in ['cir'] + sizes:
+                        if int(meter[key]) < 0:
+                            raise
+                    red_action = meter.get('red_action', "drop")
+                    if red_action == "mark":
+                        if int(meter['pcp']) not in range(8):
+                            raise
+                    elif red_action != "drop":
+                        raise
+                except Exception:
+                    raise KeyInvalid('meter', meter)
+            shaper = body.get('shaper')
+            if shaper:
+                try:
+                    if body['dir'] != "tx":
+                        raise
+                    if int(shaper['rate']) <= 0:
+                        raise
+                    if 'qsize' in shaper:
+                        qsize = int(shaper['qsize'])
+                        if qsize <= 0 or qsize & (qsize - 1) != 0:
+                            raise
+                except Exception:
+                    raise KeyInvalid('shaper', shaper)
+            vxlan = body.get('vxlan')
+            if vxlan:
+                try:
+                    if vxlan['operation'] == "add":
+                        if int(vxlan['vni']) not in range(1 << 24):
+                            raise
+                        netaddr.EUI(vxlan['src_mac'])
+                        netaddr.EUI(vxlan['dst_mac'])
+                        netaddr.IPAddress(vxlan['src_ip'], 4)
+                        netaddr.IPAddress(vxlan['dst_ip'], 4)
+                    elif vxlan['operation'] != "del":
+                        raise
+                    if 'udp_port' in vxlan:
+                        if int(vxlan['udp_port']) not in range(1, 65536):
+                            raise
+                except Exception:
+                    raise KeyInvalid('vxlan', vxlan)
 
     def vf_comp_port(self, proc, name, body):
         self._validate_vf_comp_port(body)
@@ -270,16 +392,62 @@ class V1VFHandler(BaseHandler, V1VFCommon):
             op = "none"
             vlan_id = 0
             pcp = 0
+            fcs = False
+            tpid = None
             vlan = body.get('vlan')
             if vlan:
-                if vlan['operation'] == "add":
-                    op = "add_vlantag"
+                if vlan['operation'] in ["add", "add_qinq"]:
                     vlan_id = vlan['id']
                     pcp = vlan['pcp']
-                elif vlan['operation'] == "del":
-                    op = "del_vlantag"
+                if vlan['operation'] != "none":
+                    op = {"add": "add_vlantag", "del": "del_vlantag",
+                          "add_qinq": "add_qinqtag",
+                          "del_qinq": "del_qinqtag"}[vlan['operation']]
+                fcs = vlan.get('fcs', False)
+                tpid = vlan.get('tpid')
             proc.port_add(body['port'], body['dir'],
-                          name, op, vlan_id, pcp)
+                          name, op, vlan_id, pcp, fcs, tpid)
+            # Actions are run in the order after the vlan operation.
+            for act in body.get('actions', []):
+                proc.port_add_action(body['port'], body['dir'], name,
+                                     act['operation'], act.get('value'))
+            meter = body.get('meter')
+            if meter:
+                pir = None
+                pcp = None
+                if meter['type'] == "srtcm":
+                    excess = int(meter['ebs'])
+                else:
+                    excess = int(meter['pbs'])
+                    pir = int(meter['pir'])
+                red_action = meter.get('red_action', "drop")
+                if red_action == "mark":
+                    pcp = int(meter['pcp'])
+                proc.port_add_meter(body['port'], body['dir'], name,
+                                    meter['type'], int(meter['cir']),
+                                    int(meter['cbs']), excess, pir,
+                                    red_action, pcp)
+            shaper = body.get('shaper')
+            if shaper:
+                qsize = shaper.get('qsize')
+                if qsize is not None:
+                    qsize = int(qsize)
+                proc.port_add_shaper(body['port'], body['dir'], name,
+                                     int(shaper['rate']), qsize)
+            vxlan = body.get('vxlan')
+            if vxlan:
+                udp_port = vxlan.get('udp_port')
+                if udp_port is not None:
+                    udp_port = int(udp_port)
+                if vxlan['operation'] == "add":
+                    proc.port_add_vxlan(body['port'], body['dir'], name,
+                                        "add_vxlan", int(vxlan['vni']),
+                                        vxlan['src_mac'], vxlan['dst_mac'],
+                                        vxlan['src_ip'], vxlan['dst_ip'],
+                                        udp_port)
+                else:
+                    proc.port_add_vxlan(body['port'], body['dir'], name,
+                                        "del_vxlan", udp_port=udp_port)
         else:
             proc.port_del(body['port'], body['dir'], name)
 
@@ -295,19 +463,32 @@ class V1VFHandler(BaseHandler, V1VFCommon):
                 raise KeyRequired(key)
         if body['action'] not in ["add", "del"]:
             raise KeyInvalid('action', body['action'])
-        if body['type'] not in ["mac", "vlan"]:
+        if body['type'] not in ["mac", "vlan", "qinq", "vni"]:
             raise KeyInvalid('type', body['type'])
         self._validate_port(body['port'])
 
         if not body['mac_address'] == 'default':
             self._validate_mac(body['mac_address'])
 
-        if body['type'] == "vlan":
+        if body['type'] in ["vlan", "qinq"]:
             try:
                 int(body['vlan'])
             except Exception:
                 raise KeyInvalid('vlan', body.get('vlan'))
 
+        if body['type'] == "qinq":
+            try:
+                int(body['svlan'])
+            except Exception:
+                raise KeyInvalid('svlan', body.get('svlan'))
+
+        if body['type'] == "vni":
+            try:
+                if int(body['vni']) not in range(1 << 24):
+                    raise
+            except Exception:
+                raise KeyInvalid('vni', body.get('vni'))
+
     def vf_classifier(self, proc, body):
         self._validate_vf_classifier(body)
 
@@ -317,12 +498,24 @@ class V1VFHandler(BaseHandler, V1VFCommon):
         if body['action'] == "add":
             if body['type'] == "mac":
                 proc.set_classifier_table(mac_address, port)
+            elif body['type'] == "qinq":
+                proc.set_classifier_table_with_qinq(
+                    mac_address, port, body['svlan'], body['vlan'])
+            elif body['type'] == "vni":
+                proc.set_classifier_table_with_vni(
+                    mac_address, port, body['vni'])
             else:
                 proc.set_classifier_table_with_vlan(
                     mac_address, port, body['vlan'])
         else:
             if body['type'] == "mac":
                 proc.clear_classifier_table(mac_address, port)
+            elif body['type'] == "qinq":
+                proc.clear_classifier_table_with_qinq(
+                    mac_address, port, body['svlan'], body['vlan'])
+            elif body['type'] == "vni":
+                proc.clear_classifier_table_with_vni(
+                    mac_address, port, body['vni'])
             else:
                 proc.clear_classifier_table_with_vlan(
                     mac_address, port, body['vlan'])
@@ -330,6 +523,10 @@ class V1VFHandler(BaseHandler, V1VFCommon):
 
 class V1MirrorHandler(BaseHandler, V1VFCommon):
 
+    MIRROR_FILTER_FIELDS = ['vlan', 'proto', 'src', 'dst', 'sport', 'dport']
+    MIRROR_OPTS = ['sample', 'sample_rate', 'snaplen', 'copy']
+    MIRROR_COPY_MODES = ['shallow', 'deep', 'hybrid']
+
     def __init__(self, controller):
         super(V1MirrorHandler, self).__init__(controller)
         self.type = spp_proc.TYPE_MIRROR
@@ -347,8 +544,16 @@ class V1MirrorHandler(BaseHandler, V1VFCommon):
                    callback=self.mirror_comp_start)
         self.route('/<sec_id:int>/components/<name>', 'DELETE',
                    callback=self.mirror_comp_stop)
+        self.route('/<sec_id:int>/components/<name>', 'PUT',
+                   callback=self.mirror_comp_update)
         self.route('/<sec_id:int>/components/<name>/ports', 'PUT',
                    callback=self.mirror_comp_port)
+        self.route('/<sec_id:int>/components/<name>/filter', 'PUT',
+                   callback=self.mirror_comp_filter)
+        self.route('/<sec_id:int>/latency_stats', 'PUT',
+                   callback=self.set_latency_stats)
+        self.route('/<sec_id:int>/latency', 'GET',
+                   callback=self.get_latency)
 
     def mirror_get(self, proc):
         return self.convert_info(proc.get_status())
@@ -360,6 +565,20 @@ class V1MirrorHandler(BaseHandler, V1VFCommon):
     def mirror_comp_stop(self, proc, name):
         proc.stop_component(name)
 
+    def mirror_comp_update(self, proc, name, body):
+        opts = [key for key in self.MIRROR_OPTS if key in body]
+        for key in opts:
+            if key == 'copy':
+                if body[key] not in self.MIRROR_COPY_MODES:
+                    raise KeyInvalid(key, body[key])
+            elif not isinstance(body[key], int):
+                raise KeyInvalid(key, body[key])
+        # Options can be given without core or weight.
+        if 'core' in body or 'weight' in body or len(opts) == 0:
+            self.update_comp(proc, name, body)
+        for key in opts:
+            proc.set_mirror_opt(key, name, body[key])
+
     def mirror_comp_port(self, proc, name, body):
         self.validate_comp_port(body)
         if body['action'] == "attach":
@@ -367,6 +586,27 @@ class V1MirrorHandler(BaseHandler, V1VFCommon):
         else:
             proc.port_del(body['port'], body['dir'], name)
 
+    def _validate_mirror_filter(self, body):
+        for key in body:
+            if key not in self.MIRROR_FILTER_FIELDS:
+                raise KeyInvalid(key, body[key])
+        for key in ['vlan', 'sport', 'dport']:
+            if key in body and not isinstance(body[key], int):
+                raise KeyInvalid(key, body[key])
+        if 'proto' in body and not isinstance(body['proto'], (int, str)):
+            raise KeyInvalid('proto', body['proto'])
+        for key in ['src', 'dst']:
+            if key in body and not isinstance(body[key], str):
+                raise KeyInvalid(key, body[key])
+
+    def mirror_comp_filter(self, proc, name, body):
+        self._validate_mirror_filter(body)
+        # Fields are given in the order of MIRROR_FILTER_FIELDS, and all
+        # of packets are mirrored if no field is given.
+        fields = [(key, body[key]) for key in self.MIRROR_FILTER_FIELDS
+                  if key in body]
+        proc.set_filter(name, fields)
+
 
 class V1NFVHandler(BaseHandler):
 
@@ -19,6 +19,8 @@
 #include <rte_per_lcore.h>
 #include <rte_eal.h>
 #include <rte_launch.h>
+#include <rte_ip.h>
+#include <rte_udp.h>
 #include <netinet/in.h>
 
 #include "classifier.h"
@@ -29,9 +31,7 @@
 #include "shared/secondary/spp_worker_th/vf_deps.h"
 #include "shared/secondary/spp_worker_th/port_capability.h"
 
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
 #include "shared/secondary/spp_worker_th/latency_stats.h"
-#endif
 
 #define RTE_LOGTYPE_VF_CLS RTE_LOGTYPE_USER1
 
@@ -52,6 +52,17 @@
 /* VID of VLAN untagged */
 #define VLAN_UNTAGGED_VID 0x0fff
 
+/* TPID of outer tag used before IEEE 802.1ad, accepted as well as 0x88a8. */
+#define ETHER_TYPE_QINQ_LEGACY 0x9100
+
+/* Key of table of classifiers for QinQ. */
+#define QINQ_CLS_KEY(svid, vid) (((uint32_t)(svid) << 16) | (vid))
+
+/* Length of outer headers of VXLAN before IP options. */
+#define VXLAN_OUTER_HDRS_LEN (sizeof(struct rte_ether_hdr) + \
+		sizeof(struct rte_ipv4_hdr) + sizeof(struct rte_udp_hdr) + \
+		sizeof(struct rte_vxlan_hdr))
+
 /** Value for default MAC address of classifier */
 #define CLS_DUMMY_ADDR 0x010000000000
 
@@ -66,13 +77,32 @@ struct cls_mng_info {
 /* classifier information per lcore */
 struct cls_mng_info cls_mng_info_list[RTE_MAX_LCORE];
 
+/* Free table of MAC classifiers keyed with VIDs or VNI. */
+static void
+free_clfs_table(struct rte_hash *clfs_tbl)
+{
+	const void *key;
+	void *data;
+	uint32_t next = 0;
+
+	if (clfs_tbl == NULL)
+		return;
+	while (rte_hash_iterate(clfs_tbl, &key, &data, &next) >= 0)
+		free_mac_classifier(data);
+	rte_hash_free(clfs_tbl);
+}
+
 /* uninitialize classifier information. */
 static void
 clean_component_info(struct cls_comp_info *comp_info)
 {
 	int i;
+
 	for (i = 0; i < NOF_VLAN; ++i)
 		free_mac_classifier(comp_info->mac_clfs[i]);
+
+	free_clfs_table(comp_info->qinq_clfs);
+	free_clfs_table(comp_info->vni_clfs);
 	memset(comp_info, 0, sizeof(struct cls_comp_info));
 }
 
@@ -88,6 +118,10 @@ clean_classifier(struct cls_mng_info *mng_info)
 		clean_component_info(mng_info->comp_list + (long)i);
 
 	memset(mng_info, 0, sizeof(struct cls_mng_info));
+
+	/* No update is pending until update_classifier() publishes one. */
+	mng_info->ref_index = 0;
+	mng_info->upd_index = 1;
 }
 
 /* Initialize classifier information. */
@@ -124,22 +158,84 @@ static const size_t ETHER_ADDR_STR_BUF_SZ =
  */
 static rte_atomic16_t g_hash_table_count = RTE_ATOMIC16_INIT(0xff);
 
-/* get vid from packet */
+/* Check if given ether type is TPID of outer tag of QinQ. */
+static inline int
+is_qinq_tpid(uint16_t ether_type)
+{
+	return ether_type == rte_cpu_to_be_16(RTE_ETHER_TYPE_QINQ) ||
+		ether_type == rte_cpu_to_be_16(ETHER_TYPE_QINQ_LEGACY);
+}
+
+/**
+ * Get vid from packet. VID of outer tag is also given as `svid` if the
+ * packet is tagged with QinQ, or VLAN_UNTAGGED_VID. Two stacked tags of
+ * 0x8100 are regarded as QinQ.
+ */
 static inline uint16_t
-get_vid(const struct rte_mbuf *pkt)
+get_vid(const struct rte_mbuf *pkt, uint16_t *svid)
 {
 	struct rte_ether_hdr *eth;
 	struct rte_vlan_hdr *vh;
+	const uint16_t vlan_tpid = rte_cpu_to_be_16(RTE_ETHER_TYPE_VLAN);
 
+	*svid = VLAN_UNTAGGED_VID;
 	eth = rte_pktmbuf_mtod(pkt, struct rte_ether_hdr *);
-	if (eth->ether_type == rte_cpu_to_be_16(RTE_ETHER_TYPE_VLAN)) {
-		/* vlan tagged */
-		vh = (struct rte_vlan_hdr *)(eth + 1);
-		return rte_be_to_cpu_16(vh->vlan_tci) & 0x0fff;
+	if (eth->ether_type != vlan_tpid && !is_qinq_tpid(eth->ether_type)) {
+		/* vlan untagged */
+		return VLAN_UNTAGGED_VID;
 	}
 
-	/* vlan untagged */
-	return VLAN_UNTAGGED_VID;
+	vh = (struct rte_vlan_hdr *)(eth + 1);
+	if (unlikely(vh->eth_proto == vlan_tpid)) {
+		/* Outer tag is followed by the inner one. */
+		*svid = rte_be_to_cpu_16(vh->vlan_tci) & 0x0fff;
+		vh++;
+	} else if (unlikely(eth->ether_type != vlan_tpid)) {
+		/* Outer tag only. */
+		*svid = rte_be_to_cpu_16(vh->vlan_tci) & 0x0fff;
+		return VLAN_UNTAGGED_VID;
+	}
+
+	/* vlan tagged */
+	return rte_be_to_cpu_16(vh->vlan_tci) & 0x0fff;
+}
+
+/**
+ * Get inner ether header of VXLAN packet of the default UDP port. It returns
+ * NULL if the packet is not VXLAN, and VNI is set to `vni`.
+ */
+static inline struct rte_ether_hdr *
+get_vxlan_inner(const struct rte_mbuf *pkt, uint32_t *vni)
+{
+	uint16_t ihl;
+	struct rte_ether_hdr *eth;
+	struct rte_ipv4_hdr *ipv4;
+	struct rte_udp_hdr *udp;
+	struct rte_vxlan_hdr *vxlan;
+
+	eth = rte_pktmbuf_mtod(pkt, struct rte_ether_hdr *);
+	if (eth->ether_type != rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV4) ||
+			pkt->data_len < VXLAN_OUTER_HDRS_LEN +
+			sizeof(struct rte_ether_hdr))
+		return NULL;
+
+	ipv4 = (struct rte_ipv4_hdr *)(eth + 1);
+	if (ipv4->next_proto_id != IPPROTO_UDP)
+		return NULL;
+	ihl = (ipv4->version_ihl & RTE_IPV4_HDR_IHL_MASK) *
+			RTE_IPV4_IHL_MULTIPLIER;
+	if (unlikely(pkt->data_len < VXLAN_OUTER_HDRS_LEN + ihl -
+			sizeof(struct rte_ipv4_hdr) +
+			sizeof(struct rte_ether_hdr)))
+		return NULL;
+
+	udp = (struct rte_udp_hdr *)((uint8_t *)ipv4 + ihl);
+	if (udp->dst_port != rte_cpu_to_be_16(SPP_VXLAN_UDP_PORT_DEFAULT))
+		return NULL;
+
+	vxlan = (struct rte_vxlan_hdr *)(udp + 1);
+	*vni = rte_be_to_cpu_32(vxlan->vx_vni) >> 8;
+	return (struct rte_ether_hdr *)(vxlan + 1);
 }
 
 #if RTE_LOG_DP_LEVEL >= RTE_LOG_DEBUG
@@ -153,11 +249,11 @@ log_packet(const char *name, struct rte_mbuf *pkt,
 		const char *func_name, int line_num)
 {
 	struct rte_ether_hdr *eth;
-	uint16_t vid;
+	uint16_t svid, vid;
 	char mac_addr_str[2][ETHER_ADDR_STR_BUF_SZ];
 
 	eth = rte_pktmbuf_mtod(pkt, struct rte_ether_hdr *);
-	vid = get_vid(pkt);
+	vid = get_vid(pkt, &svid);
 
 	ether_format_addr(mac_addr_str[0], sizeof(mac_addr_str),
 			&eth->d_addr);
@@ -166,9 +262,9 @@ log_packet(const char *name, struct rte_mbuf *pkt,
 
 	RTE_LOG_DP(DEBUG, VF_CLS,
 			"[%s]Packet(%s:%d). d_addr=%s, s_addr=%s, "
-			"vid=%hu, pktlen=%u\n",
+			"svid=%hu, vid=%hu, pktlen=%u\n",
 			name, func_name, line_num,
-			mac_addr_str[0], mac_addr_str[1], vid,
+			mac_addr_str[0], mac_addr_str[1], svid, vid,
 			rte_pktmbuf_pkt_len(pkt));
 }
 
@@ -182,12 +278,12 @@ log_classification(long clsd_idx, struct rte_mbuf *pkt,
 		const char *func_name, int line_num)
 {
 	struct rte_ether_hdr *eth;
-	uint16_t vid;
+	uint16_t svid, vid;
 	char mac_addr_str[2][ETHER_ADDR_STR_BUF_SZ];
 	char iface_str[STR_LEN_NAME];
 
 	eth = rte_pktmbuf_mtod(pkt, struct rte_ether_hdr *);
-	vid = get_vid(pkt);
+	vid = get_vid(pkt, &svid);
 
 	ether_format_addr(mac_addr_str[0], sizeof(mac_addr_str),
 			&eth->d_addr);
@@ -203,9 +299,10 @@ log_classification(long clsd_idx, struct rte_mbuf *pkt,
 
 	RTE_LOG_DP(DEBUG, VF_CLS,
 			"[%s]Classification(%s:%d). d_addr=%s, "
-			"s_addr=%s, vid=%hu, pktlen=%u, tx_iface=%s\n",
+			"s_addr=%s, svid=%hu, vid=%hu, pktlen=%u, "
+			"tx_iface=%s\n",
 			cmp_info->name, func_name, line_num,
-			mac_addr_str[0], mac_addr_str[1], vid,
+			mac_addr_str[0], mac_addr_str[1], svid, vid,
 			rte_pktmbuf_pkt_len(pkt), iface_str);
 }
 
@@ -300,6 +397,133 @@ create_mac_classification(void)
 	return mac_cls;
 }
 
+/**
+ * Create table of MAC classifiers keyed with pair of S-VID and C-VID, or
+ * VNI. Prefix of the name of table is given for each type of keys.
+ */
+static struct rte_hash *
+create_clfs_table(const char *prefix)
+{
+	struct rte_hash *clfs_tbl;
+	char hash_tab_name[HASH_TABLE_NAME_BUF_SZ];
+
+	sprintf(hash_tab_name, "%s_%07x%02hx", prefix, getpid(),
+			rte_atomic16_add_return(&g_hash_table_count, 1));
+
+	struct rte_hash_parameters hash_params = {
+			.name      = hash_tab_name,
+			.entries   = NOF_CLS_TABLE_ENTRIES,
+			.key_len   = sizeof(uint32_t),
+			.hash_func = DEFAULT_HASH_FUNC,
+			.hash_func_init_val = 0,
+			.socket_id = rte_socket_id(),
+	};
+
+	clfs_tbl = rte_hash_create(&hash_params);
+	if (unlikely(clfs_tbl == NULL))
+		RTE_LOG(ERR, VF_CLS, "Cannot create table of classifiers. "
+				"name=%s\n", hash_tab_name);
+	return clfs_tbl;
+}
+
+/* Get MAC classifier of given VIDs, or NULL if it is not registered. */
+static inline struct mac_classifier *
+get_mac_classifier(struct cls_comp_info *cmp_info, uint16_t svid,
+		uint16_t vid)
+{
+	void *data;
+	uint32_t key;
+
+	if (likely(svid == VLAN_UNTAGGED_VID))
+		return cmp_info->mac_clfs[vid];
+
+	if (cmp_info->qinq_clfs == NULL)
+		return NULL;
+	key = QINQ_CLS_KEY(svid, vid);
+	if (rte_hash_lookup_data(cmp_info->qinq_clfs, &key, &data) < 0)
+		return NULL;
+	return data;
+}
+
+/* Get MAC classifier of given VIDs, and create it if not registered. */
+static struct mac_classifier *
+prepare_mac_classifier(struct cls_comp_info *cmp_info, uint16_t svid,
+		uint16_t vid)
+{
+	uint32_t key;
+	struct mac_classifier *mac_cls;
+
+	mac_cls = get_mac_classifier(cmp_info, svid, vid);
+	if (likely(mac_cls != NULL))
+		return mac_cls;
+
+	RTE_LOG(DEBUG, VF_CLS, "Mac classification is not registered. "
+			"create. svid=%hu, vid=%hu\n", svid, vid);
+	mac_cls = create_mac_classification();
+	if (unlikely(mac_cls == NULL))
+		return NULL;
+
+	if (svid == VLAN_UNTAGGED_VID) {
+		cmp_info->mac_clfs[vid] = mac_cls;
+		return mac_cls;
+	}
+
+	if (cmp_info->qinq_clfs == NULL) {
+		cmp_info->qinq_clfs = create_clfs_table("cqtab");
+		if (unlikely(cmp_info->qinq_clfs == NULL)) {
+			free_mac_classifier(mac_cls);
+			return NULL;
+		}
+	}
+	key = QINQ_CLS_KEY(svid, vid);
+	if (unlikely(rte_hash_add_key_data(cmp_info->qinq_clfs, &key,
+			mac_cls) < 0)) {
+		free_mac_classifier(mac_cls);
+		return NULL;
+	}
+	return mac_cls;
+}
+
+/* Get MAC classifier of given VNI, or NULL if it is not registered. */
+static inline struct mac_classifier *
+get_vni_classifier(struct cls_comp_info *cmp_info, uint32_t vni)
+{
+	void *data;
+
+	if (rte_hash_lookup_data(cmp_info->vni_clfs, &vni, &data) < 0)
+		return NULL;
+	return data;
+}
+
+/* Get MAC classifier of given VNI, and create it if not registered. */
+static struct mac_classifier *
+prepare_vni_classifier(struct cls_comp_info *cmp_info, uint32_t vni)
+{
+	struct mac_classifier *mac_cls;
+
+	if (cmp_info->vni_clfs == NULL) {
+		cmp_info->vni_clfs = create_clfs_table("cvtab");
+		if (unlikely(cmp_info->vni_clfs == NULL))
+			return NULL;
+	}
+
+	mac_cls = get_vni_classifier(cmp_info, vni);
+	if (likely(mac_cls != NULL))
+		return mac_cls;
+
+	RTE_LOG(DEBUG, VF_CLS, "Mac classification is not registered. "
+			"create. vni=%u\n", vni);
+	mac_cls = create_mac_classification();
+	if (unlikely(mac_cls == NULL))
+		return NULL;
+	if (unlikely(rte_hash_add_key_data(cmp_info->vni_clfs, &vni,
+			mac_cls) < 0)) {
+		free_mac_classifier(mac_cls);
+		return NULL;
+	}
+	return mac_cls;
+}
+
 /* initialize classifier information. */
 static int
 init_component_info(struct cls_comp_info *cmp_info,
@@ -314,7 +538,7 @@ init_component_info(struct cls_comp_info *cmp_info,
 	struct cls_port_info *cls_rx_port_info = &cmp_info->rx_port_i;
 	struct cls_port_info *cls_tx_ports_info = cmp_info->tx_ports_i;
 	struct sppwk_port_info *tx_port = NULL;
-	uint16_t vid;
+	uint16_t svid, vid;
 
 	/* set rx */
 	if (wk_comp_info->nof_rx == 0) {
@@ -339,6 +563,7 @@ init_component_info(struct cls_comp_info *cmp_info,
 	cmp_info->mac_addr_entry = 0;
 	for (i = 0; i < wk_comp_info->nof_tx; i++) {
 		tx_port = wk_comp_info->tx_ports[i];
+		svid = tx_port->cls_attrs.svid;
 		vid = tx_port->cls_attrs.vlantag.vid;
 
 		/* store ports information */
@@ -352,16 +577,13 @@ init_component_info(struct cls_comp_info *cmp_info,
 			continue;
 
 		/* if mac classification is NULL, make instance */
-		if (unlikely(cmp_info->mac_clfs[vid] == NULL)) {
-			RTE_LOG(DEBUG, VF_CLS,
-					"Mac classification is not registered."
-					" create. vid=%hu\n", vid);
-			cmp_info->mac_clfs[vid] =
-					create_mac_classification();
-			if (unlikely(cmp_info->mac_clfs[vid] == NULL))
-				return SPPWK_RET_NG;
-		}
-		mac_cls = cmp_info->mac_clfs[vid];
+		if (tx_port->cls_attrs.vni != SPP_VXLAN_VNI_NONE)
+			mac_cls = prepare_vni_classifier(cmp_info,
+					tx_port->cls_attrs.vni);
+		else
+			mac_cls = prepare_mac_classifier(cmp_info, svid, vid);
+		if (unlikely(mac_cls == NULL))
+			return SPPWK_RET_NG;
 
 		/* store active tx_port that associate with mac address */
 		mac_cls->cls_ports[mac_cls->nof_cls_ports++] = i;
@@ -373,10 +595,10 @@ init_component_info(struct cls_comp_info *cmp_info,
 		if (unlikely(tx_port->cls_attrs.mac_addr == CLS_DUMMY_ADDR)) {
 			mac_cls->default_cls_idx = i;
 			RTE_LOG(INFO, VF_CLS,
-					"default classified. vid=%hu, "
-					"iface_type=%d, iface_no=%d, "
+					"default classified. svid=%hu, "
+					"vid=%hu, iface_type=%d, iface_no=%d, "
 					"ethdev_port_id=%d\n",
-					vid, tx_port->iface_type,
+					svid, vid, tx_port->iface_type,
 					tx_port->iface_no,
 					tx_port->ethdev_port_id);
 			continue;
@@ -393,16 +615,18 @@ init_component_info(struct cls_comp_info *cmp_info,
 		if (unlikely(ret < 0)) {
 			RTE_LOG(ERR, VF_CLS,
 					"Cannot add to classifier table. "
-					"ret=%d, vid=%hu, mac_addr=%s\n",
-					ret, vid, mac_addr_str);
+					"ret=%d, svid=%hu, vid=%hu, "
+					"mac_addr=%s\n",
+					ret, svid, vid, mac_addr_str);
 			return SPPWK_RET_NG;
 		}
 
 		RTE_LOG(INFO, VF_CLS,
 				"Add entry to classifier table. "
-				"vid=%hu, mac_addr=%s, iface_type=%d, "
-				"iface_no=%d, ethdev_port_id=%d\n",
-				vid, mac_addr_str, tx_port->iface_type,
+				"svid=%hu, vid=%hu, mac_addr=%s, "
+				"iface_type=%d, iface_no=%d, "
+				"ethdev_port_id=%d\n",
+				svid, vid, mac_addr_str, tx_port->iface_type,
 				tx_port->iface_no, tx_port->ethdev_port_id);
 	}
 
@@ -417,14 +641,9 @@ transmit_packets(struct cls_port_info *clsd_data)
 	uint16_t n_tx;
 
 	/* transmit packets */
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
-	n_tx = sppwk_eth_vlan_ring_stats_tx_burst(clsd_data->ethdev_port_id,
+	n_tx = sppwk_port_tx_burst(clsd_data->ethdev_port_id,
 			clsd_data->iface_type, clsd_data->iface_no,
-			0, clsd_data->pkts, clsd_data->nof_pkts);
-#else
-	n_tx = sppwk_eth_vlan_tx_burst(clsd_data->ethdev_port_id, 0,
 			clsd_data->pkts, clsd_data->nof_pkts);
-#endif
 
 	/* free cannot transmit packets */
 	if (unlikely(n_tx != clsd_data->nof_pkts)) {
@@ -502,12 +721,15 @@ handle_l2multicast_packet(struct rte_mbuf *pkt,
 {
 	int i;
 	struct mac_classifier *mac_cls;
-	uint16_t vid = get_vid(pkt);
+	uint16_t svid;
+	uint16_t vid = get_vid(pkt, &svid);
+	int is_tagged = (vid != VLAN_UNTAGGED_VID ||
+			svid != VLAN_UNTAGGED_VID);
 	int gen_def_clsd_idx = get_general_default_classified_index(cmp_info);
 	int n_act_clsd;
 
 	/* select mac address classification by vid */
-	mac_cls = cmp_info->mac_clfs[vid];
+	mac_cls = get_mac_classifier(cmp_info, svid, vid);
 	if (unlikely(mac_cls == NULL ||
 			mac_cls->nof_cls_ports == 0)) {
 		/* specific vlan is not registered
@@ -529,7 +751,7 @@ handle_l2multicast_packet(struct rte_mbuf *pkt,
 
 	/* add to mbuf's refcnt */
 	n_act_clsd = mac_cls->nof_cls_ports;
-	if (gen_def_clsd_idx >= 0 && vid != VLAN_UNTAGGED_VID)
+	if (gen_def_clsd_idx >= 0 && is_tagged)
 		++n_act_clsd;
 
 	rte_mbuf_refcnt_update(pkt, (int16_t)(n_act_clsd - 1));
@@ -540,12 +762,46 @@ handle_l2multicast_packet(struct rte_mbuf *pkt,
 		push_packet(pkt, clsd_data + (long)mac_cls->cls_ports[i]);
 	}
 
-	if (gen_def_clsd_idx >= 0 && vid != VLAN_UNTAGGED_VID) {
+	if (gen_def_clsd_idx >= 0 && is_tagged) {
 		LOG_CLS((long)gen_def_clsd_idx, pkt, cmp_info, clsd_data);
 		push_packet(pkt, clsd_data + (long)gen_def_clsd_idx);
 	}
 }
 
+/**
+ * Select index of classified with VNI and inner destination MAC address of
+ * VXLAN packet. It returns -1 if the packet is not VXLAN or not registered,
+ * and it is classified with the outer header instead.
+ */
+static inline int
+select_vni_classified_index(const struct rte_mbuf *pkt,
+		struct cls_comp_info *cmp_info)
+{
+	uint32_t vni;
+	void *lookup_data;
+	struct rte_ether_hdr *inner;
+	struct mac_classifier *mac_cls;
+
+	inner = get_vxlan_inner(pkt, &vni);
+	if (inner == NULL)
+		return SPPWK_RET_NG;
+
+	mac_cls = get_vni_classifier(cmp_info, vni);
+	if (mac_cls == NULL)
+		return SPPWK_RET_NG;
+
+	if (rte_hash_lookup_data(mac_cls->cls_tbl,
+			(const void *)&inner->d_addr, &lookup_data) >= 0) {
+		LOG_DBG(cmp_info->name, "Inner mac address is registered. "
+				"vni=%u\n", vni);
+		return (int)(long)lookup_data;
+	}
+
+	/* Multicast of inner is also sent to the default of VNI. */
+	LOG_DBG(cmp_info->name, "Use vni's default. vni=%u\n", vni);
+	return mac_cls->default_cls_idx;
+}
+
 /* select index of classified */
 static inline int
 select_classified_index(const struct rte_mbuf *pkt,
@@ -555,16 +811,23 @@ select_classified_index(const struct rte_mbuf *pkt,
 	struct rte_ether_hdr *eth;
 	void *lookup_data;
 	struct mac_classifier *mac_cls;
-	uint16_t vid;
+	uint16_t svid, vid;
+
+	/* VXLAN is checked only if any of entries for VNI is added. */
+	if (unlikely(cmp_info->vni_clfs != NULL)) {
+		ret = select_vni_classified_index(pkt, cmp_info);
+		if (ret >= 0)
+			return ret;
+	}
 
 	eth = rte_pktmbuf_mtod(pkt, struct rte_ether_hdr *);
-	vid = get_vid(pkt);
+	vid = get_vid(pkt, &svid);
 
 	/* select mac address classification by vid */
-	mac_cls = cmp_info->mac_clfs[vid];
+	mac_cls = get_mac_classifier(cmp_info, svid, vid);
 	if (unlikely(mac_cls == NULL)) {
 		LOG_DBG(cmp_info->name, "Mac classification is not "
-				"registered. vid=%hu\n", vid);
+				"registered. svid=%hu, vid=%hu\n", svid, vid);
 		return get_general_default_classified_index(cmp_info);
 	}
 
@@ -587,7 +850,8 @@ select_classified_index(const struct rte_mbuf *pkt,
 
 	/* if default is not set, use untagged's default */
 	if (unlikely(mac_cls->default_cls_idx < 0 &&
-			vid != VLAN_UNTAGGED_VID)) {
+			(vid != VLAN_UNTAGGED_VID ||
+			svid != VLAN_UNTAGGED_VID))) {
 		LOG_DBG(cmp_info->name, "Vid's default is not set. "
 				"use general default. vid=%hu\n", vid);
 		return get_general_default_classified_index(cmp_info);
@@ -629,6 +893,20 @@ _classify_packets(struct rte_mbuf **rx_pkts, uint16_t n_rx,
 	}
 }
 
+/* Take updated attributes of ports of given classifier. */
+static void
+take_cls_port_attrs(const struct cls_comp_info *cmp_info)
+{
+	int i;
+
+	if (cmp_info->rx_port_i.iface_type != UNDEF)
+		sppwk_take_port_attrs(cmp_info->rx_port_i.ethdev_port_id,
+				SPPWK_PORT_DIR_RX);
+	for (i = 0; i < cmp_info->nof_tx_ports; i++)
+		sppwk_take_port_attrs(cmp_info->tx_ports_i[i].ethdev_port_id,
+				SPPWK_PORT_DIR_TX);
+}
+
 /* TODO(yasufum) Revise this comment and name of func. */
 /* change update index at classifier management information */
 static inline void
@@ -636,9 +914,6 @@ change_classifier_index(struct cls_mng_info *mng_info, int id)
 {
 	if (unlikely(mng_info->ref_index ==
 			mng_info->upd_index)) {
-		/* Change reference index of port ability. */
-		sppwk_swap_two_sides(SPPWK_SWAP_REF, 0, 0);
-
 		/* Transmit all packets for switching the using data. */
 		transmit_all_packet(mng_info->comp_list + mng_info->ref_index);
 
@@ -646,6 +921,9 @@ change_classifier_index(struct cls_mng_info *mng_info, int id)
 				"Core[%u] Change update index.\n", id);
 		mng_info->ref_index =
 				(mng_info->upd_index + 1) % TWO_SIDES;
+
+		/* Change reference side of attributes of its ports. */
+		take_cls_port_attrs(mng_info->comp_list + mng_info->ref_index);
 	}
 }
 
@@ -653,7 +931,13 @@ change_classifier_index(struct cls_mng_info *mng_info, int id)
 int
 init_cls_mng_info(void)
 {
+	int cnt;
+
 	memset(cls_mng_info_list, 0, sizeof(cls_mng_info_list));
+	for (cnt = 0; cnt < RTE_MAX_LCORE; cnt++) {
+		cls_mng_info_list[cnt].ref_index = 0;
+		cls_mng_info_list[cnt].upd_index = 1;
+	}
 	return 0;
 }
 
@@ -669,9 +953,23 @@ update_classifier(struct sppwk_comp_info *wk_comp_info)
 	RTE_LOG(INFO, VF_CLS,
 			"Start updating classifier, id=%u.\n", wk_id);
 
+	/* Update side is still referred if previous update is not taken. */
+	if (unlikely(mng_info->ref_index == mng_info->upd_index)) {
+		RTE_LOG(ERR, VF_CLS,
+				"Previous update is not taken yet, id=%u.\n",
+				wk_id);
+		return SPPWK_RET_NG;
+	}
+
 	/* TODO(yasufum) rename `infos`. */
 	cls_info = mng_info->comp_list + mng_info->upd_index;
 
+	/**
+	 * Clean old one which is no longer referred because the lcore has
+	 * already taken previous update.
+	 */
+	clean_component_info(cls_info);
+
 	/* initialize update side classifier information */
 	ret = init_component_info(cls_info, wk_comp_info);
 	if (unlikely(ret != SPPWK_RET_OK)) {
@@ -681,24 +979,30 @@ update_classifier(struct sppwk_comp_info *wk_comp_info)
 	}
 	memcpy(cls_info->name, wk_comp_info->name, STR_LEN_NAME);
 
-	/* change index of reference side */
+	/**
+	 * Change index of reference side, and the lcore is waited in
+	 * sppwk_wait_update_done() with other updated components.
+	 */
 	mng_info->upd_index = mng_info->ref_index;
 	mng_info->is_used = 1;
 
-	/* wait until no longer access the new update side */
-	while (likely(mng_info->ref_index ==
-			mng_info->upd_index))
-		rte_delay_us_block(SPPWK_UPDATE_INTERVAL);
-
-	/* Clean old one. */
-	clean_component_info(mng_info->comp_list + mng_info->upd_index);
-
 	RTE_LOG(INFO, VF_CLS,
 			"Done update classifier, id=%u.\n", wk_id);
 
 	return SPPWK_RET_OK;
 }
 
+/* Check if updated classifier info is taken by its lcore. */
+int
+is_classifier_update_done(int comp_id)
+{
+	struct cls_mng_info *mng_info = cls_mng_info_list + comp_id;
+	if (mng_info->ref_index == mng_info->upd_index)
+		return 0;
+	else
+		return 1;
+}
+
 /* Classify incoming packets on a thread of given `comp_id`. */
 int
 classify_packets(int comp_id)
@@ -732,8 +1036,12 @@ classify_packets(int comp_id)
 	cur_tsc = rte_rdtsc();
 	if (unlikely(cur_tsc - prev_tsc > drain_tsc)) {
 		for (i = 0; i < cmp_info->nof_tx_ports; i++) {
-			if (likely(clsd_data_tx[i].nof_pkts == 0))
+			if (likely(clsd_data_tx[i].nof_pkts == 0)) {
+				/* Send packets remained in shaper. */
+				sppwk_eth_vlan_tx_drain(
+					clsd_data_tx[i].ethdev_port_id);
 				continue;
+			}
 
 			RTE_LOG(DEBUG, VF_CLS,
 					"transmit packets (drain). index=%d, "
@@ -749,20 +1057,15 @@ classify_packets(int comp_id)
 		return SPPWK_RET_OK;
 
 	/* Retrieve packets */
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
-	n_rx = sppwk_eth_vlan_ring_stats_rx_burst(clsd_data_rx->ethdev_port_id,
+	n_rx = sppwk_port_rx_burst(clsd_data_rx->ethdev_port_id,
 			clsd_data_rx->iface_type, clsd_data_rx->iface_no,
-			0, rx_pkts, MAX_PKT_BURST);
-#else
-	n_rx = sppwk_eth_vlan_rx_burst(clsd_data_rx->ethdev_port_id, 0,
 			rx_pkts, MAX_PKT_BURST);
-#endif
 	if (unlikely(n_rx == 0))
 		return SPPWK_RET_OK;
 
 	_classify_packets(rx_pkts, n_rx, cmp_info, clsd_data_tx);
 
-	return SPPWK_RET_OK;
+	return n_rx;
 }
 
 /* classifier iterate component information */
@@ -815,10 +1118,13 @@ get_classifier_status(unsigned int lcore_id, int id,
 	return SPPWK_RET_OK;
 }
 
-/* Add MAC addresses in classifier table for `status` command. */
+/**
+ * Add MAC addresses in classifier table for `status` command. VNI is given
+ * as `vid` for VXLAN.
+ */
 static void
 add_mac_entry(struct classifier_table_params *params,
-		uint16_t vid,
+		enum sppwk_cls_type cls_type, int svid, int vid,
 		struct mac_classifier *mac_cls,
 		__rte_unused struct cls_comp_info *cmp_info,
 		struct cls_port_info *port_info)
@@ -829,11 +1135,6 @@ add_mac_entry(struct classifier_table_params *params,
 	uint32_t next;
 	struct sppwk_port_idx port;
 	char mac_addr_str[ETHER_ADDR_STR_BUF_SZ];
-	enum sppwk_cls_type cls_type;
-
-	cls_type = SPPWK_CLS_TYPE_VLAN;
-	if (unlikely(vid == VLAN_UNTAGGED_VID))
-		cls_type = SPPWK_CLS_TYPE_MAC;
 
 	if (mac_cls->default_cls_idx >= 0) {
 		port.iface_type = (port_info +
@@ -847,7 +1148,7 @@ add_mac_entry(struct classifier_table_params *params,
 		 * Append "default" entry. `tbl_proc` is funciton pointer to
 		 * append_classifier_element_value().
 		 */
-		(*params->tbl_proc)(params, cls_type, vid,
+		(*params->tbl_proc)(params, cls_type, svid, vid,
 				SPPWK_TERM_DEFAULT, &port);
 	}
 
@@ -870,7 +1171,8 @@ add_mac_entry(struct classifier_table_params *params,
 		 * Append each entry of MAC address. `tbl_proc` is function
 		 * pointer to append_classifier_element_value().
 		 */
-		(*params->tbl_proc)(params, cls_type, vid, mac_addr_str, &port);
+		(*params->tbl_proc)(params, cls_type, svid, vid,
+				mac_addr_str, &port);
 	}
 }
 
@@ -882,6 +1184,9 @@ _add_classifier_table(struct classifier_table_params *params)
 	struct cls_mng_info *mng_info;
 	struct cls_comp_info *cmp_info;
 	struct cls_port_info *port_info;
+	const void *key;
+	void *data;
+	uint32_t next;
 
 	for (i = 0; i < RTE_MAX_LCORE; i++) {
 		mng_info = cls_mng_info_list + i;
@@ -898,10 +1203,34 @@ _add_classifier_table(struct classifier_table_params *params)
 			if (cmp_info->mac_clfs[vlan_id] == NULL)
 				continue;
 
-			add_mac_entry(params, (uint16_t) vlan_id,
+			add_mac_entry(params,
+					vlan_id == VLAN_UNTAGGED_VID ?
+					SPPWK_CLS_TYPE_MAC :
+					SPPWK_CLS_TYPE_VLAN,
+					VLAN_UNTAGGED_VID, vlan_id,
 					cmp_info->mac_clfs[vlan_id], cmp_info,
 					port_info);
 		}
+
+		next = 0;
+		while (cmp_info->qinq_clfs != NULL &&
+				rte_hash_iterate(cmp_info->qinq_clfs, &key,
+				&data, &next) >= 0) {
+			add_mac_entry(params, SPPWK_CLS_TYPE_QINQ,
+					*(const uint32_t *)key >> 16,
+					*(const uint32_t *)key & 0xffff,
+					data, cmp_info, port_info);
+		}
+
+		next = 0;
+		while (cmp_info->vni_clfs != NULL &&
+				rte_hash_iterate(cmp_info->vni_clfs, &key,
+				&data, &next) >= 0) {
+			add_mac_entry(params, SPPWK_CLS_TYPE_VNI,
+					VLAN_UNTAGGED_VID,
+					*(const uint32_t *)key,
+					data, cmp_info, port_info);
+		}
 	}
 
 	return SPPWK_RET_OK;
@@ -25,7 +25,7 @@ struct classifier_table_params;
 typedef int (*classifier_table_proc)(
 		struct classifier_table_params *params,
 		enum sppwk_cls_type cls_type,
-		int vid, const char *mac,
+		int svid, int vid, const char *mac,
 		const struct sppwk_port_idx *port);
 
 /**
@@ -42,7 +42,7 @@ struct classifier_table_params {
 int append_classifier_element_value(
 		struct classifier_table_params *params,
 		enum sppwk_cls_type cls_type,
-		int vid, const char *mac,
+		int svid, int vid, const char *mac,
 		const struct sppwk_port_idx *port);
 
 /**
@@ -79,8 +79,7 @@ void init_classifier_info(int comp_id);
  * Classify incoming packets.
  *
  * @param id Component ID.
- * @retval SPPWK_RET_OK succeeded.
- * @retval SPPWK_RET_NG failed.
+ * @return Num of received packets, or SPPWK_RET_NG if failed.
  */
 int classify_packets(int comp_id);
 
@@ -9,9 +9,7 @@
 #include "shared/secondary/spp_worker_th/vf_deps.h"
 #include "shared/secondary/spp_worker_th/port_capability.h"
 
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
 #include "shared/secondary/spp_worker_th/latency_stats.h"
-#endif
 
 #define RTE_LOGTYPE_FORWARD RTE_LOGTYPE_USER1
 
@@ -112,6 +110,14 @@ update_forwarder(struct sppwk_comp_info *comp_info)
 	/* TODO(yasufum) rename `path` of struct forward_path. */
 	struct forward_path *fwd_path = &fwd_info->path[fwd_info->upd_index];
 
+	/* Update side is still referred if previous update is not taken. */
+	if (unlikely(fwd_info->ref_index == fwd_info->upd_index)) {
+		RTE_LOG(ERR, FORWARD,
+			"Previous update is not taken yet (id=%d).\n",
+			comp_info->comp_id);
+		return SPPWK_RET_NG;
+	}
+
 	/**
 	 * Check num of RX and TX ports because forwarder has just a set of
 	 * RX and TX.
@@ -152,9 +158,8 @@ update_forwarder(struct sppwk_comp_info *comp_info)
 		memcpy(&fwd_path->ports[cnt].tx, comp_info->tx_ports[0],
 				sizeof(struct sppwk_port_info));
 
+	/* Publish it, and the lcore is waited in sppwk_wait_update_done(). */
 	fwd_info->upd_index = fwd_info->ref_index;
-	while (likely(fwd_info->ref_index == fwd_info->upd_index))
-		rte_delay_us_block(SPPWK_UPDATE_INTERVAL);
 
 	RTE_LOG(INFO, FORWARD,
 			"Done update forwarder. (id=%d, name=%s, type=%d)\n",
@@ -164,16 +169,42 @@ update_forwarder(struct sppwk_comp_info *comp_info)
 	return SPPWK_RET_OK;
 }
 
+/* Check if updated forwarder info is taken by its lcore. */
+int
+is_forwarder_update_done(int comp_id)
+{
+	struct forward_info *fwd_info = &g_forward_info[comp_id];
+	if (fwd_info->ref_index == fwd_info->upd_index)
+		return 0;
+	else
+		return 1;
+}
+
+/* Take updated attributes of ports of given path. */
+static void
+take_fwd_port_attrs(const struct forward_path *path)
+{
+	int cnt;
+
+	for (cnt = 0; cnt < path->nof_rx; cnt++)
+		sppwk_take_port_attrs(path->ports[cnt].rx.ethdev_port_id,
+				SPPWK_PORT_DIR_RX);
+	/* All of TX are the same port. */
+	if (path->nof_tx > 0)
+		sppwk_take_port_attrs(path->ports[0].tx.ethdev_port_id,
+				SPPWK_PORT_DIR_TX);
+}
+
 /* Change index of forward info */
 static inline void
 change_forward_index(int id)
 {
 	struct forward_info *info = &g_forward_info[id];
 	if (info->ref_index == info->upd_index) {
-		/* Change reference index of port ability. */
-		sppwk_swap_two_sides(SPPWK_SWAP_REF, 0, 0);
-
 		info->ref_index = (info->upd_index+1) % TWO_SIDES;
+
+		/* Change reference side of attributes of its ports. */
+		take_fwd_port_attrs(&info->path[info->ref_index]);
 	}
 }
 /**
@@ -188,6 +219,7 @@ forward_packets(int id)
 	int cnt, buf;
 	int nb_rx = 0;
 	int nb_tx = 0;
+	int nof_pkts = 0;  /* Total num of received packets. */
 	struct forward_info *info = &g_forward_info[id];
 	struct forward_path *path = NULL;
 	struct sppwk_port_info *rx;
@@ -212,27 +244,22 @@ forward_packets(int id)
 		rx = &path->ports[cnt].rx;
 		tx = &path->ports[cnt].tx;
 
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
-		nb_rx = sppwk_eth_vlan_ring_stats_rx_burst(rx->ethdev_port_id,
-				rx->iface_type, rx->iface_no, 0,
-				bufs, MAX_PKT_BURST);
-#else
-		nb_rx = sppwk_eth_vlan_rx_burst(rx->ethdev_port_id, 0,
+		nb_rx = sppwk_port_rx_burst(rx->ethdev_port_id,
+				rx->iface_type, rx->iface_no,
 				bufs, MAX_PKT_BURST);
-#endif
-		if (unlikely(nb_rx == 0))
+		if (unlikely(nb_rx == 0)) {
+			/* Send packets remained in shaper of TX port. */
+			if (tx->ethdev_port_id >= 0)
+				sppwk_eth_vlan_tx_drain(tx->ethdev_port_id);
 			continue;
+		}
+		nof_pkts += nb_rx;
 
 		/* Send packets */
 		if (tx->ethdev_port_id >= 0)
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
-			nb_tx = sppwk_eth_vlan_ring_stats_tx_burst(
-					tx->ethdev_port_id, tx->iface_type,
-					tx->iface_no, 0, bufs, nb_rx);
-#else
-			nb_tx = sppwk_eth_vlan_tx_burst(tx->ethdev_port_id,
-					0, bufs, nb_rx);
-#endif
+			nb_tx = sppwk_port_tx_burst(tx->ethdev_port_id,
+					tx->iface_type, tx->iface_no,
+					bufs, nb_rx);
 
 		/* Discard remained packets to release mbuf */
 		if (unlikely(nb_tx < nb_rx)) {
@@ -240,5 +267,5 @@ forward_packets(int id)
 				rte_pktmbuf_free(bufs[buf]);
 		}
 	}
-	return SPPWK_RET_OK;
+	return nof_pkts;
 }
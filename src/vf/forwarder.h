@@ -33,8 +33,7 @@ void init_forwarder(void);
  * as an argument of void and typecasted to spp_config_info.
  *
  * @param[in] id Unique component ID.
- * @retval SPPWK_RET_OK If succeeded.
- * @retval SPPWK_RET_NG If failed.
+ * @return Num of received packets, or SPPWK_RET_NG if failed.
  */
 int forward_packets(int id);
 
@@ -0,0 +1,599 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <stdlib.h>
+#include <time.h>
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+
+#include "rebalancer.h"
+#include "shared/secondary/return_codes.h"
+#include "shared/secondary/string_buffer.h"
+#include "shared/secondary/json_helper.h"
+#include "shared/secondary/spp_worker_th/cmd_runner.h"
+#include "shared/secondary/spp_worker_th/cmd_res_formatter.h"
+
+#define RTE_LOGTYPE_VF_REBALANCER RTE_LOGTYPE_USER1
+
+/* Record of moving component for showing in status. */
+struct rebalance_log {
+	time_t time;  /* Time of moving. */
+	char name[STR_LEN_NAME];  /* Name of moved component. */
+	unsigned int src_lcore;  /* Overloaded lcore. */
+	unsigned int dst_lcore;  /* Lcore component is moved to. */
+	int src_usage;  /* Utilization of src lcore before moving. */
+	int dst_usage;  /* Utilization of dst lcore before moving. */
+	int comp_usage;  /* Utilization of moved component. */
+	int result;  /* SPPWK_RET_OK or SPPWK_RET_NG. */
+};
+
+/* Attributes and measured results of rebalancer. */
+struct rebalancer_info {
+	int enabled;  /* Move components if 1, or only measure. */
+	int threshold;  /* Threshold of lcore utilization in percent. */
+	int nof_pool;  /* Num of lcores in the pool. */
+	unsigned int pool[RTE_MAX_LCORE];  /* Lcores for rebalancing. */
+	uint64_t prev_tsc;  /* TSC of the last measuring. */
+	int cooldown;  /* Num of remained intervals to wait after moving. */
+	int over_cnt[RTE_MAX_LCORE];  /* Intervals over threshold in a row. */
+	int lcore_usage[RTE_MAX_LCORE];  /* Utilization of each lcore. */
+	int comp_usage[RTE_MAX_LCORE];  /* Utilization of each component. */
+	struct comp_load prev_load[RTE_MAX_LCORE];  /* Load at prev_tsc. */
+	int nof_logs;  /* Num of valid entries in logs. */
+	int next_log;  /* Index of logs for next entry. */
+	struct rebalance_log logs[NOF_REBALANCE_LOGS];
+};
+
+struct comp_load g_comp_load[RTE_MAX_LCORE];
+
+static struct rebalancer_info g_rebalancer = {
+	.threshold = REBALANCE_THRESHOLD_DEFAULT,
+};
+
+/* Clear load of component, called before the component is started. */
+void
+reset_comp_load(int comp_id)
+{
+	memset(&g_comp_load[comp_id], 0x00, sizeof(struct comp_load));
+	memset(&g_rebalancer.prev_load[comp_id], 0x00,
+			sizeof(struct comp_load));
+	g_rebalancer.comp_usage[comp_id] = 0;
+}
+
+/* Return 1 if given lcore is already included in the pool. */
+static int
+is_in_pool(unsigned int lcore_id)
+{
+	int i;
+
+	for (i = 0; i < g_rebalancer.nof_pool; i++) {
+		if (g_rebalancer.pool[i] == lcore_id)
+			return 1;
+	}
+	return 0;
+}
+
+/* Parse list of lcores for rebalancing such as `2,3,5-7`. */
+int
+parse_rebalance_lcores(const char *lcores_str)
+{
+	const char *str = lcores_str;
+	char *endp = NULL;
+	unsigned long first, last, lcore_id;
+
+	g_rebalancer.nof_pool = 0;
+	while (*str != '\0') {
+		first = strtoul(str, &endp, 10);
+		last = first;
+		if (endp != str && *endp == '-') {
+			str = endp + 1;
+			last = strtoul(str, &endp, 10);
+		}
+		if (endp == str || last < first || last >= RTE_MAX_LCORE ||
+				(*endp != ',' && *endp != '\0')) {
+			RTE_LOG(ERR, VF_REBALANCER,
+					"Invalid list of lcores '%s'.\n",
+					lcores_str);
+			return SPPWK_RET_NG;
+		}
+
+		for (lcore_id = first; lcore_id <= last; lcore_id++) {
+			if (!rte_lcore_is_enabled(lcore_id) ||
+					lcore_id == rte_get_master_lcore()) {
+				RTE_LOG(ERR, VF_REBALANCER,
+						"Lcore %lu is not for workers.\n",
+						lcore_id);
+				return SPPWK_RET_NG;
+			}
+			if (!is_in_pool(lcore_id))
+				g_rebalancer.pool[g_rebalancer.nof_pool++] =
+						lcore_id;
+		}
+
+		str = (*endp == ',') ? endp + 1 : endp;
+	}
+
+	if (g_rebalancer.nof_pool < 2) {
+		RTE_LOG(ERR, VF_REBALANCER,
+				"Two or more lcores are required for "
+				"rebalancing.\n");
+		return SPPWK_RET_NG;
+	}
+
+	g_rebalancer.enabled = 1;
+	return SPPWK_RET_OK;
+}
+
+/* Parse threshold of lcore utilization. */
+int
+parse_rebalance_threshold(const char *threshold_str)
+{
+	char *endp = NULL;
+	long threshold;
+
+	threshold = strtol(threshold_str, &endp, 10);
+	if (endp == threshold_str || *endp != '\0' ||
+			threshold <= REBALANCE_MARGIN || threshold > 100) {
+		RTE_LOG(ERR, VF_REBALANCER,
+				"Invalid threshold '%s', should be in %d-100.\n",
+				threshold_str, REBALANCE_MARGIN + 1);
+		return SPPWK_RET_NG;
+	}
+
+	g_rebalancer.threshold = threshold;
+	return SPPWK_RET_OK;
+}
+
+/* Clear measured load and decisions, and start measuring. */
+void
+init_rebalancer(void)
+{
+	memset(g_comp_load, 0x00, sizeof(g_comp_load));
+	memset(g_rebalancer.prev_load, 0x00,
+			sizeof(g_rebalancer.prev_load));
+	memset(g_rebalancer.over_cnt, 0x00, sizeof(g_rebalancer.over_cnt));
+	memset(g_rebalancer.lcore_usage, 0x00,
+			sizeof(g_rebalancer.lcore_usage));
+	memset(g_rebalancer.comp_usage, 0x00,
+			sizeof(g_rebalancer.comp_usage));
+	g_rebalancer.cooldown = 0;
+	g_rebalancer.nof_logs = 0;
+	g_rebalancer.next_log = 0;
+	g_rebalancer.prev_tsc = rte_rdtsc();
+
+	if (g_rebalancer.enabled)
+		RTE_LOG(INFO, VF_REBALANCER,
+				"Rebalance on %d lcores over %d%% usage.\n",
+				g_rebalancer.nof_pool, g_rebalancer.threshold);
+}
+
+/* Update utilization of components and lcores for the last interval. */
+static void
+update_usage(uint64_t elapsed)
+{
+	int cnt, comp_id, usage;
+	unsigned int lcore_id;
+	struct core_info *core = NULL;
+	struct comp_load *prev = NULL;
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		g_rebalancer.lcore_usage[lcore_id] = 0;
+		if (sppwk_get_lcore_status(lcore_id) == SPPWK_LCORE_UNUSED)
+			continue;
+
+		core = get_core_info(lcore_id);
+		for (cnt = 0; cnt < core->num; cnt++) {
+			comp_id = core->id[cnt];
+			prev = &g_rebalancer.prev_load[comp_id];
+			usage = (g_comp_load[comp_id].busy_tsc -
+					prev->busy_tsc) * 100 / elapsed;
+			if (usage > 100)
+				usage = 100;
+			*prev = g_comp_load[comp_id];
+
+			g_rebalancer.comp_usage[comp_id] = usage;
+			g_rebalancer.lcore_usage[lcore_id] += usage;
+		}
+
+		if (g_rebalancer.lcore_usage[lcore_id] > 100)
+			g_rebalancer.lcore_usage[lcore_id] = 100;
+
+		if (g_rebalancer.lcore_usage[lcore_id] > g_rebalancer.threshold)
+			g_rebalancer.over_cnt[lcore_id]++;
+		else
+			g_rebalancer.over_cnt[lcore_id] = 0;
+	}
+}
+
+/**
+ * Find the most loaded lcore in the pool which has been over the threshold
+ * for a while and has two or more components, or return -1.
+ */
+static int
+find_src_lcore(void)
+{
+	int i;
+	int src = -1;
+	unsigned int lcore_id;
+
+	for (i = 0; i < g_rebalancer.nof_pool; i++) {
+		lcore_id = g_rebalancer.pool[i];
+		if (g_rebalancer.over_cnt[lcore_id] < REBALANCE_HOLD_CNT)
+			continue;
+		if (get_core_info(lcore_id)->num < 2)
+			continue;
+		if (src < 0 || g_rebalancer.lcore_usage[lcore_id] >
+				g_rebalancer.lcore_usage[src])
+			src = lcore_id;
+	}
+	return src;
+}
+
+/* Find the most idle lcore in the pool, or return -1 if all are busy. */
+static int
+find_dst_lcore(void)
+{
+	int i;
+	int dst = -1;
+	unsigned int lcore_id;
+
+	for (i = 0; i < g_rebalancer.nof_pool; i++) {
+		lcore_id = g_rebalancer.pool[i];
+		if (g_rebalancer.lcore_usage[lcore_id] >=
+				g_rebalancer.threshold - REBALANCE_MARGIN)
+			continue;
+		if (dst < 0 || g_rebalancer.lcore_usage[lcore_id] <
+				g_rebalancer.lcore_usage[dst])
+			dst = lcore_id;
+	}
+	return dst;
+}
+
+/**
+ * Choose a component on src which makes the peak utilization of src and dst
+ * lowest without overloading dst, or return -1 if no one is appropriate.
+ */
+static int
+choose_comp(unsigned int src, unsigned int dst)
+{
+	int cnt, comp_id, usage, peak;
+	int best_id = -1;
+	int best_peak = g_rebalancer.lcore_usage[src];
+	int src_usage = g_rebalancer.lcore_usage[src];
+	int dst_usage = g_rebalancer.lcore_usage[dst];
+	struct core_info *core = get_core_info(src);
+
+	for (cnt = 0; cnt < core->num; cnt++) {
+		comp_id = core->id[cnt];
+		usage = g_rebalancer.comp_usage[comp_id];
+		if (usage == 0)
+			continue;
+		if (dst_usage + usage >=
+				g_rebalancer.threshold - REBALANCE_MARGIN)
+			continue;
+
+		peak = RTE_MAX(src_usage - usage, dst_usage + usage);
+		if (peak < best_peak) {
+			best_peak = peak;
+			best_id = comp_id;
+		}
+	}
+	return best_id;
+}
+
+/* Move component from src to dst and record the result. */
+static void
+rebalance_comp(int comp_id, unsigned int src, unsigned int dst)
+{
+	struct sppwk_comp_info *comp_info_base = NULL;
+	struct rebalance_log *log =
+			&g_rebalancer.logs[g_rebalancer.next_log];
+
+	sppwk_get_mng_data(NULL, &comp_info_base, NULL, NULL, NULL, NULL);
+
+	log->time = time(NULL);
+	strcpy(log->name, comp_info_base[comp_id].name);
+	log->src_lcore = src;
+	log->dst_lcore = dst;
+	log->src_usage = g_rebalancer.lcore_usage[src];
+	log->dst_usage = g_rebalancer.lcore_usage[dst];
+	log->comp_usage = g_rebalancer.comp_usage[comp_id];
+
+	RTE_LOG(INFO, VF_REBALANCER,
+			"Move '%s' (%d%%) from lcore %u (%d%%) "
+			"to lcore %u (%d%%).\n",
+			log->name, log->comp_usage, src, log->src_usage,
+			dst, log->dst_usage);
+	log->result = move_comp_lcore(log->name, dst);
+	if (unlikely(log->result != SPPWK_RET_OK))
+		RTE_LOG(ERR, VF_REBALANCER, "Failed to move '%s'.\n",
+				log->name);
+
+	g_rebalancer.next_log = (g_rebalancer.next_log + 1) %
+			NOF_REBALANCE_LOGS;
+	if (g_rebalancer.nof_logs < NOF_REBALANCE_LOGS)
+		g_rebalancer.nof_logs++;
+
+	g_rebalancer.over_cnt[src] = 0;
+	g_rebalancer.cooldown = REBALANCE_COOLDOWN_CNT;
+}
+
+/* Update utilization and move a component if an lcore is overloaded. */
+void
+run_rebalancer(void)
+{
+	int src, dst, comp_id;
+	uint64_t cur_tsc = rte_rdtsc();
+	uint64_t elapsed = cur_tsc - g_rebalancer.prev_tsc;
+
+	if (elapsed < rte_get_tsc_hz() * REBALANCE_INTERVAL)
+		return;
+
+	g_rebalancer.prev_tsc = cur_tsc;
+	update_usage(elapsed);
+
+	if (!g_rebalancer.enabled)
+		return;
+
+	if (g_rebalancer.cooldown > 0) {
+		g_rebalancer.cooldown--;
+		return;
+	}
+
+	src = find_src_lcore();
+	if (src < 0)
+		return;
+
+	dst = find_dst_lcore();
+	if (dst < 0) {
+		RTE_LOG(DEBUG, VF_REBALANCER,
+				"No idle lcore for overloaded lcore %d.\n",
+				src);
+		return;
+	}
+
+	comp_id = choose_comp(src, dst);
+	if (comp_id < 0) {
+		RTE_LOG(DEBUG, VF_REBALANCER,
+				"No component can be moved from lcore %d "
+				"to %d.\n", src, dst);
+		return;
+	}
+
+	rebalance_comp(comp_id, src, dst);
+}
+
+/* Add lcores of the pool as an array of lcore IDs in JSON. */
+static int
+append_pool_value(char **output)
+{
+	int i;
+	char *tmp_buff;
+	char lcore_str[STR_LEN_SHORT];
+	int ret;
+
+	tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(tmp_buff == NULL))
+		return SPPWK_RET_NG;
+
+	for (i = 0; i < g_rebalancer.nof_pool; i++) {
+		sprintf(lcore_str, "%s%u", JSON_APPEND_COMMA(i),
+				g_rebalancer.pool[i]);
+		tmp_buff = spp_strbuf_append(tmp_buff, lcore_str,
+				strlen(lcore_str));
+		if (unlikely(tmp_buff == NULL))
+			return SPPWK_RET_NG;
+	}
+
+	ret = append_json_array_brackets(output, "pool", tmp_buff);
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
+/* Add utilization of lcores in JSON. */
+static int
+append_lcores_value(char **output)
+{
+	int ret = SPPWK_RET_OK;
+	unsigned int lcore_id;
+	char *tmp_buff, *array_buff;
+
+	array_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(array_buff == NULL))
+		return SPPWK_RET_NG;
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		if (sppwk_get_lcore_status(lcore_id) == SPPWK_LCORE_UNUSED)
+			continue;
+
+		tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+		if (unlikely(tmp_buff == NULL)) {
+			ret = SPPWK_RET_NG;
+			break;
+		}
+
+		ret = append_json_uint_value(&tmp_buff, "lcore_id", lcore_id);
+		if (likely(ret == SPPWK_RET_OK))
+			ret = append_json_int_value(&tmp_buff, "usage",
+					g_rebalancer.lcore_usage[lcore_id]);
+		if (likely(ret == SPPWK_RET_OK))
+			ret = append_json_block_brackets(&array_buff, "",
+					tmp_buff);
+		spp_strbuf_free(tmp_buff);
+		if (unlikely(ret != SPPWK_RET_OK))
+			break;
+	}
+
+	if (likely(ret == SPPWK_RET_OK))
+		ret = append_json_array_brackets(output, "lcores",
+				array_buff);
+	spp_strbuf_free(array_buff);
+	return ret;
+}
+
+/* Add load of running components in JSON. */
+static int
+append_comps_value(char **output)
+{
+	int ret = SPPWK_RET_OK;
+	int cnt, comp_id;
+	unsigned int lcore_id;
+	struct core_info *core = NULL;
+	struct sppwk_comp_info *comp_info_base = NULL;
+	char *tmp_buff, *array_buff;
+
+	array_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(array_buff == NULL))
+		return SPPWK_RET_NG;
+
+	sppwk_get_mng_data(NULL, &comp_info_base, NULL, NULL, NULL, NULL);
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		if (sppwk_get_lcore_status(lcore_id) == SPPWK_LCORE_UNUSED)
+			continue;
+
+		core = get_core_info(lcore_id);
+		for (cnt = 0; cnt < core->num; cnt++) {
+			comp_id = core->id[cnt];
+			tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+			if (unlikely(tmp_buff == NULL)) {
+				ret = SPPWK_RET_NG;
+				break;
+			}
+
+			ret = append_json_str_value(&tmp_buff, "name",
+					comp_info_base[comp_id].name);
+			if (likely(ret == SPPWK_RET_OK))
+				ret = append_json_uint_value(&tmp_buff,
+						"lcore_id", lcore_id);
+			if (likely(ret == SPPWK_RET_OK))
+				ret = append_json_int_value(&tmp_buff, "usage",
+					g_rebalancer.comp_usage[comp_id]);
+			if (likely(ret == SPPWK_RET_OK))
+				ret = append_json_uint64_value(&tmp_buff,
+					"busy_cycles",
+					g_comp_load[comp_id].busy_tsc);
+			if (likely(ret == SPPWK_RET_OK))
+				ret = append_json_uint64_value(&tmp_buff,
+					"idle_cycles",
+					g_comp_load[comp_id].idle_tsc);
+			if (likely(ret == SPPWK_RET_OK))
+				ret = append_json_uint64_value(&tmp_buff,
+					"rx_pkts",
+					g_comp_load[comp_id].rx_pkts);
+			if (likely(ret == SPPWK_RET_OK))
+				ret = append_json_block_brackets(&array_buff,
+						"", tmp_buff);
+			spp_strbuf_free(tmp_buff);
+			if (unlikely(ret != SPPWK_RET_OK))
+				break;
+		}
+		if (unlikely(ret != SPPWK_RET_OK))
+			break;
+	}
+
+	if (likely(ret == SPPWK_RET_OK))
+		ret = append_json_array_brackets(output, "components",
+				array_buff);
+	spp_strbuf_free(array_buff);
+	return ret;
+}
+
+/* Add recent decisions of moving in JSON, from the oldest one. */
+static int
+append_logs_value(char **output)
+{
+	int ret = SPPWK_RET_OK;
+	int i;
+	struct rebalance_log *log = NULL;
+	char *tmp_buff, *array_buff;
+
+	array_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(array_buff == NULL))
+		return SPPWK_RET_NG;
+
+	for (i = 0; i < g_rebalancer.nof_logs; i++) {
+		log = &g_rebalancer.logs[(g_rebalancer.next_log -
+				g_rebalancer.nof_logs + i +
+				NOF_REBALANCE_LOGS) % NOF_REBALANCE_LOGS];
+		tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+		if (unlikely(tmp_buff == NULL)) {
+			ret = SPPWK_RET_NG;
+			break;
+		}
+
+		ret = append_json_uint64_value(&tmp_buff, "time",
+				(uint64_t)log->time);
+		if (likely(ret == SPPWK_RET_OK))
+			ret = append_json_str_value(&tmp_buff, "name",
+					log->name);
+		if (likely(ret == SPPWK_RET_OK))
+			ret = append_json_uint_value(&tmp_buff, "src_lcore",
+					log->src_lcore);
+		if (likely(ret == SPPWK_RET_OK))
+			ret = append_json_int_value(&tmp_buff, "src_usage",
+					log->src_usage);
+		if (likely(ret == SPPWK_RET_OK))
+			ret = append_json_uint_value(&tmp_buff, "dst_lcore",
+					log->dst_lcore);
+		if (likely(ret == SPPWK_RET_OK))
+			ret = append_json_int_value(&tmp_buff, "dst_usage",
+					log->dst_usage);
+		if (likely(ret == SPPWK_RET_OK))
+			ret = append_json_int_value(&tmp_buff, "comp_usage",
+					log->comp_usage);
+		if (likely(ret == SPPWK_RET_OK))
+			ret = append_json_str_value(&tmp_buff, "result",
+					(log->result == SPPWK_RET_OK) ?
+					"success" : "error");
+		if (likely(ret == SPPWK_RET_OK))
+			ret = append_json_block_brackets(&array_buff, "",
+					tmp_buff);
+		spp_strbuf_free(tmp_buff);
+		if (unlikely(ret != SPPWK_RET_OK))
+			break;
+	}
+
+	if (likely(ret == SPPWK_RET_OK))
+		ret = append_json_array_brackets(output, "decisions",
+				array_buff);
+	spp_strbuf_free(array_buff);
+	return ret;
+}
+
+/* Add entry of rebalancer to a response in JSON. */
+int
+add_rebalancer_status(const char *name, char **output,
+		void *tmp __attribute__ ((unused)))
+{
+	int ret;
+	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, VF_REBALANCER, "Failed to alloc buff.\n");
+		return SPPWK_RET_NG;
+	}
+
+	ret = append_json_int_value(&tmp_buff, "enabled",
+			g_rebalancer.enabled);
+	if (likely(ret == SPPWK_RET_OK))
+		ret = append_json_int_value(&tmp_buff, "threshold",
+				g_rebalancer.threshold);
+	if (likely(ret == SPPWK_RET_OK))
+		ret = append_pool_value(&tmp_buff);
+	if (likely(ret == SPPWK_RET_OK))
+		ret = append_lcores_value(&tmp_buff);
+	if (likely(ret == SPPWK_RET_OK))
+		ret = append_comps_value(&tmp_buff);
+	if (likely(ret == SPPWK_RET_OK))
+		ret = append_logs_value(&tmp_buff);
+	if (unlikely(ret != SPPWK_RET_OK)) {
+		RTE_LOG(ERR, VF_REBALANCER,
+				"Failed to make status of rebalancer.\n");
+		spp_strbuf_free(tmp_buff);
+		return SPPWK_RET_NG;
+	}
+
+	ret = append_json_block_brackets(output, name, tmp_buff);
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
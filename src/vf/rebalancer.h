@@ -0,0 +1,117 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+ */
+
+#ifndef __SPP_REBALANCER_H__
+#define __SPP_REBALANCER_H__
+
+#include <rte_memory.h>
+#include "shared/secondary/spp_worker_th/cmd_utils.h"
+
+/**
+ * @file
+ * SPP Rebalancer
+ *
+ * Rebalancer measures busy cycles and received packets of each component
+ * on worker lcores. If a pool of lcores is given with `--rebalance` option,
+ * it also moves a component from an lcore which is over the threshold of
+ * utilization to the most idle one in the pool. An lcore is regarded as
+ * overloaded only if it exceeds the threshold for several intervals in a row,
+ * and no other move is done for a while after moving to avoid ping-pong.
+ */
+
+/* Default threshold of lcore utilization in percent. */
+#define REBALANCE_THRESHOLD_DEFAULT 80
+
+/* Interval of measuring and rebalancing. */
+#define REBALANCE_INTERVAL 1  /* sec */
+
+/* Num of intervals an lcore should be over the threshold before moving. */
+#define REBALANCE_HOLD_CNT 3
+
+/* Num of intervals of doing nothing after moving component. */
+#define REBALANCE_COOLDOWN_CNT 5
+
+/* Destination should be below the threshold by this margin after moving. */
+#define REBALANCE_MARGIN 10  /* percent */
+
+/* Num of recent decisions kept for showing in status. */
+#define NOF_REBALANCE_LOGS 8
+
+/* Load of a component counted on the lcore running it. */
+struct comp_load {
+	uint64_t busy_tsc;  /* Cycles of calls which have received packets. */
+	uint64_t idle_tsc;  /* Cycles of calls which have received nothing. */
+	uint64_t rx_pkts;  /* Num of received packets. */
+} __rte_cache_aligned;
+
+/* Load of components indexed by component ID, updated by worker lcores. */
+extern struct comp_load g_comp_load[RTE_MAX_LCORE];
+
+/**
+ * Add load of one call of component, called from slave_main().
+ *
+ * @param[in] comp_id Component ID.
+ * @param[in] cycles TSC cycles of the call.
+ * @param[in] nof_pkts Num of received packets in the call.
+ */
+static inline void
+add_comp_load(int comp_id, uint64_t cycles, int nof_pkts)
+{
+	struct comp_load *load = &g_comp_load[comp_id];
+
+	if (nof_pkts > 0) {
+		load->busy_tsc += cycles;
+		load->rx_pkts += nof_pkts;
+	} else
+		load->idle_tsc += cycles;
+}
+
+/**
+ * Clear load of component, called before the component is started.
+ *
+ * @param[in] comp_id Component ID.
+ */
+void reset_comp_load(int comp_id);
+
+/**
+ * Parse list of lcores for rebalancing such as `2,3,5-7`.
+ *
+ * @param[in] lcores_str List of lcore IDs given with `--rebalance`.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int parse_rebalance_lcores(const char *lcores_str);
+
+/**
+ * Parse threshold of lcore utilization given with `--rebalance-threshold`.
+ *
+ * @param[in] threshold_str Threshold in percent.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int parse_rebalance_threshold(const char *threshold_str);
+
+/* Clear measured load and decisions, and start measuring. */
+void init_rebalancer(void);
+
+/**
+ * Update utilization of lcores and components, and move a component if an
+ * lcore in the pool is overloaded. It is called from the loop of master
+ * thread and does nothing until the interval is passed.
+ */
+void run_rebalancer(void);
+
+/**
+ * Add entry of rebalancer to a response in JSON.
+ *
+ * @param[in] name Name of the entry.
+ * @param[in,out] output Placeholder of JSON msg.
+ * @param tmp Not used.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int add_rebalancer_status(const char *name, char **output,
+		void *tmp __attribute__ ((unused)));
+
+#endif /* __SPP_REBALANCER_H__ */
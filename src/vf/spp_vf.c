@@ -5,9 +5,11 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <getopt.h>
+#include <rte_cycles.h>
 
 #include "classifier.h"
 #include "forwarder.h"
+#include "rebalancer.h"
 #include "shared/secondary/common.h"
 #include "shared/secondary/utils.h"
 #include "shared/secondary/spp_worker_th/cmd_utils.h"
@@ -16,12 +18,20 @@
 #include "shared/secondary/spp_worker_th/cmd_runner.h"
 #include "shared/secondary/spp_worker_th/cmd_parser.h"
 #include "shared/secondary/spp_worker_th/port_capability.h"
+#include "shared/secondary/spp_worker_th/ring_fusion.h"
+#include "shared/secondary/spp_worker_th/queue_occupancy.h"
+
+#include "shared/secondary/spp_worker_th/latency_stats.h"
 
 #define RTE_LOGTYPE_SPP_VF RTE_LOGTYPE_USER1
 
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
-#include "shared/secondary/spp_worker_th/latency_stats.h"
-#endif
+/* Burst functions of ports without and with measuring latency. */
+static const struct sppwk_burst_ops g_vlan_burst = {
+	sppwk_eth_vlan_rx_burst, sppwk_eth_vlan_tx_burst
+};
+static const struct sppwk_burst_ops g_vlan_stats_burst = {
+	sppwk_eth_vlan_stats_rx_burst, sppwk_eth_vlan_stats_tx_burst
+};
 
 /* getopt_long return value for long option */
 enum SPP_LONGOPT_RETVAL {
@@ -29,7 +39,9 @@ enum SPP_LONGOPT_RETVAL {
 
 	/* Return value definition for getopt_long(). Only for long option. */
 	SPP_LONGOPT_RETVAL_CLIENT_ID,    /* For `--client-id` */
-	SPP_LONGOPT_RETVAL_VHOST_CLIENT  /* For `--vhost-client` */
+	SPP_LONGOPT_RETVAL_VHOST_CLIENT, /* For `--vhost-client` */
+	SPP_LONGOPT_RETVAL_REBALANCE,    /* For `--rebalance` */
+	SPP_LONGOPT_RETVAL_REBALANCE_THRESHOLD  /* `--rebalance-threshold` */
 };
 
 /* Declare global variables */
@@ -58,12 +70,18 @@ usage(const char *progname)
 	RTE_LOG(INFO, SPP_VF, "Usage: %s [EAL args] --"
 			" --client-id CLIENT_ID"
 			" -s SERVER_IP:SERVER_PORT"
-			" [--vhost-client]\n"
+			" [--vhost-client]"
+			" [--rebalance LCORES]"
+			" [--rebalance-threshold PERCENT]\n"
 			" --client-id CLIENT_ID   : My client ID\n"
 			" -s SERVER_IP:SERVER_PORT  :"
 			" Access information to the server\n"
 			" --vhost-client            : Run vhost on client\n"
-			, progname);
+			" --rebalance LCORES        :"
+			" Move components among lcores such as '2-4'\n"
+			" --rebalance-threshold PERCENT :"
+			" Lcore usage to start moving (default %d)\n"
+			, progname, REBALANCE_THRESHOLD_DEFAULT);
 }
 
 /* Parse options for client app */
@@ -89,6 +107,10 @@ parse_app_args(int argc, char *argv[])
 					SPP_LONGOPT_RETVAL_CLIENT_ID },
 			{ "vhost-client", no_argument, NULL,
 					SPP_LONGOPT_RETVAL_VHOST_CLIENT },
+			{ "rebalance", required_argument, NULL,
+					SPP_LONGOPT_RETVAL_REBALANCE },
+			{ "rebalance-threshold", required_argument, NULL,
+					SPP_LONGOPT_RETVAL_REBALANCE_THRESHOLD },
 			{ 0 },
 	};
 
@@ -120,6 +142,19 @@ parse_app_args(int argc, char *argv[])
 		case SPP_LONGOPT_RETVAL_VHOST_CLIENT:
 			set_vhost_cli_mode(1);
 			break;
+		case SPP_LONGOPT_RETVAL_REBALANCE:
+			if (parse_rebalance_lcores(optarg) != SPPWK_RET_OK) {
+				usage(progname);
+				return SPPWK_RET_NG;
+			}
+			break;
+		case SPP_LONGOPT_RETVAL_REBALANCE_THRESHOLD:
+			if (parse_rebalance_threshold(optarg) !=
+					SPPWK_RET_OK) {
+				usage(progname);
+				return SPPWK_RET_NG;
+			}
+			break;
 		case 's':
 			ret = parse_server(&ctl_ip, &ctl_port, optarg);
 			set_spp_ctl_ip(ctl_ip);
@@ -154,6 +189,8 @@ slave_main(void *arg __attribute__ ((unused)))
 {
 	int ret = 0;
 	int cnt = 0;
+	int comp_id, nof_rx, nof_pkts;
+	uint64_t start_tsc, end_tsc, poll_tsc;
 	unsigned int lcore_id = rte_lcore_id();
 	enum sppwk_lcore_status status = SPPWK_LCORE_STOPPED;
 	struct core_mng_info *info = &g_core_info[lcore_id];
@@ -171,24 +208,40 @@ slave_main(void *arg __attribute__ ((unused)))
 			/* Setting with the flush command trigger. */
 			info->ref_index = (info->upd_index+1) % TWO_SIDES;
 			core = get_core_info(lcore_id);
+			apply_ring_fusion(lcore_id);
 		}
 
 		/* It is for processing multiple components. */
+		nof_pkts = 0;
+		poll_tsc = start_tsc = rte_rdtsc();
 		for (cnt = 0; cnt < core->num; cnt++) {
-			/* Component classification to call a function. */
-			if (sppwk_get_comp_type(core->id[cnt]) ==
-					SPPWK_TYPE_CLS) {
+			comp_id = core->id[cnt];
+
+			/**
+			 * Component classification to call a function, up to
+			 * its weight of bursts while it has backlog.
+			 */
+			if (sppwk_get_comp_type(comp_id) == SPPWK_TYPE_CLS)
 				/* Component type for classifier. */
-				ret = classify_packets(core->id[cnt]);
-				if (unlikely(ret != 0))
-					break;
-			} else {
+				nof_rx = sppwk_run_comp(comp_id,
+						core->weight[cnt],
+						classify_packets);
+			else
 				/* Component type for forward or merge. */
-				ret = forward_packets(core->id[cnt]);
-				if (unlikely(ret != 0))
-					break;
+				nof_rx = sppwk_run_comp(comp_id,
+						core->weight[cnt],
+						forward_packets);
+
+			if (unlikely(nof_rx < 0)) {
+				ret = SPPWK_RET_NG;
+				break;
 			}
+			end_tsc = rte_rdtsc();
+			add_comp_load(comp_id, end_tsc - start_tsc, nof_rx);
+			start_tsc = end_tsc;
+			nof_pkts += nof_rx;
 		}
+		update_lcore_stats(lcore_id, start_tsc - poll_tsc, nof_pkts);
 		if (unlikely(ret != 0)) {
 			RTE_LOG(ERR, SPP_VF, "Failed to forward on lcore %d. "
 					"(id = %d).\n",
@@ -272,6 +325,9 @@ main(int argc, char *argv[])
 
 		init_forwarder();
 		sppwk_port_capability_init();
+		init_ring_fusion();
+		init_rebalancer();
+		init_queue_occupancy();
 
 		/* Setup connection for accepting commands from controller */
 		get_spp_ctl_ip(ctl_ip);
@@ -280,24 +336,16 @@ main(int argc, char *argv[])
 		if (unlikely(ret != SPPWK_RET_OK))
 			break;
 
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
-		int port_type, port_id;
-		char dev_name[RTE_DEV_NAME_MAX_LEN] = { 0 };
-		int nof_rings = 0;
-		for (int i = 0; i < RTE_MAX_ETHPORTS; i++) {
-			if (!rte_eth_dev_is_valid_port(i))
-				continue;
-			rte_eth_dev_get_name_by_port(i, dev_name);
-			ret = parse_dev_name(dev_name, &port_type, &port_id);
-			if (port_type == RING)
-				nof_rings++;
-		}
-		ret = sppwk_init_ring_latency_stats(
-				SPP_RING_LATENCY_STATS_SAMPLING_INTERVAL,
-				nof_rings);
+		/* Latency is measured after enabled with a command. */
+		sppwk_init_port_burst(&g_vlan_burst, &g_vlan_stats_burst);
+		ret = sppwk_init_port_latency_stats(
+				SPP_RING_LATENCY_STATS_SAMPLING_INTERVAL);
+		if (unlikely(ret != SPPWK_RET_OK))
+			break;
+		ret = sppwk_init_e2e_latency_stats(
+				SPP_E2E_LATENCY_STATS_SAMPLING_RATE);
 		if (unlikely(ret != SPPWK_RET_OK))
 			break;
-#endif /* SPP_RINGLATENCYSTATS_ENABLE */
 
 		/* Start worker threads of classifier and forwarder */
 		RTE_LCORE_FOREACH_SLAVE(lcore_id) {
@@ -327,14 +375,16 @@ main(int argc, char *argv[])
 			if (unlikely(ret != SPPWK_RET_OK))
 				break;
 
+			/* Measure load and move components if required. */
+			run_rebalancer();
+
+			/* Sample num of packets waiting in RX queues. */
+			run_queue_occupancy();
+
 		       /*
 			* Wait to avoid CPU overloaded.
 			*/
 			usleep(100);
-
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
-			print_ring_latency_stats(&g_iface_info);
-#endif /* SPP_RINGLATENCYSTATS_ENABLE */
 		}
 
 		if (unlikely(ret != SPPWK_RET_OK)) {
@@ -358,9 +408,7 @@ main(int argc, char *argv[])
 	 */
 	del_vhost_sockfile(g_iface_info.vhost);
 
-#ifdef SPP_RINGLATENCYSTATS_ENABLE
-	sppwk_clean_ring_latency_stats();
-#endif /* SPP_RINGLATENCYSTATS_ENABLE */
+	sppwk_clean_latency_stats();
 
 	RTE_LOG(INFO, SPP_VF, "Exit spp_vf.\n");
 	return ret;
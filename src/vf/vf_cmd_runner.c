@@ -4,12 +4,16 @@
 
 #include "classifier.h"
 #include "forwarder.h"
+#include "rebalancer.h"
 #include "shared/secondary/return_codes.h"
 #include "shared/secondary/json_helper.h"
 #include "shared/secondary/spp_worker_th/port_capability.h"
 #include "shared/secondary/spp_worker_th/cmd_parser.h"
 #include "shared/secondary/spp_worker_th/cmd_runner.h"
 #include "shared/secondary/spp_worker_th/cmd_res_formatter.h"
+#include "shared/secondary/spp_worker_th/ring_fusion.h"
+#include "shared/secondary/spp_worker_th/queue_occupancy.h"
+#include "shared/secondary/spp_worker_th/latency_stats.h"
 #include "shared/secondary/spp_worker_th/vf_deps.h"
 
 #define RTE_LOGTYPE_VF_CMD_RUNNER RTE_LOGTYPE_USER1
@@ -23,6 +27,8 @@ const char *CLS_TYPE_A_LIST[] = {
 	"none",
 	"mac",
 	"vlan",
+	"qinq",
+	"vni",
 	"",  /* termination */
 };
 
@@ -30,7 +36,7 @@ const char *CLS_TYPE_A_LIST[] = {
 static int
 update_cls_table(enum sppwk_action wk_action,
 		enum sppwk_cls_type cls_type __attribute__ ((unused)),
-		int vid, const char *mac_str,
+		int svid, int vid, int vni, const char *mac_str,
 		const struct sppwk_port_idx *port)
 {
 	/**
@@ -73,6 +79,17 @@ update_cls_table(enum sppwk_action wk_action,
 					"Unexpected VLAN ID `%d`.\n", vid);
 			return SPPWK_RET_NG;
 		}
+		if (port_info->cls_attrs.svid != svid) {
+			RTE_LOG(ERR, VF_CMD_RUNNER,
+					"Unexpected outer VLAN ID `%d`.\n",
+					svid);
+			return SPPWK_RET_NG;
+		}
+		if (port_info->cls_attrs.vni != vni) {
+			RTE_LOG(ERR, VF_CMD_RUNNER,
+					"Unexpected VNI `%d`.\n", vni);
+			return SPPWK_RET_NG;
+		}
 		if ((port_info->cls_attrs.mac_addr != 0) &&
 				port_info->cls_attrs.mac_addr != mac_uint64) {
 			RTE_LOG(ERR, VF_CMD_RUNNER, "Unexpected MAC %s.\n",
@@ -82,6 +99,8 @@ update_cls_table(enum sppwk_action wk_action,
 
 		/* Initialize deleted attributes again. */
 		port_info->cls_attrs.vlantag.vid = ETH_VLAN_ID_MAX;
+		port_info->cls_attrs.svid = ETH_VLAN_ID_MAX;
+		port_info->cls_attrs.vni = SPP_VXLAN_VNI_NONE;
 		port_info->cls_attrs.mac_addr = 0;
 		memset(port_info->cls_attrs.mac_addr_str, 0x00, STR_LEN_SHORT);
 	} else if (wk_action == SPPWK_ACT_ADD) {
@@ -104,6 +123,8 @@ update_cls_table(enum sppwk_action wk_action,
 
 		/* Update attrs with validated params. */
 		port_info->cls_attrs.vlantag.vid = vid;
+		port_info->cls_attrs.svid = svid;
+		port_info->cls_attrs.vni = vni;
 		port_info->cls_attrs.mac_addr = mac_uint64;
 		strcpy(port_info->cls_attrs.mac_addr_str, mac_str);
 	}
@@ -167,6 +188,9 @@ update_comp(enum sppwk_action wk_action, const char *name,
 		comp_info->wk_type = wk_type;
 		comp_info->lcore_id = lcore_id;
 		comp_info->comp_id = comp_lcore_id;
+		comp_info->weight = SPPWK_WEIGHT_DEFAULT;
+		reset_comp_load(comp_lcore_id);
+		sppwk_reset_sched_stats(comp_lcore_id);
 
 		core->id[core->num] = comp_lcore_id;
 		core->num++;
@@ -260,7 +284,6 @@ update_port(enum sppwk_action wk_action,
 	int port_idx;
 	int ret_del = -1;
 	int comp_lcore_id = 0;
-	int cnt = 0;
 	struct sppwk_comp_info *comp_info = NULL;
 	struct sppwk_port_info *port_info = NULL;
 	int *nof_ports = NULL;
@@ -298,20 +321,12 @@ update_port(enum sppwk_action wk_action,
 		port_idx = get_idx_port_info(port_info, *nof_ports, ports);
 		if (port_idx >= SPPWK_RET_OK) {
 			/* registered */
-			if (port_attrs->ops == SPPWK_PORT_OPS_ADD_VLAN) {
-				while ((cnt < PORT_CAPABL_MAX) &&
-					    (port_info->port_attrs[cnt].ops !=
-					    SPPWK_PORT_OPS_ADD_VLAN))
-					cnt++;
-				if (cnt >= PORT_CAPABL_MAX) {
-					RTE_LOG(ERR, VF_CMD_RUNNER, "update VLAN tag "
-						"Non-registratio\n");
+			/* Update or add an action of registered port. */
+			if (port_attrs->ops != SPPWK_PORT_OPS_NONE) {
+				ret = sppwk_set_port_attrs(port_info,
+						port_attrs);
+				if (ret != SPPWK_RET_OK)
 					return SPPWK_RET_NG;
-				}
-				memcpy(&port_info->port_attrs[cnt], port_attrs,
-					sizeof(struct sppwk_port_attrs));
-
-				ret = SPPWK_RET_OK;
 				break;
 			}
 			return SPPWK_RET_OK;
@@ -324,18 +339,9 @@ update_port(enum sppwk_action wk_action,
 		}
 
 		if (port_attrs->ops != SPPWK_PORT_OPS_NONE) {
-			while ((cnt < PORT_CAPABL_MAX) &&
-					(port_info->port_attrs[cnt].ops !=
-					SPPWK_PORT_OPS_NONE)) {
-				cnt++;
-			}
-			if (cnt >= PORT_CAPABL_MAX) {
-				RTE_LOG(ERR, VF_CMD_RUNNER,
-						"No space of port ability.\n");
+			if (sppwk_set_port_attrs(port_info, port_attrs) !=
+					SPPWK_RET_OK)
 				return SPPWK_RET_NG;
-			}
-			memcpy(&port_info->port_attrs[cnt], port_attrs,
-					sizeof(struct sppwk_port_attrs));
 		}
 
 		port_info->iface_type = port->iface_type;
@@ -346,15 +352,8 @@ update_port(enum sppwk_action wk_action,
 		break;
 
 	case SPPWK_ACT_DEL:
-		for (cnt = 0; cnt < PORT_CAPABL_MAX; cnt++) {
-			if (port_info->port_attrs[cnt].ops ==
-					SPPWK_PORT_OPS_NONE)
-				continue;
-
-			if (port_info->port_attrs[cnt].dir == dir)
-				memset(&port_info->port_attrs[cnt], 0x00,
-					sizeof(struct sppwk_port_attrs));
-		}
+		/* Shaper of the port is also released. */
+		sppwk_reset_port_attrs(port_info, dir);
 
 		ret_del = delete_port_info(port_info, *nof_ports, ports);
 		if (ret_del == 0)
@@ -383,9 +382,12 @@ exec_one_cmd(const struct sppwk_cmd_attrs *cmd)
 	switch (cmd->type) {
 	case SPPWK_CMDTYPE_CLS_MAC:
 	case SPPWK_CMDTYPE_CLS_VLAN:
+	case SPPWK_CMDTYPE_CLS_QINQ:
 		ret = update_cls_table(cmd->spec.cls_table.wk_action,
 				cmd->spec.cls_table.cls_type,
+				cmd->spec.cls_table.svid,
 				cmd->spec.cls_table.vid,
+				cmd->spec.cls_table.vni,
 				cmd->spec.cls_table.mac,
 				&cmd->spec.cls_table.port);
 		if (ret == 0) {
@@ -395,6 +397,23 @@ exec_one_cmd(const struct sppwk_cmd_attrs *cmd)
 		break;
 
 	case SPPWK_CMDTYPE_WORKER:
+		/* Moving component flushes by itself for handing over. */
+		if (cmd->spec.comp.wk_action == SPPWK_ACT_MOVE) {
+			ret = move_comp_lcore(cmd->spec.comp.name,
+					cmd->spec.comp.core);
+			break;
+		}
+		if (cmd->spec.comp.wk_action == SPPWK_ACT_WEIGHT) {
+			ret = set_comp_weight(cmd->spec.comp.name,
+					cmd->spec.comp.weight);
+			break;
+		}
+		if (SPPWK_IS_MIR_OPT_ACT(cmd->spec.comp.wk_action)) {
+			RTE_LOG(ERR, VF_CMD_RUNNER,
+					"Action is only for mirror.\n");
+			ret = SPPWK_RET_NG;
+			break;
+		}
 		ret = update_comp(
 				cmd->spec.comp.wk_action,
 				cmd->spec.comp.name,
@@ -419,6 +438,18 @@ exec_one_cmd(const struct sppwk_cmd_attrs *cmd)
 		}
 		break;
 
+	case SPPWK_CMDTYPE_LATENCY_STATS:
+		RTE_LOG(INFO, VF_CMD_RUNNER, "with mode `%s`.\n",
+				cmd->spec.latency_stats.enable ? "on" : "off");
+		ret = sppwk_set_latency_stats(
+				cmd->spec.latency_stats.enable);
+		break;
+
+	case SPPWK_CMDTYPE_FILTER:
+		RTE_LOG(ERR, VF_CMD_RUNNER, "Filter is only for mirror.\n");
+		ret = SPPWK_RET_NG;
+		break;
+
 	default:
 		/* Do nothing. */
 		ret = SPPWK_RET_OK;
@@ -542,6 +573,16 @@ update_comp_info(struct sppwk_comp_info *p_comp_info, int *p_change_comp)
 	return SPPWK_RET_OK;
 }
 
+/* Check if updated info of component is taken by its lcore. */
+int
+is_comp_update_done(int comp_id)
+{
+	if (sppwk_get_comp_type(comp_id) == SPPWK_TYPE_CLS)
+		return is_classifier_update_done(comp_id);
+	else
+		return is_forwarder_update_done(comp_id);
+}
+
 /**
  * Operation function called in iterator for getting each of entries of
  * classifier table named as iterate_adding_mac_entry().
@@ -550,7 +591,7 @@ int
 append_classifier_element_value(
 		struct classifier_table_params *params,
 		enum sppwk_cls_type cls_type,
-		int vid, const char *mac,
+		int svid, int vid, const char *mac,
 		const struct sppwk_port_idx *port)
 {
 	int ret = SPPWK_RET_NG;
@@ -578,8 +619,13 @@ append_classifier_element_value(
 		sprintf(value_str, "%s", mac);
 		break;
 	case SPPWK_CLS_TYPE_VLAN:
+	case SPPWK_CLS_TYPE_VNI:
+		/* VNI is given as `vid` for VXLAN. */
 		sprintf(value_str, "%d/%s", vid, mac);
 		break;
+	case SPPWK_CLS_TYPE_QINQ:
+		sprintf(value_str, "%d/%d/%s", svid, vid, mac);
+		break;
 	default:
 		/* not used */
 		break;
@@ -642,8 +688,16 @@ int get_status_ops(struct cmd_res_formatter_ops *ops_list)
 		{ "vhost", add_interface },
 		{ "ring", add_interface },
 		{ "master-lcore", add_master_lcore},
+		{ "lcore_stats", add_lcore_stats},
+		{ "sched", add_sched_stats},
 		{ "core", add_core},
 		{ "classifier_table", add_classifier_table},
+		{ "rebalance", add_rebalancer_status},
+		{ "ring_fusion", add_ring_fusion_status},
+		{ "latency_stats", add_latency_stats_mode},
+		{ "port_latency", add_port_latency_status},
+		{ "e2e_latency", add_e2e_latency_status},
+		{ "queue_occupancy", add_queue_occupancy_status},
 		{ "", NULL }
 	};
 	memcpy(ops_list, tmp_ops_list, sizeof(tmp_ops_list));
@@ -224,3 +224,32 @@ class TestSppNfv(TestCase):
 
         self.assertTrue(pri['ring_ports'][ring_idx]['rx'] > 0)
         self.assertTrue(pri['ring_ports'][ring_idx]['tx'] > 0)
+
+    def test_lcore_stats(self):
+        """Check if busy cycles and packets of lcore are counted up.
+
+        Stats of the slave lcore are counted while forwarding packets
+        from null PMD, and it is confirmed to be busy.
+        """
+
+        wait_time = 1  # sec, wait for forwarding
+        ports = ['nullpmd:1', 'nullpmd:2']
+
+        for port in ports:
+            self._add_port(port)
+        self._patch(ports[0], ports[1])
+        self._set_forwarding_status('start')
+
+        time.sleep(wait_time)  # wait to start forwarding
+
+        self._set_forwarding_status('stop')
+        self._reset_patches()
+        for port in ports:
+            self._del_port(port)
+
+        nfv = self._get_nfv_status()
+        lcore_stats = nfv['lcore_stats']
+        self.assertTrue(len(lcore_stats) > 0)
+        self.assertTrue(lcore_stats[0]['busy_cycles'] > 0)
+        self.assertTrue(lcore_stats[0]['pkts'] > 0)
+        self.assertTrue(lcore_stats[0]['cycles_per_pkt'] > 0)
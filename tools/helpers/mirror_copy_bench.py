@@ -0,0 +1,107 @@
+#!/usr/bin/env python
+# SPDX-License-Identifier: BSD-3-Clause
+# Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+"""Compare cycles per packet of copy modes of spp_mirror.
+
+Copy mode of the component is changed for each of modes, and busy cycles and
+packets of the lcore running the component are sampled from `lcore_stats` of
+spp_mirror via spp-ctl. Traffic should be sent to the component while
+measuring.
+"""
+
+from __future__ import print_function
+import argparse
+import requests
+import sys
+import time
+
+COPY_MODES = ['shallow', 'deep', 'hybrid']
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(
+        description="Measure cost of copy modes of spp_mirror")
+    parser.add_argument('-b', '--bind-addr', type=str, default='127.0.0.1',
+                        help='Address of spp-ctl, default is 127.0.0.1')
+    parser.add_argument('-a', '--api-port', type=int, default=7777,
+                        help='Port of REST API of spp-ctl, default is 7777')
+    parser.add_argument('--sec-id', type=int, required=True,
+                        help='Secondary ID of spp_mirror')
+    parser.add_argument('--comp', type=str, required=True,
+                        help='Name of component such as mr1')
+    parser.add_argument('--modes', type=str, nargs='+', choices=COPY_MODES,
+                        default=COPY_MODES, help='Copy modes measured')
+    parser.add_argument('-d', '--duration', type=int, default=10,
+                        help='Seconds of measuring each mode')
+    return parser.parse_args()
+
+
+class MirrorClient(object):
+    """Send requests of spp_mirror to spp-ctl."""
+
+    def __init__(self, addr, port, sec_id):
+        self.base_url = 'http://%s:%d/v1/mirrors/%d' % (addr, port, sec_id)
+
+    def get_status(self):
+        res = requests.get(self.base_url)
+        res.raise_for_status()
+        return res.json()
+
+    def put_comp(self, comp, body):
+        res = requests.put('%s/components/%s' % (self.base_url, comp),
+                           json=body)
+        res.raise_for_status()
+
+    def get_lcore_id(self, comp):
+        for comp_info in self.get_status()['components']:
+            if comp_info.get('name') == comp:
+                return comp_info['core']
+        return None
+
+    def get_lcore_stats(self, lcore_id):
+        for stats in self.get_status()['lcore_stats']:
+            if stats['lcore_id'] == lcore_id:
+                return stats
+        return None
+
+
+def measure(client, args, mode):
+    """Set given copy mode and return cycles per packet."""
+
+    client.put_comp(args.comp, {'copy': mode})
+
+    lcore_id = client.get_lcore_id(args.comp)
+    if lcore_id is None:
+        print('Error: no such component %s' % args.comp)
+        sys.exit(1)
+
+    # Skip the first second for the lcore taking updated info.
+    time.sleep(1)
+    start = client.get_lcore_stats(lcore_id)
+    time.sleep(args.duration)
+    end = client.get_lcore_stats(lcore_id)
+
+    busy = end['busy_cycles'] - start['busy_cycles']
+    pkts = end['pkts'] - start['pkts']
+    if pkts == 0:
+        print('Error: no packets received on lcore %d' % lcore_id)
+        sys.exit(1)
+    return busy / float(pkts), pkts
+
+
+def main():
+    args = parse_args()
+    client = MirrorClient(args.bind_addr, args.api_port, args.sec_id)
+
+    results = {}
+    for mode in args.modes:
+        results[mode] = measure(client, args, mode)
+        print('%-7s: %.1f cycles/pkt (%d pkts)' % (
+            mode, results[mode][0], results[mode][1]))
+
+    # Leave the component with default mode.
+    client.put_comp(args.comp, {'copy': 'shallow'})
+
+
+if __name__ == '__main__':
+    main()
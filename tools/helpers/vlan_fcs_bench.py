@@ -0,0 +1,127 @@
+#!/usr/bin/env python
+# SPDX-License-Identifier: BSD-3-Clause
+# Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
+"""Compare cycles per packet of VLAN ops of spp_vf with and without FCS.
+
+Port is attached to the component again for each of the settings, and
+busy cycles and packets of the lcore running the component are sampled from
+`lcore_stats` of spp_vf via spp-ctl. Traffic should be sent to the component
+while measuring.
+"""
+
+from __future__ import print_function
+import argparse
+import requests
+import sys
+import time
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(
+        description="Measure cost of recalculating FCS in VLAN ops")
+    parser.add_argument('-b', '--bind-addr', type=str, default='127.0.0.1',
+                        help='Address of spp-ctl, default is 127.0.0.1')
+    parser.add_argument('-a', '--api-port', type=int, default=7777,
+                        help='Port of REST API of spp-ctl, default is 7777')
+    parser.add_argument('--sec-id', type=int, required=True,
+                        help='Secondary ID of spp_vf')
+    parser.add_argument('--comp', type=str, required=True,
+                        help='Name of component such as fwd1')
+    parser.add_argument('--port', type=str, required=True,
+                        help='Resource UID of port such as phy:0')
+    parser.add_argument('--dir', type=str, choices=['rx', 'tx'],
+                        required=True, help='Direction of port')
+    parser.add_argument('--vlan-op', type=str, choices=['add', 'del'],
+                        default='add', help='VLAN operation, default is add')
+    parser.add_argument('--vid', type=int, default=100,
+                        help='VLAN ID for add, default is 100')
+    parser.add_argument('--pcp', type=int, default=0,
+                        help='PCP for add, default is 0')
+    parser.add_argument('-d', '--duration', type=int, default=10,
+                        help='Seconds of measuring each setting')
+    return parser.parse_args()
+
+
+class VfClient(object):
+    """Send requests of spp_vf to spp-ctl."""
+
+    def __init__(self, addr, port, sec_id):
+        self.base_url = 'http://%s:%d/v1/vfs/%d' % (addr, port, sec_id)
+
+    def get_status(self):
+        res = requests.get(self.base_url)
+        res.raise_for_status()
+        return res.json()
+
+    def put_port(self, comp, body):
+        res = requests.put('%s/components/%s/ports' % (self.base_url, comp),
+                           json=body)
+        res.raise_for_status()
+
+    def get_lcore_id(self, comp):
+        for comp_info in self.get_status()['components']:
+            if comp_info.get('name') == comp:
+                return comp_info['core']
+        return None
+
+    def get_lcore_stats(self, lcore_id):
+        for stats in self.get_status()['lcore_stats']:
+            if stats['lcore_id'] == lcore_id:
+                return stats
+        return None
+
+
+def measure(client, args, fcs):
+    """Attach port with given FCS setting and return cycles per packet."""
+
+    client.put_port(args.comp, {'action': 'detach', 'port': args.port,
+                                'dir': args.dir})
+    vlan = {'operation': args.vlan_op, 'id': args.vid, 'pcp': args.pcp,
+            'fcs': fcs}
+    client.put_port(args.comp, {'action': 'attach', 'port': args.port,
+                                'dir': args.dir, 'vlan': vlan})
+
+    lcore_id = client.get_lcore_id(args.comp)
+    if lcore_id is None:
+        print('Error: no such component %s' % args.comp)
+        sys.exit(1)
+
+    # Skip the first second for the lcore taking updated info.
+    time.sleep(1)
+    start = client.get_lcore_stats(lcore_id)
+    time.sleep(args.duration)
+    end = client.get_lcore_stats(lcore_id)
+
+    busy = end['busy_cycles'] - start['busy_cycles']
+    pkts = end['pkts'] - start['pkts']
+    if pkts == 0:
+        print('Error: no packets received on lcore %d' % lcore_id)
+        sys.exit(1)
+    return busy / float(pkts), pkts
+
+
+def main():
+    args = parse_args()
+    client = VfClient(args.bind_addr, args.api_port, args.sec_id)
+
+    results = {}
+    for fcs in [False, True]:
+        results[fcs] = measure(client, args, fcs)
+        print('fcs %-5s: %.1f cycles/pkt (%d pkts)' % (
+            'on' if fcs else 'off', results[fcs][0], results[fcs][1]))
+
+    diff = results[True][0] - results[False][0]
+    print('FCS costs %.1f cycles/pkt (%.1f%%)' % (
+        diff, diff * 100 / results[False][0]))
+
+    # Leave the port with default setting.
+    client.put_port(args.comp, {'action': 'detach', 'port': args.port,
+                                'dir': args.dir})
+    client.put_port(args.comp, {
+        'action': 'attach', 'port': args.port, 'dir': args.dir,
+        'vlan': {'operation': args.vlan_op, 'id': args.vid,
+                 'pcp': args.pcp}})
+
+
+if __name__ == '__main__':
+    main()